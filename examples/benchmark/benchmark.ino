@@ -0,0 +1,260 @@
+/*!
+ * @file  benchmark.ino
+ * @brief  Measure the speed of the audio pipeline and print the results as JSON
+ * @details  The real A2DP data callback, the output processing (volume, filter, equalizer, channel swap), the WAV sample
+ * @n  converters and the sample rate converter are driven with synthetic audio, no Bluetooth, I2S or SD card is needed.
+ * @n  The output task's work is done as in the library, the output goes to a sink which drops it.
+ * @n  Each case reports ns per frame, frames per second and the realtime factor (seconds of audio processed per second),
+ * @n  the output sample width and the memory of the I2S DMA buffers at that width.
+ * @n  The JSON document is printed once after reset, keep it with the library version to track regressions across releases.
+ * @note  Build it once as it is and once with FILTER_FIXED_POINT opened in DFRobot_MAX98357A.h to compare both filters.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <DFRobot_MAX98357A.h>
+
+#define BENCH_VERSION   "1.0.1"   // Version of the library being measured, as in library.properties
+#define BENCH_BLOCKS   200   // Blocks processed per case, after one block to warm up the caches
+#define A2DP_BLOCK_FRAMES   512   // Stereo frames per A2DP data callback, as delivered by the SBC decoder
+#define SD_SOURCE_RATE   48000   // Sample rate of the converted SD case, so the sample rate converter is measured
+#define I2S_RATE   44100   // The fixed I2S rate of the library, the rate of the A2DP case
+
+/**
+ * The library keeps the processing in protected static functions, the benchmark reaches them through a derived class
+ */
+class BenchAmplifier : public DFRobot_MAX98357A
+{
+public:
+  static void a2dpData(const uint8_t *data, uint32_t len) { audioDataProcessCallback(data, len); }
+  static size_t output(size_t len) { return outputBuffer(len); }
+  static void sdData(Resampler &resampler, int16_t *out, const uint8_t *data, uint32_t len) { writeResampled(resampler, out, data, len, 0); }
+};
+
+/**
+ * Takes the output in place of I2S and drops it, in every sample width
+ */
+class DiscardSink : public AudioSink
+{
+public:
+  size_t write(const void *data, size_t len, uint32_t ticksToWait) { return len; }
+  bool setBitsPerSample(uint8_t bitsPerSample) { return true; }
+};
+
+BenchAmplifier amplifier;   // instantiate an object to control the amplifier
+DiscardSink discardSink;   // The output sink of the benchmark
+
+int16_t a2dpBlock[A2DP_BLOCK_FRAMES * 2];   // Synthetic 16-bit stereo A2DP data
+uint8_t wav16Block[WAV_WRITE_FRAMES * 4];   // Synthetic 16-bit stereo WAV data, as read from the SD card
+uint8_t wav24Block[WAV_WRITE_FRAMES * 6];   // Synthetic 24-bit stereo WAV data
+int16_t converted[WAV_WRITE_FRAMES * 2];   // WAV data converted to 16-bit stereo
+int16_t resampled[RESAMPLE_OUT_FRAMES * 2];   // Output of the sample rate converter
+
+bool swapped = true;   // The Bluetooth source swaps the channels by default
+bool firstResult = true;   // No comma before the first result
+
+/**************************************************************
+                      Setup And Loop
+**************************************************************/
+
+void setup(void)
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  /**
+   * The PCM buffer is allocated by initI2S() in normal use, the benchmark only needs the buffer and not the I2S driver
+   */
+  if(!amplifier.getPCMBuffer()->begin(PCM_BUFFER_SIZE)){
+    Serial.println("Allocate PCM buffer failed !");
+    return;
+  }
+  amplifier.setAudioSink(&discardSink);
+  makeTestSignal();
+
+  Serial.print("{\"library\":\"DFRobot_MAX98357A\",\"version\":\"" BENCH_VERSION "\"");
+  Serial.printf(",\"cpu_mhz\":%u,\"sample_rate\":%u", getCpuFrequencyMhz(), I2S_RATE);
+#ifdef FILTER_FIXED_POINT
+  Serial.print(",\"filter\":\"fixed\"");
+#else
+  Serial.print(",\"filter\":\"float\"");
+#endif
+  Serial.print(",\"results\":[");
+
+  // Bluetooth: the A2DP data callback and the output processing
+  setSwap(false);
+  amplifier.setVolume(5);   // Unity gain, the PCM buffer is written to the sink in place
+  benchA2DP("a2dp_unity");
+  setSwap(true);
+  benchA2DP("a2dp_unity_swap");   // Unity gain, the channels are swapped in place
+  setSwap(false);
+  amplifier.setVolume(3);
+  benchA2DP("a2dp_volume");
+  setSwap(true);
+  benchA2DP("a2dp_volume_swap");
+  amplifier.setVolume(9);   // Above unity, the limiter works
+  benchA2DP("a2dp_volume_limiter");
+  amplifier.setVolume(3);
+  amplifier.openFilter(bq_type_highpass, 500);
+  benchA2DP("a2dp_highpass");
+  amplifier.openFilter(bq_type_lowpass, 15000);
+  benchA2DP("a2dp_highpass_lowpass");
+  amplifier.setEqualizerBand(0, bq_type_lowshelf, 100, 0.707, 3);
+  amplifier.setEqualizerBand(1, bq_type_peak, 1000, 1.0, -2);
+  amplifier.setEqualizerBand(2, bq_type_highshelf, 8000, 0.707, 2);
+  amplifier.openEqualizer();
+  benchA2DP("a2dp_filter_equalizer");
+
+  // The same processing with wide output, the samples keep 8 more bits
+  amplifier.setOutputBits(24);
+  benchA2DP("a2dp_filter_equalizer_24bit");
+  amplifier.setOutputBits(32);
+  benchA2DP("a2dp_filter_equalizer_32bit");
+  amplifier.closeEqualizer();
+  amplifier.closeFilter();
+  benchA2DP("a2dp_volume_swap_32bit");
+  amplifier.setOutputBits(24);
+  benchA2DP("a2dp_volume_swap_24bit");
+  amplifier.setOutputBits(16);
+
+  // SD card: the WAV sample conversion, the sample rate conversion and the output processing
+  setSwap(false);
+  amplifier.setVolume(3);
+  benchSD("sd_16bit_44100", 16, I2S_RATE, RESAMPLER_QUALITY_MEDIUM);
+  benchSD("sd_24bit_44100", 24, I2S_RATE, RESAMPLER_QUALITY_MEDIUM);
+  benchSD("sd_16bit_48000_low", 16, SD_SOURCE_RATE, RESAMPLER_QUALITY_LOW);
+  benchSD("sd_16bit_48000_medium", 16, SD_SOURCE_RATE, RESAMPLER_QUALITY_MEDIUM);
+  benchSD("sd_16bit_48000_high", 16, SD_SOURCE_RATE, RESAMPLER_QUALITY_HIGH);
+  benchSD("sd_24bit_48000_medium", 24, SD_SOURCE_RATE, RESAMPLER_QUALITY_MEDIUM);
+
+  Serial.println("]}");
+}
+
+void loop()
+{
+  delay(1000);
+}
+
+/**************************************************************
+                      Test signal
+**************************************************************/
+
+void makeTestSignal(void)
+{
+  uint32_t noise = 2463534242UL;   // xorshift32, so the filters never see a settled input
+  for(int i=0; i<A2DP_BLOCK_FRAMES; i++){
+    noise ^= noise << 13;
+    noise ^= noise >> 17;
+    noise ^= noise << 5;
+    float t = (float)i / I2S_RATE;
+    int32_t left = (int32_t)(12000.0 * sin(2.0 * PI * 440.0 * t)) + (int16_t)(noise & 0x3ff) - 512;
+    int32_t right = (int32_t)(12000.0 * sin(2.0 * PI * 1000.0 * t)) + (int16_t)((noise >> 10) & 0x3ff) - 512;
+    a2dpBlock[2 * i] = (int16_t)left;
+    a2dpBlock[2 * i + 1] = (int16_t)right;
+  }
+
+  memcpy(wav16Block, a2dpBlock, sizeof(wav16Block));
+  for(size_t i=0; i<WAV_WRITE_FRAMES * 2; i++){   // Little-endian 24-bit, the low byte carries more noise
+    int32_t sample = a2dpBlock[i] * 256 + (i & 0xff);
+    wav24Block[3 * i] = (uint8_t)sample;
+    wav24Block[3 * i + 1] = (uint8_t)(sample >> 8);
+    wav24Block[3 * i + 2] = (uint8_t)(sample >> 16);
+  }
+}
+
+/**************************************************************
+                      Benchmark cases
+**************************************************************/
+
+void setSwap(bool swap)
+{
+  if(swap != swapped){
+    amplifier.reverseLeftRightChannels();
+    swapped = swap;
+  }
+}
+
+/**
+ * Do the work of the output task for the data in the PCM buffer
+ * flush - Also process the last partial DMA buffer
+ */
+void drainOutput(bool flush)
+{
+  const size_t bufferLen = I2S_DMA_BUF_LEN * 4;   // One DMA buffer of raw audio data
+  PCMRingBuffer *buffer = amplifier.getPCMBuffer();
+  while((buffer->available() >= bufferLen) || (flush && (buffer->available() >= 4))){
+    BenchAmplifier::output((buffer->available() < bufferLen) ? (buffer->available() & ~3) : bufferLen);
+  }
+}
+
+void printResult(const char *name, uint32_t frames, uint32_t sourceRate, uint32_t us)
+{
+  if(us == 0){
+    us = 1;
+  }
+  double seconds = us / 1000000.0;
+  uint8_t bits = amplifier.getOutputBits();
+  uint32_t dmaBytes = I2S_DMA_BUF_COUNT * I2S_DMA_BUF_LEN * 2 * ((bits == 16) ? 2 : 4);
+  Serial.printf("%s{\"name\":\"%s\",\"frames\":%u,\"source_rate\":%u,\"us\":%u,\"ns_per_frame\":%.1f,\"frames_per_sec\":%.0f,\"realtime_factor\":%.1f,\"output_bits\":%u,\"dma_bytes\":%u}",
+                firstResult ? "" : ",", name, frames, sourceRate, us,
+                us * 1000.0 / frames, frames / seconds, (frames / (double)sourceRate) / seconds, bits, dmaBytes);
+  firstResult = false;
+}
+
+void benchA2DP(const char *name)
+{
+  BenchAmplifier::a2dpData((const uint8_t *)a2dpBlock, sizeof(a2dpBlock));   // Warm up, and settle the volume ramp
+  drainOutput(true);
+
+  uint32_t start = micros();
+  for(int i=0; i<BENCH_BLOCKS; i++){
+    BenchAmplifier::a2dpData((const uint8_t *)a2dpBlock, sizeof(a2dpBlock));
+    drainOutput(false);
+  }
+  drainOutput(true);
+  uint32_t us = micros() - start;
+
+  printResult(name, BENCH_BLOCKS * A2DP_BLOCK_FRAMES, I2S_RATE, us);
+}
+
+void benchSD(const char *name, uint16_t bits, uint32_t rate, uint8_t quality)
+{
+  sWavFormat_t format;
+  memset(&format, 0, sizeof(format));
+  format.formatTag = WAV_FORMAT_PCM;
+  format.numChannels = 2;
+  format.sampleRate = rate;
+  format.bitsPerSample = bits;
+  format.validBits = bits;
+  format.blockAlign = 2 * (bits / 8);
+  pcmConvert_t convert = PCMConverter::select(format);   // NULL for 16-bit stereo, as in the player
+  const uint8_t *block = (bits == 24) ? wav24Block : wav16Block;
+
+  Resampler resampler;
+  if(!resampler.begin(rate, I2S_RATE, quality)){
+    Serial.println("Allocate the sample rate converter failed !");
+    return;
+  }
+
+  uint32_t start = 0;
+  for(int i=0; i<=BENCH_BLOCKS; i++){
+    if(i == 1){   // The first block only warms up
+      drainOutput(true);
+      start = micros();
+    }
+    const uint8_t *pcm = block;
+    if(convert != NULL){
+      convert(pcm, converted, WAV_WRITE_FRAMES);
+      pcm = (const uint8_t *)converted;
+    }
+    BenchAmplifier::sdData(resampler, resampled, pcm, WAV_WRITE_FRAMES * 4);
+    drainOutput(false);
+  }
+  drainOutput(true);
+  uint32_t us = micros() - start;
+
+  printResult(name, BENCH_BLOCKS * WAV_WRITE_FRAMES, rate, us);
+}
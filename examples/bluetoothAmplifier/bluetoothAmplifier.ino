@@ -15,6 +15,17 @@
 #include <DFRobot_MAX98357A.h>
 
 DFRobot_MAX98357A amplifier;   // instantiate an object to control the amplifier
+volatile bool metadataChanged = false;   // set by the Bluetooth task when the metadata of the playing track changes
+
+/**
+ * @brief Called in the Bluetooth task for every attribute of the metadata that changes, it only sets a flag for loop()
+ * @param type - ESP_AVRC_MD_ATTR_* type of the attribute
+ * @param text - The new text, "" when cleared at a track change
+ */
+void onMetadata(uint8_t type, const char *text)
+{
+  metadataChanged = true;
+}
 
 void setup(void)
 {
@@ -34,17 +45,25 @@ void setup(void)
   }
   Serial.println("Initialize succeed!");
 
+  amplifier.setMetadataCallback(onMetadata);
 }
 
 void loop(void)
 {
+  if(!metadataChanged){
+    delay(100);
+    return;
+  }
+  delay(200);   // Let the rest of the response arrive, the attributes come one by one
+  metadataChanged = false;
+
   String Title, Artist, Album;
   /**
-   * @brief Get "metadata" through AVRC command
+   * @brief Get "metadata" of the playing track, it is requested by the library and cached, so this does not wait
    * @param type - The type of metadata to be obtained, and the parameters currently supported:
-   * @n     ESP_AVRC_MD_ATTR_TITLE   ESP_AVRC_MD_ATTR_ARTIST   ESP_AVRC_MD_ATTR_ALBUM
-   * @return The corresponding type of "metadata"
-   * @note Return "NULL" if timeout occurs when requesting metadata
+   * @n     ESP_AVRC_MD_ATTR_TITLE   ESP_AVRC_MD_ATTR_ARTIST   ESP_AVRC_MD_ATTR_ALBUM   ESP_AVRC_MD_ATTR_TRACK_NUM
+   * @n     ESP_AVRC_MD_ATTR_NUM_TRACKS   ESP_AVRC_MD_ATTR_GENRE   ESP_AVRC_MD_ATTR_PLAYING_TIME
+   * @return The corresponding type of "metadata", empty when it has not been received
    */
   Title = amplifier.getMetadata(ESP_AVRC_MD_ATTR_TITLE);
   if(0 != Title.length()){
@@ -61,5 +80,4 @@ void loop(void)
     Serial.print("Music album: ");
     Serial.println(Album);
   }
-  delay(3000);
 }
@@ -0,0 +1,43 @@
+/*!
+ * @file  AudioSink.h
+ * @brief  Define the interface of the audio output sink
+ * @details  The processed audio data is submitted to a sink instead of calling the I2S driver directly,
+ * @n        so the output device can be replaced, e.g. by a sink counting calls and bytes on a host computer
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __AUDIO_SINK_H__
+#define __AUDIO_SINK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+class AudioSink
+{
+public:
+  virtual ~AudioSink() {}
+
+  /**
+   * @fn write
+   * @brief Submit audio data to the output device
+   * @param data - The audio data to be output, interleaved stereo frames
+   * @param len - Byte length of audio data
+   * @param ticksToWait - The longest time to wait for free space in the output device
+   * @return The number of bytes actually accepted, less than len on timeout or error
+   */
+  virtual size_t write(const void *data, size_t len, uint32_t ticksToWait) = 0;
+
+  /**
+   * @fn setBitsPerSample
+   * @brief Set the width of the samples written from now on, called by the output task between writes
+   * @param bitsPerSample - 16: int16_t samples; 24 or 32: int32_t words with the sample MSB-aligned
+   * @return true if the device takes the width, the default takes 16-bit samples only
+   */
+  virtual bool setBitsPerSample(uint8_t bitsPerSample) { return bitsPerSample == 16; }
+};
+
+#endif
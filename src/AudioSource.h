@@ -0,0 +1,34 @@
+/*!
+ * @file  AudioSource.h
+ * @brief  Define the interface of the audio input source
+ * @details  The audio data of a track is pulled from a source instead of calling fread directly,
+ * @n        so the input device can be replaced, e.g. by a throttled source simulating a slow SD card on a host computer
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __AUDIO_SOURCE_H__
+#define __AUDIO_SOURCE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+class AudioSource
+{
+public:
+  virtual ~AudioSource() {}
+
+  /**
+   * @fn read
+   * @brief Read the next audio data from the input device, it may block
+   * @param data - Buffer for the audio data
+   * @param len - Byte length of the buffer
+   * @return The number of bytes actually read, 0 at the end of the audio data or on error
+   */
+  virtual size_t read(void *data, size_t len) = 0;
+};
+
+#endif
@@ -71,10 +71,21 @@ void Biquad::setBiquad(int type, float Fc, float Q, float peakGainDB) {
 }
 
 void Biquad::calcBiquad(void) {
+    float coef[5];
+    calcCoefficients(type, Fc, Q, peakGain, coef);
+    a0 = coef[0];
+    a1 = coef[1];
+    a2 = coef[2];
+    b1 = coef[3];
+    b2 = coef[4];
+}
+
+void Biquad::calcCoefficients(int type, float Fc, float Q, float peakGain, float coef[5]) {
     float norm;
-    float V = pow(10, fabs(peakGain) / 20.0);
-    float K = tan(PI * Fc);
-    switch (this->type) {
+    float a0 = 1.0f, a1 = 0.0f, a2 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+    float V = powf(10.0f, fabsf(peakGain) / 20.0f);
+    float K = tanf((float)PI * Fc);
+    switch (type) {
         case bq_type_lowpass:
             norm = 1 / (1 + K / Q + K * K);
             a0 = K * K * norm;
@@ -131,41 +142,58 @@ void Biquad::calcBiquad(void) {
             break;
         case bq_type_lowshelf:
             if (peakGain >= 0) {    // boost
-                norm = 1 / (1 + sqrt(2) * K + K * K);
-                a0 = (1 + sqrt(2*V) * K + V * K * K) * norm;
+                norm = 1 / (1 + (float)M_SQRT2 * K + K * K);
+                a0 = (1 + sqrtf(2*V) * K + V * K * K) * norm;
                 a1 = 2 * (V * K * K - 1) * norm;
-                a2 = (1 - sqrt(2*V) * K + V * K * K) * norm;
+                a2 = (1 - sqrtf(2*V) * K + V * K * K) * norm;
                 b1 = 2 * (K * K - 1) * norm;
-                b2 = (1 - sqrt(2) * K + K * K) * norm;
+                b2 = (1 - (float)M_SQRT2 * K + K * K) * norm;
             }
             else {    // cut
-                norm = 1 / (1 + sqrt(2*V) * K + V * K * K);
-                a0 = (1 + sqrt(2) * K + K * K) * norm;
+                norm = 1 / (1 + sqrtf(2*V) * K + V * K * K);
+                a0 = (1 + (float)M_SQRT2 * K + K * K) * norm;
                 a1 = 2 * (K * K - 1) * norm;
-                a2 = (1 - sqrt(2) * K + K * K) * norm;
+                a2 = (1 - (float)M_SQRT2 * K + K * K) * norm;
                 b1 = 2 * (V * K * K - 1) * norm;
-                b2 = (1 - sqrt(2*V) * K + V * K * K) * norm;
+                b2 = (1 - sqrtf(2*V) * K + V * K * K) * norm;
             }
             break;
         case bq_type_highshelf:
             if (peakGain >= 0) {    // boost
-                norm = 1 / (1 + sqrt(2) * K + K * K);
-                a0 = (V + sqrt(2*V) * K + K * K) * norm;
+                norm = 1 / (1 + (float)M_SQRT2 * K + K * K);
+                a0 = (V + sqrtf(2*V) * K + K * K) * norm;
                 a1 = 2 * (K * K - V) * norm;
-                a2 = (V - sqrt(2*V) * K + K * K) * norm;
+                a2 = (V - sqrtf(2*V) * K + K * K) * norm;
                 b1 = 2 * (K * K - 1) * norm;
-                b2 = (1 - sqrt(2) * K + K * K) * norm;
+                b2 = (1 - (float)M_SQRT2 * K + K * K) * norm;
             }
             else {    // cut
-                norm = 1 / (V + sqrt(2*V) * K + K * K);
-                a0 = (1 + sqrt(2) * K + K * K) * norm;
+                norm = 1 / (V + sqrtf(2*V) * K + K * K);
+                a0 = (1 + (float)M_SQRT2 * K + K * K) * norm;
                 a1 = 2 * (K * K - 1) * norm;
-                a2 = (1 - sqrt(2) * K + K * K) * norm;
+                a2 = (1 - (float)M_SQRT2 * K + K * K) * norm;
                 b1 = 2 * (K * K - V) * norm;
-                b2 = (V - sqrt(2*V) * K + K * K) * norm;
+                b2 = (V - sqrtf(2*V) * K + K * K) * norm;
             }
             break;
+        case bq_type_lowpass1:    // Q is not used
+            norm = 1 / (1 + K);
+            a0 = K * norm;
+            a1 = a0;
+            b1 = (K - 1) * norm;
+            break;
+
+        case bq_type_highpass1:
+            norm = 1 / (1 + K);
+            a0 = norm;
+            a1 = -a0;
+            b1 = (K - 1) * norm;
+            break;
     }
-    
-    return;
+
+    coef[0] = a0;
+    coef[1] = a1;
+    coef[2] = a2;
+    coef[3] = b1;
+    coef[4] = b2;
 }
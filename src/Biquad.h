@@ -26,9 +26,12 @@
 
 #include <Arduino.h>
 
+#define DSP_INLINE   inline __attribute__((always_inline))   //!< Per-sample functions of the processing chains, inlined also when optimizing for size
+#define DSP_FRACTION_BITS   ((int)(8))   //!< Fraction bits below the output LSB carried by the int32_t samples of the processing chains
+
 /**
  * @enum None
- * @brief 7 filter modes
+ * @brief 9 filter modes, the last two are first-order sections, e.g. the odd stage of a Butterworth filter of odd order
  */
 enum {
     bq_type_lowpass = 0,
@@ -37,7 +40,9 @@ enum {
     bq_type_notch,
     bq_type_peak,
     bq_type_lowshelf,
-    bq_type_highshelf
+    bq_type_highshelf,
+    bq_type_lowpass1,
+    bq_type_highpass1
 };
 
 class Biquad {
@@ -105,6 +110,18 @@ public:
      * @return The processed data
      */
     float process(float in);
+
+    /**
+     * @fn calcCoefficients
+     * @brief Calculate the data processing coefficients of a filter, shared by the float and the fixed-point filters
+     * @param type - Filter type select, as the enumerated type above
+     * @param Fc - Ratio of filter threshold to sampling frequency, range: 0.0-0.5
+     * @param Q - Filter coefficient
+     * @param peakGain - Peak gain in dB. It is required in some filter modes
+     * @param coef - The calculated coefficients in the order a0, a1, a2, b1, b2
+     * @return None
+     */
+    static void calcCoefficients(int type, float Fc, float Q, float peakGain, float coef[5]);
     
 protected:
 
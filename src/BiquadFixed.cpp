@@ -0,0 +1,36 @@
+/*!
+ * @file  BiquadFixed.cpp
+ * @brief  Define the coefficients of the fixed-point biquad filters
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <math.h>
+
+#include "BiquadFixed.h"
+
+void quantizeBiquad(const float coef[5], int32_t fixed[5], int *shift)
+{
+  // Give up fraction bits until every coefficient fits, e.g. shelves and peaks with a large boost
+  int64_t scaled[5];
+  int bits = BIQUAD_FIXED_SHIFT + 1;
+  bool fit = false;
+  while(!fit && (bits > 16)){
+    bits--;
+    fit = true;
+    for(int i=0; i<5; i++){
+      scaled[i] = llround(ldexp((double)coef[i], bits));   // 2^bits * coef
+      if((scaled[i] > INT32_MAX) || (scaled[i] < INT32_MIN)){
+        fit = false;
+      }
+    }
+  }
+
+  for(int i=0; i<5; i++){
+    fixed[i] = (int32_t)scaled[i];
+  }
+  *shift = bits;
+}
@@ -0,0 +1,31 @@
+/*!
+ * @file  BiquadFixed.h
+ * @brief  Define the coefficients of the fixed-point biquad filters
+ * @details  StereoBiquadFixed and the fixed-point equalizer filter integer samples in direct form I with Q2.30 coefficients
+ * @n        (fewer fraction bits for coefficients of 2 or more) and a 64-bit accumulator. The coefficients come from the
+ * @n        one designer of the float filters, Biquad::calcCoefficients(), and are quantized here
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __BIQUAD_FIXED_H__
+#define __BIQUAD_FIXED_H__
+
+#include "Biquad.h"
+
+#define BIQUAD_FIXED_SHIFT   ((int)(30))   //!< The number of fraction bits of the coefficients when all of them are less than 2
+
+/**
+ * @fn quantizeBiquad
+ * @brief Scale the float coefficients of Biquad::calcCoefficients() for the fixed-point filters
+ * @param coef - The float coefficients in the order a0, a1, a2, b1, b2
+ * @param fixed - The coefficients scaled by 2^shift, in the same order
+ * @param shift - The number of fraction bits of the coefficients, BIQUAD_FIXED_SHIFT unless a coefficient is 2 or more
+ * @return None
+ */
+void quantizeBiquad(const float coef[5], int32_t fixed[5], int *shift);
+
+#endif
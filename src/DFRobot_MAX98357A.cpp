@@ -14,58 +14,163 @@
 
 uint8_t DFRobot_MAX98357A::remoteAddress[6];   // Address of the connected remote Bluetooth device
 
-float _volume = 1.0;   // Change the coefficient of audio signal volume
-int32_t _sampleRate = 44100;   // I2S communication frequency
+GainStage _gain;   // Change the audio signal volume
+int32_t _sampleRate = 44100;   // I2S communication frequency, fixed, the sources at other rates are converted to it
+std::atomic<uint8_t> _outputBitsSet(OUTPUT_BITS_PER_SAMPLE);   // The output sample width set by the control task
+uint8_t _outputBits = OUTPUT_BITS_PER_SAMPLE;   // The output sample width the output task works with
+uint8_t _resampleQuality = RESAMPLER_QUALITY_MEDIUM;   // Quality of the sample rate conversion
+Resampler _sdResampler;   // Converts the playing WAV file to the I2S rate
+StreamConverter _streamConverter;   // Converts the Bluetooth stream to the I2S rate and follows its drift, owned by the output task
+std::atomic<uint32_t> _streamRate(0);   // The sample rate of the Bluetooth stream, set by the A2DP event task
+std::atomic<uint32_t> _streamConfig(0);   // Counts the configurations of the Bluetooth stream, the output task sets up _streamConverter for each
+std::atomic<bool> _pcmFromStream(false);   // Whether the PCM buffer holds the Bluetooth stream at its own rate, set by the producer
+bool _driftCompensation = false;   // Whether the next Bluetooth stream follows the drift of its clock
+uint16_t _jitterLatencyMs = JITTER_LATENCY_MS;   // The fill level (ms) of the PCM buffer kept for a Bluetooth stream
 bool _avrcConnected = false;   // AVRC connection status
 bool _filterFlag = false;   // Filter enabling flag
 
-String _metadata = "";   // metadata
-uint8_t _metaFlag = 0;   // metadata refresh flag
+MetadataCache _metadata;   // The metadata of the playing track, filled by avrcCallback()
+void (*_metadataCallback)(uint8_t type, const char *text) = NULL;   // Called by avrcCallback() for every attribute that changes
 uint8_t _voiceSource = MAX98357A_VOICE_FROM_BT;   // The audio source, used to correct left and right audio
 
-Biquad _filterLLP[NUMBER_OF_FILTER];   // Left channel low-pass filter
-Biquad _filterRLP[NUMBER_OF_FILTER];   // Right channel low-pass filter
-Biquad _filterLHP[NUMBER_OF_FILTER];   // Left channel high-pass filter
-Biquad _filterRHP[NUMBER_OF_FILTER];   // Right channel high-pass filter
-
-char fileName[100];
-uint8_t SDAmplifierMark = SD_AMPLIFIER_STOP;   // SD card play flag
-xTaskHandle xPlayWAV = NULL;   // SD card play Task
-String _musicList[100];   // SD card music list
-uint8_t musicCount = 0;   // SD card music count
+FilterLP _filterLP;   // Stereo low-pass filter
+FilterHP _filterHP;   // Stereo high-pass filter
+FilterLP _filterLPOld;   // Stereo low-pass filter before a large change, used by the crossfade
+FilterHP _filterHPOld;   // Stereo high-pass filter before a large change, used by the crossfade
+uint16_t _filterFadeFrames = FILTER_FADE_FRAMES;   // Length of the crossfade after a large filter change
+uint16_t _fadeLength = 0;   // Length of the running crossfade
+uint16_t _fadeRemaining = 0;   // Stereo frames left in the running crossfade
 
 /**
- * @struct sWavParse_t
- * @brief The struct for parsing audio information in WAV format
+ * @struct sFilterCoefSet_t
+ * @brief The coefficients of the whole filter, handed over from setFilter() to the output task
  */
 typedef struct
 {
-    char                  riffType[4];
-    unsigned int          riffSize;
-    char                  waveType[4];
-    char                  formatType[4];
-    unsigned int          formatSize;
-    uint16_t              compressionCode;
-    i2s_channel_t         numChannels;
-    uint32_t              sampleRate;
-    unsigned int          bytesPerSecond;
-    unsigned short        blockAlign;
-    i2s_bits_per_sample_t bitsPerSample;
-    char                  dataType1[1];
-    char                  dataType2[3];
-    unsigned int          dataSize;
-    char                  data[800];
-}sWavParse_t;
+  FilterBiquad::sCoef_t lp[FilterLP::STAGES];
+  FilterBiquad::sCoef_t hp[FilterHP::STAGES];
+  uint16_t fadeFrames;   // Length of the crossfade to the new coefficients, 0 for none
+}sFilterCoefSet_t;
+
+sFilterCoefSet_t _filterDesign;   // The latest coefficients, owned by setFilter()
+float _filterFc[2] = {20000.0, 2.0};   // The latest threshold of the low-pass and high-pass filter
+TripleBuffer<sFilterCoefSet_t> _filterCoef;   // The coefficients published to the output task
+
+Equalizer _equalizer(44100);   // N-band equalizer
+bool _eqFlag = false;   // Equalizer enabling flag
+PeakLimiter _limiter(_sampleRate);   // Look-ahead limiter in front of the output
+bool _limiting = false;   // Whether the limiter is in the path, its delay line is flushed when it leaves the path
+uint32_t _limiterPrime = 0;   // Frames of the empty delay line still to be filled after the limiter entered the path, they are not output
+Requantizer _requantizer;   // Dither and noise shaping of the output
+
+typedef ChainCascade<FilterLP> filterLPStage_t;
+typedef ChainCascade<FilterHP> filterHPStage_t;
+template <typename out_t> using volumeChain_t = DSPChain<ChainGain<int32_t>, ChainRequantizer<out_t> >;   // Volume below unity
+template <typename out_t> using volumeLimitChain_t = DSPChain<ChainGain<filterSample_t>, ChainLimiter, ChainRequantizer<out_t> >;   // Volume above unity and limiter
+template <typename out_t> using filterChain_t = DSPChain<ChainGain<filterSample_t>, filterLPStage_t, filterHPStage_t, ChainLimiter, ChainRequantizer<out_t> >;   // Volume, low-pass and high-pass filter, limiter
+template <typename out_t> using eqChain_t = DSPChain<ChainGain<filterSample_t>, ChainEqualizer, ChainLimiter, ChainRequantizer<out_t> >;   // Volume, equalizer and limiter
+template <typename out_t> using filterEQChain_t = DSPChain<ChainGain<filterSample_t>, filterLPStage_t, filterHPStage_t, ChainEqualizer, ChainLimiter, ChainRequantizer<out_t> >;   // Volume, filter, equalizer and limiter
+typedef DSPChain<filterLPStage_t, filterHPStage_t> filterStages_t;
+typedef ChainCrossfade<filterStages_t> fadeStage_t;   // From the old to the new low-pass and high-pass filter
+template <typename out_t> using fadeChain_t = DSPChain<ChainGain<filterSample_t>, fadeStage_t, ChainLimiter, ChainRequantizer<out_t> >;   // Volume, crossfading filter, limiter
+template <typename out_t> using fadeEQChain_t = DSPChain<ChainGain<filterSample_t>, fadeStage_t, ChainEqualizer, ChainLimiter, ChainRequantizer<out_t> >;   // Volume, crossfading filter, equalizer and limiter
+template <typename out_t> using flushChain_t = DSPChain<ChainLimiter, ChainRequantizer<out_t> >;   // The frames left in the delay line of the limiter
+
+static inline fadeStage_t fadeStage(void)
+{
+  return fadeStage_t(filterStages_t(filterLPStage_t(&_filterLPOld), filterHPStage_t(&_filterHPOld)),
+                     filterStages_t(filterLPStage_t(&_filterLP), filterHPStage_t(&_filterHP)), &_fadeRemaining, &_fadeLength);
+}
 
 /**
- * @struct sWavInfo_t
- * @brief All the information of the audio in WAV format
+ * The chains of one type of output words, selected per block by processFrames(), the filters and the equalizer keep
+ * their state in the objects above
  */
-typedef struct
+template <typename out_t>
+struct OutputChains
 {
-    sWavParse_t header;
-    FILE *fp;
-}sWavInfo_t;
+  OutputChains()
+    : volume(ChainGain<int32_t>(&_gain), ChainRequantizer<out_t>(&_requantizer)),
+      volumeLimit(ChainGain<filterSample_t>(&_gain), ChainLimiter(&_limiter), ChainRequantizer<out_t>(&_requantizer)),
+      filter(ChainGain<filterSample_t>(&_gain), filterLPStage_t(&_filterLP), filterHPStage_t(&_filterHP),
+             ChainLimiter(&_limiter), ChainRequantizer<out_t>(&_requantizer)),
+      eq(ChainGain<filterSample_t>(&_gain), ChainEqualizer(&_equalizer), ChainLimiter(&_limiter), ChainRequantizer<out_t>(&_requantizer)),
+      filterEQ(ChainGain<filterSample_t>(&_gain), filterLPStage_t(&_filterLP), filterHPStage_t(&_filterHP),
+               ChainEqualizer(&_equalizer), ChainLimiter(&_limiter), ChainRequantizer<out_t>(&_requantizer)),
+      fade(ChainGain<filterSample_t>(&_gain), fadeStage(), ChainLimiter(&_limiter), ChainRequantizer<out_t>(&_requantizer)),
+      fadeEQ(ChainGain<filterSample_t>(&_gain), fadeStage(), ChainEqualizer(&_equalizer), ChainLimiter(&_limiter),
+             ChainRequantizer<out_t>(&_requantizer)),
+      flush(ChainLimiter(&_limiter), ChainRequantizer<out_t>(&_requantizer)) {}
+
+  volumeChain_t<out_t> volume;
+  volumeLimitChain_t<out_t> volumeLimit;
+  filterChain_t<out_t> filter;
+  eqChain_t<out_t> eq;
+  filterEQChain_t<out_t> filterEQ;
+  fadeChain_t<out_t> fade;
+  fadeEQChain_t<out_t> fadeEQ;
+  flushChain_t<out_t> flush;
+};
+
+OutputChains<int16_t> _chains16;   // 16-bit output
+OutputChains<int32_t> _chains32;   // 24-bit and 32-bit output
+
+static inline OutputChains<int16_t> & outputChains(int16_t * out) { return _chains16; }
+static inline OutputChains<int32_t> & outputChains(int32_t * out) { return _chains32; }
+
+I2SAudioSink _i2sSink(I2S_NUM_0, _sampleRate);   // The default output sink
+AudioSink * _sink = &_i2sSink;   // The output sink of the processed audio data
+PipelineStats _stats;   // Runtime statistics of the audio pipeline
+
+sTaskConfig_t _taskConfig[PIPELINE_STAGE_COUNT] = {   // Core, priority and stack size of each stage, by PIPELINE_STAGE_*
+  {PREFETCH_TASK_CORE, PREFETCH_TASK_PRIORITY, PREFETCH_TASK_STACK_SIZE},
+  {PLAY_TASK_CORE, PLAY_TASK_PRIORITY, PLAY_TASK_STACK_SIZE},
+  {OUTPUT_TASK_CORE, OUTPUT_TASK_PRIORITY, OUTPUT_TASK_STACK_SIZE},
+};
+
+PCMRingBuffer _pcmBuffer;   // The buffer between the audio source and the output task
+size_t _pcmBufferSize = PCM_BUFFER_SIZE;   // The depth of the PCM buffer
+PipelineTask _outputTask;   // The task draining the PCM buffer through the processing into the sink
+std::atomic<uint32_t> _outputConfig(0);   // Changed by the control task with every setting deciding the output path
+uint32_t _outputPathConfig = 0;   // The _outputConfig the output path was selected for
+uint8_t _outputPath = OUTPUT_PATH_PROCESS;   // How the output task handles the audio data
+bool _outputPathSettled = false;   // false: the output path is selected again before the next buffer
+
+PrefetchBuffer _prefetch;   // The read-ahead buffers between the SD card and the play task
+uint8_t _prefetchCount = PREFETCH_BUFFER_COUNT;   // The number of read-ahead buffers
+size_t _prefetchSize = PREFETCH_BUFFER_SIZE;   // The size of each read-ahead buffer
+FileAudioSource _fileSource;   // The audio data of the playing WAV file
+SemaphoreHandle_t _prefetchLock = NULL;   // Held by the reader task during each read, and by the play task while switching the file
+PipelineTask _prefetchTask;   // The task reading the SD card ahead of playback
+
+char fileName[sizeof(SD_MOUNT_POINT) + MUSIC_INDEX_PATH_LEN];   // Full path of the file to be played
+uint8_t SDAmplifierMark = SD_AMPLIFIER_STOP;   // SD card play flag
+PipelineTask _playTask;   // SD card play task, converts the WAV samples and the sample rate
+MusicIndex _musicIndex;   // SD card music index, kept on the card
+PlayQueue _queue;   // SD card playlist, track numbers of the music index
+bool _queueActive = false;   // Whether the play task takes its tracks from the queue
+volatile bool _skipRequest = false;   // Asks the play task to move on to the next track of the queue
+SemaphoreHandle_t _sdLock = NULL;   // Guards the music index, the queue and the file name shared by the application and the play task
+
+static inline void lockSD(void)
+{
+  if(_sdLock != NULL){
+    xSemaphoreTake(_sdLock, portMAX_DELAY);
+  }
+}
+
+static inline void unlockSD(void)
+{
+  if(_sdLock != NULL){
+    xSemaphoreGive(_sdLock);
+  }
+}
+
+// A setting deciding the output path has changed, the output task selects the path again before the next buffer
+static inline void outputConfigChanged(void)
+{
+  _outputConfig.fetch_add(1, std::memory_order_release);
+}
 
 /*************************** Init ******************************/
 
@@ -88,10 +193,8 @@ bool DFRobot_MAX98357A::begin(const char *btName, int bclk, int lrclk, int din)
   }
 
   // Initialize the filter
-  setFilter(_filterLLP, bq_type_lowpass, 20000.0);
-  setFilter(_filterRLP, bq_type_lowpass, 20000.0);
-  setFilter(_filterLHP, bq_type_highpass, 2.0);
-  setFilter(_filterRHP, bq_type_highpass, 2.0);
+  setFilter(bq_type_lowpass, 20000.0);
+  setFilter(bq_type_highpass, 2.0);
 
   return true;
 }
@@ -103,20 +206,29 @@ void DFRobot_MAX98357A::end(void)
   ESP_ERROR_CHECK(esp_bluedroid_disable());   // stop & destroy bluetooth
   ESP_ERROR_CHECK(esp_bluedroid_deinit());
   btStop();
+  _playTask.stop();   // Each task leaves its loop and ends itself, the play task first as it feeds the other two
+  _prefetchTask.stop();
+  _outputTask.stop();
+  _prefetch.end();   // release the buffers
+  if(_prefetchLock != NULL){
+    vSemaphoreDelete(_prefetchLock);
+    _prefetchLock = NULL;
+  }
+  _pcmBuffer.end();
   ESP_ERROR_CHECK(i2s_driver_uninstall(I2S_NUM_0));   // stop & destroy i2s driver
 }
 
 bool DFRobot_MAX98357A::initI2S(int _bclk, int _lrclk, int _din)
 {
-  static const i2s_config_t i2s_config = {
+  const i2s_config_t i2s_config = {
     .mode = static_cast<i2s_mode_t>(I2S_MODE_MASTER | I2S_MODE_TX),   // The main controller can transmit data but not receive.
     .sample_rate = _sampleRate,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,   // 16 bits per sample
+    .bits_per_sample = (_outputBits == 16) ? I2S_BITS_PER_SAMPLE_16BIT : I2S_BITS_PER_SAMPLE_32BIT,   // 24-bit samples are sent in 32-bit slots
     .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,   // 2-channels
     .communication_format = I2S_COMM_FORMAT_STAND_I2S,   // I2S communication I2S Philips standard, data launch at second BCK
     .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,   // Interrupt level 1
-    .dma_buf_count = 4,   // number of buffers, 128 max.
-    .dma_buf_len = 400,   // size of each buffer, AVRC communication may be affected if the value is too high.
+    .dma_buf_count = I2S_DMA_BUF_COUNT,   // number of buffers, 128 max.
+    .dma_buf_len = I2S_DMA_BUF_LEN,   // size of each buffer, AVRC communication may be affected if the value is too high.
     .use_apll = false,   // For the application of a high precision clock, select the APLL_CLK clock source in the frequency range of 16 to 128 MHz. It's not the case here, so select false.
     .tx_desc_auto_clear = true
   };
@@ -137,6 +249,18 @@ bool DFRobot_MAX98357A::initI2S(int _bclk, int _lrclk, int _din)
     return false;
   }
 
+  // Create the PCM buffer and the output task draining it into I2S
+  if (!_outputTask.isRunning()){
+    if (!_pcmBuffer.begin(_pcmBufferSize)){
+      DBG("Allocate PCM buffer failed !");
+      return false;
+    }
+    if (!_outputTask.start("outputTask", &outputTask, NULL, _taskConfig[PIPELINE_STAGE_OUTPUT])){
+      DBG("Create output task failed !");
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -195,6 +319,7 @@ bool DFRobot_MAX98357A::initBluetooth(const char * _btName)
     return false;
   }
   _voiceSource = MAX98357A_VOICE_FROM_BT;
+  outputConfigChanged();
 
   return true;
 }
@@ -229,9 +354,40 @@ bool DFRobot_MAX98357A::initSDCard(uint8_t csPin)
   // Serial.printf("SD Card Size: %lluMB\n", cardSize);
 
   _voiceSource = MAX98357A_VOICE_FROM_SD;
+  outputConfigChanged();
+
+  if(_sdLock == NULL){
+    _sdLock = xSemaphoreCreateMutex();
+    if(_sdLock == NULL){
+      DBG("Create SD lock failed !");
+      return false;
+    }
+  }
+  lockSD();
+  _musicIndex.begin(SD_MOUNT_POINT, MUSIC_INDEX_FILE);   // The index of the last scan, if any
+  unlockSD();
+
+  if(!_prefetchTask.isRunning()){
+    if(!_prefetch.begin(_prefetchCount, _prefetchSize)){
+      DBG("Allocate prefetch buffers failed !");
+      return false;
+    }
+    _prefetchLock = xSemaphoreCreateMutex();
+    if(_prefetchLock == NULL){
+      DBG("Create prefetch lock failed !");
+      return false;
+    }
+    if(!_prefetchTask.start("prefetchTask", &prefetchTask, NULL, _taskConfig[PIPELINE_STAGE_SD_READ])){
+      DBG("Create prefetch task failed !");
+      return false;
+    }
+  }
 
   SDAmplifierMark = SD_AMPLIFIER_STOP;
-  xTaskCreate(&playWAV, "playWAV", 2048, NULL, 5, &xPlayWAV);
+  if(!_playTask.isRunning() && !_playTask.start("playWAV", &playWAV, NULL, _taskConfig[PIPELINE_STAGE_DECODE])){
+    DBG("Create play task failed !");
+    return false;
+  }
 
   return true;
 }
@@ -241,61 +397,204 @@ bool DFRobot_MAX98357A::initSDCard(uint8_t csPin)
 void DFRobot_MAX98357A::reverseLeftRightChannels(void)
 {
   _voiceSource = (_voiceSource ? MAX98357A_VOICE_FROM_SD : MAX98357A_VOICE_FROM_BT);
+  outputConfigChanged();
 }
 
-void DFRobot_MAX98357A::listDir(fs::FS &fs, const char * dirName)
+void DFRobot_MAX98357A::setAudioSink(AudioSink * sink)
 {
-  DBG(dirName);
-  DBG("|");
+  _sink = (sink ? sink : &_i2sSink);
+}
 
-  File root = fs.open(dirName);
-  if(!root){
-    DBG("Failed to open directory");
-    return;
+void DFRobot_MAX98357A::setPCMBufferSize(size_t size)
+{
+  _pcmBufferSize = (size < PCM_BUFFER_MIN_SIZE) ? PCM_BUFFER_MIN_SIZE : size;
+}
+
+PCMRingBuffer * DFRobot_MAX98357A::getPCMBuffer(void)
+{
+  return &_pcmBuffer;
+}
+
+void DFRobot_MAX98357A::setPrefetchBuffers(uint8_t count, size_t size)
+{
+  _prefetchCount = count;
+  _prefetchSize = size;
+}
+
+PrefetchBuffer * DFRobot_MAX98357A::getPrefetchBuffer(void)
+{
+  return &_prefetch;
+}
+
+void DFRobot_MAX98357A::getStats(sPipelineStats_t * stats)
+{
+  _stats.snapshot(stats, getCpuFrequencyMhz() * 1000000, _sampleRate);
+  stats->pcmUnderruns = _pcmBuffer.getUnderruns();
+  stats->pcmOverruns = _pcmBuffer.getOverruns();
+  stats->pcmHighWater = _pcmBuffer.getHighWater();
+  stats->sdStalls = _prefetch.getStalls();
+  stats->prefetchLowWater = _prefetch.getLowWater();
+  stats->clockDrift = _streamConverter.getDrift();
+}
+
+void DFRobot_MAX98357A::resetStats(void)
+{
+  _stats.reset();
+  _pcmBuffer.resetCounters();
+  _prefetch.resetCounters();
+}
+
+void DFRobot_MAX98357A::setResampleQuality(uint8_t quality)
+{
+  _resampleQuality = quality;
+}
+
+void DFRobot_MAX98357A::setDriftCompensation(bool enable, uint16_t latencyMs)
+{
+  _driftCompensation = enable;
+  _jitterLatencyMs = latencyMs;
+}
+
+bool DFRobot_MAX98357A::setTaskConfig(uint8_t stage, int8_t core, uint8_t priority, uint32_t stackSize)
+{
+  PipelineTask * tasks[PIPELINE_STAGE_COUNT] = {&_prefetchTask, &_playTask, &_outputTask};   // By PIPELINE_STAGE_*
+  if((stage >= PIPELINE_STAGE_COUNT) || ((core != 0) && (core != 1) && (core != PIPELINE_NO_AFFINITY)) ||
+     (priority >= configMAX_PRIORITIES) || (stackSize < PIPELINE_MIN_STACK_SIZE)){
+    DBG("Unknown stage, core, priority or stack size !");
+    return false;
   }
-  if(!root.isDirectory()){
-    DBG("Not a directory");
-    return;
+  if(tasks[stage]->isRunning()){
+    DBG("The task already runs, set it up before it is created !");
+    return false;
   }
+  _taskConfig[stage].core = core;
+  _taskConfig[stage].priority = priority;
+  _taskConfig[stage].stackSize = stackSize;
+  return true;
+}
 
-  File file = root.openNextFile();
-  while(file){
-    // DBG(file.name());
-    if(file.isDirectory()){
-      listDir(fs, file.path());
-    } else {
-      DBG(file.path());
-      if(strstr(file.name(), ".wav")){
-        _musicList[musicCount] = file.path();
-        musicCount++;
-      }
+void DFRobot_MAX98357A::scanSDMusic(String * musicList)
+{
+  updateMusicIndex(false);
+  lockSD();
+  uint32_t count = _musicIndex.count();
+  if(count > SCAN_MUSIC_LIST_MAX){
+    count = SCAN_MUSIC_LIST_MAX;
+  }
+  sMusicTrack_t track;
+  for(uint32_t i = 0; i < count; i++){
+    if(_musicIndex.getTrack(i, &track)){
+      musicList[i] = track.path;
     }
-    file = root.openNextFile();
   }
+
+  // Set playing music by default
+  if((count > 0) && _musicIndex.getTrack(0, &track)){
+    strcpy(fileName, SD_MOUNT_POINT);
+    strncat(fileName, track.path, sizeof(fileName) - strlen(fileName) - 1);
+  }
+  unlockSD();
 }
 
-void DFRobot_MAX98357A::scanSDMusic(String * musicList)
+uint32_t DFRobot_MAX98357A::updateMusicIndex(bool full)
 {
-  musicCount = 0;   // Discard original list
-  listDir(SD, "/");
-  uint8_t i = 0;
-  while(i < musicCount){
-    musicList[i] = _musicList[i];
-    i++;
+  lockSD();
+  if(!_musicIndex.update(full)){
+    DBG("Write music index failed !");
   }
+  DBG(_musicIndex.getScannedDirs());
+  DBG(_musicIndex.getParsedFiles());
+  uint32_t count = _musicIndex.count();
+  unlockSD();
+  return count;
+}
 
-  // Set playing music by default
-  char SDName[80]="/sd";
-  strcat(SDName, musicList[0].c_str());
-  strcpy(fileName, SDName);
+uint32_t DFRobot_MAX98357A::getMusicCount(void)
+{
+  lockSD();
+  uint32_t count = _musicIndex.count();
+  unlockSD();
+  return count;
+}
+
+bool DFRobot_MAX98357A::getMusicTrack(uint32_t index, sMusicTrack_t * track)
+{
+  lockSD();
+  bool ret = _musicIndex.getTrack(index, track);
+  unlockSD();
+  return ret;
+}
+
+bool DFRobot_MAX98357A::enqueueSDMusic(uint32_t index)
+{
+  lockSD();
+  bool ret = (index < _musicIndex.count()) && _queue.enqueue(index);
+  unlockSD();
+  return ret;
+}
+
+void DFRobot_MAX98357A::clearSDQueue(void)
+{
+  SDPlayerControl(SD_AMPLIFIER_STOP);
+  lockSD();
+  _queue.clear();
+  _queueActive = false;
+  unlockSD();
+}
+
+bool DFRobot_MAX98357A::playSDQueue(void)
+{
+  SDPlayerControl(SD_AMPLIFIER_STOP);
+  uint32_t index;
+  lockSD();
+  _queueActive = _queue.start(&index);
+  bool ret = _queueActive;
+  unlockSD();
+  if(ret){
+    SDPlayerControl(SD_AMPLIFIER_PLAY);
+  }
+  return ret;
+}
+
+void DFRobot_MAX98357A::nextSDMusic(void)
+{
+  if(SD_AMPLIFIER_STOP != SDAmplifierMark){   // The play task moves on and keeps playing
+    _skipRequest = true;
+    SDPlayerControl(SD_AMPLIFIER_PLAY);
+    return;
+  }
+  uint32_t index;
+  lockSD();
+  bool ret = _queueActive && _queue.next(&index, true);
+  unlockSD();
+  if(ret){
+    SDPlayerControl(SD_AMPLIFIER_PLAY);
+  }
+}
+
+void DFRobot_MAX98357A::setSDRepeat(uint8_t mode)
+{
+  lockSD();
+  _queue.setRepeat(mode);
+  unlockSD();
+}
+
+void DFRobot_MAX98357A::setSDShuffle(bool shuffle)
+{
+  lockSD();
+  _queue.setSeed(esp_random());
+  _queue.setShuffle(shuffle);
+  unlockSD();
 }
 
 void DFRobot_MAX98357A::playSDMusic(const char *musicName)
 {
   SDPlayerControl(SD_AMPLIFIER_STOP);
-  char SDName[80]="/sd";   // The default SD card mount point in SD.h
-  strcat(SDName, musicName);   // It need to be an absolute path.
-  strcpy(fileName, SDName);
+  lockSD();
+  _queueActive = false;   // A single track, not the queue
+  strcpy(fileName, SD_MOUNT_POINT);   // The default SD card mount point in SD.h
+  strncat(fileName, musicName, sizeof(fileName) - strlen(fileName) - 1);   // It need to be an absolute path.
+  unlockSD();
   SDPlayerControl(SD_AMPLIFIER_PLAY);
 }
 
@@ -307,18 +606,12 @@ void DFRobot_MAX98357A::SDPlayerControl(uint8_t CMD)
 
 String DFRobot_MAX98357A::getMetadata(uint8_t type)
 {
-  _metadata = "";
-  if(_avrcConnected){
-    esp_avrc_ct_send_metadata_cmd(type, type);   // Request metadata from remote Bluetooth device via AVRC command
-    for(uint8_t i=0; i<20; i++){   // Wait response
-      if(0 != _metaFlag){
-        break;
-      }
-      delay(100);
-    }
-    _metaFlag = 0;
-  }
-  return _metadata;
+  return String(_metadata.get(type));
+}
+
+void DFRobot_MAX98357A::setMetadataCallback(void (*callback)(uint8_t type, const char *text))
+{
+  _metadataCallback = callback;
 }
 
 uint8_t * DFRobot_MAX98357A::getRemoteAddress(void)
@@ -332,53 +625,130 @@ uint8_t * DFRobot_MAX98357A::getRemoteAddress(void)
 void DFRobot_MAX98357A::setVolume(float vol)
 {
   vol /= 5.0;   // vol range is 0-9
-  _volume = constrain(vol, 0.0, 2.0);
+  _gain.setGain(constrain(vol, 0.0, 2.0));   // Reached with a ramp over the next block
+  outputConfigChanged();
+}
+
+void DFRobot_MAX98357A::setVolumeDB(float gainDB)
+{
+  _gain.setGainDB(gainDB);
+  outputConfigChanged();
 }
 
 void DFRobot_MAX98357A::openFilter(int type, float fc)
 {
-  if(bq_type_lowpass == type){   // Set low-pass filter
-    setFilter(_filterLLP, type, fc);
-    setFilter(_filterRLP, type, fc);
-  }else{   // Set high-pass filter
-    setFilter(_filterLHP, type, fc);
-    setFilter(_filterRHP, type, fc);
-  }
+  setFilter(type, fc);
   _filterFlag = true;
+  outputConfigChanged();
 }
 
 void DFRobot_MAX98357A::closeFilter(void)
 {
   _filterFlag = false;
+  outputConfigChanged();
 }
 
-void DFRobot_MAX98357A::setFilter(Biquad * _filter, int _type, float _fc)
+void DFRobot_MAX98357A::setFilterCrossfade(uint16_t frames)
 {
-  _fc = (constrain(_fc, 2.0, 20000.0)) / (float)_sampleRate;   // Ratio of filter threshold to sampling frequency, range: 0.0-0.5
-  float Q;
-  for(int i; i<NUMBER_OF_FILTER; i++){
-    Q = 1 / (2 * cos( PI / (NUMBER_OF_FILTER * 4) + i * PI / (NUMBER_OF_FILTER * 2) ));
-    DBG("\n-------- Q ");
-    DBG(Q);
-    DBG("++++++++ _fc ");
-    DBG(_fc);
-    DBG("++++++++ _type ");
-    DBG(_type);
-    _filter[i].setBiquad(_type, _fc, Q, 0);
+  _filterFadeFrames = frames;
+}
+
+bool DFRobot_MAX98357A::setEqualizerBand(uint8_t band, int type, float fc, float Q, float gainDB)
+{
+  bool ret = _equalizer.setBand(band, type, fc, Q, gainDB);
+  outputConfigChanged();   // A flat band drops out of the equalizer
+  return ret;
+}
+
+bool DFRobot_MAX98357A::enableEqualizerBand(uint8_t band, bool enable)
+{
+  bool ret = _equalizer.enableBand(band, enable);
+  outputConfigChanged();
+  return ret;
+}
+
+void DFRobot_MAX98357A::openEqualizer(void)
+{
+  _eqFlag = true;
+  outputConfigChanged();
+}
+
+void DFRobot_MAX98357A::closeEqualizer(void)
+{
+  _eqFlag = false;
+  outputConfigChanged();
+}
+
+void DFRobot_MAX98357A::setLimiter(float ceilingDB, float attackMs, float releaseMs)
+{
+  _limiter.set(ceilingDB, attackMs, releaseMs);
+}
+
+bool DFRobot_MAX98357A::setOutputBits(uint8_t bitsPerSample)
+{
+  if((bitsPerSample != 16) && (bitsPerSample != 24) && (bitsPerSample != 32)){
+    DBG("Unknown output width !");
+    return false;
+  }
+  _outputBitsSet.store(bitsPerSample, std::memory_order_relaxed);
+  if(!_outputTask.isRunning()){   // Nothing is output yet, the I2S driver is installed with the width
+    _outputBits = bitsPerSample;
+    _requantizer.setOutputBits(bitsPerSample);
   }
+  outputConfigChanged();
+  return true;
 }
 
-int16_t DFRobot_MAX98357A::filterToWork(Biquad * filterHP, Biquad * filterLP, float rawData)
+uint8_t DFRobot_MAX98357A::getOutputBits(void)
 {
-  for(int i; i<NUMBER_OF_FILTER; i++){
-    rawData = filterLP[i].process(rawData);
+  return _outputBits;
+}
+
+bool DFRobot_MAX98357A::setDither(uint8_t bitsPerSample, uint8_t mode)
+{
+  if(!_requantizer.setMode(bitsPerSample, mode)){
+    DBG("Unknown output width or dither mode !");
+    return false;
   }
+  return true;
+}
 
-  for(int i; i<NUMBER_OF_FILTER; i++){
-    rawData = filterHP[i].process(rawData);
+void DFRobot_MAX98357A::setFilter(int _type, float _fc)
+{
+  _fc = constrain(_fc, 2.0, 20000.0);
+  float * lastFc = (bq_type_lowpass == _type) ? &_filterFc[0] : &_filterFc[1];
+  // Crossfade when the threshold moves by more than an octave, smaller steps are applied directly
+  bool largeChange = (_fc > *lastFc * 2) || (_fc * 2 < *lastFc);
+  *lastFc = _fc;
+
+  _fc /= (float)_sampleRate;   // Ratio of filter threshold to sampling frequency, range: 0.0-0.5
+  DBG("++++++++ _fc ");
+  DBG(_fc);
+  DBG("++++++++ _type ");
+  DBG(_type);
+  if(bq_type_lowpass == _type){   // The Q of every stage is a constant of the filter type
+    FilterLP::design(_type, _fc, _filterDesign.lp);
+  }else{
+    FilterHP::design(_type, _fc, _filterDesign.hp);
   }
+  _filterDesign.fadeFrames = largeChange ? _filterFadeFrames : 0;
+  _filterCoef.write(_filterDesign);   // Publish the whole set at once, the output task never sees half of it
+}
 
-  return (int16_t)(constrain(rawData, -32767, 32767));
+void DFRobot_MAX98357A::updateFilter(void)
+{
+  if(!_filterCoef.update()){
+    return;
+  }
+  const sFilterCoefSet_t &set = _filterCoef.front();
+  if(_filterFlag && (set.fadeFrames > 0)){   // Keep the old filter running during the crossfade
+    _filterLPOld = _filterLP;
+    _filterHPOld = _filterHP;
+    _fadeLength = set.fadeFrames;
+    _fadeRemaining = set.fadeFrames;
+  }
+  _filterLP.setCoefficients(set.lp);
+  _filterHP.setCoefficients(set.hp);
 }
 
 /*************************** Function ******************************/
@@ -399,6 +769,21 @@ void DFRobot_MAX98357A::a2dpCallback(esp_a2d_cb_event_t event, esp_a2d_cb_param_
      * } audio_cfg;                               /*!< media codec configuration information
      */
     case ESP_A2D_AUDIO_CFG_EVT:
+      // Also sent on a reconfiguration or a reconnection while the output task converts, it sets up the converter itself
+      if(a2d->audio_cfg.mcc.type == ESP_A2D_MCT_SBC){
+        uint32_t rate = 16000;
+        uint8_t oct0 = a2d->audio_cfg.mcc.cie.sbc[0];   // Sampling frequency bits of the SBC codec information
+        if(oct0 & (0x01 << 6)){
+          rate = 32000;
+        }else if(oct0 & (0x01 << 5)){
+          rate = 44100;
+        }else if(oct0 & (0x01 << 4)){
+          rate = 48000;
+        }
+        _streamRate.store(rate, std::memory_order_relaxed);
+        _streamConfig.fetch_add(1, std::memory_order_release);
+      }
+      break;
     /*!<
      * Connection state changed event
      *
@@ -430,17 +815,12 @@ void DFRobot_MAX98357A::avrcCallback(esp_avrc_ct_cb_event_t event, esp_avrc_ct_c
 
   switch (event) {
     /*!< metadata response event */
-    case ESP_AVRC_CT_METADATA_RSP_EVT: {
-        char *attr_text = (char *) malloc (rc->meta_rsp.attr_length + 1);
-        memcpy(attr_text, rc->meta_rsp.attr_text, rc->meta_rsp.attr_length);
-        attr_text[rc->meta_rsp.attr_length] = 0;
-        _metadata = String(attr_text);
-        _metaFlag = rc->meta_rsp.attr_id;
-        DBG("_metadata");
-        DBG(_metadata);
+    case ESP_AVRC_CT_METADATA_RSP_EVT: {   // One event per attribute of the request
+        uint8_t type = rc->meta_rsp.attr_id;
+        if(_metadata.set(type, rc->meta_rsp.attr_text, rc->meta_rsp.attr_length) && (_metadataCallback != NULL)){
+          _metadataCallback(type, _metadata.stored(type));
+        }
         DBG(rc->meta_rsp.attr_id);
-
-        free(attr_text);
         break;
       }
     /*!< connection state changed event */
@@ -453,17 +833,24 @@ void DFRobot_MAX98357A::avrcCallback(esp_avrc_ct_cb_event_t event, esp_avrc_ct_c
             remoteAddress[i] = *(p + i);
             DBG(remoteAddress[i], HEX);
           }
+          requestMetadata();
         /*!< disconnecting remote device */
         }else{
           DBG(sizeof(remoteAddress));
           memset(remoteAddress, 0, 6);
+          clearMetadata();
         }
         break;
       }
-    /*!< passthrough response event */
-    case ESP_AVRC_CT_PASSTHROUGH_RSP_EVT:
     /*!< notification event */
     case ESP_AVRC_CT_CHANGE_NOTIFY_EVT:
+      if(rc->change_ntf.event_id == ESP_AVRC_RN_TRACK_CHANGE){   // The registration is used up by the notification, requestMetadata() renews it
+        clearMetadata();
+        requestMetadata();
+      }
+      break;
+    /*!< passthrough response event */
+    case ESP_AVRC_CT_PASSTHROUGH_RSP_EVT:
     /*!< feature of remote device indication event */
     case ESP_AVRC_CT_REMOTE_FEATURES_EVT:
     /*!< supported notification events capability of peer device */
@@ -479,128 +866,624 @@ void DFRobot_MAX98357A::avrcCallback(esp_avrc_ct_cb_event_t event, esp_avrc_ct_c
   }
 }
 
-void DFRobot_MAX98357A::audioDataProcessCallback(const uint8_t *data, uint32_t len)
+void DFRobot_MAX98357A::requestMetadata(void)
 {
-  int16_t* data16 = (int16_t*)data;   // Convert to 16-bit sample data
-  int16_t processedData[2];   // Store the processed audio data
-  int count = len / 4;   // The number of audio data to be processed in int16_t[2]
-  size_t i2s_bytes_write = 0;   // i2s_write() the variable storing the number of data to be written
+  if(esp_avrc_ct_send_metadata_cmd(AVRC_TL_METADATA, METADATA_ATTR_ALL)){   // All attributes in one command
+    DBG("Request the metadata failed !");
+  }
+  if(esp_avrc_ct_send_register_notification_cmd(AVRC_TL_TRACK_CHANGE, ESP_AVRC_RN_TRACK_CHANGE, 0)){
+    DBG("Register the track change notification failed !");
+  }
+}
+
+void DFRobot_MAX98357A::clearMetadata(void)
+{
+  uint8_t cleared = _metadata.clear();
+  for(uint8_t i=0; (i<METADATA_ATTR_COUNT) && (_metadataCallback != NULL); i++){
+    if(cleared & (1 << i)){
+      _metadataCallback((uint8_t)(1 << i), "");
+    }
+  }
+}
+
+// The largest absolute sample of a block in 16-bit units, for the statistics
+template <typename out_t>
+static inline uint16_t peakOf(const out_t * data, int n)
+{
+  int32_t lo = 0, hi = 0;
+  for(int i=0; i<n; i++){
+    int32_t x = data[i] >> (8 * (sizeof(out_t) - sizeof(int16_t)));
+    lo = (x < lo) ? x : lo;
+    hi = (x > hi) ? x : hi;
+  }
+  return (uint16_t)((-lo > hi) ? -lo : hi);
+}
+
+#ifdef PCM_WIDE_SAMPLES
+// Unity gain, the wide samples are the words of 32-bit output as they are, narrower output is requantized
+static inline bool copyFrames(const pcm_t * in, int16_t * out, int count, uint8_t swap)
+{
+  return false;
+}
+
+static inline bool copyFrames(const pcm_t * in, int32_t * out, int count, uint8_t swap)
+{
+  if(_outputBits != 32){
+    return false;
+  }
+  for(int i=0; i<count; i++){
+    out[2 * i + swap] = in[2 * i];
+    out[2 * i + 1 - swap] = in[2 * i + 1];
+  }
+  return true;
+}
+#else
+// Unity gain, the samples are copied, widened for 24-bit and 32-bit output
+static inline bool copyFrames(const pcm_t * in, int16_t * out, int count, uint8_t swap)
+{
+  if(swap == 0){
+    memcpy(out, in, count * 2 * sizeof(int16_t));
+    return true;
+  }
+  for(int i=0; i<count; i++){
+    int16_t l = in[2 * i];
+    out[2 * i] = in[2 * i + 1];
+    out[2 * i + 1] = l;
+  }
+  return true;
+}
+
+static inline bool copyFrames(const pcm_t * in, int32_t * out, int count, uint8_t swap)
+{
+  for(int i=0; i<count; i++){
+    out[2 * i + swap] = (int32_t)in[2 * i] * 65536;
+    out[2 * i + 1 - swap] = (int32_t)in[2 * i + 1] * 65536;
+  }
+  return true;
+}
+#endif
+
+// Swap the channels of 16-bit stereo frames in place, each frame is one 32-bit word rotated by 16 bits,
+// the peak for the statistics is taken in the same pass
+static inline uint16_t swapFramesInPlace(uint32_t * frames, size_t count)
+{
+  int32_t lo = 0, hi = 0;
+  for(size_t i=0; i<count; i++){
+    uint32_t w = frames[i];
+    int32_t a = (int16_t)w;
+    int32_t b = (int16_t)(w >> 16);
+    lo = (a < lo) ? a : lo;
+    hi = (a > hi) ? a : hi;
+    lo = (b < lo) ? b : lo;
+    hi = (b > hi) ? b : hi;
+    frames[i] = (w >> 16) | (w << 16);
+  }
+  return (uint16_t)((-lo > hi) ? -lo : hi);
+}
+
+int DFRobot_MAX98357A::processFrames(const pcm_t * in, void * out, int count)
+{
+  if(_outputBits == 16){
+    return processFramesTo(in, (int16_t *)out, count);
+  }else{
+    return processFramesTo(in, (int32_t *)out, count);
+  }
+}
+
+int DFRobot_MAX98357A::flushLimiter(void * out)
+{
+  if(_outputBits == 16){
+    return flushLimiterTo((int16_t *)out);
+  }else{
+    return flushLimiterTo((int32_t *)out);
+  }
+}
 
-  if(!_filterFlag){   // Change sample data only according to volume multiplier
-    for(int i=0; i<count; i++){
-      processedData[0+_voiceSource] = (int16_t)((*data16) * _volume);   // Change audio data volume of left channel
-      DBG(processedData[0], HEX);
-      data16++;
+// Drop the first frames of a block while the delay line of the limiter is being filled, they are its initial silence
+template <typename out_t>
+static inline int dropPrimeFrames(out_t * out, int count)
+{
+  int drop = (_limiterPrime < (uint32_t)count) ? (int)_limiterPrime : count;
+  if(drop > 0){
+    memmove(out, out + 2 * drop, (count - drop) * 2 * sizeof(out_t));
+    _limiterPrime -= drop;
+  }
+  return count - drop;
+}
 
-      processedData[1-_voiceSource] = (int16_t)((*data16) * _volume);   // Change audio data volume of right channel
-      DBG(processedData[1], HEX);
-      data16++;
+template <typename out_t>
+int DFRobot_MAX98357A::flushLimiterTo(out_t * out)
+{
+  if(!_limiting){
+    return 0;
+  }
+  static const pcm_t silence[LIMITER_LOOKAHEAD_FRAMES * 2] = {0};   // Pushes the delayed frames out
+  outputChains(out).flush.template process<filterSample_t>(silence, out, LIMITER_LOOKAHEAD_FRAMES, _voiceSource);
+  _limiting = false;
+  return dropPrimeFrames(out, LIMITER_LOOKAHEAD_FRAMES);
+}
 
-      i2s_write(I2S_NUM_0,  processedData, 4, &i2s_bytes_write, 20);   // Transfer audio data to the amplifier via I2S
+template <typename out_t>
+int DFRobot_MAX98357A::processFramesTo(const pcm_t * in, out_t * out, int count)
+{
+  uint32_t start = ESP.getCycleCount();
+  uint32_t filterCycles = 0;   // The part spent with the filter or equalizer on
+  out_t * outStart = out;
+  OutputChains<out_t> & chains = outputChains(out);
+
+  // Pick up new coefficients at the block boundary
+  updateFilter();
+  uint8_t eqBands = _equalizer.update();
+
+  bool filterOn = _filterFlag;
+  bool eqOn = _eqFlag && (eqBands > 0);   // No pass at all when every band is disabled or flat
+  if(!filterOn){   // A crossfade does not outlive the filter
+    _fadeRemaining = 0;
+  }
+
+  // Without gain above unity, filter or equalizer no sample can exceed full scale, and the limiter is bypassed.
+  // No frame is lost or inserted when it enters or leaves the path: the frames still delayed are output first when it
+  // leaves, and the frames filling its empty delay line are not output when it enters
+  bool bypass = !filterOn && !eqOn && _gain.isAttenuating();
+  if(bypass){
+    out += 2 * flushLimiterTo(out);
+  }else if(!_limiting){
+    _limiter.reset();
+    _limiterPrime = LIMITER_LOOKAHEAD_FRAMES;
+    _limiting = true;
+  }
+
+  // One fused loop per configuration, the left and right channels are swapped for the Bluetooth source
+  if(bypass){   // Change sample data only according to volume multiplier
+    if(!_gain.isUnity() || !copyFrames(in, out, count, _voiceSource)){   // Copied at unity when the output words hold the samples, so no dither
+      chains.volume.template process<int32_t>(in, out, count, _voiceSource);
+    }
+  }else if(!filterOn && !eqOn){   // Volume above unity
+    chains.volumeLimit.template process<filterSample_t>(in, out, count, _voiceSource);
+  }else{   // Filtering with a simple digital filter and the equalizer, during a crossfade the old and new filter run side by side
+    uint32_t filterStart = ESP.getCycleCount();
+    if(_fadeRemaining > 0){
+      if(eqOn){
+        chains.fadeEQ.template process<filterSample_t>(in, out, count, _voiceSource);
+      }else{
+        chains.fade.template process<filterSample_t>(in, out, count, _voiceSource);
+      }
+    }else if(filterOn && eqOn){
+      chains.filterEQ.template process<filterSample_t>(in, out, count, _voiceSource);
+    }else if(filterOn){
+      chains.filter.template process<filterSample_t>(in, out, count, _voiceSource);
+    }else{
+      chains.eq.template process<filterSample_t>(in, out, count, _voiceSource);
     }
-  }else{   // Filtering with a simple digital filter
-    for(int i=0; i<count; i++){
-      processedData[0+_voiceSource] = filterToWork(_filterLHP, _filterLLP, ((*data16) * _volume));   // Change audio data volume of left channel, and perform filtering operation
-      data16++;
+    filterCycles = ESP.getCycleCount() - filterStart;
+  }
+  if(!bypass){
+    count = dropPrimeFrames(out, count);
+  }
 
-      processedData[1-_voiceSource] = filterToWork(_filterRHP, _filterRLP, ((*data16) * _volume));   // Change audio data volume of right channel, and perform filtering operation
-      data16++;
+  int frames = (out - outStart) / 2 + count;
+  uint16_t peak = peakOf(outStart, 2 * frames);
+  _stats.recordOutput(frames, ESP.getCycleCount() - start, filterCycles, peak);
+  return frames;
+}
 
-      i2s_write(I2S_NUM_0, processedData, 4, &i2s_bytes_write, 100);   // Transfer audio data to the amplifier via I2S
+size_t DFRobot_MAX98357A::writeToSink(const void * data, size_t len)
+{
+  size_t bytesWritten = _sink->write(data, len, I2S_WRITE_TIMEOUT);
+  if(bytesWritten < len){   // The sink timed out, the rest of the chunk is dropped
+    _stats.recordShortWrite(len - bytesWritten);
+    DBG("Short write to the sink, dropped bytes: ");
+    DBG(len - bytesWritten);
+  }
+  return bytesWritten;
+}
+
+void DFRobot_MAX98357A::audioDataProcessCallback(const uint8_t *data, uint32_t len)
+{
+  // Runs in the Bluetooth task, only copy the data at the rate of the stream and never wait for the output, the output
+  // task converts it
+  uint32_t start = ESP.getCycleCount();
+  if(!_pcmFromStream.load(std::memory_order_relaxed)){
+    _pcmFromStream.store(true, std::memory_order_relaxed);
+  }
+  len &= ~3;   // Whole interleaved int16_t stereo frames
+#ifdef PCM_WIDE_SAMPLES
+  static pcm_t widened[WAV_WRITE_FRAMES * 2];   // Only the Bluetooth task, widened a part at a time
+  bool written = true;
+  for(uint32_t done=0; done<len; done+=WAV_WRITE_FRAMES * 4){
+    size_t n = ((len - done) / 4 < WAV_WRITE_FRAMES) ? ((len - done) / 4) : WAV_WRITE_FRAMES;
+    PCMConverter::stereo16(data + done, widened, n);
+    written = writeToBuffer((const uint8_t *)widened, n * PCM_FRAME_BYTES, 0) && written;
+  }
+#else
+  bool written = writeToBuffer(data, len, 0);
+#endif
+  if(!written){
+    DBG("PCM buffer is full, A2DP data dropped");
+  }
+  _stats.recordCallback(ESP.getCycleCount() - start);
+}
+
+bool DFRobot_MAX98357A::writeToBuffer(const uint8_t *data, uint32_t len, uint32_t ticksToWait)
+{
+  size_t partMax = (_pcmBuffer.size() / 2) & ~(PCM_FRAME_BYTES - 1);   // Half the buffer, so the output task can drain the other half meanwhile
+  if(partMax == 0){
+    return false;
+  }
+  bool ret = true;
+  while(len > 0){
+    uint32_t n = (len > partMax) ? partMax : len;
+    while((_pcmBuffer.space() < n) && (ticksToWait > 0) && PipelineTask::keepRunning()){   // Wait for the output task to make room
+      PipelineTask::sleep(1);
+      if(ticksToWait != portMAX_DELAY){
+        ticksToWait--;
+      }
     }
+    if(!_pcmBuffer.write(data, n)){
+      ret = false;
+    }
+    _outputTask.notify();
+    data += n;
+    len -= n;
   }
+  return ret;
 }
 
-void DFRobot_MAX98357A::playWAV(void *arg)
+bool DFRobot_MAX98357A::writeResampled(Resampler &resampler, pcm_t *out, const uint8_t *data, uint32_t len, uint32_t ticksToWait)
 {
-  while(1){
-    while(SD_AMPLIFIER_STOP == SDAmplifierMark){
-      vTaskDelay(100);
+  if(resampler.isBypass()){
+    return writeToBuffer(data, len, ticksToWait);
+  }
+
+  bool ret = true;
+  const pcm_t *in = (const pcm_t *)data;
+  size_t frames = len / PCM_FRAME_BYTES;
+  while(frames > 0){
+    size_t used;
+    size_t n = resampler.process(in, frames, out, RESAMPLE_OUT_FRAMES, &used);
+    in += used * 2;
+    frames -= used;
+    if((n > 0) && !writeToBuffer((const uint8_t *)out, n * PCM_FRAME_BYTES, ticksToWait)){
+      ret = false;
     }
+  }
+  return ret;
+}
 
-    sWavInfo_t * wav = (sWavInfo_t *)calloc(1, sizeof(sWavInfo_t));
-    if(wav == NULL){
-      DBG("Unable to allocate WAV struct.");
-      SDAmplifierMark = SD_AMPLIFIER_STOP;
+bool DFRobot_MAX98357A::flushResampled(Resampler &resampler, pcm_t *out, uint32_t ticksToWait)
+{
+  size_t n = resampler.flush(out, RESAMPLE_OUT_FRAMES);
+  return (n == 0) || writeToBuffer((const uint8_t *)out, n * PCM_FRAME_BYTES, ticksToWait);
+}
+
+uint8_t DFRobot_MAX98357A::selectOutputPath(bool * settled)
+{
+  *settled = true;
+  bool eqOn = _eqFlag && (_equalizer.update() > 0);   // Picks up the bands as processFrames() does
+  if(_filterFlag || eqOn || (_outputBits != 16) || (PCM_FRACTION_BITS > 0)){   // In place the PCM buffer is the 16-bit output
+    return OUTPUT_PATH_PROCESS;
+  }
+  if(!_gain.isUnity()){
+    *settled = (_gain.getGain() != GAIN_UNITY_Q15);   // Selected again once the ramp to unity has run
+    return OUTPUT_PATH_PROCESS;
+  }
+
+  // A crossfade starts again from scratch when processing resumes, the limiter is flushed by outputBuffer()
+  _fadeRemaining = 0;
+  return _voiceSource ? OUTPUT_PATH_SWAP : OUTPUT_PATH_PASSTHROUGH;
+}
+
+size_t DFRobot_MAX98357A::outputBuffer(size_t len, bool convert)
+{
+  static pcm_t rawData[I2S_DMA_BUF_LEN * 2];   // The raw audio data of one DMA buffer
+  static int32_t processedData[I2S_DMA_BUF_LEN + 2 * LIMITER_LOOKAHEAD_FRAMES];   // The processed audio data of one DMA buffer, or half of it in 32-bit words, and the frames flushed from the limiter
+
+  uint32_t config = _outputConfig.load(std::memory_order_acquire);
+  if(!_outputPathSettled || (config != _outputPathConfig)){   // Not per buffer, only after a change
+    _outputPathConfig = config;
+    _outputPath = selectOutputPath(&_outputPathSettled);
+  }
+  size_t frameBytes = (_outputBits == 16) ? (2 * sizeof(int16_t)) : (2 * sizeof(int32_t));
+  bool inPlace = (_outputPath != OUTPUT_PATH_PROCESS) && !convert;   // Converted frames are in rawData anyway
+  if((inPlace || (len == 0)) && _limiting){   // The frames still delayed by the limiter go first
+    writeToSink(processedData, flushLimiter(processedData) * frameBytes);
+  }
+  if(len == 0){
+    return 0;
+  }
+  if(inPlace){
+    return writeInPlace(len, _outputPath == OUTPUT_PATH_SWAP);
+  }
+
+  if(convert){
+    len = _streamConverter.read(_pcmBuffer, rawData, len / PCM_FRAME_BYTES) * PCM_FRAME_BYTES;
+  }else{
+    len = _pcmBuffer.read(rawData, len) & ~(PCM_FRAME_BYTES - 1);   // A short read here is an underrun
+  }
+  // Wide output is processed and written half a DMA buffer at a time, so it needs no larger buffer
+  int frames = len / PCM_FRAME_BYTES;
+  int step = (_outputBits == 16) ? I2S_DMA_BUF_LEN : (I2S_DMA_BUF_LEN / 2);
+  for(int done=0; done<frames; done+=step){
+    int n = (frames - done < step) ? (frames - done) : step;
+    n = processFrames(rawData + 2 * done, processedData, n);
+    writeToSink(processedData, n * frameBytes);   // Transfer audio data to the amplifier via I2S
+  }
+  return len;
+}
+
+size_t DFRobot_MAX98357A::writeInPlace(size_t len, bool swap)
+{
+  uint8_t * part[2];
+  size_t partLen[2];
+  len = _pcmBuffer.peek(len, &part[0], &partLen[0], &part[1]) & ~3;   // A short peek here is an underrun
+  partLen[0] = (partLen[0] < len) ? partLen[0] : len;
+  partLen[1] = len - partLen[0];
+
+  // The data stays in the PCM buffer until the sink has taken it, it is only released afterwards
+  uint32_t cycles = 0;
+  uint16_t peak = 0;
+  for(int k=0; k<2; k++){
+    if(partLen[k] == 0){
       continue;
     }
+    uint32_t start = ESP.getCycleCount();
+    uint16_t partPeak = swap ? swapFramesInPlace((uint32_t *)part[k], partLen[k] / 4) : peakOf((const int16_t *)part[k], partLen[k] / 2);
+    peak = (partPeak > peak) ? partPeak : peak;
+    cycles += ESP.getCycleCount() - start;
+    writeToSink(part[k], partLen[k]);
+  }
+  _pcmBuffer.skip(len);
+  _stats.recordOutput(len / 4, cycles, 0, peak);
+  return len;
+}
+
+void DFRobot_MAX98357A::outputTask(void *arg)
+{
+  const size_t bufferLen = I2S_DMA_BUF_LEN * PCM_FRAME_BYTES;   // The raw audio data of one DMA buffer
+  bool playing = false;   // Whether the buffer has been prefilled and a whole DMA buffer is read each time
+  AudioSink * sink = NULL;   // The sink and width the output was last set up for, the first block sets them up
+  uint8_t bits = _outputBits;
+  uint32_t streamConfig = 0;   // The configuration of the Bluetooth stream _streamConverter is set up for
+
+  while(PipelineTask::keepRunning()){
+    uint32_t config = _streamConfig.load(std::memory_order_acquire);
+    if(config != streamConfig){   // A new Bluetooth stream, the converter is only used by this task
+      streamConfig = config;
+      size_t latency = 0;
+      if(_driftCompensation){   // The jitter buffer: the output starts at the target level and the control loop keeps it there
+        latency = (size_t)_sampleRate * _jitterLatencyMs / 1000;
+        size_t half = _pcmBuffer.size() / PCM_FRAME_BYTES / 2;
+        latency = (latency > half) ? half : latency;
+        latency = (latency < OUTPUT_PREFILL_SIZE / PCM_FRAME_BYTES) ? (OUTPUT_PREFILL_SIZE / PCM_FRAME_BYTES) : latency;
+      }
+      if(!_streamConverter.begin(_streamRate.load(std::memory_order_relaxed), _sampleRate, _resampleQuality, latency)){
+        DBG("Allocate the Bluetooth sample rate converter failed !");
+      }
+    }
+    bool convert = _pcmFromStream.load(std::memory_order_relaxed) && !_streamConverter.isBypass();
+    size_t prefill = convert ? _streamConverter.getPrefill() : 0;
+
+    size_t want = bufferLen;
+    size_t need = convert ? _streamConverter.sourceBytes(I2S_DMA_BUF_LEN) : want;   // Of the source in the PCM buffer
+    if(_pcmBuffer.available() < (playing ? need : (prefill ? prefill : OUTPUT_PREFILL_SIZE))){
+      if(PipelineTask::wait(OUTPUT_WAIT_TICKS)){
+        continue;   // New data arrived, check the fill level again
+      }
+      if(!playing){   // The source stopped before the prefill level, flush what is left
+        size_t left = _pcmBuffer.available() & ~(PCM_FRAME_BYTES - 1);
+        if(left == 0){
+          outputBuffer(0);   // And then the frames still delayed by the limiter
+          continue;
+        }
+        want = convert ? want : left;   // The converter takes what there is
+      }
+    }
+
+    _stats.recordDepth(_pcmBuffer.available());
+    if((sink != _sink) || (bits != _outputBitsSet.load(std::memory_order_relaxed))){   // A new sink or width, set up between two writes
+      sink = _sink;
+      bits = _outputBitsSet.load(std::memory_order_relaxed);
+      uint8_t width = bits;
+      if(!sink->setBitsPerSample(width)){
+        DBG("The sink does not take the output width, 16-bit output is used");
+        width = 16;
+        sink->setBitsPerSample(width);
+      }
+      _outputBits = width;
+      _requantizer.setOutputBits(width);
+      _outputPathSettled = false;
+    }
+
+    size_t done = outputBuffer(want, convert);
+    playing = (done == bufferLen);
+    if(convert){
+      _streamConverter.update(_pcmBuffer, done / PCM_FRAME_BYTES, playing);
+    }
+  }
+}
 
-    wav->fp = fopen(fileName, "rb");
-    if(wav->fp == NULL){
+void DFRobot_MAX98357A::prefetchTask(void *arg)
+{
+  while(PipelineTask::keepRunning()){
+    xSemaphoreTake(_prefetchLock, portMAX_DELAY);
+    uint32_t start = ESP.getCycleCount();
+    bool filled = _prefetch.fill(_fileSource);   // Blocks for the SD read, outside of the play task
+    uint32_t cycles = ESP.getCycleCount() - start;
+    xSemaphoreGive(_prefetchLock);
+
+    if(filled){
+      _stats.recordSDRead(cycles);
+      _playTask.notify();
+    }else{   // All buffers full, or no file playing
+      PipelineTask::wait(PREFETCH_WAIT_TICKS);
+    }
+  }
+}
+
+FILE * DFRobot_MAX98357A::openTrack(WavParser &parser, bool advance, bool skip)
+{
+  for(uint16_t attempt = 0; attempt <= PLAY_QUEUE_SIZE; attempt++){
+    char path[sizeof(fileName)];
+    bool found;
+    bool queued;
+    lockSD();
+    queued = _queueActive;
+    if(queued){
+      uint32_t index;
+      sMusicTrack_t track;
+      found = (advance ? _queue.next(&index, skip) : _queue.current(&index)) && _musicIndex.getTrack(index, &track);
+      if(found){
+        strcpy(fileName, SD_MOUNT_POINT);
+        strncat(fileName, track.path, sizeof(fileName) - strlen(fileName) - 1);
+      }
+    }else{
+      found = !advance;   // A single track has no next one
+    }
+    strcpy(path, fileName);
+    unlockSD();
+    if(!found){
+      return NULL;
+    }
+
+    FILE *fp = fopen(path, "rb");
+    if(fp == NULL){
       DBG("Unable to open wav file.");
-      DBG(fileName);
-      SDAmplifierMark = SD_AMPLIFIER_STOP;
-      continue;
+      DBG(path);
+    }else if(!parser.parseFile(fp)){
+      DBG(parser.getError());
+      fclose(fp);
+      fp = NULL;
     }
-    if(fread(&(wav->header.riffType), 1, 4, wav->fp) != 4){
-      DBG("couldn't read RIFF_ID.");
-      SDAmplifierMark = SD_AMPLIFIER_STOP;
-      continue;  /* bad error "couldn't read RIFF_ID" */
+    if((fp != NULL) || !queued){
+      return fp;
     }
-    if(strncmp("RIFF", wav->header.riffType, 4)){
-      DBG("RIFF descriptor not found.") ;
-      SDAmplifierMark = SD_AMPLIFIER_STOP;
-      continue;
+    advance = true;   // Skip the broken track of the queue
+    skip = true;
+  }
+  return NULL;
+}
+
+void DFRobot_MAX98357A::playWAV(void *arg)
+{
+  static pcm_t converted[WAV_WRITE_FRAMES * 2];   // Only one play task, so the buffers are not on its small stack
+  static pcm_t resampled[RESAMPLE_OUT_FRAMES * 2];
+  WavParser parser;
+  bool advance = false;   // Move on in the queue before opening the track
+  bool skip = false;   // Moving on was asked by the user
+  uint8_t tag = 0;   // Tag of the buffers of the track being read
+
+  while(PipelineTask::keepRunning()){
+    while((SD_AMPLIFIER_STOP == SDAmplifierMark) && PipelineTask::keepRunning()){
+      advance = false;
+      PipelineTask::sleep(100);
     }
-    fread(&(wav->header.riffSize), 4, 1, wav->fp);
-    if(fread(&wav->header.waveType, 1, 4, wav->fp) != 4){
-      DBG("couldn't read format");
-      SDAmplifierMark = SD_AMPLIFIER_STOP;
-      continue;  /* bad error "couldn't read format" */
+    if(!PipelineTask::keepRunning()){
+      break;
     }
-    if(strncmp("WAVE", wav->header.waveType, 4)){
-      DBG("WAVE chunk ID not found.") ;
+    _skipRequest = false;
+
+    FILE *fp = openTrack(parser, advance, skip);
+    advance = false;
+    skip = false;
+    if(fp == NULL){
       SDAmplifierMark = SD_AMPLIFIER_STOP;
       continue;
     }
-    if(fread(&(wav->header.formatType), 1, 4, wav->fp) != 4){
-      DBG("couldn't read format_ID");
-      SDAmplifierMark = SD_AMPLIFIER_STOP;
-      continue;  /* bad error "couldn't read format_ID" */
-    }
-    if(strncmp("fmt", wav->header.formatType, 3)){
-      DBG("fmt chunk format not found.");
+    sWavFormat_t format = parser.getFormat();   // Format of the track being played
+    sWavFormat_t nextFormat = format;   // Format of the track being read, when it is ahead
+    pcmConvert_t convert = PCMConverter::select(format);   // Chosen once per track, NULL for 16-bit stereo in the low-memory mode
+    if(!_sdResampler.begin(format.sampleRate, _sampleRate, _resampleQuality)){   // The I2S clock stays, the track is converted
+      DBG("Allocate the sample rate converter failed !");
+      fclose(fp);
       SDAmplifierMark = SD_AMPLIFIER_STOP;
       continue;
     }
-    fread(&(wav->header.formatSize), 4, 1, wav->fp);
-    fread(&(wav->header.compressionCode), 2, 1, wav->fp);
-    fread(&(wav->header.numChannels), 2, 1, wav->fp);
-    fread(&(wav->header.sampleRate), 4, 1, wav->fp);
-    fread(&(wav->header.bytesPerSecond), 4, 1, wav->fp);
-    fread(&(wav->header.blockAlign), 2, 1, wav->fp);
-    fread(&(wav->header.bitsPerSample), 2, 1, wav->fp);
-    while(1){
-      if(fread(&wav->header.dataType1, 1, 1, wav->fp) != 1){
-        DBG("Unable to read data chunk ID.");
-        free(wav);
-        break;
+    _pcmFromStream.store(false, std::memory_order_relaxed);   // Converted to the I2S rate here, the output takes it as it is
+
+    xSemaphoreTake(_prefetchLock, portMAX_DELAY);   // Hand the file over to the reader task
+    _prefetch.clear();
+    _prefetch.setBlockAlign(format.blockAlign);
+    _prefetch.restart(++tag);
+    _fileSource.open(fp, format.dataSize);
+    xSemaphoreGive(_prefetchLock);
+    _prefetchTask.notify();
+    uint8_t playingTag = tag;
+    bool nextTried = false;   // Whether the track after the one being read has been opened
+
+    while(!_prefetch.isReady() && (SD_AMPLIFIER_STOP != SDAmplifierMark) && PipelineTask::keepRunning()){   // Prefill, so the start is not counted as a stall
+      PipelineTask::wait(PREFETCH_WAIT_TICKS);
+    }
+
+    while((SD_AMPLIFIER_STOP != SDAmplifierMark) && !_skipRequest && PipelineTask::keepRunning()){
+      if(!nextTried && _prefetch.isSourceEnd()){   // The reader is done with the file, hand it the next track while this one still plays
+        nextTried = true;
+        FILE *next = openTrack(parser, true, false);
+        if(next != NULL){
+          nextFormat = parser.getFormat();
+          xSemaphoreTake(_prefetchLock, portMAX_DELAY);
+          _prefetch.setBlockAlign(nextFormat.blockAlign);
+          _prefetch.restart(++tag);
+          _fileSource.open(next, nextFormat.dataSize);
+          xSemaphoreGive(_prefetchLock);
+          _prefetchTask.notify();
+          fclose(fp);
+          fp = next;
+        }
       }
-      if(strncmp("d", wav->header.dataType1, 1) == 0){
-        fread(&wav->header.dataType2, 3, 1, wav->fp);
-        if(strncmp("ata", wav->header.dataType2, 3) == 0){
-          fread(&(wav->header.dataSize),4,1,wav->fp);
+
+      size_t len;
+      uint8_t bufferTag;
+      const uint8_t *data = _prefetch.getReadBuffer(&len, &bufferTag);
+      if(data == NULL){
+        if(_prefetch.isEnd()){
+          flushResampled(_sdResampler, resampled, portMAX_DELAY);   // The end of the queue, the tail of the last track
           break;
         }
+        PipelineTask::wait(PREFETCH_WAIT_TICKS);   // Stalled, wait for the reader task
+        continue;
       }
-    }
-
-    i2s_set_sample_rates(I2S_NUM_0, wav->header.sampleRate);   // Set I2S sampling rate based on the parsed audio sampling frequency
-
-    while(fread(&wav->header.data, 1 , 800 , wav->fp)){
-      audioDataProcessCallback((uint8_t *)&wav->header.data, 800);   // Send the parsed audio data to the amplifier broadcast function
-      if(SD_AMPLIFIER_STOP == SDAmplifierMark){
-        break;
+      if(bufferTag != playingTag){   // The first buffer of the next track, it follows the last frame of this one
+        playingTag = bufferTag;
+        format = nextFormat;
+        convert = PCMConverter::select(format);
+        if(_sdResampler.getInRate() != format.sampleRate){   // At the same rate the converter keeps its history
+          flushResampled(_sdResampler, resampled, portMAX_DELAY);   // The tail of the last track, still in the history
+          if(!_sdResampler.begin(format.sampleRate, _sampleRate, _resampleQuality)){
+            DBG("Allocate the sample rate converter failed !");
+            break;
+          }
+        }
+        nextTried = false;
       }
-      while(SD_AMPLIFIER_PAUSE == SDAmplifierMark){
-        vTaskDelay(100);
+
+      size_t frames = len / format.blockAlign;   // Whole frames only, a truncated last frame is dropped
+      for(size_t i = 0; (i < frames) && (SD_AMPLIFIER_STOP != SDAmplifierMark) && !_skipRequest && PipelineTask::keepRunning(); i += WAV_WRITE_FRAMES){
+        size_t n = ((frames - i) < WAV_WRITE_FRAMES) ? (frames - i) : WAV_WRITE_FRAMES;
+        const uint8_t *pcm = data + i * format.blockAlign;
+        if(convert != NULL){
+          convert(pcm, converted, n);
+          pcm = (const uint8_t *)converted;
+        }
+        writeResampled(_sdResampler, resampled, pcm, n * PCM_FRAME_BYTES, portMAX_DELAY);   // Send the parsed audio data to the output task
+        while((SD_AMPLIFIER_PAUSE == SDAmplifierMark) && !_skipRequest && PipelineTask::keepRunning()){
+          PipelineTask::sleep(100);
+        }
       }
+      _prefetch.releaseRead();
+      _prefetchTask.notify();
     }
 
-    fclose(wav->fp);
-    free(wav);
-    SDAmplifierMark = SD_AMPLIFIER_STOP;
-    vTaskDelay(100);
+    xSemaphoreTake(_prefetchLock, portMAX_DELAY);   // Take the file back before closing it
+    _fileSource.close();
+    _prefetch.clear();
+    xSemaphoreGive(_prefetchLock);
+    fclose(fp);
+
+    if(_skipRequest && (SD_AMPLIFIER_STOP != SDAmplifierMark)){
+      advance = (tag == playingTag);   // When the next track was already opened, the queue is on it
+      skip = true;
+    }else{   // Stopped, or the end of the track or queue
+      SDAmplifierMark = SD_AMPLIFIER_STOP;
+    }
   }
-  vTaskDelete(xPlayWAV);
 }
@@ -23,7 +23,27 @@
 
 #include <driver/i2s.h>
 
+#include "I2SAudioSink.h"
+#include "PCMRingBuffer.h"
+#include "FileAudioSource.h"
+#include "PrefetchBuffer.h"
+#include "PipelineTask.h"
+
 #include "Biquad.h"   // Code from https://www.earlevel.com/main/2012/11/26/biquad-c-source-code/ . Thank you very much!
+#include "StereoBiquad.h"
+#include "FilterCascade.h"
+#include "Equalizer.h"
+#include "DSPChain.h"
+#include "TripleBuffer.h"
+#include "GainStage.h"
+#include "WavParser.h"
+#include "PCMConverter.h"
+#include "Resampler.h"
+#include "StreamConverter.h"
+#include "MusicIndex.h"
+#include "PlayQueue.h"
+#include "PipelineStats.h"
+#include "MetadataCache.h"
 
 #include "SD.h"
 
@@ -34,12 +54,69 @@
   #define DBG(...)
 #endif
 
-#define NUMBER_OF_FILTER   ((int)(3))   //!< The number of the cascaded filter
+// #define FILTER_FIXED_POINT   //!< Open this macro to filter the int16_t samples with the fixed-point biquad, without float conversion per sample
+#ifdef FILTER_FIXED_POINT
+  typedef StereoBiquadFixed FilterBiquad;   //!< The stereo biquad type of the cascaded filter
+  typedef int32_t filterSample_t;   //!< The sample type of the cascaded filter
+#else
+  typedef StereoBiquad FilterBiquad;
+  typedef float filterSample_t;
+#endif
+#define FILTER_LP_ORDER   ((int)(6))   //!< Order of the low-pass filter, range: 1-8, the slope is 6 dB per octave and order
+#define FILTER_LP_ALIGNMENT   FILTER_BUTTERWORTH   //!< Alignment of the low-pass filter, FILTER_BUTTERWORTH or FILTER_LINKWITZ_RILEY
+#define FILTER_HP_ORDER   ((int)(6))   //!< Order of the high-pass filter, range: 1-8
+#define FILTER_HP_ALIGNMENT   FILTER_BUTTERWORTH   //!< Alignment of the high-pass filter, FILTER_BUTTERWORTH or FILTER_LINKWITZ_RILEY
+typedef FilterCascade<FilterBiquad, FILTER_LP_ORDER, FILTER_LP_ALIGNMENT> FilterLP;   //!< The low-pass filter
+typedef FilterCascade<FilterBiquad, FILTER_HP_ORDER, FILTER_HP_ALIGNMENT> FilterHP;   //!< The high-pass filter
+#define FILTER_FADE_FRAMES   ((uint16_t)(256))   //!< The default length (stereo frames) of the crossfade after a large filter change
+
+#define I2S_DMA_BUF_COUNT   ((int)(4))   //!< The number of I2S DMA buffers
+#define I2S_DMA_BUF_LEN   ((int)(400))   //!< The number of stereo frames in each I2S DMA buffer, it is also the size of each write to the sink
+#define OUTPUT_BITS_PER_SAMPLE   ((uint8_t)(16))   //!< The default output sample width, 16 is the low-memory mode, 24 and 32 double the DMA buffers
+#define I2S_WRITE_TIMEOUT   ((uint32_t)(100))   //!< The longest time (ticks) to wait for the sink to accept a chunk
+
+#define PCM_BUFFER_SIZE   ((size_t)(4096 * PCM_FRAME_BYTES))   //!< The default depth (bytes) of the buffer between the audio source and the output task, 4096 stereo frames
+#define OUTPUT_PREFILL_SIZE   ((size_t)(I2S_DMA_BUF_LEN * PCM_FRAME_BYTES * 2))   //!< The fill level (bytes) the buffer must reach before the output task starts or restarts after an underrun, a drift-compensated Bluetooth stream waits for its jitter target instead
+#define PCM_BUFFER_MIN_SIZE   ((size_t)(2 * ((OUTPUT_PREFILL_SIZE > RESAMPLE_OUT_FRAMES * PCM_FRAME_BYTES) ? OUTPUT_PREFILL_SIZE : (RESAMPLE_OUT_FRAMES * PCM_FRAME_BYTES))))   //!< The smallest depth (bytes) of the PCM buffer, it holds the prefill level or a resampled block twice
+#define OUTPUT_WAIT_TICKS   ((uint32_t)(20))   //!< The longest time (ticks) the output task waits for new data before flushing what is left
+#define OUTPUT_TASK_STACK_SIZE   ((uint32_t)(4096))   //!< The stack size of the output task
+#define OUTPUT_TASK_PRIORITY   ((UBaseType_t)(10))   //!< The priority of the output task
+#define OUTPUT_TASK_CORE   ((int8_t)(1))   //!< The core of the output task, the filters stay clear of the Bluetooth controller and stack on core 0
+#define OUTPUT_PATH_PROCESS   ((uint8_t)(0))   //!< The output task runs the audio data through processFrames()
+#define OUTPUT_PATH_PASSTHROUGH   ((uint8_t)(1))   //!< Nothing to process, the PCM buffer is written to the sink in place
+#define OUTPUT_PATH_SWAP   ((uint8_t)(2))   //!< Only the channels are swapped, in place in the PCM buffer
+
+#define WAV_WRITE_FRAMES   ((size_t)(200))   //!< The number of frames converted and written to the PCM buffer at a time, the play state is checked in between
+
+#define RESAMPLE_OUT_FRAMES   ((size_t)(256))   //!< The number of stereo frames converted to the output rate per write to the PCM buffer
+#define JITTER_LATENCY_MS   ((uint16_t)(40))   //!< The default fill level (ms) the PCM buffer is kept at for a Bluetooth stream with drift compensation
+
+#define PREFETCH_BUFFER_COUNT   ((uint8_t)(4))   //!< The default number of read-ahead buffers of SD card playback
+#define PREFETCH_BUFFER_SIZE   ((size_t)(4096))   //!< The default size (bytes) of each read-ahead buffer, one SD read each
+#define PREFETCH_WAIT_TICKS   ((uint32_t)(10))   //!< The longest time (ticks) the reader or the player waits for the other before checking again
+#define PREFETCH_TASK_STACK_SIZE   ((uint32_t)(4096))   //!< The stack size of the SD reader task, the FAT driver and the SD host driver run on it during each read
+#define PREFETCH_TASK_PRIORITY   ((UBaseType_t)(6))   //!< The priority of the SD reader task, above the play task so reads are issued as soon as a buffer is free
+#define PREFETCH_TASK_CORE   PIPELINE_NO_AFFINITY   //!< The core of the SD reader task, it mostly waits for the card
+#define PLAY_TASK_STACK_SIZE   ((uint32_t)(4096))   //!< The stack size of the SD play task, it opens and parses the tracks and looks up the queue and the index
+#define PLAY_TASK_PRIORITY   ((UBaseType_t)(5))   //!< The priority of the SD play task
+#define PLAY_TASK_CORE   ((int8_t)(0))   //!< The core of the SD play task, the sample conversion runs beside the output task, below the Bluetooth tasks
+
+#define PIPELINE_STAGE_SD_READ   ((uint8_t)(0))   //!< The stage reading the SD card ahead of playback
+#define PIPELINE_STAGE_DECODE   ((uint8_t)(1))   //!< The stage converting the WAV samples and the sample rate of SD playback
+#define PIPELINE_STAGE_OUTPUT   ((uint8_t)(2))   //!< The stage running the volume, filters, equalizer and limiter and writing I2S
+#define PIPELINE_STAGE_COUNT   ((uint8_t)(3))   //!< The number of pipeline stages with their own task
 
 #define SD_AMPLIFIER_PLAY  ((uint8_t)1)   //!< Playback control of audio in SD card - start playback
 #define SD_AMPLIFIER_PAUSE ((uint8_t)2)   //!< Playback control of audio in SD card - pause playback
 #define SD_AMPLIFIER_STOP  ((uint8_t)3)   //!< Playback control of audio in SD card - stop playback
 
+#define SD_MOUNT_POINT   "/sd"   //!< The mount point of the SD card in SD.h
+#define MUSIC_INDEX_FILE   "/sd/.musicindex"   //!< The index of the music files on the SD card
+#define SCAN_MUSIC_LIST_MAX   ((uint32_t)(100))   //!< The most tracks scanSDMusic() copies into its list
+
+#define AVRC_TL_METADATA   ((uint8_t)(0))   //!< The AVRC transaction label of the metadata requests
+#define AVRC_TL_TRACK_CHANGE   ((uint8_t)(1))   //!< The AVRC transaction label of the track change notification
+
 #define MAX98357A_VOICE_FROM_SD ((uint8_t)0)
 #define MAX98357A_VOICE_FROM_BT ((uint8_t)1)
 
@@ -107,9 +184,80 @@ public:
    * @param musicList - The music files in WAV format scanned from the SD card. Type is character string array
    * @return None
    * @note Only support English for path name of music files and WAV for their format currently
+   * @n    The music index is updated first, the list gets its first SCAN_MUSIC_LIST_MAX tracks
    */
   void scanSDMusic(String * musicList);
 
+  /**
+   * @fn updateMusicIndex
+   * @brief Update the index of the music files kept on the SD card, only the directories whose entries changed are scanned again
+   * @param full - true: scan every directory and parse every file again, e.g. after files were replaced under the same name
+   * @return The number of tracks in the index
+   */
+  uint32_t updateMusicIndex(bool full=false);
+
+  /**
+   * @fn getMusicCount
+   * @brief Get the number of tracks in the music index, without scanning the SD card
+   * @return The number of tracks
+   */
+  uint32_t getMusicCount(void);
+
+  /**
+   * @fn getMusicTrack
+   * @brief Get a track of the music index, read from the index file on demand
+   * @param index - The track number, range: 0 to getMusicCount()-1
+   * @param track - The path (like /musicDir/music.wav), size, modification time and format of the track
+   * @return true on success, false when the number is out of range
+   */
+  bool getMusicTrack(uint32_t index, sMusicTrack_t * track);
+
+  /**
+   * @fn enqueueSDMusic
+   * @brief Add a track of the music index to the playlist queue
+   * @param index - The track number of the music index, range: 0 to getMusicCount()-1
+   * @return true on success, false when the number is out of range or the queue holds PLAY_QUEUE_SIZE tracks
+   */
+  bool enqueueSDMusic(uint32_t index);
+
+  /**
+   * @fn clearSDQueue
+   * @brief Stop playback and remove all the tracks from the playlist queue
+   * @return None
+   */
+  void clearSDQueue(void);
+
+  /**
+   * @fn playSDQueue
+   * @brief Play the playlist queue from its first track
+   * @note The next track is opened and buffered while the current one plays, so they join without a gap
+   * @return true on success, false when the queue is empty
+   */
+  bool playSDQueue(void);
+
+  /**
+   * @fn nextSDMusic
+   * @brief Skip to the next track of the playlist queue, also with PLAY_REPEAT_ONE
+   * @return None
+   */
+  void nextSDMusic(void);
+
+  /**
+   * @fn setSDRepeat
+   * @brief Set the repeat mode of the playlist queue
+   * @param mode - PLAY_REPEAT_OFF: stop after the last track; PLAY_REPEAT_ONE: repeat the current track; PLAY_REPEAT_ALL: start over after the last track
+   * @return None
+   */
+  void setSDRepeat(uint8_t mode);
+
+  /**
+   * @fn setSDShuffle
+   * @brief Play the tracks of the playlist queue in random order
+   * @param shuffle - true: random order; false: queued order
+   * @return None
+   */
+  void setSDShuffle(bool shuffle);
+
   /**
    * @fn playSDMusic
    * @brief Play music files in the SD card
@@ -135,13 +283,26 @@ public:
 
   /**
    * @fn getMetadata
-   * @brief Get "metadata" through AVRC command
+   * @brief Get "metadata" of the playing track, without waiting: all attributes are requested through one AVRC command
+   * @n     when the remote device connects and whenever it notifies a track change, and the responses are cached
    * @param type - The type of metadata to be obtained, and the parameters currently supported: 
-   * @n     ESP_AVRC_MD_ATTR_TITLE   ESP_AVRC_MD_ATTR_ARTIST   ESP_AVRC_MD_ATTR_ALBUM
-   * @return The corresponding type of "metadata"
+   * @n     ESP_AVRC_MD_ATTR_TITLE   ESP_AVRC_MD_ATTR_ARTIST   ESP_AVRC_MD_ATTR_ALBUM   ESP_AVRC_MD_ATTR_TRACK_NUM
+   * @n     ESP_AVRC_MD_ATTR_NUM_TRACKS   ESP_AVRC_MD_ATTR_GENRE   ESP_AVRC_MD_ATTR_PLAYING_TIME
+   * @note Call it from one task only, e.g. loop()
+   * @return The corresponding type of "metadata", empty when it has not been received yet
    */
   String getMetadata(uint8_t type);
 
+  /**
+   * @fn setMetadataCallback
+   * @brief Set the function called when an attribute of the "metadata" changes
+   * @param callback - The function, called with the ESP_AVRC_MD_ATTR_* type and the new text ("" when cleared at a track change
+   * @n     or disconnection); NULL for none
+   * @note The function runs in the Bluetooth task, it must return quickly and must not call getMetadata()
+   * @return None
+   */
+  void setMetadataCallback(void (*callback)(uint8_t type, const char *text));
+
   /**
    * @fn getRemoteAddress
    * @brief Get the address of the remote Bluetooth device
@@ -161,12 +322,22 @@ public:
    */
   void setVolume(float vol);
 
+  /**
+   * @fn setVolumeDB
+   * @brief Set volume in dB
+   * @param gainDB - Gain in dB, range: -80.0 to +6.0 in steps of 0.5, lower settings mute
+   * @note 0 dB for the original volume of audio data, the same as setVolume(5)
+   * @return None
+   */
+  void setVolumeDB(float gainDB);
+
   /**
    * @fn openFilter
    * @brief Open audio filter
    * @param type - bq_type_highpass: open high-pass filtering; bq_type_lowpass: open low-pass filtering
    * @param fc - Threshold of filtering, range: 2-20000
    * @note For example, setting high-pass filter mode and the threshold of 500 indicates to filter out the audio signal below 500; high-pass filter and low-pass filter will work simultaneously.
+   * @n The order and alignment of each filter are chosen at compile time by FILTER_LP_ORDER, FILTER_HP_ORDER, FILTER_LP_ALIGNMENT and FILTER_HP_ALIGNMENT
    * @return None
    */
   void openFilter(int type, float fc);
@@ -178,6 +349,94 @@ public:
    */
   void closeFilter(void);
 
+  /**
+   * @fn setFilterCrossfade
+   * @brief Set the crossfade between the old and new filter when the threshold of filtering changes by more than an octave
+   * @param frames - Length of the crossfade in stereo frames, 0 switches the crossfade off, default to FILTER_FADE_FRAMES
+   * @note Smaller changes are always applied at the next block without resetting the filter state, so they do not click
+   * @return None
+   */
+  void setFilterCrossfade(uint16_t frames);
+
+  /**
+   * @fn setEqualizerBand
+   * @brief Set a band of the equalizer
+   * @param band - The band number, range: 0 to EQ_MAX_BANDS-1
+   * @param type - bq_type_peak: peak band; bq_type_lowshelf: low-shelf band; bq_type_highshelf: high-shelf band
+   * @param fc - Center (peak) or corner (shelf) frequency of the band, range: 2-20000
+   * @param Q - Quality factor of the band, e.g. 0.707
+   * @param gainDB - Gain of the band in dB, a band with 0 dB is skipped
+   * @return true on success, false when the band number is out of range
+   */
+  bool setEqualizerBand(uint8_t band, int type, float fc, float Q, float gainDB);
+
+  /**
+   * @fn enableEqualizerBand
+   * @brief Enable or disable a band of the equalizer, disabled bands are skipped
+   * @param band - The band number, range: 0 to EQ_MAX_BANDS-1
+   * @param enable - true: enable the band; false: disable the band
+   * @return true on success, false when the band number is out of range
+   */
+  bool enableEqualizerBand(uint8_t band, bool enable);
+
+  /**
+   * @fn openEqualizer
+   * @brief Open the equalizer, the enabled bands work together with the filter
+   * @return None
+   */
+  void openEqualizer(void);
+
+  /**
+   * @fn closeEqualizer
+   * @brief Close the equalizer, the band settings are kept
+   * @return None
+   */
+  void closeEqualizer(void);
+
+  /**
+   * @fn setLimiter
+   * @brief Set the look-ahead limiter in front of the output, it works whenever the volume is above 5 or the filter or equalizer is open
+   * @param ceilingDB - The largest output level in dBFS, range: -20.0 to 0.0, default to LIMITER_CEILING_DB
+   * @param attackMs - Time of the fall of the gain before a peak in ms, range: 0.02 ms to the look-ahead, default to LIMITER_ATTACK_MS
+   * @param releaseMs - Release time constant in ms, range: 1.0-1000.0, default to LIMITER_RELEASE_MS
+   * @note The limiter delays the audio by LIMITER_LOOKAHEAD_FRAMES and keeps every sample at or below the ceiling
+   * @return None
+   */
+  void setLimiter(float ceilingDB, float attackMs, float releaseMs);
+
+  /**
+   * @fn setDither
+   * @brief Set the dither added when the processed audio is requantized to the output samples
+   * @param bitsPerSample - The output sample width the setting is for: 16 or 24, 32-bit output is not rounded
+   * @param mode - The dither:
+   * @n     DITHER_OFF - Round to the nearest step, the error follows the signal as distortion
+   * @n     DITHER_TPDF - Triangular dither of +-1 LSB, a flat noise floor and no distortion, default for 16-bit, 24-bit has none by default
+   * @n     DITHER_SHAPED1 - TPDF dither with first-order noise shaping, less noise at low frequencies, more at high ones
+   * @n     DITHER_SHAPED2 - TPDF dither with second-order noise shaping, more strongly so
+   * @note Unchanged audio at volume 5 with the filter and equalizer closed is passed through without dither
+   * @return true on success, false for an unknown width or mode
+   */
+  bool setDither(uint8_t bitsPerSample, uint8_t mode);
+
+  /**
+   * @fn setOutputBits
+   * @brief Set the width of the samples sent to the amplifier, the processing is the same for all widths
+   * @param bitsPerSample - The output sample width:
+   * @n     16 - 16-bit samples, the low-memory mode, default to OUTPUT_BITS_PER_SAMPLE
+   * @n     24 - 24-bit samples in 32-bit I2S slots, the processed audio is kept to 1/256 of a 16-bit step
+   * @n     32 - 32-bit samples, nothing is rounded
+   * @note The output task switches at the next DMA buffer, the wide modes double the memory of the I2S DMA buffers
+   * @return true on success, false for an unknown width
+   */
+  bool setOutputBits(uint8_t bitsPerSample);
+
+  /**
+   * @fn getOutputBits
+   * @brief Get the width of the samples sent to the amplifier, 16 when the sink does not take the width set
+   * @return 16, 24 or 32
+   */
+  uint8_t getOutputBits(void);
+
   /**
    * @fn reverseLeftRightChannels
    * @brief Reverse left and right channels, When you find that the left
@@ -186,50 +445,207 @@ public:
    */
   void reverseLeftRightChannels(void);
 
-protected:
+  /**
+   * @fn setAudioSink
+   * @brief Replace the output sink of the processed audio data
+   * @param sink - The new output sink, NULL restores the default I2S sink
+   * @return None
+   */
+  void setAudioSink(AudioSink * sink);
 
   /**
-   * @fn end
-   * @brief End communication, release resources
+   * @fn setPCMBufferSize
+   * @brief Set the depth of the buffer between the audio source and the output task
+   * @param size - Depth of the buffer in bytes, rounded up to a power of two, default to PCM_BUFFER_SIZE, at least PCM_BUFFER_MIN_SIZE
+   * @note It must be called before begin() or initI2S(), which allocate the buffer
    * @return None
    */
-  void end(void);
+  void setPCMBufferSize(size_t size);
 
   /**
-   * @fn listDir
-   * @brief Traversal of SD card files
-   * @param fs - SD card file stream pointer
-   * @param dirName - Start traversal of SD card catalogue
+   * @fn getPCMBuffer
+   * @brief Get the buffer between the audio source and the output task, e.g. to read its high-water mark and underrun counters
+   * @return The pointer of the buffer
+   */
+  PCMRingBuffer * getPCMBuffer(void);
+
+  /**
+   * @fn setPrefetchBuffers
+   * @brief Set the read-ahead buffers of SD card playback, filled by a reader task ahead of the player
+   * @param count - The number of buffers, range: 2 to PREFETCH_MAX_BUFFERS, default to PREFETCH_BUFFER_COUNT
+   * @param size - Size of each buffer in bytes, rounded up to a multiple of PREFETCH_ALIGN, default to PREFETCH_BUFFER_SIZE
+   * @note It must be called before initSDCard(), which allocates the buffers
    * @return None
    */
-  void listDir(fs::FS &fs, const char * dirName);
+  void setPrefetchBuffers(uint8_t count, size_t size);
+
+  /**
+   * @fn getPrefetchBuffer
+   * @brief Get the read-ahead buffers of SD card playback, e.g. to read their stall counter and low-water mark
+   * @return The pointer of the buffers
+   */
+  PrefetchBuffer * getPrefetchBuffer(void);
+
+  /**
+   * @fn setResampleQuality
+   * @brief Set the quality of the conversion of sources at other sample rates to the fixed I2S rate
+   * @param quality - RESAMPLER_QUALITY_LOW, RESAMPLER_QUALITY_MEDIUM (default) or RESAMPLER_QUALITY_HIGH
+   * @note It applies from the next SD track or Bluetooth stream configuration, sources at the I2S rate are not converted
+   * @n     unless the drift of a Bluetooth stream is compensated, see setDriftCompensation()
+   * @return None
+   */
+  void setResampleQuality(uint8_t quality);
+
+  /**
+   * @fn setDriftCompensation
+   * @brief Keep the PCM buffer of a Bluetooth stream at a constant fill level, so the drift of the phone's clock against the
+   * @n     I2S clock neither adds latency nor causes underruns: the stream is resampled by a ratio trimmed by a PI control loop
+   * @param enable - true: follow the drift, the output task converts the stream; false (default): pass a stream at the I2S rate through unchanged
+   * @param latencyMs - The fill level to keep in ms, at most half of the PCM buffer, default to JITTER_LATENCY_MS
+   * @note It applies from the next Bluetooth stream configuration. The output starts once this level is reached
+   * @return None
+   */
+  void setDriftCompensation(bool enable, uint16_t latencyMs=JITTER_LATENCY_MS);
+
+  /**
+   * @fn setTaskConfig
+   * @brief Set the core, priority and stack size of the task of a pipeline stage
+   * @param stage - The pipeline stage:
+   * @n     PIPELINE_STAGE_SD_READ - reads the SD card ahead of playback, created by initSDCard()
+   * @n     PIPELINE_STAGE_DECODE - converts the WAV samples and the sample rate, created by initSDCard()
+   * @n     PIPELINE_STAGE_OUTPUT - volume, filters, equalizer, limiter and the I2S output, created by begin()
+   * @param core - 0, 1 or PIPELINE_NO_AFFINITY for either core
+   * @param priority - FreeRTOS priority, below configMAX_PRIORITIES
+   * @param stackSize - Stack size in bytes, at least PIPELINE_MIN_STACK_SIZE
+   * @note The stages pass the audio data through lock-free buffers; the A2DP data callback runs in the Bluetooth stack
+   * @return true on success, false for an unknown stage, core or priority, a too small stack, or when the task already runs
+   */
+  bool setTaskConfig(uint8_t stage, int8_t core, uint8_t priority, uint32_t stackSize);
+
+  /**
+   * @fn getStats
+   * @brief Take a snapshot of the runtime statistics of the audio pipeline: processing time of the callback and
+   * @n     the output blocks, PCM buffer depth, short writes to I2S, SD read time, filter time share, CPU load, peak and clipping,
+   * @n     the drift of the Bluetooth clock
+   * @param stats - The snapshot, see sPipelineStats_t
+   * @note The counters are updated without locking, so a snapshot taken while playing may mix neighbouring blocks
+   * @return None
+   */
+  void getStats(sPipelineStats_t * stats);
+
+  /**
+   * @fn resetStats
+   * @brief Clear the runtime statistics, including the counters of the PCM buffer and the SD read-ahead buffers
+   * @return None
+   */
+  void resetStats(void);
+
+protected:
+
+  /**
+   * @fn end
+   * @brief End communication, stop the pipeline tasks and wait until they have ended, release resources
+   * @return None
+   */
+  void end(void);
 
   /**
    * @fn setFilter
-   * @brief Set filter
-   * @param _filter - The filter to be set
+   * @brief Set filter, the new coefficients are published to the output task, which picks them up at the next block
    * @param _type - bq_type_highpass: open high-pass filtering; bq_type_lowpass: open low-pass filtering
    * @param _fc - Threshold of filtering, range: 2-20000
    * @return None
    */
-  void setFilter(Biquad * _filter, int _type, float _fc);
+  void setFilter(int _type, float _fc);
 
   /**
-   * @fn filterToWork
-   * @brief Make the filter work, process audio data
-   * @param filterHP - The high-pass filter to be used
-   * @param filterLP - The low-pass filter to be used
-   * @param rawData - The raw audio data to be processed. float
-   * @return The processed audio data int16_t
+   * @fn updateFilter
+   * @brief Pick up the filter coefficients published by setFilter(), called by the output task at a block boundary
+   * @return None
+   */
+  static void updateFilter(void);
+
+  /**
+   * @fn processFrames
+   * @brief Change volume, filter and arrange the channels of a block of stereo frames
+   * @param in - The raw audio data, interleaved pcm_t stereo frames
+   * @param out - The processed audio data, interleaved stereo frames of int16_t for 16-bit output, int32_t for wider output
+   * @param count - The number of stereo frames, no more than I2S_DMA_BUF_LEN
+   * @return The number of stereo frames in out, up to LIMITER_LOOKAHEAD_FRAMES more or fewer than count when the limiter
+   * @n      leaves or enters the path
+   */
+  static int processFrames(const pcm_t * in, void * out, int count);
+
+  /**
+   * @fn processFramesTo
+   * @brief processFrames() for one type of output words
+   * @param in - The raw audio data, interleaved pcm_t stereo frames
+   * @param out - The processed audio data, int16_t or int32_t words
+   * @param count - The number of stereo frames, no more than I2S_DMA_BUF_LEN
+   * @return The number of stereo frames in out
+   */
+  template <typename out_t>
+  static int processFramesTo(const pcm_t * in, out_t * out, int count);
+
+  /**
+   * @fn flushLimiter
+   * @brief Output the frames still in the delay line of the limiter and take it out of the path, e.g. before the data is written in place
+   * @param out - The flushed audio data, interleaved stereo frames of int16_t for 16-bit output, int32_t for wider output
+   * @return The number of stereo frames in out, no more than LIMITER_LOOKAHEAD_FRAMES, 0 when the limiter is not in the path
    */
-  static int16_t filterToWork(Biquad * filterHP, Biquad * filterLP, float rawData);
+  static int flushLimiter(void * out);
+
+  /**
+   * @fn flushLimiterTo
+   * @brief flushLimiter() for one type of output words
+   * @param out - The flushed audio data, int16_t or int32_t words
+   * @return The number of stereo frames in out
+   */
+  template <typename out_t>
+  static int flushLimiterTo(out_t * out);
+
+  /**
+   * @fn selectOutputPath
+   * @brief Choose how the output task handles the audio data, called by the output task when a setting has changed
+   * @param settled - Set to false when the path has to be chosen again before the next buffer, e.g. during a volume ramp
+   * @return OUTPUT_PATH_PROCESS, OUTPUT_PATH_PASSTHROUGH or OUTPUT_PATH_SWAP
+   */
+  static uint8_t selectOutputPath(bool * settled);
+
+  /**
+   * @fn outputBuffer
+   * @brief Take audio data from the PCM buffer through the output path into the sink
+   * @param len - Byte length of the audio data wanted, no more than one DMA buffer of raw audio data, 0 when the source
+   * @n             has stopped: only the frames still delayed by the limiter are written
+   * @param convert - true: the PCM buffer holds the Bluetooth stream, converted to the I2S rate by _streamConverter first
+   * @return The number of bytes of raw audio data output, at the I2S rate, less than len when the buffer runs dry
+   */
+  static size_t outputBuffer(size_t len, bool convert=false);
+
+  /**
+   * @fn writeInPlace
+   * @brief Write the audio data to the sink from the storage of the PCM buffer, without a copy
+   * @param len - Byte length of the audio data wanted
+   * @param swap - true: swap the left and right channels in place first; false: write the data as it is
+   * @return The number of bytes taken from the PCM buffer
+   */
+  static size_t writeInPlace(size_t len, bool swap);
+
+  /**
+   * @fn writeToSink
+   * @brief Submit the processed audio data to the output sink, partial writes and timeouts are counted and reported
+   * @param data - The processed audio data
+   * @param len - Byte length of audio data
+   * @return The number of bytes actually accepted by the sink
+   */
+  static size_t writeToSink(const void * data, size_t len);
 
 /*************************** Function ******************************/
 
   /**
    * @fn audioDataProcessCallback
    * @brief esp_a2d_sink_register_data_callback() function, 
-   * @n     Process the audio stream data of Bluetooth A2DP protocol communication
+   * @n     Copy the audio stream data of Bluetooth A2DP protocol communication into the PCM buffer, the output task processes it
    * @param data - The audio data from the remote Bluetooth device
    * @param len - Byte length of audio data
    * @return None
@@ -257,6 +673,20 @@ protected:
    */
   static void avrcCallback(esp_avrc_ct_cb_event_t event, esp_avrc_ct_cb_param_t *param);
 
+  /**
+   * @fn requestMetadata
+   * @brief Request all attributes of the "metadata" and register for the next track change notification, called by avrcCallback()
+   * @return None
+   */
+  static void requestMetadata(void);
+
+  /**
+   * @fn clearMetadata
+   * @brief Empty the cached "metadata" and call the callback for every attribute cleared, called by avrcCallback()
+   * @return None
+   */
+  static void clearMetadata(void);
+
   /**
    * @fn playWAV
    * @brief The parsing play function for audio files in WAV format
@@ -266,6 +696,67 @@ protected:
    */
   static void playWAV(void *arg);
 
+  /**
+   * @fn writeToBuffer
+   * @brief Copy the raw audio data into the PCM buffer and wake up the output task
+   * @n     Data longer than half the buffer is copied in parts, so a write never waits for more space than the buffer has
+   * @param data - The raw audio data, interleaved pcm_t stereo frames
+   * @param len - Byte length of audio data
+   * @param ticksToWait - The longest time to wait for free space, 0 drops the data at once when the buffer is full
+   * @return true on success, false when some of the data is dropped
+   */
+  static bool writeToBuffer(const uint8_t *data, uint32_t len, uint32_t ticksToWait);
+
+  /**
+   * @fn writeResampled
+   * @brief Convert the raw audio data to the I2S sample rate and copy it into the PCM buffer
+   * @param resampler - The converter of the source
+   * @param out - Buffer of RESAMPLE_OUT_FRAMES stereo frames for the converted data
+   * @param data - The raw audio data, interleaved pcm_t stereo frames
+   * @param len - Byte length of audio data
+   * @param ticksToWait - The longest time to wait for free space, 0 drops the data at once when the buffer is full
+   * @return true on success, false when some data is dropped
+   */
+  static bool writeResampled(Resampler &resampler, pcm_t *out, const uint8_t *data, uint32_t len, uint32_t ticksToWait);
+
+  /**
+   * @fn flushResampled
+   * @brief Copy the frames still held in the history of the converter into the PCM buffer, at the end of a source
+   * @param resampler - The converter of the source, its history is cleared
+   * @param out - Buffer of RESAMPLE_OUT_FRAMES stereo frames for the converted data
+   * @param ticksToWait - The longest time to wait for free space, 0 drops the data at once when the buffer is full
+   * @return true on success, false when some data is dropped
+   */
+  static bool flushResampled(Resampler &resampler, pcm_t *out, uint32_t ticksToWait);
+
+  /**
+   * @fn outputTask
+   * @brief The task draining the PCM buffer through the audio processing into the output sink
+   * @param arg - Corresponding parameter information
+   * @return None
+   * @note Because of some factors like action scope, the function should be static. Therefore it is shared by multiple objects of the class.
+   */
+  static void outputTask(void *arg);
+
+  /**
+   * @fn prefetchTask
+   * @brief The task reading the audio data of the playing WAV file into the read-ahead buffers
+   * @param arg - Corresponding parameter information
+   * @return None
+   * @note Because of some factors like action scope, the function should be static. Therefore it is shared by multiple objects of the class.
+   */
+  static void prefetchTask(void *arg);
+
+  /**
+   * @fn openTrack
+   * @brief Open and parse the single track, or a track of the playlist queue, broken tracks of the queue are skipped
+   * @param parser - The parser, it holds the format of the track on success
+   * @param advance - false: the current track; true: the next track of the queue
+   * @param skip - Moving on was asked by the user, see PlayQueue::next()
+   * @return The file left at the first sample, NULL when there is no track
+   */
+  static FILE * openTrack(WavParser &parser, bool advance, bool skip);
+
 private:
 
 };
@@ -0,0 +1,317 @@
+/*!
+ * @file  DSPChain.h
+ * @brief  Define the processing chain composed of stages at compile time, e.g. DSPChain<ChainGain<float>, ChainCascade<FilterLP>, ChainLimiter, ChainRequantizer<int16_t> >
+ * @details  Every stage processes one stereo frame in tick(), and the chain runs the frame through all of its stages
+ * @n        before moving on to the next frame, so the whole chain is one loop over the block with no intermediate buffers.
+ * @n        The chain is run on a local copy, and the small stages load their state in begin() and store it back in end(),
+ * @n        so the compiler can keep the state in registers through the loop. The configuration is chosen by selecting
+ * @n        one of several chains instantiated in advance, never by a branch per sample.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __DSP_CHAIN_H__
+#define __DSP_CHAIN_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "PCMSample.h"
+#include "GainStage.h"
+#include "Equalizer.h"
+#include "PeakLimiter.h"
+#include "Requantizer.h"
+
+template <typename... Stages>
+class DSPChain;
+
+template <>
+class DSPChain<>
+{
+public:
+  void begin(size_t frames) {}
+  template <typename sample_t>
+  DSP_INLINE void tick(sample_t &l, sample_t &r) {}
+  void end(void) {}
+};
+
+template <typename First, typename... Rest>
+class DSPChain<First, Rest...>
+{
+public:
+  DSPChain(const First &first, const Rest &... rest) : _first(first), _rest(rest...) {}
+
+  /**
+   * @fn begin
+   * @brief Load the state of every stage before a block
+   * @param frames - Number of stereo frames in the block
+   * @return None
+   */
+  void begin(size_t frames)
+  {
+    _first.begin(frames);
+    _rest.begin(frames);
+  }
+
+  /**
+   * @fn tick
+   * @brief Run one stereo frame through every stage
+   * @param l - The left sample, overwritten by the processed sample
+   * @param r - The right sample, overwritten by the processed sample
+   * @return None
+   */
+  template <typename sample_t>
+  DSP_INLINE void tick(sample_t &l, sample_t &r)
+  {
+    _first.tick(l, r);
+    _rest.tick(l, r);
+  }
+
+  /**
+   * @fn end
+   * @brief Store the state of every stage after a block
+   * @return None
+   */
+  void end(void)
+  {
+    _first.end();
+    _rest.end();
+  }
+
+  /**
+   * @fn process
+   * @brief Run a block of interleaved stereo frames through the chain in one loop
+   * @param in - The audio data to be processed, pcm_t samples
+   * @param out - The processed audio data, int16_t or int32_t words
+   * @param frames - Number of stereo frames in the block
+   * @param swap - 1: swap the left and right channels of the output; 0: keep them
+   * @note The chain must end with a stage bringing the samples into the range of the output words, e.g. ChainRequantizer
+   * @return None
+   */
+  template <typename sample_t, typename out_t>
+  void process(const pcm_t *in, out_t *out, size_t frames, uint8_t swap)
+  {
+    DSPChain chain(*this);   // Not aliased by in or out, so the state can stay in registers
+    chain.begin(frames);
+    for(size_t i=0; i<frames; i++){
+      sample_t l = in[2 * i];
+      sample_t r = in[2 * i + 1];
+      chain.tick(l, r);
+      out[2 * i + swap] = (out_t)l;
+      out[2 * i + 1 - swap] = (out_t)r;
+    }
+    chain.end();
+  }
+
+protected:
+  First _first;
+  DSPChain<Rest...> _rest;
+};
+
+/**
+ * @brief The volume stage, it ramps to a new gain over the block as given by GainStage::ramp()
+ * @n int32_t samples are scaled as by GainStage and gain DSP_FRACTION_BITS below the LSB, float samples are scaled in float
+ * @n Every chain fed with pcm_t samples starts with it, it brings the PCM_FRACTION_BITS of wide samples to the scale of the chain
+ */
+template <typename sample_t>
+class ChainGain;
+
+template <>
+class ChainGain<int32_t>
+{
+public:
+  ChainGain(GainStage *stage) : _stage(stage), _gain(0), _step(0) {}
+  void begin(size_t frames) { _gain = _stage->ramp(frames, &_step); }
+  DSP_INLINE void tick(int32_t &l, int32_t &r)
+  {
+    _gain += _step;
+    int32_t g = _gain >> 9;
+#ifdef PCM_WIDE_SAMPLES
+    l = (int32_t)(((int64_t)l * g) >> (15 - DSP_FRACTION_BITS + PCM_FRACTION_BITS));
+    r = (int32_t)(((int64_t)r * g) >> (15 - DSP_FRACTION_BITS + PCM_FRACTION_BITS));
+#else
+    l = (l * g) >> (15 - DSP_FRACTION_BITS);
+    r = (r * g) >> (15 - DSP_FRACTION_BITS);
+#endif
+  }
+  void end(void) {}
+
+protected:
+  GainStage *_stage;
+  int32_t _gain;   // Q24
+  int32_t _step;   // Q24
+};
+
+template <>
+class ChainGain<float>
+{
+public:
+  ChainGain(GainStage *stage) : _stage(stage), _gain(0), _step(0) {}
+  void begin(size_t frames)
+  {
+    int32_t step;
+    _gain = _stage->ramp(frames, &step) * (1.0f / (1 << 24) / (1 << PCM_FRACTION_BITS));
+    _step = step * (1.0f / (1 << 24) / (1 << PCM_FRACTION_BITS));
+  }
+  DSP_INLINE void tick(float &l, float &r)
+  {
+    _gain += _step;
+    l *= _gain;
+    r *= _gain;
+  }
+  void end(void) {}
+
+protected:
+  GainStage *_stage;
+  float _gain;
+  float _step;
+};
+
+/**
+ * @brief A filter cascade, e.g. FilterCascade<StereoBiquad, 6>, it works on the state of the given object in place
+ * @n The coefficients and the state of the stages do not fit in the registers, a working copy would only be spilled
+ * @n to the stack and shuffled between the registers and the stack on every frame
+ */
+template <typename Cascade>
+class ChainCascade
+{
+public:
+  ChainCascade(Cascade *cascade) : _cascade(cascade) {}
+  void begin(size_t frames) {}
+  template <typename sample_t>
+  DSP_INLINE void tick(sample_t &l, sample_t &r) { _cascade->tick(l, r); }
+  void end(void) {}
+
+protected:
+  Cascade *_cascade;
+};
+
+/**
+ * @brief A crossfade from the output of one stage to the output of another, e.g. from the old filter to the new one
+ * @n Both stages run on every frame, the weight of the old one falls linearly over the length of the crossfade, and
+ * @n the frames left are loaded from and stored back to the given counter
+ */
+template <typename Stage>
+class ChainCrossfade
+{
+public:
+  ChainCrossfade(const Stage &from, const Stage &to, uint16_t *remaining, const uint16_t *length)
+    : _from(from), _to(to), _remainingPtr(remaining), _lengthPtr(length), _remaining(0), _length(1) {}
+  void begin(size_t frames)
+  {
+    _from.begin(frames);
+    _to.begin(frames);
+    _remaining = *_remainingPtr;
+    _length = *_lengthPtr ? *_lengthPtr : 1;
+  }
+  template <typename sample_t>
+  DSP_INLINE void tick(sample_t &l, sample_t &r)
+  {
+    sample_t fromL = l, fromR = r;
+    _from.tick(fromL, fromR);
+    _to.tick(l, r);
+    if(_remaining > 0){   // The old stage runs on after the end of the crossfade until the end of the block, unheard
+      blend(l, fromL);
+      blend(r, fromR);
+      _remaining--;
+    }
+  }
+  void end(void)
+  {
+    _from.end();
+    _to.end();
+    *_remainingPtr = _remaining;
+  }
+
+protected:
+  DSP_INLINE void blend(int32_t &to, int32_t from)
+  {
+    int32_t w = ((int32_t)_remaining << 15) / _length;   // Weight of the old stage in Q15
+    to += (int32_t)(((int64_t)(from - to) * w) >> 15);
+  }
+  DSP_INLINE void blend(float &to, float from)
+  {
+    to += (from - to) * ((float)_remaining / _length);   // Weighted by the old stage
+  }
+
+  Stage _from;
+  Stage _to;
+  uint16_t *_remainingPtr;
+  const uint16_t *_lengthPtr;
+  uint16_t _remaining;   // Working copy for the block
+  uint16_t _length;
+};
+
+/**
+ * @brief The equalizer, its bands are packed at runtime and it works on its own state in place
+ */
+class ChainEqualizer
+{
+public:
+  ChainEqualizer(Equalizer *eq) : _eq(eq) {}
+  void begin(size_t frames) {}
+  template <typename sample_t>
+  DSP_INLINE void tick(sample_t &l, sample_t &r) { _eq->tick(l, r); }
+  void end(void) {}
+
+protected:
+  Equalizer *_eq;
+};
+
+/**
+ * @brief The look-ahead limiter, it delays the samples by LIMITER_LOOKAHEAD_FRAMES and works on its own state in place
+ */
+class ChainLimiter
+{
+public:
+  ChainLimiter(PeakLimiter *limiter) : _limiter(limiter) {}
+  void begin(size_t frames) { _limiter->begin(); }
+  template <typename sample_t>
+  DSP_INLINE void tick(sample_t &l, sample_t &r) { _limiter->tick(l, r); }
+  void end(void) {}
+
+protected:
+  PeakLimiter *_limiter;
+};
+
+/**
+ * @brief The requantization to the output words, int16_t for 16-bit output, int32_t for 24-bit and 32-bit output
+ * @n its state is loaded from and stored back to the given object
+ */
+template <typename out_t>
+class ChainRequantizer;
+
+template <>
+class ChainRequantizer<int16_t>
+{
+public:
+  ChainRequantizer(Requantizer *requantizer) : _requantizer(requantizer) {}
+  void begin(size_t frames) { _requantizer->begin(frames, &_shaper); }
+  template <typename sample_t>
+  DSP_INLINE void tick(sample_t &l, sample_t &r) { Requantizer::tick(_shaper, l, r); }
+  void end(void) { _requantizer->end(_shaper); }
+
+protected:
+  Requantizer *_requantizer;
+  Requantizer::sShaper_t _shaper;   // Working copy for the block
+};
+
+template <>
+class ChainRequantizer<int32_t>
+{
+public:
+  ChainRequantizer(Requantizer *requantizer) : _requantizer(requantizer) {}
+  void begin(size_t frames) { _requantizer->begin(frames, &_shaper); }
+  template <typename sample_t>
+  DSP_INLINE void tick(sample_t &l, sample_t &r) { Requantizer::tickWide(_shaper, l, r); }
+  void end(void) { _requantizer->end(_shaper); }
+
+protected:
+  Requantizer *_requantizer;
+  Requantizer::sShaper_t _shaper;
+};
+
+#endif
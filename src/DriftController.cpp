@@ -0,0 +1,51 @@
+/*!
+ * @file  DriftController.cpp
+ * @brief  Define the control loop keeping the PCM buffer of a streamed source at a constant fill level
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "DriftController.h"
+
+static inline float clampPPM(float ppm)
+{
+  return (ppm > DRIFT_MAX_PPM) ? DRIFT_MAX_PPM : ((ppm < -DRIFT_MAX_PPM) ? -DRIFT_MAX_PPM : ppm);
+}
+
+DriftController::DriftController(void)
+  : _rate(44100.0f), _kp(0.0f), _ki(0.0f), _average(0.0f), _integral(0.0f), _target(0), _restart(true), _drift(0.0f)
+{
+}
+
+void DriftController::begin(uint32_t sampleRate, size_t target)
+{
+  // The buffer integrates the rate difference: d(fill)/dt = rate * (drift - trim) * 1e-6. With the PI trim
+  // kp * e + ki * integral(e dt) the loop is s^2 + rate * 1e-6 * (kp * s + ki), critically damped at w = 1 / DRIFT_SETTLE_SECONDS
+  float w = 1.0f / DRIFT_SETTLE_SECONDS;
+  _rate = (float)sampleRate;
+  _kp = 2.0f * w * 1e6f / _rate;
+  _ki = w * w * 1e6f / _rate;
+  _integral = 0.0f;
+  _target = target;
+  _restart = true;
+  _drift.store(0.0f, std::memory_order_relaxed);
+}
+
+float DriftController::update(size_t fill, size_t frames)
+{
+  if(_restart){
+    _average = (float)fill;
+    _restart = false;
+  }else{
+    float a = (float)frames / (_rate * DRIFT_SMOOTH_SECONDS);
+    _average += ((a < 1.0f) ? a : 1.0f) * ((float)fill - _average);
+  }
+
+  float e = _average - (float)_target;
+  _integral = clampPPM(_integral + _ki * e * ((float)frames / _rate));   // Clamped against wind-up, e.g. by a source far off its rate
+  _drift.store(_integral, std::memory_order_relaxed);
+  return clampPPM(_kp * e + _integral);
+}
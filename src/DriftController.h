@@ -0,0 +1,102 @@
+/*!
+ * @file  DriftController.h
+ * @brief  Define the control loop keeping the PCM buffer of a streamed source at a constant fill level
+ * @details  The clock of a Bluetooth source never runs exactly at the I2S clock, so the buffer between them slowly fills
+ * @n        up, adding latency, or runs dry. The controller averages the fill level seen by the consumer, and a PI loop
+ * @n        on its distance from the target gives the trim of the resampling ratio in ppm. The integral term settles on
+ * @n        the drift of the two clocks, so the buffer, and with it the latency, stays at the target without any frame
+ * @n        being dropped or repeated. The loop is critically damped and slow, so the pitch never audibly wobbles.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __DRIFT_CONTROLLER_H__
+#define __DRIFT_CONTROLLER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define DRIFT_MAX_PPM   ((float)(1000.0f))   //!< The largest trim of the ratio, crystals are within about +-100 ppm of each other
+#define DRIFT_SETTLE_SECONDS   ((float)(40.0f))   //!< Time constant of the control loop, 1 / natural frequency
+#define DRIFT_SMOOTH_SECONDS   ((float)(2.0f))   //!< Time constant of the average of the fill level, longer than the bursts of the Bluetooth stack
+
+class DriftController
+{
+public:
+  /**
+   * @fn DriftController
+   * @brief Constructor, the controller is inactive until begin()
+   * @return None
+   */
+  DriftController(void);
+
+  /**
+   * @fn begin
+   * @brief Start controlling a new stream, the drift estimate starts from 0
+   * @param sampleRate - The output sample rate, the rate the buffer is drained at
+   * @param target - The fill level (stereo frames) to keep
+   * @return None
+   */
+  void begin(uint32_t sampleRate, size_t target);
+
+  /**
+   * @fn end
+   * @brief Stop controlling, isActive() is false afterwards
+   * @return None
+   */
+  void end(void) { _target = 0; }
+
+  /**
+   * @fn isActive
+   * @brief Whether a stream is controlled
+   * @return true between begin() and end()
+   */
+  bool isActive(void) const { return _target > 0; }
+
+  /**
+   * @fn restart
+   * @brief Start the average of the fill level again from the next update(), e.g. after the buffer was refilled
+   * @n     The drift estimate is kept, the clocks have not changed
+   * @return None
+   */
+  void restart(void) { _restart = true; }
+
+  /**
+   * @fn update
+   * @brief Take the fill level of the buffer after a block of output, called by the consumer
+   * @param fill - The fill level as the stereo frames it lasts at the output rate
+   * @param frames - The stereo frames output since the last update, the time passed at the output rate
+   * @return The trim of the resampling ratio in ppm, positive to consume the source faster
+   */
+  float update(size_t fill, size_t frames);
+
+  /**
+   * @fn getDrift
+   * @brief Get the estimated drift, may be called by any task
+   * @return How much faster the source clock runs than the output clock, in ppm
+   */
+  float getDrift(void) const { return _drift.load(std::memory_order_relaxed); }
+
+  /**
+   * @fn getTarget
+   * @brief Get the fill level kept
+   * @return The target in stereo frames, 0 when inactive
+   */
+  size_t getTarget(void) const { return _target; }
+
+protected:
+  float _rate;   // The output sample rate
+  float _kp;   // ppm per frame of distance from the target
+  float _ki;   // ppm per frame of distance and second
+  float _average;   // The average fill level in frames
+  float _integral;   // ppm, settles on the drift
+  size_t _target;
+  bool _restart;
+  std::atomic<float> _drift;   // _integral published to other tasks
+};
+
+#endif
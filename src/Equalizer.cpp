@@ -0,0 +1,123 @@
+/*!
+ * @file  Equalizer.cpp
+ * @brief  Define the N-band parametric/graphic equalizer
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "Equalizer.h"
+
+Equalizer::Equalizer(float sampleRate)
+{
+  _sampleRate = sampleRate;
+  for(uint8_t i=0; i<EQ_MAX_BANDS; i++){
+    _bands[i].type = bq_type_peak;
+    _bands[i].fc = 1000.0;
+    _bands[i].Q = 0.707;
+    _bands[i].gainDB = 0.0;
+    _bands[i].enable = false;
+  }
+  _work = NULL;
+  memset(_running, 0, sizeof(_running));
+  rebuild();
+  update();
+}
+
+void Equalizer::setSampleRate(float sampleRate)
+{
+  _sampleRate = sampleRate;
+  rebuild();
+}
+
+bool Equalizer::setBand(uint8_t band, int type, float fc, float Q, float gainDB)
+{
+  if(band >= EQ_MAX_BANDS){
+    return false;
+  }
+  _bands[band].type = type;
+  _bands[band].fc = constrain(fc, 2.0, 20000.0);
+  _bands[band].Q = Q;
+  _bands[band].gainDB = gainDB;
+  rebuild();
+  return true;
+}
+
+bool Equalizer::enableBand(uint8_t band, bool enable)
+{
+  if(band >= EQ_MAX_BANDS){
+    return false;
+  }
+  _bands[band].enable = enable;
+  rebuild();
+  return true;
+}
+
+void Equalizer::rebuild(void)
+{
+  uint8_t n = 0;
+  for(uint8_t i=0; i<EQ_MAX_BANDS; i++){
+    const sEQBand_t &b = _bands[i];
+    if(!b.enable){
+      continue;
+    }
+    bool gainType = (b.type == bq_type_peak) || (b.type == bq_type_lowshelf) || (b.type == bq_type_highshelf);
+    if(gainType && (b.gainDB == 0.0)){   // A flat band does not change the signal
+      continue;
+    }
+    float Fc = b.fc / _sampleRate;
+    if(Fc > 0.49){
+      Fc = 0.49;
+    }
+    _design.band[n] = i;
+    Biquad::calcCoefficients(b.type, Fc, b.Q, b.gainDB, _design.coef[n]);
+    quantizeBiquad(_design.coef[n], _design.coefFixed[n], &_design.shift[n]);
+    n++;
+  }
+  _design.active = n;
+  _coefSets.write(_design);
+}
+
+uint8_t Equalizer::update(void)
+{
+  if(_coefSets.update()){
+    _work = &_coefSets.front();
+    bool running[EQ_MAX_BANDS] = {false};
+    for(uint8_t k=0; k<_work->active; k++){
+      uint8_t b = _work->band[k];
+      running[b] = true;
+      if(!_running[b]){   // A band joining the cascade starts from silence
+        memset(_state[b], 0, sizeof(_state[b]));
+        memset(_stateFixed[b], 0, sizeof(_stateFixed[b]));
+        memset(_errFixed[b], 0, sizeof(_errFixed[b]));
+      }else if(_shift[b] != _work->shift[k]){   // The truncation errors are relative to the old scale
+        memset(_errFixed[b], 0, sizeof(_errFixed[b]));
+      }
+      _shift[b] = _work->shift[k];
+    }
+    memcpy(_running, running, sizeof(_running));
+  }
+  return _work->active;
+}
+
+void Equalizer::process(float *data, size_t frames)
+{
+  if(_work->active == 0){
+    return;
+  }
+  for(size_t i=0; i<frames; i++){
+    tick(data[2 * i], data[2 * i + 1]);
+  }
+}
+
+void Equalizer::process(int32_t *data, size_t frames)
+{
+  if(_work->active == 0){
+    return;
+  }
+  for(size_t i=0; i<frames; i++){
+    tick(data[2 * i], data[2 * i + 1]);
+  }
+}
@@ -0,0 +1,195 @@
+/*!
+ * @file  Equalizer.h
+ * @brief  Define the N-band parametric/graphic equalizer
+ * @details  Each band is a peak, low-shelf or high-shelf biquad (other Biquad types are accepted too). Only the enabled bands
+ * @n        which change the signal are packed into the working cascade, and the packed bands are run in one fused loop,
+ * @n        so the equalizer costs one pass over the buffer however many bands are active.
+ * @n        The bands are set by the control task and the packed coefficients are handed over to the audio task through
+ * @n        a TripleBuffer, which picks them up at the start of a block without taking a lock.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __EQUALIZER_H__
+#define __EQUALIZER_H__
+
+#include "Biquad.h"
+#include "BiquadFixed.h"
+#include "TripleBuffer.h"
+
+#define EQ_MAX_BANDS   ((uint8_t)(10))   //!< The maximum number of equalizer bands
+
+class Equalizer
+{
+public:
+  /**
+   * @fn Equalizer
+   * @brief Constructor, all the bands are disabled
+   * @param sampleRate - The sampling frequency of the audio data
+   * @return None
+   */
+  Equalizer(float sampleRate=44100);
+
+  /**
+   * @fn setSampleRate
+   * @brief Set the sampling frequency of the audio data, the coefficients of all the bands are recalculated
+   * @param sampleRate - The sampling frequency of the audio data
+   * @return None
+   */
+  void setSampleRate(float sampleRate);
+
+  /**
+   * @fn setBand
+   * @brief Set the parameters of a band, the enable state of the band is unchanged
+   * @param band - The band number, range: 0 to EQ_MAX_BANDS-1
+   * @param type - bq_type_peak, bq_type_lowshelf, bq_type_highshelf or another type enumerated in Biquad.h
+   * @param fc - Center (peak) or corner (shelf) frequency of the band, range: 2-20000
+   * @param Q - Quality factor of the band
+   * @param gainDB - Gain of the band in dB, a peak or shelf band with 0 dB is skipped
+   * @return true on success, false when the band number is out of range
+   */
+  bool setBand(uint8_t band, int type, float fc, float Q, float gainDB);
+
+  /**
+   * @fn enableBand
+   * @brief Enable or disable a band, disabled bands are skipped
+   * @param band - The band number, range: 0 to EQ_MAX_BANDS-1
+   * @param enable - true: enable the band; false: disable the band
+   * @return true on success, false when the band number is out of range
+   */
+  bool enableBand(uint8_t band, bool enable);
+
+  /**
+   * @fn getActiveBands
+   * @brief Get the number of bands packed into the working cascade, called by the control task
+   * @return The number of bands which are enabled and change the signal
+   */
+  uint8_t getActiveBands(void) const { return _design.active; }
+
+  /**
+   * @fn update
+   * @brief Pick up the coefficients published by the control task, called by the audio task at a block boundary
+   * @return The number of bands in the working cascade
+   */
+  uint8_t update(void);
+
+  /**
+   * @fn process
+   * @brief Process a block of interleaved stereo frames through all the working bands in one pass, called by the audio task
+   * @param data - The audio data to be processed, it is overwritten by the processed data
+   * @param frames - Number of stereo frames in the block
+   * @return None
+   */
+  void process(float *data, size_t frames);
+  void process(int32_t *data, size_t frames);
+
+  /**
+   * @fn tick
+   * @brief Process one stereo frame through all the working bands, for processing chains which run all their stages frame by frame
+   * @param l - The left sample, overwritten by the processed sample
+   * @param r - The right sample, overwritten by the processed sample
+   * @return None
+   */
+  void tick(float &l, float &r);
+  void tick(int32_t &l, int32_t &r);
+
+protected:
+
+  /**
+   * @fn rebuild
+   * @brief Pack the active bands and publish their coefficients to the audio task
+   * @return None
+   */
+  void rebuild(void);
+
+  typedef struct
+  {
+    int type;
+    float fc, Q, gainDB;
+    bool enable;
+  }sEQBand_t;
+
+  /**
+   * @struct sEQCoefSet_t
+   * @brief The packed coefficients handed over to the audio task
+   */
+  typedef struct
+  {
+    uint8_t active;   // The number of packed bands
+    uint8_t band[EQ_MAX_BANDS];   // The band number of each packed band, its state follows the band across repacking
+    float coef[EQ_MAX_BANDS][5];   // Float coefficients a0, a1, a2, b1, b2
+    int32_t coefFixed[EQ_MAX_BANDS][5];   // Fixed-point coefficients
+    int shift[EQ_MAX_BANDS];
+  }sEQCoefSet_t;
+
+  // Owned by the control task
+  sEQBand_t _bands[EQ_MAX_BANDS];
+  float _sampleRate;
+  sEQCoefSet_t _design;
+
+  TripleBuffer<sEQCoefSet_t> _coefSets;
+
+  // Owned by the audio task
+  const sEQCoefSet_t *_work;   // The working coefficients
+  bool _running[EQ_MAX_BANDS];   // Whether each band is in the working cascade
+  int _shift[EQ_MAX_BANDS];   // The fixed-point scale each band is running with
+  float _state[EQ_MAX_BANDS][4];   // Float state z1L, z1R, z2L, z2R of each band
+  int32_t _stateFixed[EQ_MAX_BANDS][8];   // Fixed-point state x1, x2, y1, y2 of both channels of each band
+  int64_t _errFixed[EQ_MAX_BANDS][4];   // Truncation errors e1, e2 of both channels of each band
+};
+
+DSP_INLINE void Equalizer::tick(float &l, float &r)
+{
+  const sEQCoefSet_t *set = _work;
+  const uint8_t active = set->active;
+  float xL = l;
+  float xR = r;
+  for(uint8_t k=0; k<active; k++){   // Run the frame through every packed band before moving on
+    const float *c = set->coef[k];
+    float *z = _state[set->band[k]];
+    float yL = xL * c[0] + z[0];
+    float yR = xR * c[0] + z[1];
+    z[0] = xL * c[1] + z[2] - c[3] * yL;
+    z[1] = xR * c[1] + z[3] - c[3] * yR;
+    z[2] = xL * c[2] - c[4] * yL;
+    z[3] = xR * c[2] - c[4] * yR;
+    xL = yL;
+    xR = yR;
+  }
+  l = xL;
+  r = xR;
+}
+
+DSP_INLINE void Equalizer::tick(int32_t &l, int32_t &r)
+{
+  const sEQCoefSet_t *set = _work;
+  const uint8_t active = set->active;
+  int32_t x[2] = {l, r};
+  for(uint8_t k=0; k<active; k++){
+    const int32_t *c = set->coefFixed[k];
+    const int shift = set->shift[k];
+    const int64_t mask = ((int64_t)1 << shift) - 1;
+    uint8_t b = set->band[k];
+    for(int ch=0; ch<2; ch++){
+      int32_t *s = &_stateFixed[b][4 * ch];   // x1, x2, y1, y2
+      int64_t *e = &_errFixed[b][2 * ch];   // e1, e2
+      int64_t acc = 2 * e[0] - e[1] + (int64_t)c[0] * x[ch] + (int64_t)c[1] * s[0] + (int64_t)c[2] * s[1]
+                                     - (int64_t)c[3] * s[2] - (int64_t)c[4] * s[3];
+      int32_t y = (int32_t)(acc >> shift);
+      e[1] = e[0];
+      e[0] = acc & mask;
+      s[1] = s[0];
+      s[0] = x[ch];
+      s[3] = s[2];
+      s[2] = y;
+      x[ch] = y;
+    }
+  }
+  l = x[0];
+  r = x[1];
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*!
+ * @file  FileAudioSource.cpp
+ * @brief  Define the audio input source of a part of a file
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "FileAudioSource.h"
+
+FileAudioSource::FileAudioSource(void)
+  : _fp(NULL), _remaining(0)
+{
+}
+
+void FileAudioSource::open(FILE *fp, uint32_t len)
+{
+  _fp = fp;
+  _remaining = len;
+}
+
+void FileAudioSource::close(void)
+{
+  _fp = NULL;
+  _remaining = 0;
+}
+
+size_t FileAudioSource::read(void *data, size_t len)
+{
+  if(_fp == NULL){
+    return 0;
+  }
+  if(len > _remaining){
+    len = _remaining;
+  }
+  size_t ret = fread(data, 1, len, _fp);
+  _remaining -= ret;
+  return ret;
+}
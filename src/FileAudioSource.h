@@ -0,0 +1,58 @@
+/*!
+ * @file  FileAudioSource.h
+ * @brief  Define the audio input source of a part of a file
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __FILE_AUDIO_SOURCE_H__
+#define __FILE_AUDIO_SOURCE_H__
+
+#include <stdio.h>
+
+#include "AudioSource.h"
+
+class FileAudioSource : public AudioSource
+{
+public:
+  /**
+   * @fn FileAudioSource
+   * @brief Constructor
+   * @return None
+   */
+  FileAudioSource(void);
+
+  /**
+   * @fn open
+   * @brief Read the audio data from the current position of a file
+   * @param fp - The opened file, it stays owned by the caller
+   * @param len - Byte length of the audio data, 0xFFFFFFFF reads up to the end of the file
+   * @return None
+   */
+  void open(FILE *fp, uint32_t len);
+
+  /**
+   * @fn close
+   * @brief Stop reading the file, the file is not closed
+   * @return None
+   */
+  void close(void);
+
+  /**
+   * @fn read
+   * @brief Read the next audio data from the file
+   * @param data - Buffer for the audio data
+   * @param len - Byte length of the buffer
+   * @return The number of bytes actually read, 0 at the end of the audio data or on error
+   */
+  size_t read(void *data, size_t len);
+
+protected:
+  FILE *_fp;
+  uint32_t _remaining;   // Bytes of audio data left in the file
+};
+
+#endif
@@ -0,0 +1,159 @@
+/*!
+ * @file  FilterCascade.h
+ * @brief  Define the low-pass and high-pass filter of a given order and alignment, a series of stereo biquads
+ * @details  The order and the alignment are template parameters, so the number of stages is known at compile time:
+ * @n        the Q of every stage is worked out by the compiler and the stages are unrolled in tick().
+ * @n        A Butterworth filter of order N is N/2 second-order stages with the pole Q of the stage, plus one first-order
+ * @n        stage when N is odd. A Linkwitz-Riley filter of order N is the Butterworth filter of order N/2 twice.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __FILTER_CASCADE_H__
+#define __FILTER_CASCADE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Biquad.h"
+
+#define FILTER_BUTTERWORTH   ((uint8_t)(0))   //!< Maximally flat pass band, -3 dB at the threshold, order 1-8
+#define FILTER_LINKWITZ_RILEY   ((uint8_t)(1))   //!< -6 dB at the threshold, the low-pass and high-pass filter of a crossover sum to a flat response, order 2, 4, 6 or 8 (invert the high-pass output of order 2 and 6)
+
+/**
+ * @fn filterCos
+ * @brief cos() for constant expressions, the Taylor series up to x^26, exact in double for |x| <= PI/2
+ * @param x2 - The square of the angle
+ * @param term - The current term of the series, 1.0 to start
+ * @param n - The index of the current term, 0 to start
+ * @return cos(x)
+ */
+constexpr double filterCos(double x2, double term, int n)
+{
+  return (n > 12) ? term : (term + filterCos(x2, -term * x2 / ((2 * n + 1) * (2 * n + 2)), n + 1));
+}
+
+/**
+ * @fn butterworthQ
+ * @brief The Q of a stage of a Butterworth filter, 1 / (2 * cos(PI * (2 * stage + 1 + order % 2) / (2 * order)))
+ * @param order - Order of the Butterworth filter
+ * @param stage - The stage, the last stage of an odd order is the first-order stage
+ * @return The Q, 0 for the first-order stage
+ */
+constexpr float butterworthQ(int order, int stage)
+{
+  return ((order % 2) && (stage == order / 2)) ? 0.0f :
+         (float)(0.5 / filterCos(3.14159265358979323846 * (2 * stage + 1 + order % 2) / (2 * order) *
+                                 3.14159265358979323846 * (2 * stage + 1 + order % 2) / (2 * order), 1.0, 0));
+}
+
+/**
+ * @brief Run a stereo frame through N stages, unrolled at compile time
+ */
+template <int N>
+struct FilterUnroll
+{
+  template <typename Filter, typename sample_t>
+  static DSP_INLINE void tick(Filter *stage, sample_t &l, sample_t &r)
+  {
+    stage->tick(l, r);
+    FilterUnroll<N - 1>::tick(stage + 1, l, r);
+  }
+};
+
+template <>
+struct FilterUnroll<0>
+{
+  template <typename Filter, typename sample_t>
+  static DSP_INLINE void tick(Filter *stage, sample_t &l, sample_t &r) {}
+};
+
+/**
+ * @brief Calculate the coefficients of the stages from STAGE on, unrolled so that every Q is a constant expression
+ */
+template <typename Cascade, int STAGE, bool END = (STAGE >= Cascade::STAGES)>
+struct FilterDesignUnroll
+{
+  static void design(int type, float Fc, typename Cascade::filter_t::sCoef_t *coef)
+  {
+    constexpr float Q = Cascade::stageQ(STAGE);
+    if(Q > 0){
+      Cascade::filter_t::calcCoefficients(type, Fc, Q, 0, coef[STAGE]);
+    }else{
+      Cascade::filter_t::calcCoefficients((type == bq_type_lowpass) ? bq_type_lowpass1 : bq_type_highpass1, Fc, 0, 0, coef[STAGE]);
+    }
+    FilterDesignUnroll<Cascade, STAGE + 1>::design(type, Fc, coef);
+  }
+};
+
+template <typename Cascade, int STAGE>
+struct FilterDesignUnroll<Cascade, STAGE, true>
+{
+  static void design(int type, float Fc, typename Cascade::filter_t::sCoef_t *coef) {}
+};
+
+template <typename Filter, int ORDER, uint8_t ALIGNMENT = FILTER_BUTTERWORTH>
+class FilterCascade
+{
+public:
+  typedef Filter filter_t;   // The stereo biquad of each stage, StereoBiquad or StereoBiquadFixed
+  static const int BUTTERWORTH_ORDER = (ALIGNMENT == FILTER_LINKWITZ_RILEY) ? (ORDER / 2) : ORDER;
+  static const int BUTTERWORTH_STAGES = (BUTTERWORTH_ORDER + 1) / 2;
+  static const int STAGES = (ALIGNMENT == FILTER_LINKWITZ_RILEY) ? (2 * BUTTERWORTH_STAGES) : BUTTERWORTH_STAGES;   // The number of biquads
+
+  static_assert((ORDER >= 1) && (ORDER <= 8), "The filter order must be 1-8");
+  static_assert((ALIGNMENT == FILTER_BUTTERWORTH) || ((ALIGNMENT == FILTER_LINKWITZ_RILEY) && (ORDER % 2 == 0)),
+                "A Linkwitz-Riley filter must be of order 2, 4, 6 or 8");
+
+  /**
+   * @fn stageQ
+   * @brief The Q of a stage
+   * @param stage - The stage, range: 0 to STAGES - 1
+   * @return The Q, 0 for a first-order stage
+   */
+  static constexpr float stageQ(int stage) { return butterworthQ(BUTTERWORTH_ORDER, stage % BUTTERWORTH_STAGES); }
+
+  /**
+   * @fn design
+   * @brief Calculate the coefficients of all the stages, no trigonometry apart from the tan() of the threshold
+   * @param type - bq_type_lowpass or bq_type_highpass
+   * @param Fc - Ratio of filter threshold to sampling frequency, range: 0.0-0.5
+   * @param coef - The coefficients of the STAGES stages
+   * @return None
+   */
+  static void design(int type, float Fc, typename Filter::sCoef_t *coef)
+  {
+    FilterDesignUnroll<FilterCascade, 0>::design(type, Fc, coef);
+  }
+
+  /**
+   * @fn setCoefficients
+   * @brief Replace the coefficients of all the stages, the state is kept so the change does not click
+   * @param coef - The coefficients of the STAGES stages
+   * @return None
+   */
+  void setCoefficients(const typename Filter::sCoef_t *coef)
+  {
+    for(int i=0; i<STAGES; i++){
+      _stage[i].setCoefficients(coef[i]);
+    }
+  }
+
+  /**
+   * @fn tick
+   * @brief Process one stereo frame
+   * @param l - The left sample, overwritten by the filtered sample
+   * @param r - The right sample, overwritten by the filtered sample
+   * @return None
+   */
+  template <typename sample_t>
+  DSP_INLINE void tick(sample_t &l, sample_t &r) { FilterUnroll<STAGES>::tick(_stage, l, r); }
+
+protected:
+  Filter _stage[STAGES];
+};
+
+#endif
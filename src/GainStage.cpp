@@ -0,0 +1,77 @@
+/*!
+ * @file  GainStage.cpp
+ * @brief  Define the volume gain stage
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "GainStage.h"
+
+#define GAIN_TABLE_SIZE   ((int)(173))   // -80.0 dB to +6.0 dB
+
+// round(32768 * 10^(dB / 20)), dB = -80.0, -79.5, ... +6.0
+const uint16_t GainStage::_dbTable[GAIN_TABLE_SIZE] = {
+      3,     3,     4,     4,     4,     4,     5,     5,     5,     6,
+      6,     6,     7,     7,     7,     8,     8,     9,     9,    10,
+     10,    11,    12,    12,    13,    14,    15,    16,    16,    17,
+     18,    20,    21,    22,    23,    25,    26,    28,    29,    31,
+     33,    35,    37,    39,    41,    44,    46,    49,    52,    55,
+     58,    62,    65,    69,    73,    78,    82,    87,    92,    98,
+    104,   110,   116,   123,   130,   138,   146,   155,   164,   174,
+    184,   195,   207,   219,   232,   246,   260,   276,   292,   309,
+    328,   347,   368,   389,   413,   437,   463,   490,   519,   550,
+    583,   617,   654,   693,   734,   777,   823,   872,   924,   978,
+   1036,  1098,  1163,  1232,  1305,  1382,  1464,  1550,  1642,  1740,
+   1843,  1952,  2068,  2190,  2320,  2457,  2603,  2757,  2920,  3093,
+   3277,  3471,  3677,  3894,  4125,  4370,  4629,  4903,  5193,  5501,
+   5827,  6172,  6538,  6925,  7336,  7771,  8231,  8719,  9235,  9783,
+  10362, 10976, 11627, 12315, 13045, 13818, 14637, 15504, 16423, 17396,
+  18427, 19519, 20675, 21900, 23198, 24573, 26029, 27571, 29205, 30935,
+  32768, 34710, 36766, 38945, 41252, 43697, 46286, 49029, 51934, 55011,
+  58271, 61723, 65381
+};
+
+GainStage::GainStage(void)
+  : _target(GAIN_UNITY_Q15), _current(GAIN_UNITY_Q15)
+{
+}
+
+void GainStage::setGain(float gain)
+{
+  int32_t q15 = (int32_t)(gain * GAIN_UNITY_Q15 + 0.5f);
+  if(q15 < 0){
+    q15 = 0;
+  }else if(q15 > GAIN_MAX_Q15){
+    q15 = GAIN_MAX_Q15;
+  }
+  _target.store(q15, std::memory_order_relaxed);
+}
+
+void GainStage::setGainDB(float gainDB)
+{
+  int index = (int)((gainDB - GAIN_TABLE_MIN_DB) / GAIN_TABLE_STEP_DB + 0.5f);
+  int32_t q15;
+  if(index < 0){
+    q15 = 0;
+  }else if(index >= GAIN_TABLE_SIZE){
+    q15 = _dbTable[GAIN_TABLE_SIZE - 1];
+  }else{
+    q15 = _dbTable[index];
+  }
+  _target.store(q15, std::memory_order_relaxed);
+}
+
+int32_t GainStage::ramp(size_t frames, int32_t *step)
+{
+  int32_t target = getGain();
+  int32_t gain = _current << 9;
+  *step = 0;
+  if((frames > 0) && (_current != target)){
+    *step = ((target << 9) - gain) / (int32_t)frames;
+    _current = target;
+  }
+  return gain;
+}
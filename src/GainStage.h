@@ -0,0 +1,89 @@
+/*!
+ * @file  GainStage.h
+ * @brief  Define the volume gain stage
+ * @details  The gain is kept as an integer in Q15 (32768 is unity, up to 2.0), a dB setting is looked up in a precomputed table.
+ * @n        A new gain is reached with a linear ramp over the next block, so volume changes do not cause zipper noise.
+ * @n        The processing chains apply the gain themselves, see ChainGain in DSPChain.h, unity gain is skipped.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __GAIN_STAGE_H__
+#define __GAIN_STAGE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define GAIN_UNITY_Q15   ((int32_t)(32768))   //!< Unity gain in Q15
+#define GAIN_MAX_Q15   ((int32_t)(65535))   //!< The largest gain in Q15, just below 2.0
+#define GAIN_TABLE_MIN_DB   ((float)(-80.0))   //!< The smallest gain in the dB table, lower settings mute
+#define GAIN_TABLE_STEP_DB   ((float)(0.5))   //!< The step of the dB table
+
+class GainStage
+{
+public:
+  /**
+   * @fn GainStage
+   * @brief Constructor, the gain starts at unity
+   * @return None
+   */
+  GainStage(void);
+
+  /**
+   * @fn setGain
+   * @brief Set the target gain, called by the control task
+   * @param gain - Linear gain, range: 0.0-2.0
+   * @return None
+   */
+  void setGain(float gain);
+
+  /**
+   * @fn setGainDB
+   * @brief Set the target gain in dB through the precomputed table, called by the control task
+   * @param gainDB - Gain in dB, range: -80.0 to +6.0 in steps of 0.5, lower settings mute
+   * @return None
+   */
+  void setGainDB(float gainDB);
+
+  /**
+   * @fn getGain
+   * @brief Get the target gain
+   * @return Gain in Q15
+   */
+  int32_t getGain(void) const { return _target.load(std::memory_order_relaxed); }
+
+  /**
+   * @fn isUnity
+   * @brief Whether the gain stage can be skipped, called by the audio task
+   * @return true when the gain is unity and no ramp is pending
+   */
+  bool isUnity(void) const { return (_current == GAIN_UNITY_Q15) && (getGain() == GAIN_UNITY_Q15); }
+
+  /**
+   * @fn isAttenuating
+   * @brief Whether the gain stays at or below unity over the next block, called by the audio task
+   * @return true when neither the current nor the target gain is above unity
+   */
+  bool isAttenuating(void) const { return (_current <= GAIN_UNITY_Q15) && (getGain() <= GAIN_UNITY_Q15); }
+
+  /**
+   * @fn ramp
+   * @brief Take the gain ramp of the next block, for the processing chains which apply the gain, called by the audio task
+   * @param frames - Number of stereo frames in the block
+   * @param step - Gain step per frame in Q24
+   * @return The gain in Q24 before the block, the gain of frame i is the return value + (i + 1) * step
+   */
+  int32_t ramp(size_t frames, int32_t *step);
+
+protected:
+  static const uint16_t _dbTable[];   // Q15 gain of GAIN_TABLE_MIN_DB + i * GAIN_TABLE_STEP_DB
+
+  std::atomic<int32_t> _target;   // Target gain in Q15, set by the control task
+  int32_t _current;   // Gain in Q15 reached at the end of the last block, owned by the audio task
+};
+
+#endif
@@ -0,0 +1,38 @@
+/*!
+ * @file  I2SAudioSink.cpp
+ * @brief  Define the audio output sink of the I2S driver
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "I2SAudioSink.h"
+
+I2SAudioSink::I2SAudioSink(i2s_port_t port, uint32_t sampleRate)
+{
+  _port = port;
+  _sampleRate = sampleRate;
+}
+
+size_t I2SAudioSink::write(const void *data, size_t len, uint32_t ticksToWait)
+{
+  size_t bytesWritten = 0;
+  if(i2s_write(_port, data, len, &bytesWritten, ticksToWait)){
+    return 0;
+  }
+  return bytesWritten;
+}
+
+bool I2SAudioSink::setBitsPerSample(uint8_t bitsPerSample)
+{
+  if((bitsPerSample != 16) && (bitsPerSample != 24) && (bitsPerSample != 32)){
+    return false;
+  }
+  i2s_bits_per_sample_t bits = (bitsPerSample == 16) ? I2S_BITS_PER_SAMPLE_16BIT : I2S_BITS_PER_SAMPLE_32BIT;
+  if(i2s_set_clk(_port, _sampleRate, bits, I2S_CHANNEL_STEREO)){
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,53 @@
+/*!
+ * @file  I2SAudioSink.h
+ * @brief  Define the audio output sink of the I2S driver
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __I2S_AUDIO_SINK_H__
+#define __I2S_AUDIO_SINK_H__
+
+#include <driver/i2s.h>
+
+#include "AudioSink.h"
+
+class I2SAudioSink : public AudioSink
+{
+public:
+  /**
+   * @fn I2SAudioSink
+   * @brief Constructor
+   * @param port - The I2S port the audio data is written to, the driver must be installed before writing
+   * @param sampleRate - The sample rate the driver is installed with
+   * @return None
+   */
+  I2SAudioSink(i2s_port_t port=I2S_NUM_0, uint32_t sampleRate=44100);
+
+  /**
+   * @fn write
+   * @brief Write audio data into the DMA buffers of the I2S driver
+   * @param data - The audio data to be output, interleaved stereo frames
+   * @param len - Byte length of audio data
+   * @param ticksToWait - The longest time to wait for free DMA buffers
+   * @return The number of bytes actually written
+   */
+  size_t write(const void *data, size_t len, uint32_t ticksToWait);
+
+  /**
+   * @fn setBitsPerSample
+   * @brief Set the width of the I2S slots, 24-bit samples are sent in 32-bit slots, which the MAX98357A accepts
+   * @param bitsPerSample - 16, 24 or 32
+   * @return true on success, false when the driver cannot be set
+   */
+  bool setBitsPerSample(uint8_t bitsPerSample);
+
+protected:
+  i2s_port_t _port;
+  uint32_t _sampleRate;
+};
+
+#endif
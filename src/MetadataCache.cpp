@@ -0,0 +1,80 @@
+/*!
+ * @file  MetadataCache.cpp
+ * @brief  Define the cache of the metadata of the track playing on the remote Bluetooth device
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <string.h>
+
+#include "MetadataCache.h"
+
+MetadataCache::MetadataCache(void)
+{
+  memset(&_work, 0, sizeof(_work));
+  _published.write(_work);   // The first get() picks up the empty copy, the other slots are written before they are published
+}
+
+int8_t MetadataCache::indexOf(uint8_t attrId)
+{
+  if((attrId == 0) || (attrId & (attrId - 1)) || (attrId & ~METADATA_ATTR_ALL)){   // Exactly one known bit
+    return -1;
+  }
+  return (int8_t)__builtin_ctz(attrId);
+}
+
+bool MetadataCache::set(uint8_t attrId, const uint8_t *text, size_t len)
+{
+  int8_t i = indexOf(attrId);
+  if(i < 0){
+    return false;
+  }
+  if(len > METADATA_TEXT_SIZE - 1){
+    len = METADATA_TEXT_SIZE - 1;
+    while((len > 0) && ((text[len] & 0xc0) == 0x80)){   // Do not split a multi-byte character
+      len--;
+    }
+  }
+  char *slot = _work.text[i];
+  if((strlen(slot) == len) && (memcmp(slot, text, len) == 0)){
+    return false;
+  }
+  memcpy(slot, text, len);
+  slot[len] = 0;
+  _published.write(_work);
+  return true;
+}
+
+const char * MetadataCache::stored(uint8_t attrId) const
+{
+  int8_t i = indexOf(attrId);
+  return (i < 0) ? "" : _work.text[i];
+}
+
+uint8_t MetadataCache::clear(void)
+{
+  uint8_t mask = 0;
+  for(uint8_t i=0; i<METADATA_ATTR_COUNT; i++){
+    if(_work.text[i][0] != 0){
+      mask |= (uint8_t)(1 << i);
+      _work.text[i][0] = 0;
+    }
+  }
+  if(mask){
+    _published.write(_work);
+  }
+  return mask;
+}
+
+const char * MetadataCache::get(uint8_t attrId)
+{
+  int8_t i = indexOf(attrId);
+  if(i < 0){
+    return "";
+  }
+  _published.update();
+  return _published.front().text[i];
+}
@@ -0,0 +1,85 @@
+/*!
+ * @file  MetadataCache.h
+ * @brief  Define the cache of the metadata of the track playing on the remote Bluetooth device
+ * @details  The AVRC callback stores each attribute of a metadata response in a fixed-size buffer of a working copy and
+ * @n        publishes the copy through a TripleBuffer, so reading an attribute never waits for the Bluetooth task and
+ * @n        never allocates. Attributes are identified by their ESP_AVRC_MD_ATTR_* bit, e.g. ESP_AVRC_MD_ATTR_TITLE.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __METADATA_CACHE_H__
+#define __METADATA_CACHE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "TripleBuffer.h"
+
+#define METADATA_ATTR_COUNT   ((uint8_t)(7))   //!< The attributes kept: title, artist, album, track number, number of tracks, genre, playing time
+#define METADATA_ATTR_ALL   ((uint8_t)(0x7f))   //!< The mask of all attributes kept, as requested in one metadata command
+#define METADATA_TEXT_SIZE   ((size_t)(128))   //!< The buffer (bytes) of each attribute, longer texts are cut at a UTF-8 character boundary
+
+/**
+ * @struct sMetadata_t
+ * @brief The texts of all attributes, NUL-terminated, empty when not received
+ */
+typedef struct
+{
+  char text[METADATA_ATTR_COUNT][METADATA_TEXT_SIZE];   // By the bit number of the attribute
+}sMetadata_t;
+
+class MetadataCache
+{
+public:
+  /**
+   * @fn MetadataCache
+   * @brief Constructor, all attributes are empty
+   * @return None
+   */
+  MetadataCache(void);
+
+  /**
+   * @fn set
+   * @brief Store the text of an attribute and publish it, called by the Bluetooth task
+   * @param attrId - The ESP_AVRC_MD_ATTR_* bit of the attribute
+   * @param text - The text, not NUL-terminated
+   * @param len - The length of the text in bytes
+   * @return true when the stored text changed, false when it is the same or the attribute is unknown
+   */
+  bool set(uint8_t attrId, const uint8_t *text, size_t len);
+
+  /**
+   * @fn stored
+   * @brief Get the text of an attribute as the Bluetooth task stored it, only called by that task, e.g. for a callback
+   * @param attrId - The ESP_AVRC_MD_ATTR_* bit of the attribute
+   * @return The NUL-terminated text, "" when not received or unknown
+   */
+  const char * stored(uint8_t attrId) const;
+
+  /**
+   * @fn clear
+   * @brief Empty all attributes and publish them, called by the Bluetooth task, e.g. when the track changes
+   * @return The mask of the attributes which were not empty
+   */
+  uint8_t clear(void);
+
+  /**
+   * @fn get
+   * @brief Get the latest published text of an attribute, called by one reader task, e.g. loop()
+   * @param attrId - The ESP_AVRC_MD_ATTR_* bit of the attribute
+   * @return The NUL-terminated text, "" when not received or unknown, valid until the next get() of the reader
+   */
+  const char * get(uint8_t attrId);
+
+protected:
+  static int8_t indexOf(uint8_t attrId);
+
+  sMetadata_t _work;   // The working copy of the Bluetooth task
+  TripleBuffer<sMetadata_t> _published;
+};
+
+#endif
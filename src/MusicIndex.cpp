@@ -0,0 +1,404 @@
+/*!
+ * @file  MusicIndex.cpp
+ * @brief  Define the persistent index of the WAV files on the SD card
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "MusicIndex.h"
+
+#define MUSIC_INDEX_VERSION   ((uint16_t)(1))
+
+/**
+ * @struct sIndexHeader_t
+ * @brief The header of the index file, the record sizes reject an index written by a different build
+ */
+typedef struct
+{
+  char magic[4];   // "MIDX"
+  uint16_t version;
+  uint16_t trackSize;
+  uint16_t dirSize;
+  uint16_t reserved;
+  uint32_t trackCount;
+  uint32_t dirCount;
+}sIndexHeader_t;
+
+static uint32_t fnv1a(uint32_t hash, const char *str)
+{
+  while(*str){
+    hash = (hash ^ (uint8_t)*str++) * 16777619u;
+  }
+  return hash;
+}
+
+static inline uint32_t pathHash(const char *path)
+{
+  return fnv1a(2166136261u, path);
+}
+
+static bool isWavName(const char *name)
+{
+  size_t len = strlen(name);
+  return (len > 4) && !strcasecmp(name + len - 4, ".wav");
+}
+
+MusicIndex::MusicIndex(void)
+  : _fp(NULL), _trackCount(0), _dirCount(0), _pageFirst(0), _pageCount(0), _rootLen(0),
+    _out(NULL), _dirs(NULL), _outTracks(0), _outDirs(0), _oldDirs(NULL), _oldDirCount(0), _oldTrackCount(0), _scannedDirs(0), _parsedFiles(0)
+{
+  _root[0] = 0;
+  _indexFile[0] = 0;
+}
+
+MusicIndex::~MusicIndex()
+{
+  end();
+}
+
+bool MusicIndex::begin(const char *root, const char *indexFile)
+{
+  end();
+  if((strlen(root) >= sizeof(_root)) || (strlen(indexFile) + 4 >= sizeof(_indexFile))){   // Room for the suffix of the temporary files
+    return false;
+  }
+  strcpy(_root, root);
+  strcpy(_indexFile, indexFile);
+  return openIndex();
+}
+
+void MusicIndex::end(void)
+{
+  if(_fp != NULL){
+    fclose(_fp);
+    _fp = NULL;
+  }
+  _trackCount = 0;
+  _dirCount = 0;
+  _pageCount = 0;
+}
+
+bool MusicIndex::openIndex(void)
+{
+  _trackCount = 0;
+  _dirCount = 0;
+  _pageCount = 0;
+  _fp = fopen(_indexFile, "rb");
+  if(_fp == NULL){
+    return false;
+  }
+
+  sIndexHeader_t header;
+  if((fread(&header, sizeof(header), 1, _fp) != 1) || memcmp(header.magic, "MIDX", 4) ||
+     (header.version != MUSIC_INDEX_VERSION) || (header.trackSize != sizeof(sMusicTrack_t)) ||
+     (header.dirSize != sizeof(sDirRecord_t))){
+    fclose(_fp);
+    _fp = NULL;
+    return false;
+  }
+  _trackCount = header.trackCount;
+  _dirCount = header.dirCount;
+  return true;
+}
+
+bool MusicIndex::readTrack(FILE *fp, uint32_t index, sMusicTrack_t *track)
+{
+  return !fseek(fp, (long)(sizeof(sIndexHeader_t) + index * sizeof(sMusicTrack_t)), SEEK_SET) &&
+         (fread(track, sizeof(sMusicTrack_t), 1, fp) == 1);
+}
+
+bool MusicIndex::getTrack(uint32_t index, sMusicTrack_t *track)
+{
+  if((_fp == NULL) || (index >= _trackCount)){
+    return false;
+  }
+  if((index < _pageFirst) || (index >= _pageFirst + _pageCount)){   // Page in the records from this track on
+    if(fseek(_fp, (long)(sizeof(sIndexHeader_t) + index * sizeof(sMusicTrack_t)), SEEK_SET)){
+      return false;
+    }
+    uint32_t n = _trackCount - index;
+    if(n > MUSIC_INDEX_PAGE_TRACKS){
+      n = MUSIC_INDEX_PAGE_TRACKS;
+    }
+    _pageFirst = index;
+    _pageCount = (uint8_t)fread(_page, sizeof(sMusicTrack_t), n, _fp);
+    if(_pageCount == 0){
+      return false;
+    }
+  }
+  memcpy(track, &_page[index - _pageFirst], sizeof(sMusicTrack_t));
+  return true;
+}
+
+bool MusicIndex::update(bool full)
+{
+  char tmpFile[MUSIC_INDEX_ROOT_LEN + 4], dirFile[MUSIC_INDEX_ROOT_LEN + 4];
+  strcpy(tmpFile, _indexFile);
+  strcat(tmpFile, ".tmp");
+  strcpy(dirFile, _indexFile);
+  strcat(dirFile, ".dir");
+
+  // The previous index is only read from now on, its directories are kept in memory
+  FILE *old = _fp;
+  _fp = NULL;
+  _oldDirs = NULL;
+  _oldDirCount = 0;
+  if((old != NULL) && (full || !loadOldDirs(old, _trackCount, _dirCount))){
+    fclose(old);
+    old = NULL;
+  }
+
+  _scannedDirs = 0;
+  _parsedFiles = 0;
+  _outTracks = 0;
+  _outDirs = 0;
+  _out = fopen(tmpFile, "wb");
+  _dirs = fopen(dirFile, "w+b");
+  bool ret = (_out != NULL) && (_dirs != NULL);
+
+  sIndexHeader_t header;
+  memset(&header, 0, sizeof(header));
+  if(ret){
+    ret = (fwrite(&header, sizeof(header), 1, _out) == 1);   // Written again with the counts at the end
+  }
+  if(ret){
+    _rootLen = strlen(_root);
+    strcpy(_full, _root);
+    ret = scanDir(old, _rootLen);
+  }
+  if(ret){   // Append the directory records
+    sDirRecord_t dir;
+    rewind(_dirs);
+    for(uint32_t i = 0; ret && (i < _outDirs); i++){
+      ret = (fread(&dir, sizeof(dir), 1, _dirs) == 1) && (fwrite(&dir, sizeof(dir), 1, _out) == 1);
+    }
+  }
+  if(ret){
+    memcpy(header.magic, "MIDX", 4);
+    header.version = MUSIC_INDEX_VERSION;
+    header.trackSize = sizeof(sMusicTrack_t);
+    header.dirSize = sizeof(sDirRecord_t);
+    header.trackCount = _outTracks;
+    header.dirCount = _outDirs;
+    ret = !fseek(_out, 0, SEEK_SET) && (fwrite(&header, sizeof(header), 1, _out) == 1);
+  }
+
+  if(_out != NULL){
+    ret = !fclose(_out) && ret;
+    _out = NULL;
+  }
+  if(_dirs != NULL){
+    fclose(_dirs);
+    _dirs = NULL;
+  }
+  remove(dirFile);
+  if(old != NULL){
+    fclose(old);
+  }
+  free(_oldDirs);
+  _oldDirs = NULL;
+  _oldDirCount = 0;
+
+  if(ret){   // Replace the previous index, FAT does not rename over an existing file
+    remove(_indexFile);
+    ret = !rename(tmpFile, _indexFile);
+  }else{
+    remove(tmpFile);
+  }
+  openIndex();
+  return ret;
+}
+
+bool MusicIndex::loadOldDirs(FILE *old, uint32_t oldTracks, uint32_t oldDirs)
+{
+  if(oldDirs == 0){
+    return false;
+  }
+  _oldDirs = (sOldDir_t *)malloc(oldDirs * sizeof(sOldDir_t));
+  if((_oldDirs == NULL) ||
+     fseek(old, (long)(sizeof(sIndexHeader_t) + oldTracks * sizeof(sMusicTrack_t)), SEEK_SET)){
+    return false;
+  }
+  sDirRecord_t dir;
+  for(uint32_t i = 0; i < oldDirs; i++){
+    if(fread(&dir, sizeof(dir), 1, old) != 1){
+      return false;
+    }
+    dir.path[MUSIC_INDEX_PATH_LEN - 1] = 0;
+    _oldDirs[i].pathHash = pathHash(dir.path);
+    _oldDirs[i].hash = dir.hash;
+    _oldDirs[i].mtime = dir.mtime;
+    _oldDirs[i].firstTrack = dir.firstTrack;
+    _oldDirs[i].trackCount = dir.trackCount;
+    _oldDirs[i].record = i;
+  }
+  _oldDirCount = oldDirs;
+  _oldTrackCount = oldTracks;
+  return true;
+}
+
+bool MusicIndex::copyTracks(FILE *old, uint32_t first, uint32_t count)
+{
+  for(uint32_t i = 0; i < count; i++){
+    if(!readTrack(old, first + i, &_track) || (fwrite(&_track, sizeof(_track), 1, _out) != 1)){
+      return false;
+    }
+    _outTracks++;
+  }
+  return true;
+}
+
+bool MusicIndex::scanDir(FILE *old, size_t len)
+{
+  DIR *dir = opendir(_full);
+  if(dir == NULL){   // Unreadable directories are left out
+    return true;
+  }
+
+  // The signature covers the names and types of the entries, adding, removing or renaming any of them changes it
+  const char *rel = _full + _rootLen;
+  uint32_t hash = 2166136261u;
+  struct dirent *entry;
+  while((entry = readdir(dir)) != NULL){
+    if(entry->d_name[0] == '.'){   // Hidden entries, including the index itself
+      continue;
+    }
+    hash = fnv1a(hash, entry->d_name);
+    hash = (hash ^ (entry->d_type == DT_DIR)) * 16777619u;
+  }
+  struct stat st;
+  uint32_t mtime = (stat(_full, &st) == 0) ? (uint32_t)st.st_mtime : 0;
+
+  const sOldDir_t *oldDir = NULL;
+  uint32_t relHash = pathHash(rel);
+  sDirRecord_t record;
+  for(uint32_t i = 0; (old != NULL) && (i < _oldDirCount); i++){
+    if((_oldDirs[i].pathHash == relHash) &&   // Confirmed with the path of its record
+       !fseek(old, (long)(sizeof(sIndexHeader_t) + _oldTrackCount * sizeof(sMusicTrack_t) + _oldDirs[i].record * sizeof(sDirRecord_t)), SEEK_SET) &&
+       (fread(&record, sizeof(record), 1, old) == 1) && !strncmp(record.path, rel, MUSIC_INDEX_PATH_LEN)){
+      oldDir = &_oldDirs[i];
+      break;
+    }
+  }
+
+  memset(&record, 0, sizeof(record));
+  strcpy(record.path, rel);
+  record.hash = hash;
+  record.mtime = mtime;
+  record.firstTrack = _outTracks;
+  if((oldDir != NULL) && (oldDir->hash == hash) && (oldDir->mtime == mtime)){   // Unchanged, copy the previous records
+    if(!copyTracks(old, oldDir->firstTrack, oldDir->trackCount)){
+      closedir(dir);
+      return false;
+    }
+  }else{
+    _scannedDirs++;
+    rewinddir(dir);
+    scanFiles(old, dir, len, oldDir);
+  }
+  record.trackCount = _outTracks - record.firstTrack;
+  if(fwrite(&record, sizeof(record), 1, _dirs) != 1){
+    closedir(dir);
+    return false;
+  }
+  _outDirs++;
+
+  // The subdirectories after the files, so the tracks of each directory are contiguous
+  bool ret = true;
+  rewinddir(dir);
+  while(ret && ((entry = readdir(dir)) != NULL)){
+    if((entry->d_name[0] == '.') || (entry->d_type != DT_DIR)){
+      continue;
+    }
+    size_t nameLen = strlen(entry->d_name);
+    if(len - _rootLen + 1 + nameLen >= MUSIC_INDEX_PATH_LEN){   // Too deep
+      continue;
+    }
+    _full[len] = '/';
+    strcpy(_full + len + 1, entry->d_name);
+    ret = scanDir(old, len + 1 + nameLen);
+    _full[len] = 0;
+  }
+  closedir(dir);
+  return ret;
+}
+
+void MusicIndex::scanFiles(FILE *old, void *handle, size_t len, const sOldDir_t *oldDir)
+{
+  DIR *dir = (DIR *)handle;
+
+  // The size and modification time of the previous tracks, so unchanged files are not parsed again
+  sOldTrack_t *oldTracks = NULL;
+  uint32_t oldCount = 0;
+  if((oldDir != NULL) && (oldDir->trackCount > 0)){
+    oldTracks = (sOldTrack_t *)malloc(oldDir->trackCount * sizeof(sOldTrack_t));
+    for(uint32_t i = 0; (oldTracks != NULL) && (i < oldDir->trackCount); i++){
+      if(!readTrack(old, oldDir->firstTrack + i, &_track)){
+        break;
+      }
+      _track.path[MUSIC_INDEX_PATH_LEN - 1] = 0;
+      oldTracks[i].pathHash = pathHash(_track.path);
+      oldTracks[i].size = _track.size;
+      oldTracks[i].mtime = _track.mtime;
+      oldCount = i + 1;
+    }
+  }
+
+  struct dirent *entry;
+  while((entry = readdir(dir)) != NULL){
+    if((entry->d_name[0] == '.') || (entry->d_type == DT_DIR) || !isWavName(entry->d_name)){
+      continue;
+    }
+    size_t nameLen = strlen(entry->d_name);
+    if(len - _rootLen + 1 + nameLen >= MUSIC_INDEX_PATH_LEN){   // Path too long
+      continue;
+    }
+    _full[len] = '/';
+    strcpy(_full + len + 1, entry->d_name);
+
+    struct stat st;
+    if(stat(_full, &st) == 0){
+      const char *rel = _full + _rootLen;
+      uint32_t relHash = pathHash(rel);
+      bool found = false;
+      for(uint32_t i = 0; i < oldCount; i++){
+        if((oldTracks[i].pathHash == relHash) && (oldTracks[i].size == (uint32_t)st.st_size) &&
+           (oldTracks[i].mtime == (uint32_t)st.st_mtime) && readTrack(old, oldDir->firstTrack + i, &_track) &&
+           !strcmp(_track.path, rel)){
+          found = true;
+          break;
+        }
+      }
+      if(!found){   // New or changed, parse its header
+        FILE *fp = fopen(_full, "rb");
+        if(fp != NULL){
+          WavParser parser;
+          _parsedFiles++;
+          if(parser.parseFile(fp)){
+            memset(&_track, 0, sizeof(_track));
+            strcpy(_track.path, rel);
+            _track.size = (uint32_t)st.st_size;
+            _track.mtime = (uint32_t)st.st_mtime;
+            _track.format = parser.getFormat();
+            found = true;
+          }
+          fclose(fp);
+        }
+      }
+      if(found && (fwrite(&_track, sizeof(_track), 1, _out) == 1)){
+        _outTracks++;
+      }
+    }
+    _full[len] = 0;
+  }
+  free(oldTracks);
+}
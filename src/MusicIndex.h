@@ -0,0 +1,176 @@
+/*!
+ * @file  MusicIndex.h
+ * @brief  Define the persistent index of the WAV files on the SD card
+ * @details  The index file holds one fixed-size record per track (path, size, modification time and the parsed format),
+ * @n        followed by one record per directory with a signature of its entries. An update walks the directories
+ * @n        again, but only re-examines the ones whose signature changed; the records of the others are copied over.
+ * @n        Records are paged in on demand, so there is no track limit and the index is not kept in memory.
+ * @n        Only the POSIX file and directory functions are used, the same code runs against a directory tree on a host.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __MUSIC_INDEX_H__
+#define __MUSIC_INDEX_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "WavParser.h"
+
+#define MUSIC_INDEX_PATH_LEN   ((size_t)(128))   //!< The longest path (with '\0') of a track or directory relative to the root, longer ones are skipped
+#define MUSIC_INDEX_ROOT_LEN   ((size_t)(32))   //!< The longest root and index file path (with '\0')
+#define MUSIC_INDEX_PAGE_TRACKS   ((uint8_t)(4))   //!< The number of track records read from the index at a time
+
+/**
+ * @struct sMusicTrack_t
+ * @brief A track of the index, also its record in the index file
+ */
+typedef struct
+{
+  char path[MUSIC_INDEX_PATH_LEN];   // Relative to the root, e.g. "/musicDir/music.wav"
+  uint32_t size;   // File size in bytes
+  uint32_t mtime;   // Modification time of the file
+  sWavFormat_t format;   // The format parsed from the WAV header, including the position of the samples
+}sMusicTrack_t;
+
+class MusicIndex
+{
+public:
+  /**
+   * @fn MusicIndex
+   * @brief Constructor
+   * @return None
+   */
+  MusicIndex(void);
+  ~MusicIndex();
+
+  /**
+   * @fn begin
+   * @brief Open the index of a directory tree, an existing index file is used as it is
+   * @param root - The root of the tree, e.g. "/sd"
+   * @param indexFile - The index file, e.g. "/sd/.musicindex"
+   * @return true when an existing index was opened, false when there is none yet (call update())
+   */
+  bool begin(const char *root, const char *indexFile);
+
+  /**
+   * @fn end
+   * @brief Close the index file
+   * @return None
+   */
+  void end(void);
+
+  /**
+   * @fn update
+   * @brief Walk the tree and rewrite the index, the directories whose entries did not change are not re-examined
+   * @param full - true: re-examine every directory and parse every header again, e.g. after files were replaced under the same name
+   * @return true on success, false when the index could not be written
+   */
+  bool update(bool full=false);
+
+  /**
+   * @fn count
+   * @brief Get the number of tracks in the index
+   * @return The number of tracks
+   */
+  uint32_t count(void) const { return _trackCount; }
+
+  /**
+   * @fn getTrack
+   * @brief Get a track, its record is read from the index file when it is not in the current page
+   * @param index - The track number, range: 0 to count()-1
+   * @param track - The track
+   * @return true on success, false when the number is out of range or the index could not be read
+   */
+  bool getTrack(uint32_t index, sMusicTrack_t *track);
+
+  /**
+   * @fn getScannedDirs
+   * @brief Get the number of directories re-examined by the last update()
+   * @return The number of directories
+   */
+  uint32_t getScannedDirs(void) const { return _scannedDirs; }
+
+  /**
+   * @fn getParsedFiles
+   * @brief Get the number of WAV headers parsed by the last update()
+   * @return The number of files
+   */
+  uint32_t getParsedFiles(void) const { return _parsedFiles; }
+
+protected:
+  /**
+   * @struct sDirRecord_t
+   * @brief A directory in the index file
+   */
+  typedef struct
+  {
+    char path[MUSIC_INDEX_PATH_LEN];   // Relative to the root, "" for the root
+    uint32_t hash;   // Signature of the names and types of the entries
+    uint32_t mtime;   // Modification time of the directory
+    uint32_t firstTrack;   // The first of its own tracks, the tracks of its subdirectories are not included
+    uint32_t trackCount;
+  }sDirRecord_t;
+
+  /**
+   * @struct sOldDir_t
+   * @brief A directory of the previous index, kept in memory during update()
+   */
+  typedef struct
+  {
+    uint32_t pathHash;
+    uint32_t hash;
+    uint32_t mtime;
+    uint32_t firstTrack;
+    uint32_t trackCount;
+    uint32_t record;   // Number of its record
+  }sOldDir_t;
+
+  /**
+   * @struct sOldTrack_t
+   * @brief A track of a changed directory in the previous index, kept in memory while the directory is re-examined
+   */
+  typedef struct
+  {
+    uint32_t pathHash;
+    uint32_t size;
+    uint32_t mtime;
+  }sOldTrack_t;
+
+  bool openIndex(void);
+  bool loadOldDirs(FILE *old, uint32_t oldTracks, uint32_t oldDirs);
+  bool scanDir(FILE *old, size_t len);
+  void scanFiles(FILE *old, void *dir, size_t len, const sOldDir_t *oldDir);
+  bool copyTracks(FILE *old, uint32_t first, uint32_t count);
+  bool readTrack(FILE *fp, uint32_t index, sMusicTrack_t *track);
+
+  char _root[MUSIC_INDEX_ROOT_LEN];
+  char _indexFile[MUSIC_INDEX_ROOT_LEN];
+  FILE *_fp;   // The index file, open for reading the pages
+  uint32_t _trackCount;
+  uint32_t _dirCount;
+  uint32_t _pageFirst;   // The first track of the page in memory
+  uint8_t _pageCount;   // The number of tracks of the page in memory
+  sMusicTrack_t _page[MUSIC_INDEX_PAGE_TRACKS];
+
+  // State of update()
+  char _full[MUSIC_INDEX_ROOT_LEN + MUSIC_INDEX_PATH_LEN];   // Full path of the current entry
+  size_t _rootLen;
+  FILE *_out;   // The new index
+  FILE *_dirs;   // The directory records of the new index, appended to it at the end
+  uint32_t _outTracks;   // Tracks written to the new index
+  uint32_t _outDirs;   // Directories written to the new index
+  sOldDir_t *_oldDirs;
+  uint32_t _oldDirCount;
+  uint32_t _oldTrackCount;
+  uint32_t _scannedDirs;
+  uint32_t _parsedFiles;
+  sMusicTrack_t _track;   // The record being written
+};
+
+#endif
@@ -0,0 +1,187 @@
+/*!
+ * @file  PCMConverter.cpp
+ * @brief  Define the block conversion kernels from the PCM layouts of WAV files to interleaved stereo pcm_t
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <string.h>
+#include <math.h>
+
+#include "PCMConverter.h"
+
+// The samples are assembled from bytes, the source has no alignment and the result does not depend on the host byte order
+static inline uint32_t read32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#ifdef PCM_WIDE_SAMPLES
+// Left-justified, the bits below those of the source are zero
+static inline pcm_t read8(const uint8_t *p)
+{
+  return (pcm_t)(((int32_t)p[0] - 128) * 16777216);
+}
+
+static inline pcm_t read16(const uint8_t *p)
+{
+  return (pcm_t)(((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 24));
+}
+
+static inline pcm_t read24(const uint8_t *p)
+{
+  return (pcm_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24));
+}
+
+static inline pcm_t readInt32(const uint8_t *p)
+{
+  return (pcm_t)read32(p);
+}
+
+static inline pcm_t readFloat(const uint8_t *p)
+{
+  union { uint32_t u; float f; } v;
+  v.u = read32(p);
+  float x = v.f * 2147483648.0f;
+  if(!(x < 2147483648.0f)){   // Written so that NaN saturates as well
+    return PCM_SAMPLE_MAX;
+  }
+  return (x > -2147483648.0f) ? (pcm_t)lrintf(x) : PCM_SAMPLE_MIN;
+}
+#else
+// The low-memory mode, the bytes below the top 16 bits are dropped
+static inline pcm_t read8(const uint8_t *p)
+{
+  return (pcm_t)((p[0] - 128) * 256);
+}
+
+static inline pcm_t read16(const uint8_t *p)
+{
+  return (pcm_t)(p[0] | (p[1] << 8));
+}
+
+static inline pcm_t read24(const uint8_t *p)
+{
+  return read16(p + 1);
+}
+
+static inline pcm_t readInt32(const uint8_t *p)
+{
+  return read16(p + 2);
+}
+
+static inline pcm_t readFloat(const uint8_t *p)
+{
+  union { uint32_t u; float f; } v;
+  v.u = read32(p);
+  float x = v.f * 32768.0f;
+  x = (x < 32767.0f) ? x : 32767.0f;   // Written so that NaN saturates as well
+  x = (x > -32768.0f) ? x : -32768.0f;
+  return (pcm_t)lrintf(x);
+}
+#endif
+
+pcmConvert_t PCMConverter::select(const sWavFormat_t &format)
+{
+  bool mono = (format.numChannels == 1);
+  if(format.formatTag == WAV_FORMAT_IEEE_FLOAT){
+    return mono ? monoFloat : stereoFloat;
+  }
+  switch(format.bitsPerSample){
+    case 8:
+      return mono ? mono8 : stereo8;
+    case 24:
+      return mono ? mono24 : stereo24;
+    case 32:
+      return mono ? mono32 : stereo32;
+    default:
+#ifdef PCM_WIDE_SAMPLES
+      return mono ? mono16 : stereo16;   // Widened as well
+#else
+      return mono ? mono16 : NULL;
+#endif
+  }
+}
+
+void PCMConverter::mono8(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames; i++){
+    pcm_t x = read8(in + i);
+    out[2 * i] = x;
+    out[2 * i + 1] = x;
+  }
+}
+
+void PCMConverter::stereo8(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames * 2; i++){
+    out[i] = read8(in + i);
+  }
+}
+
+void PCMConverter::mono16(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames; i++){
+    pcm_t x = read16(in + 2 * i);
+    out[2 * i] = x;
+    out[2 * i + 1] = x;
+  }
+}
+
+void PCMConverter::stereo16(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames * 2; i++){
+    out[i] = read16(in + 2 * i);
+  }
+}
+
+void PCMConverter::mono24(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames; i++){
+    pcm_t x = read24(in + 3 * i);
+    out[2 * i] = x;
+    out[2 * i + 1] = x;
+  }
+}
+
+void PCMConverter::stereo24(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames * 2; i++){
+    out[i] = read24(in + 3 * i);
+  }
+}
+
+void PCMConverter::mono32(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames; i++){
+    pcm_t x = readInt32(in + 4 * i);
+    out[2 * i] = x;
+    out[2 * i + 1] = x;
+  }
+}
+
+void PCMConverter::stereo32(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames * 2; i++){
+    out[i] = readInt32(in + 4 * i);
+  }
+}
+
+void PCMConverter::monoFloat(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames; i++){
+    pcm_t x = readFloat(in + 4 * i);
+    out[2 * i] = x;
+    out[2 * i + 1] = x;
+  }
+}
+
+void PCMConverter::stereoFloat(const uint8_t *in, pcm_t *out, size_t frames)
+{
+  for(size_t i = 0; i < frames * 2; i++){
+    out[i] = readFloat(in + 4 * i);
+  }
+}
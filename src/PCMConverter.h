@@ -0,0 +1,79 @@
+/*!
+ * @file  PCMConverter.h
+ * @brief  Define the block conversion kernels from the PCM layouts of WAV files to interleaved stereo pcm_t
+ * @details  One kernel per layout (channels, sample width, integer or float). The kernel is selected once per track
+ * @n        from the parsed header, so the per-sample loops carry no format branches. In the low-memory mode the samples
+ * @n        are cut to 16 bits here, with PCM_WIDE_SAMPLES they are left-justified in 32 bits and keep all of their bits.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __PCM_CONVERTER_H__
+#define __PCM_CONVERTER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "WavParser.h"
+#include "PCMSample.h"
+
+/**
+ * @brief A conversion kernel
+ * @param in - Frames in the source layout, little-endian, no alignment required
+ * @param out - Buffer for the interleaved stereo pcm_t frames
+ * @param frames - The number of frames
+ */
+typedef void (*pcmConvert_t)(const uint8_t *in, pcm_t *out, size_t frames);
+
+class PCMConverter
+{
+public:
+  /**
+   * @fn select
+   * @brief Select the kernel of a layout
+   * @param format - The format parsed from the WAV header
+   * @return The kernel, NULL when the data is interleaved stereo pcm_t already and can be used as it is, 16-bit stereo
+   * @n in the low-memory mode
+   */
+  static pcmConvert_t select(const sWavFormat_t &format);
+
+  /**
+   * @fn mono8 / stereo8
+   * @brief Unsigned 8-bit to signed, a mono sample is copied to both channels
+   */
+  static void mono8(const uint8_t *in, pcm_t *out, size_t frames);
+  static void stereo8(const uint8_t *in, pcm_t *out, size_t frames);
+
+  /**
+   * @fn mono16 / stereo16
+   * @brief 16-bit, a mono sample is copied to both channels
+   */
+  static void mono16(const uint8_t *in, pcm_t *out, size_t frames);
+  static void stereo16(const uint8_t *in, pcm_t *out, size_t frames);
+
+  /**
+   * @fn mono24 / stereo24
+   * @brief 24-bit, the lowest byte is dropped in the low-memory mode
+   */
+  static void mono24(const uint8_t *in, pcm_t *out, size_t frames);
+  static void stereo24(const uint8_t *in, pcm_t *out, size_t frames);
+
+  /**
+   * @fn mono32 / stereo32
+   * @brief 32-bit integer, the lowest two bytes are dropped in the low-memory mode
+   */
+  static void mono32(const uint8_t *in, pcm_t *out, size_t frames);
+  static void stereo32(const uint8_t *in, pcm_t *out, size_t frames);
+
+  /**
+   * @fn monoFloat / stereoFloat
+   * @brief 32-bit float in -1.0 to 1.0, rounded and saturated
+   */
+  static void monoFloat(const uint8_t *in, pcm_t *out, size_t frames);
+  static void stereoFloat(const uint8_t *in, pcm_t *out, size_t frames);
+};
+
+#endif
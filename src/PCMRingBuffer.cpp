@@ -0,0 +1,147 @@
+/*!
+ * @file  PCMRingBuffer.cpp
+ * @brief  Define the lock-free single-producer/single-consumer ring buffer of PCM audio data
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "PCMRingBuffer.h"
+
+PCMRingBuffer::PCMRingBuffer(void)
+  : _data(NULL), _size(0), _mask(0), _head(0), _tail(0), _highWater(0), _underruns(0), _overruns(0)
+{
+}
+
+PCMRingBuffer::~PCMRingBuffer()
+{
+  end();
+}
+
+bool PCMRingBuffer::begin(size_t size)
+{
+  size_t depth = 4;
+  while(depth < size){
+    depth <<= 1;
+  }
+
+  end();
+  _data = (uint8_t *)malloc(depth);
+  if(_data == NULL){
+    return false;
+  }
+  _size = depth;
+  _mask = depth - 1;
+  _head.store(0, std::memory_order_relaxed);
+  _tail.store(0, std::memory_order_relaxed);
+  resetCounters();
+  return true;
+}
+
+void PCMRingBuffer::end(void)
+{
+  free(_data);
+  _data = NULL;
+  _size = 0;
+  _mask = 0;
+}
+
+bool PCMRingBuffer::write(const void *data, size_t len)
+{
+  uint32_t head = _head.load(std::memory_order_relaxed);
+  uint32_t tail = _tail.load(std::memory_order_acquire);
+  size_t used = (uint32_t)(head - tail);
+  if((_data == NULL) || (len > _size - used)){
+    _overruns.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  size_t offset = head & _mask;
+  size_t first = _size - offset;   // Bytes before wrapping around
+  if(first > len){
+    first = len;
+  }
+  memcpy(_data + offset, data, first);
+  memcpy(_data, (const uint8_t *)data + first, len - first);
+  _head.store(head + len, std::memory_order_release);
+
+  used += len;
+  if(used > _highWater.load(std::memory_order_relaxed)){
+    _highWater.store(used, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+size_t PCMRingBuffer::read(void *data, size_t len)
+{
+  uint32_t tail = _tail.load(std::memory_order_relaxed);
+  uint32_t head = _head.load(std::memory_order_acquire);
+  size_t used = (uint32_t)(head - tail);
+  if(used < len){
+    _underruns.fetch_add(1, std::memory_order_relaxed);
+    len = used;
+  }
+  if(len == 0){
+    return 0;
+  }
+
+  size_t offset = tail & _mask;
+  size_t first = _size - offset;
+  if(first > len){
+    first = len;
+  }
+  memcpy(data, _data + offset, first);
+  memcpy((uint8_t *)data + first, _data, len - first);
+  _tail.store(tail + len, std::memory_order_release);
+  return len;
+}
+
+size_t PCMRingBuffer::peek(size_t len, uint8_t **first, size_t *firstLen, uint8_t **second)
+{
+  uint32_t tail = _tail.load(std::memory_order_relaxed);
+  uint32_t head = _head.load(std::memory_order_acquire);
+  size_t used = (uint32_t)(head - tail);
+  if(used < len){
+    _underruns.fetch_add(1, std::memory_order_relaxed);
+    len = used;
+  }
+
+  size_t offset = tail & _mask;
+  size_t part = _size - offset;
+  *first = _data + offset;
+  *firstLen = (part > len) ? len : part;
+  *second = _data;
+  return len;
+}
+
+void PCMRingBuffer::skip(size_t len)
+{
+  _tail.store(_tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+}
+
+void PCMRingBuffer::clear(void)
+{
+  _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+size_t PCMRingBuffer::available(void) const
+{
+  return (uint32_t)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed));
+}
+
+size_t PCMRingBuffer::space(void) const
+{
+  return _size - (uint32_t)(_head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_acquire));
+}
+
+void PCMRingBuffer::resetCounters(void)
+{
+  _highWater.store(0, std::memory_order_relaxed);
+  _underruns.store(0, std::memory_order_relaxed);
+  _overruns.store(0, std::memory_order_relaxed);
+}
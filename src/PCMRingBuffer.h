@@ -0,0 +1,151 @@
+/*!
+ * @file  PCMRingBuffer.h
+ * @brief  Define the lock-free single-producer/single-consumer ring buffer of PCM audio data
+ * @details  One task writes audio data (e.g. the A2DP data callback) and another task reads it (e.g. the output task),
+ * @n        neither of them takes a lock or blocks in the buffer.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __PCM_RING_BUFFER_H__
+#define __PCM_RING_BUFFER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+class PCMRingBuffer
+{
+public:
+  /**
+   * @fn PCMRingBuffer
+   * @brief Constructor, the buffer has no storage until begin() is called
+   * @return None
+   */
+  PCMRingBuffer(void);
+  ~PCMRingBuffer();
+
+  /**
+   * @fn begin
+   * @brief Allocate the storage of the buffer, it must not be called while the buffer is in use
+   * @param size - Depth of the buffer in bytes, rounded up to a power of two
+   * @return true on success, false on error
+   */
+  bool begin(size_t size);
+
+  /**
+   * @fn end
+   * @brief Release the storage of the buffer, it must not be called while the buffer is in use
+   * @return None
+   */
+  void end(void);
+
+  /**
+   * @fn write
+   * @brief Copy data into the buffer, only called by the producer
+   * @param data - The data to be written
+   * @param len - Byte length of data
+   * @return true when all the data is copied, false when there is not enough space and nothing is copied (counted as an overrun)
+   */
+  bool write(const void *data, size_t len);
+
+  /**
+   * @fn read
+   * @brief Copy data out of the buffer, only called by the consumer
+   * @param data - The buffer receiving the data
+   * @param len - Byte length of the data wanted
+   * @return The number of bytes copied, less than len when the buffer runs dry (counted as an underrun)
+   */
+  size_t read(void *data, size_t len);
+
+  /**
+   * @fn peek
+   * @brief Get the data in place instead of copying it, only called by the consumer, skip() releases it
+   * @n     The data stays owned by the consumer until it is released, so it may be changed in place
+   * @param len - Byte length of the data wanted
+   * @param first - The data up to the end of the storage
+   * @param firstLen - Byte length of the data at first
+   * @param second - The rest of the data, wrapped around to the start of the storage
+   * @return The number of bytes in place, less than len when the buffer runs dry (counted as an underrun)
+   */
+  size_t peek(size_t len, uint8_t **first, size_t *firstLen, uint8_t **second);
+
+  /**
+   * @fn skip
+   * @brief Release data taken by peek(), only called by the consumer
+   * @param len - Byte length of the data, no more than peek() returned
+   * @return None
+   */
+  void skip(size_t len);
+
+  /**
+   * @fn clear
+   * @brief Discard all the data in the buffer, only called by the consumer
+   * @return None
+   */
+  void clear(void);
+
+  /**
+   * @fn available
+   * @brief Get the number of bytes which can be read
+   * @return Byte length of data in the buffer
+   */
+  size_t available(void) const;
+
+  /**
+   * @fn space
+   * @brief Get the number of bytes which can be written
+   * @return Byte length of free space in the buffer
+   */
+  size_t space(void) const;
+
+  /**
+   * @fn size
+   * @brief Get the depth of the buffer
+   * @return Depth of the buffer in bytes, 0 before begin()
+   */
+  size_t size(void) const { return _size; }
+
+  /**
+   * @fn getHighWater
+   * @brief Get the largest fill level the buffer has reached
+   * @return Byte length of the high-water mark
+   */
+  size_t getHighWater(void) const { return _highWater.load(std::memory_order_relaxed); }
+
+  /**
+   * @fn getUnderruns
+   * @brief Get the number of reads the buffer could not satisfy completely
+   * @return The number of underruns
+   */
+  uint32_t getUnderruns(void) const { return _underruns.load(std::memory_order_relaxed); }
+
+  /**
+   * @fn getOverruns
+   * @brief Get the number of writes dropped because the buffer was full
+   * @return The number of overruns
+   */
+  uint32_t getOverruns(void) const { return _overruns.load(std::memory_order_relaxed); }
+
+  /**
+   * @fn resetCounters
+   * @brief Reset the high-water mark, underrun and overrun counters
+   * @return None
+   */
+  void resetCounters(void);
+
+protected:
+  uint8_t *_data;
+  size_t _size;   // Power of two
+  size_t _mask;
+  std::atomic<uint32_t> _head;   // Total bytes written, only changed by the producer
+  std::atomic<uint32_t> _tail;   // Total bytes read, only changed by the consumer
+  std::atomic<uint32_t> _highWater;
+  std::atomic<uint32_t> _underruns;
+  std::atomic<uint32_t> _overruns;
+};
+
+#endif
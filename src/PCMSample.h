@@ -0,0 +1,36 @@
+/*!
+ * @file  PCMSample.h
+ * @brief  Define the samples handed from the audio sources through the PCM buffer and the sample-rate converter to the output
+ * @details  By default a sample is an int16_t, the low-memory mode: wider sources are cut to 16 bits as they are converted,
+ * @n        and a frame takes 4 bytes of the PCM buffer. With PCM_WIDE_SAMPLES a sample is an int32_t with the value
+ * @n        left-justified (Q31), 24-bit and 32-bit sources keep their low bits through the converter, the PCM buffer and
+ * @n        the sample-rate converter, and only the requantizer of the output narrows them. A frame then takes 8 bytes,
+ * @n        and the PCM buffer is twice as deep for the same time.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __PCM_SAMPLE_H__
+#define __PCM_SAMPLE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+// #define PCM_WIDE_SAMPLES   //!< Open this macro to carry the samples as left-justified int32_t from the source to the requantizer, instead of int16_t
+#ifdef PCM_WIDE_SAMPLES
+  typedef int32_t pcm_t;   //!< A sample of the PCM buffer, full scale is that of the type
+  #define PCM_FRACTION_BITS   ((int)(16))   //!< The bits of a sample below the LSB of 16-bit audio
+  #define PCM_SAMPLE_MAX   ((int32_t)(INT32_MAX))   //!< The largest sample
+  #define PCM_SAMPLE_MIN   ((int32_t)(INT32_MIN))   //!< The smallest sample
+#else
+  typedef int16_t pcm_t;
+  #define PCM_FRACTION_BITS   ((int)(0))
+  #define PCM_SAMPLE_MAX   ((int32_t)(32767))
+  #define PCM_SAMPLE_MIN   ((int32_t)(-32768))
+#endif
+#define PCM_FRAME_BYTES   ((size_t)(2 * sizeof(pcm_t)))   //!< The bytes of an interleaved stereo frame of the PCM buffer
+
+#endif
@@ -0,0 +1,61 @@
+/*!
+ * @file  PeakLimiter.cpp
+ * @brief  Define the look-ahead peak limiter in front of the output
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <math.h>
+#include <string.h>
+
+#include "PeakLimiter.h"
+
+PeakLimiter::PeakLimiter(uint32_t sampleRate)
+  : _sampleRate(sampleRate)
+{
+  set(LIMITER_CEILING_DB, LIMITER_ATTACK_MS, LIMITER_RELEASE_MS);
+  _attack = 0;   // The average is set up by begin()
+  _gain = LIMITER_UNITY_Q30;
+  begin();
+  reset();
+}
+
+/**
+ * The share of the distance to the target covered per frame by a one-pole smoother with the time constant, in Q24
+ */
+static int32_t timeCoefficient(float ms, uint32_t sampleRate)
+{
+  float coef = 1.0f - expf(-1000.0f / (ms * sampleRate));
+  int32_t q24 = (int32_t)(coef * (1 << 24) + 0.5f);
+  return (q24 < 1) ? 1 : q24;
+}
+
+void PeakLimiter::set(float ceilingDB, float attackMs, float releaseMs)
+{
+  ceilingDB = constrain(ceilingDB, -20.0, 0.0);
+  releaseMs = constrain(releaseMs, 1.0, 1000.0);
+  int32_t ceiling = (int32_t)(32767.0f * powf(10.0f, ceilingDB / 20.0f));
+  _ceilingSet.store(ceiling, std::memory_order_relaxed);
+  uint32_t attack = (uint32_t)(attackMs * _sampleRate / 1000.0f + 0.5f);
+  _attackSet.store(constrain(attack, (uint32_t)1, LIMITER_LOOKAHEAD_FRAMES), std::memory_order_relaxed);
+  _releaseSet.store(timeCoefficient(releaseMs, _sampleRate), std::memory_order_relaxed);
+}
+
+void PeakLimiter::reset(void)
+{
+  memset(_delay, 0, sizeof(_delay));
+  for(uint32_t i=0; i<LIMITER_LOOKAHEAD_FRAMES; i++){
+    _average[i] = LIMITER_UNITY_Q30;
+  }
+  _sum = (int64_t)LIMITER_UNITY_Q30 * _attack;
+  _gain = LIMITER_UNITY_Q30;
+  _hold = LIMITER_UNITY_Q30;
+  _smooth = LIMITER_UNITY_Q30;
+  _windowPeak = 0;
+  _frame = 0;
+  _head = 0;
+  _tail = 0;
+}
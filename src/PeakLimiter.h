@@ -0,0 +1,196 @@
+/*!
+ * @file  PeakLimiter.h
+ * @brief  Define the look-ahead peak limiter in front of the output
+ * @details  The samples are delayed by LIMITER_LOOKAHEAD_FRAMES. Each frame needs the gain ceiling / peak (or unity), and
+ * @n        the smallest gain needed by the frames in the delay line is held, kept by a monotonic queue of the largest
+ * @n        peaks: each frame is added and removed at most once, O(1) per frame on average. A rising held gain is slowed
+ * @n        down by the release time, and the result is averaged over the attack time, which is no longer than the delay:
+ * @n        every average includes the gain held for the frame leaving the delay line, so the gain is reached in time.
+ * @n        The stereo channels share one gain so the image does not move. Both channels are stored and scaled as int32_t
+ * @n        with DSP_FRACTION_BITS below the output LSB, the gains are in Q30.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __PEAK_LIMITER_H__
+#define __PEAK_LIMITER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "Biquad.h"
+
+#define LIMITER_LOOKAHEAD_FRAMES   ((uint32_t)(64))   //!< Delay of the limiter in stereo frames, a power of two, 1.45 ms at 44100 Hz
+#define LIMITER_CEILING_DB   ((float)(-0.3))   //!< The default ceiling in dBFS
+#define LIMITER_ATTACK_MS   ((float)(1.0))   //!< The default attack time in ms
+#define LIMITER_RELEASE_MS   ((float)(50.0))   //!< The default release time constant in ms
+
+#define LIMITER_UNITY_Q30   ((int32_t)(1 << 30))   //!< Unity gain of the limiter in Q30
+
+class PeakLimiter
+{
+public:
+  /**
+   * @fn PeakLimiter
+   * @brief Constructor, the limiter starts with the default settings and an empty delay line
+   * @param sampleRate - Sample rate of the audio data, to work out the time constants
+   * @return None
+   */
+  PeakLimiter(uint32_t sampleRate);
+
+  /**
+   * @fn set
+   * @brief Set the ceiling and time constants, called by the control task, the audio task picks them up at the next block
+   * @param ceilingDB - The largest output level in dBFS, range: -20.0 to 0.0
+   * @param attackMs - Attack time in ms, the length of the fall of the gain before a peak, range: one frame to LIMITER_LOOKAHEAD_FRAMES
+   * @param releaseMs - Release time constant in ms, range: 1.0-1000.0
+   * @return None
+   */
+  void set(float ceilingDB, float attackMs, float releaseMs);
+
+  /**
+   * @fn reset
+   * @brief Clear the delay line and return to unity gain, called by the audio task before the limiter runs again after a pause
+   * @return None
+   */
+  void reset(void);
+
+  /**
+   * @fn begin
+   * @brief Pick up the settings before a block, called by the audio task
+   * @return None
+   */
+  void begin(void)
+  {
+    _ceiling = _ceilingSet.load(std::memory_order_relaxed);
+    _release = _releaseSet.load(std::memory_order_relaxed);
+    uint32_t attack = _attackSet.load(std::memory_order_relaxed);
+    if(attack != _attack){   // Restart the average at the current gain
+      _attack = attack;
+      _attackInv = (1 << 24) / attack;
+      for(uint32_t i=0; i<LIMITER_LOOKAHEAD_FRAMES; i++){
+        _average[i] = _gain;
+      }
+      _sum = (int64_t)_gain * attack;
+    }
+  }
+
+  /**
+   * @fn tick
+   * @brief Take one stereo frame and return the frame LIMITER_LOOKAHEAD_FRAMES earlier, limited
+   * @param l - The left sample, overwritten by the delayed sample
+   * @param r - The right sample, overwritten by the delayed sample
+   * @return None
+   */
+  void tick(int32_t &l, int32_t &r);
+  void tick(float &l, float &r);
+
+  /**
+   * @fn process
+   * @brief Limit a block of interleaved stereo frames in place, begin() is called first
+   * @param data - The audio data, overwritten by the delayed and limited data
+   * @param frames - Number of stereo frames in the block
+   * @return None
+   */
+  template <typename sample_t>
+  void process(sample_t *data, size_t frames)
+  {
+    begin();
+    for(size_t i=0; i<frames; i++){
+      tick(data[2 * i], data[2 * i + 1]);
+    }
+  }
+
+  /**
+   * @fn getGain
+   * @brief Get the current gain, called by the audio task
+   * @return Gain in Q30
+   */
+  int32_t getGain(void) const { return _gain; }
+
+protected:
+  static const uint32_t _peakSize = 2 * LIMITER_LOOKAHEAD_FRAMES;   // Room for the LIMITER_LOOKAHEAD_FRAMES + 1 peaks of the window
+
+  uint32_t _sampleRate;
+  std::atomic<int32_t> _ceilingSet;   // Set by the control task
+  std::atomic<uint32_t> _attackSet;
+  std::atomic<int32_t> _releaseSet;
+
+  int32_t _ceiling;   // The largest output sample, in output LSBs
+  uint32_t _attack;   // Frames averaged, range: 1 to LIMITER_LOOKAHEAD_FRAMES
+  int32_t _attackInv;   // 1 / _attack in Q24
+  int32_t _release;   // Share of the distance to the held gain covered per frame in Q24 while the gain rises
+  int32_t _hold;   // The smallest gain needed in the delay line
+  int32_t _smooth;   // The held gain with the release
+  int64_t _sum;   // Sum of the last _attack smoothed gains
+  int32_t _gain;   // The gain of the frame leaving the delay line
+  uint32_t _windowPeak;   // The largest peak in the delay line, the held gain was worked out for it
+  uint32_t _frame;   // Frames taken, wraps
+  uint32_t _head;   // The oldest, and largest, peak of the queue, wraps
+  uint32_t _tail;   // One past the newest, and smallest, peak of the queue, wraps
+  uint32_t _peak[_peakSize];   // The queue of decreasing peaks
+  uint32_t _peakFrame[_peakSize];   // The frame of each peak
+  int32_t _average[LIMITER_LOOKAHEAD_FRAMES];   // The last smoothed gains, by frame
+  int32_t _delay[2 * LIMITER_LOOKAHEAD_FRAMES];
+};
+
+DSP_INLINE void PeakLimiter::tick(int32_t &l, int32_t &r)
+{
+  uint32_t al = (l < 0) ? -l : l;
+  uint32_t ar = (r < 0) ? -r : r;
+  uint32_t peak = (al > ar) ? al : ar;
+
+  // Smaller peaks in front of this one can never be the largest again
+  while((_tail != _head) && (_peak[(_tail - 1) % _peakSize] <= peak)){
+    _tail--;
+  }
+  _peak[_tail % _peakSize] = peak;
+  _peakFrame[_tail % _peakSize] = _frame;
+  _tail++;
+  if(_frame - _peakFrame[_head % _peakSize] > LIMITER_LOOKAHEAD_FRAMES){   // Left the delay line
+    _head++;
+  }
+
+  uint32_t windowPeak = _peak[_head % _peakSize];
+  if(windowPeak != _windowPeak){
+    _windowPeak = windowPeak;
+    // The peak is rounded up to whole LSBs for the division, so the gain errs on the low side
+    uint32_t lsbPeak = (windowPeak + (1 << DSP_FRACTION_BITS) - 1) >> DSP_FRACTION_BITS;
+    _hold = (windowPeak > ((uint32_t)_ceiling << DSP_FRACTION_BITS)) ? (int32_t)((((uint32_t)_ceiling << 15) / lsbPeak) << 15) : LIMITER_UNITY_Q30;
+  }
+  if(_hold < _smooth){
+    _smooth = _hold;
+  }else{
+    int32_t step = (int32_t)(((int64_t)(_hold - _smooth) * _release) >> 24);
+    _smooth = (step == 0) ? _hold : (_smooth + step);   // Settle exactly, so a unity gain leaves the samples untouched
+  }
+
+  int32_t *a = &_average[_frame % LIMITER_LOOKAHEAD_FRAMES];
+  _sum += _smooth - _average[(_frame - _attack) % LIMITER_LOOKAHEAD_FRAMES];
+  *a = _smooth;
+  _gain = (_sum == (int64_t)LIMITER_UNITY_Q30 * _attack) ? LIMITER_UNITY_Q30 : (int32_t)((_sum * _attackInv) >> 24);
+
+  int32_t *d = &_delay[2 * (_frame % LIMITER_LOOKAHEAD_FRAMES)];
+  int32_t dl = d[0];
+  int32_t dr = d[1];
+  d[0] = l;
+  d[1] = r;
+  l = (int32_t)(((int64_t)dl * _gain + (1 << 29)) >> 30);
+  r = (int32_t)(((int64_t)dr * _gain + (1 << 29)) >> 30);
+  _frame++;
+}
+
+DSP_INLINE void PeakLimiter::tick(float &l, float &r)
+{
+  int32_t il = (int32_t)(l * (float)(1 << DSP_FRACTION_BITS));
+  int32_t ir = (int32_t)(r * (float)(1 << DSP_FRACTION_BITS));
+  tick(il, ir);
+  l = (float)il * (1.0f / (1 << DSP_FRACTION_BITS));
+  r = (float)ir * (1.0f / (1 << DSP_FRACTION_BITS));
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*!
+ * @file  PipelineStats.cpp
+ * @brief  Define the runtime statistics of the audio pipeline
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "PipelineStats.h"
+
+StatsHistogram::StatsHistogram(uint8_t shift)
+  : _shift(shift)
+{
+  reset();
+}
+
+void StatsHistogram::snapshot(sStatsHistogram_t *hist) const
+{
+  for(uint8_t i = 0; i < STATS_HIST_BUCKETS; i++){
+    hist->bucket[i] = _bucket[i].load(std::memory_order_relaxed);
+  }
+  hist->count = _count.load(std::memory_order_relaxed);
+  hist->max = _max.load(std::memory_order_relaxed);
+  hist->shift = _shift;
+}
+
+void StatsHistogram::reset(void)
+{
+  for(uint8_t i = 0; i < STATS_HIST_BUCKETS; i++){
+    _bucket[i].store(0, std::memory_order_relaxed);
+  }
+  _count.store(0, std::memory_order_relaxed);
+  _max.store(0, std::memory_order_relaxed);
+}
+
+PipelineStats::PipelineStats(void)
+  : _callbackCycles(STATS_CYCLES_SHIFT), _outputCycles(STATS_CYCLES_SHIFT),
+    _sdReadCycles(STATS_SD_READ_SHIFT), _pcmDepth(STATS_DEPTH_SHIFT)
+{
+  reset();
+}
+
+void PipelineStats::snapshot(sPipelineStats_t *stats, uint32_t cpuHz, uint32_t sampleRate) const
+{
+  _callbackCycles.snapshot(&stats->callbackCycles);
+  _outputCycles.snapshot(&stats->outputCycles);
+  _sdReadCycles.snapshot(&stats->sdReadCycles);
+  _pcmDepth.snapshot(&stats->pcmDepth);
+  stats->outputFrames = _outputFrames.load(std::memory_order_relaxed);
+  stats->shortWrites = _shortWrites.load(std::memory_order_relaxed);
+  stats->droppedBytes = _droppedBytes.load(std::memory_order_relaxed);
+  stats->clippedBlocks = _clippedBlocks.load(std::memory_order_relaxed);
+  stats->peak = _peak.load(std::memory_order_relaxed);
+
+  uint64_t outputUnits = _outputUnits.load(std::memory_order_relaxed);
+  uint64_t filterUnits = _filterUnits.load(std::memory_order_relaxed);
+  uint64_t busyUnits = outputUnits + _callbackUnits.load(std::memory_order_relaxed);
+  stats->filterShare = outputUnits ? (uint16_t)(filterUnits * 1000 / outputUnits) : 0;
+
+  // The output frames were played in outputFrames / sampleRate seconds, that is this many cycles
+  uint64_t playUnits = (uint64_t)stats->outputFrames * cpuHz / sampleRate >> STATS_CYCLES_SHIFT;
+  uint64_t load = playUnits ? (busyUnits * 1000 / playUnits) : 0;
+  stats->cpuLoad = (load > 0xffff) ? 0xffff : (uint16_t)load;
+}
+
+void PipelineStats::reset(void)
+{
+  _callbackCycles.reset();
+  _outputCycles.reset();
+  _sdReadCycles.reset();
+  _pcmDepth.reset();
+  _callbackUnits.store(0, std::memory_order_relaxed);
+  _outputUnits.store(0, std::memory_order_relaxed);
+  _filterUnits.store(0, std::memory_order_relaxed);
+  _outputFrames.store(0, std::memory_order_relaxed);
+  _shortWrites.store(0, std::memory_order_relaxed);
+  _droppedBytes.store(0, std::memory_order_relaxed);
+  _clippedBlocks.store(0, std::memory_order_relaxed);
+  _peak.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,222 @@
+/*!
+ * @file  PipelineStats.h
+ * @brief  Define the runtime statistics of the audio pipeline
+ * @details  Each counter has a single writer (the Bluetooth callback, the output task or the prefetch task) and is updated
+ * @n        with relaxed atomics, a few cycles per block. Any task can take a snapshot at any time without locking.
+ * @n        Durations are kept in CPU cycles in histograms with power-of-two buckets.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __PIPELINE_STATS_H__
+#define __PIPELINE_STATS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define STATS_HIST_BUCKETS   ((uint8_t)(16))   //!< Buckets of each histogram, bucket 0 counts values below 2^shift, bucket i (i > 0) values in [2^(shift+i-1), 2^(shift+i)), the last bucket also all larger values
+
+#define STATS_CYCLES_SHIFT   ((uint8_t)(8))   //!< Bucket shift of the processing time histograms, 256 cycles to 4.2M cycles
+#define STATS_SD_READ_SHIFT   ((uint8_t)(12))   //!< Bucket shift of the SD read time histogram, 4096 cycles to 67M cycles
+#define STATS_DEPTH_SHIFT   ((uint8_t)(6))   //!< Bucket shift of the PCM buffer depth histogram, 64 bytes to 1M bytes
+
+/**
+ * @struct sStatsHistogram_t
+ * @brief A snapshot of a histogram
+ */
+typedef struct
+{
+  uint32_t bucket[STATS_HIST_BUCKETS];   // See STATS_HIST_BUCKETS
+  uint32_t count;   // Values recorded
+  uint32_t max;   // The largest value recorded
+  uint8_t shift;   // Bucket shift, see STATS_HIST_BUCKETS
+}sStatsHistogram_t;
+
+/**
+ * @struct sPipelineStats_t
+ * @brief A snapshot of the statistics of the audio pipeline
+ */
+typedef struct
+{
+  sStatsHistogram_t callbackCycles;   // Duration of the A2DP data callback in cycles
+  sStatsHistogram_t outputCycles;   // Processing time of one output block (volume, filter, equalizer) in cycles
+  sStatsHistogram_t sdReadCycles;   // Duration of one SD card read of the prefetch task in cycles
+  sStatsHistogram_t pcmDepth;   // Bytes queued in the PCM buffer in front of I2S when the output task takes a block
+  uint32_t outputFrames;   // Stereo frames processed by the output task
+  uint16_t filterShare;   // Share of the output processing time spent in blocks with the filter or equalizer on, in 1/1000
+  uint16_t cpuLoad;   // Time of the callback and output processing against the playing time of the output, in 1/1000 of one core
+  uint32_t shortWrites;   // Writes to the sink that timed out
+  uint32_t droppedBytes;   // Bytes the sink did not accept
+  uint32_t clippedBlocks;   // Output blocks which reached full scale
+  uint16_t peak;   // The largest absolute output sample
+  uint32_t pcmUnderruns;   // Reads of the output task the PCM buffer could not satisfy completely
+  uint32_t pcmOverruns;   // Writes dropped because the PCM buffer was full
+  uint32_t pcmHighWater;   // The largest fill level of the PCM buffer in bytes
+  uint32_t sdStalls;   // Times the player ran out of SD data read ahead, each stall counted once
+  uint8_t prefetchLowWater;   // The fewest SD buffers read ahead while playing
+  float clockDrift;   // How much faster the clock of the Bluetooth source runs than the I2S clock in ppm, see setDriftCompensation()
+}sPipelineStats_t;
+
+class StatsHistogram
+{
+public:
+  /**
+   * @fn StatsHistogram
+   * @brief Constructor
+   * @param shift - Bucket shift, see STATS_HIST_BUCKETS
+   * @return None
+   */
+  StatsHistogram(uint8_t shift);
+
+  /**
+   * @fn record
+   * @brief Record a value, called by the single writer
+   * @param value - The value
+   * @return None
+   */
+  void record(uint32_t value)
+  {
+    uint32_t units = value >> _shift;
+    uint8_t i = units ? (uint8_t)(32 - __builtin_clz(units)) : 0;
+    if(i >= STATS_HIST_BUCKETS){
+      i = STATS_HIST_BUCKETS - 1;
+    }
+    _bucket[i].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    if(value > _max.load(std::memory_order_relaxed)){
+      _max.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @fn snapshot
+   * @brief Copy the histogram
+   * @param hist - The copy
+   * @return None
+   */
+  void snapshot(sStatsHistogram_t *hist) const;
+
+  /**
+   * @fn reset
+   * @brief Clear the histogram
+   * @return None
+   */
+  void reset(void);
+
+protected:
+  std::atomic<uint32_t> _bucket[STATS_HIST_BUCKETS];
+  std::atomic<uint32_t> _count;
+  std::atomic<uint32_t> _max;
+  uint8_t _shift;
+};
+
+class PipelineStats
+{
+public:
+  /**
+   * @fn PipelineStats
+   * @brief Constructor
+   * @return None
+   */
+  PipelineStats(void);
+
+  /**
+   * @fn recordCallback
+   * @brief Record one A2DP data callback, called by the Bluetooth task
+   * @param cycles - Duration of the callback in cycles
+   * @return None
+   */
+  void recordCallback(uint32_t cycles)
+  {
+    _callbackCycles.record(cycles);
+    _callbackUnits.fetch_add(cycles >> STATS_CYCLES_SHIFT, std::memory_order_relaxed);
+  }
+
+  /**
+   * @fn recordOutput
+   * @brief Record one output block, called by the output task
+   * @param frames - Stereo frames in the block
+   * @param cycles - Processing time of the block in cycles
+   * @param filterCycles - The part of it spent with the filter or equalizer on
+   * @param peak - The largest absolute output sample of the block
+   * @return None
+   */
+  void recordOutput(uint32_t frames, uint32_t cycles, uint32_t filterCycles, uint16_t peak)
+  {
+    _outputCycles.record(cycles);
+    _outputFrames.fetch_add(frames, std::memory_order_relaxed);
+    _outputUnits.fetch_add(cycles >> STATS_CYCLES_SHIFT, std::memory_order_relaxed);
+    _filterUnits.fetch_add(filterCycles >> STATS_CYCLES_SHIFT, std::memory_order_relaxed);
+    if(peak > _peak.load(std::memory_order_relaxed)){
+      _peak.store(peak, std::memory_order_relaxed);
+    }
+    if(peak >= 32767){
+      _clippedBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @fn recordDepth
+   * @brief Record the fill level of the PCM buffer, called by the output task when it takes a block
+   * @param depth - Bytes queued in the PCM buffer
+   * @return None
+   */
+  void recordDepth(uint32_t depth) { _pcmDepth.record(depth); }
+
+  /**
+   * @fn recordShortWrite
+   * @brief Record a write the sink did not fully accept, called by the output task
+   * @param dropped - Bytes the sink did not accept
+   * @return None
+   */
+  void recordShortWrite(uint32_t dropped)
+  {
+    _shortWrites.fetch_add(1, std::memory_order_relaxed);
+    _droppedBytes.fetch_add(dropped, std::memory_order_relaxed);
+  }
+
+  /**
+   * @fn recordSDRead
+   * @brief Record one SD card read, called by the prefetch task
+   * @param cycles - Duration of the read in cycles
+   * @return None
+   */
+  void recordSDRead(uint32_t cycles) { _sdReadCycles.record(cycles); }
+
+  /**
+   * @fn snapshot
+   * @brief Copy the statistics, the buffer counters of sPipelineStats_t are left to the caller
+   * @param stats - The copy
+   * @param cpuHz - CPU clock, to work out the load
+   * @param sampleRate - Output sample rate, to work out the load
+   * @return None
+   */
+  void snapshot(sPipelineStats_t *stats, uint32_t cpuHz, uint32_t sampleRate) const;
+
+  /**
+   * @fn reset
+   * @brief Clear the statistics
+   * @return None
+   */
+  void reset(void);
+
+protected:
+  StatsHistogram _callbackCycles;
+  StatsHistogram _outputCycles;
+  StatsHistogram _sdReadCycles;
+  StatsHistogram _pcmDepth;
+  std::atomic<uint32_t> _callbackUnits;   // Total callback cycles >> STATS_CYCLES_SHIFT
+  std::atomic<uint32_t> _outputUnits;   // Total output cycles >> STATS_CYCLES_SHIFT
+  std::atomic<uint32_t> _filterUnits;   // Total filter cycles >> STATS_CYCLES_SHIFT
+  std::atomic<uint32_t> _outputFrames;
+  std::atomic<uint32_t> _shortWrites;
+  std::atomic<uint32_t> _droppedBytes;
+  std::atomic<uint32_t> _clippedBlocks;
+  std::atomic<uint16_t> _peak;
+};
+
+#endif
@@ -0,0 +1,236 @@
+/*!
+ * @file  PipelineTask.cpp
+ * @brief  Define the task running one stage of the audio pipeline
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "PipelineTask.h"
+
+static thread_local PipelineTask *_currentTask = NULL;   // The task of the calling thread, NULL outside the pipeline
+
+bool PipelineTask::keepRunning(void)
+{
+  PipelineTask *task = _currentTask;
+  return (task == NULL) || !task->_stopping.load(std::memory_order_relaxed);
+}
+
+#ifdef ESP_PLATFORM
+
+PipelineTask::PipelineTask(void)
+  : _entry(NULL), _arg(NULL), _stopping(false), _handle(NULL), _handleLock(NULL), _done(NULL)
+{
+}
+
+PipelineTask::~PipelineTask()
+{
+  stop();
+  if(_handleLock != NULL){
+    vSemaphoreDelete(_handleLock);
+  }
+}
+
+void PipelineTask::run(void *arg)
+{
+  PipelineTask *task = (PipelineTask *)arg;
+  _currentTask = task;
+  task->_entry(task->_arg);
+
+  xSemaphoreTake(task->_handleLock, portMAX_DELAY);   // No notify() is under way and none follows
+  task->_handle = NULL;
+  xSemaphoreGive(task->_handleLock);
+  xSemaphoreGive(task->_done);   // The object may be gone from here on
+  vTaskDelete(NULL);
+}
+
+bool PipelineTask::start(const char *name, void (*entry)(void *), void *arg, const sTaskConfig_t &config)
+{
+  if(isRunning()){
+    return false;
+  }
+  stop();   // Clean up after a task which ended by itself
+  if(_handleLock == NULL){
+    _handleLock = xSemaphoreCreateMutex();
+  }
+  _done = xSemaphoreCreateBinary();
+  if((_handleLock == NULL) || (_done == NULL)){
+    if(_done != NULL){
+      vSemaphoreDelete(_done);
+      _done = NULL;
+    }
+    return false;
+  }
+  _entry = entry;
+  _arg = arg;
+  _stopping.store(false, std::memory_order_relaxed);
+
+  BaseType_t core = (config.core == PIPELINE_NO_AFFINITY) ? tskNO_AFFINITY : config.core;
+  TaskHandle_t handle = NULL;
+  xSemaphoreTake(_handleLock, portMAX_DELAY);   // The new task may run and end before the handle is stored
+  BaseType_t ret = xTaskCreatePinnedToCore(run, name, config.stackSize, this, config.priority, &handle, core);
+  _handle = (ret == pdPASS) ? handle : NULL;
+  xSemaphoreGive(_handleLock);
+  if(ret != pdPASS){
+    vSemaphoreDelete(_done);
+    _done = NULL;
+    return false;
+  }
+  return true;
+}
+
+void PipelineTask::stop(void)
+{
+  if(_done == NULL){
+    return;
+  }
+  _stopping.store(true, std::memory_order_relaxed);
+  notify();   // Out of wait()
+  xSemaphoreTake(_done, portMAX_DELAY);   // Also given when the task has ended by itself before
+  vSemaphoreDelete(_done);
+  _done = NULL;
+}
+
+bool PipelineTask::isRunning(void) const
+{
+  return _handle != NULL;
+}
+
+void PipelineTask::notify(void)
+{
+  if(_handleLock == NULL){
+    return;
+  }
+  xSemaphoreTake(_handleLock, portMAX_DELAY);
+  if(_handle != NULL){
+    xTaskNotifyGive(_handle);
+  }
+  xSemaphoreGive(_handleLock);
+}
+
+bool PipelineTask::wait(uint32_t ticks)
+{
+  bool notified = ulTaskNotifyTake(pdTRUE, ticks) != 0;
+  return notified && keepRunning();
+}
+
+void PipelineTask::sleep(uint32_t ticks)
+{
+  vTaskDelay(ticks);
+}
+
+#else
+
+#include <string.h>
+#include <chrono>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+PipelineTask::PipelineTask(void)
+  : _entry(NULL), _arg(NULL), _stopping(false), _notified(0), _running(false)
+{
+}
+
+PipelineTask::~PipelineTask()
+{
+  stop();
+}
+
+void PipelineTask::run(void *arg)
+{
+  PipelineTask *task = (PipelineTask *)arg;
+  _currentTask = task;
+  task->_entry(task->_arg);
+  task->_running.store(false, std::memory_order_relaxed);
+}
+
+bool PipelineTask::start(const char *name, void (*entry)(void *), void *arg, const sTaskConfig_t &config)
+{
+  if(isRunning()){
+    return false;
+  }
+  stop();   // Join a thread which ended by itself
+  _entry = entry;
+  _arg = arg;
+  _stopping.store(false, std::memory_order_relaxed);
+  _notified = 0;
+  _running.store(true, std::memory_order_relaxed);
+  _thread = std::thread(run, this);
+
+  // The priority and the stack size are not applied, a thread without privileges can not raise its priority
+#ifdef __linux__
+  char threadName[16];   // At most 15 characters
+  strncpy(threadName, name, sizeof(threadName) - 1);
+  threadName[sizeof(threadName) - 1] = 0;
+  pthread_setname_np(_thread.native_handle(), threadName);
+  cpu_set_t allowed;
+  if((config.core != PIPELINE_NO_AFFINITY) && (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)){
+    int n = config.core % CPU_COUNT(&allowed);   // The n-th of the CPUs the process may run on
+    for(int cpu=0; cpu<CPU_SETSIZE; cpu++){
+      if(CPU_ISSET(cpu, &allowed) && (n-- == 0)){
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(_thread.native_handle(), sizeof(set), &set);
+        break;
+      }
+    }
+  }
+#else
+  (void)name;
+  (void)config;
+#endif
+  return true;
+}
+
+void PipelineTask::stop(void)
+{
+  if(!_thread.joinable()){
+    return;
+  }
+  _stopping.store(true, std::memory_order_relaxed);
+  notify();
+  _thread.join();
+}
+
+bool PipelineTask::isRunning(void) const
+{
+  return _running.load(std::memory_order_relaxed);
+}
+
+void PipelineTask::notify(void)
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  _notified++;
+  _wake.notify_one();
+}
+
+bool PipelineTask::wait(uint32_t ticks)
+{
+  PipelineTask *task = _currentTask;
+  if(task == NULL){
+    sleep(ticks);
+    return false;
+  }
+  std::unique_lock<std::mutex> guard(task->_lock);
+  auto woken = [task]{ return (task->_notified > 0) || task->_stopping.load(std::memory_order_relaxed); };
+  bool notified = true;
+  if(ticks == UINT32_MAX){   // portMAX_DELAY, no timeout
+    task->_wake.wait(guard, woken);
+  }else{
+    notified = task->_wake.wait_for(guard, std::chrono::milliseconds(ticks), woken);
+  }
+  task->_notified = 0;
+  return notified && !task->_stopping.load(std::memory_order_relaxed);
+}
+
+void PipelineTask::sleep(uint32_t ticks)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*!
+ * @file  PipelineTask.h
+ * @brief  Define the task running one stage of the audio pipeline
+ * @details  On the ESP32 the task is a FreeRTOS task pinned to a core, with its own priority and stack size. Elsewhere,
+ * @n        e.g. on a Linux host, it is a std::thread, so the stages and the lock-free buffers between them can be run
+ * @n        and measured without the hardware; it is named and pinned to the core as far as the host allows, the priority
+ * @n        and stack size are not used there and a tick is 1 ms.
+ * @n        A stage waits for work with wait() and is woken by notify() from the stage feeding it, as with the direct
+ * @n        task notifications of FreeRTOS. stop() never kills a task: it raises a flag, the task sees it in keepRunning()
+ * @n        or wait(), leaves its loop, releasing what it holds, and ends itself when its function returns.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __PIPELINE_TASK_H__
+#define __PIPELINE_TASK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#else
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#define PIPELINE_NO_AFFINITY   ((int8_t)(-1))   //!< The task runs on either core
+#define PIPELINE_MIN_STACK_SIZE   ((uint32_t)(1024))   //!< The smallest stack size (bytes) of a task
+
+/**
+ * @struct sTaskConfig_t
+ * @brief Where and how a task of the pipeline runs
+ */
+typedef struct
+{
+  int8_t core;   // 0 or 1, PIPELINE_NO_AFFINITY for either core
+  uint8_t priority;   // FreeRTOS priority
+  uint32_t stackSize;   // Stack size in bytes
+}sTaskConfig_t;
+
+class PipelineTask
+{
+public:
+  /**
+   * @fn PipelineTask
+   * @brief Constructor, the task does not run before start()
+   * @return None
+   */
+  PipelineTask(void);
+  ~PipelineTask();
+
+  /**
+   * @fn start
+   * @brief Create the task and run it
+   * @param name - Name of the task
+   * @param entry - The function of the task, it loops while keepRunning(), the task ends when it returns
+   * @param arg - The argument of entry
+   * @param config - Core, priority and stack size; on a host the core is taken modulo the CPUs the process may use
+   * @return true on success, false when the task can not be created or already runs
+   */
+  bool start(const char *name, void (*entry)(void *), void *arg, const sTaskConfig_t &config);
+
+  /**
+   * @fn stop
+   * @brief Stop the task and wait until it has ended, it must not be called by the task itself
+   * @n     The task leaves its loop at the next keepRunning() or wait(), which is woken, so it never ends holding a lock
+   * @return None
+   */
+  void stop(void);
+
+  /**
+   * @fn isRunning
+   * @brief Whether the task has been started and has not ended
+   * @return true when running
+   */
+  bool isRunning(void) const;
+
+  /**
+   * @fn notify
+   * @brief Wake the task from wait(), a notification given while it is busy is kept for its next wait()
+   * @return None
+   */
+  void notify(void);
+
+  /**
+   * @fn wait
+   * @brief Wait for a notification, called by the task itself
+   * @param ticks - The longest time to wait
+   * @return true when notified, false on timeout
+   */
+  static bool wait(uint32_t ticks);
+
+  /**
+   * @fn sleep
+   * @brief Let the calling task sleep
+   * @param ticks - The time to sleep
+   * @return None
+   */
+  static void sleep(uint32_t ticks);
+
+  /**
+   * @fn keepRunning
+   * @brief Whether the calling task should go on with its loop, false once stop() has been called for it
+   * @return true to go on
+   */
+  static bool keepRunning(void);
+
+protected:
+  static void run(void *task);
+
+  void (*_entry)(void *);
+  void *_arg;
+  std::atomic<bool> _stopping;
+#ifdef ESP_PLATFORM
+  TaskHandle_t _handle;   // NULL once the task has ended
+  SemaphoreHandle_t _handleLock;   // Keeps the task from ending while it is notified, created by the first start()
+  SemaphoreHandle_t _done;   // Given by the task as it ends, NULL when not started
+#else
+  std::thread _thread;
+  std::mutex _lock;   // Guards _notified
+  std::condition_variable _wake;
+  uint32_t _notified;   // Notifications not taken yet
+  std::atomic<bool> _running;
+#endif
+};
+
+#endif
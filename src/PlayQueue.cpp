@@ -0,0 +1,132 @@
+/*!
+ * @file  PlayQueue.cpp
+ * @brief  Define the playlist queue of the SD card player
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "PlayQueue.h"
+
+PlayQueue::PlayQueue(void)
+  : _count(0), _pos(0), _repeat(PLAY_REPEAT_OFF), _shuffle(false), _seed(2463534242u)
+{
+}
+
+uint32_t PlayQueue::random(void)
+{
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+  return _seed;
+}
+
+void PlayQueue::setSeed(uint32_t seed)
+{
+  _seed = seed ? seed : 2463534242u;
+}
+
+void PlayQueue::shuffleFrom(uint16_t first)
+{
+  for(uint16_t i = _count; i > first + 1; i--){   // Fisher-Yates over the positions first to _count-1
+    uint16_t j = first + random() % (i - first);
+    uint8_t t = _order[i - 1];
+    _order[i - 1] = _order[j];
+    _order[j] = t;
+  }
+}
+
+bool PlayQueue::enqueue(uint32_t track)
+{
+  if(_count >= PLAY_QUEUE_SIZE){
+    return false;
+  }
+  _tracks[_count] = track;
+  _order[_count] = (uint8_t)_count;
+  _count++;
+  if(_shuffle && (_count - _pos > 2)){   // Somewhere after the current track
+    uint16_t j = _pos + 1 + random() % (_count - _pos - 1);
+    uint8_t t = _order[_count - 1];
+    _order[_count - 1] = _order[j];
+    _order[j] = t;
+  }
+  return true;
+}
+
+void PlayQueue::clear(void)
+{
+  _count = 0;
+  _pos = 0;
+}
+
+void PlayQueue::setRepeat(uint8_t mode)
+{
+  _repeat = (mode > PLAY_REPEAT_ALL) ? PLAY_REPEAT_OFF : mode;
+}
+
+void PlayQueue::setShuffle(bool shuffle)
+{
+  if(shuffle == _shuffle){
+    return;
+  }
+  _shuffle = shuffle;
+  if(shuffle){
+    shuffleFrom((_pos < _count) ? (_pos + 1) : 0);
+  }else{   // The queued order again, from the current track on
+    uint16_t cur = (_pos < _count) ? _order[_pos] : _count;
+    for(uint16_t i = 0; i < _count; i++){
+      _order[i] = (uint8_t)i;
+    }
+    _pos = cur;
+  }
+}
+
+bool PlayQueue::start(uint32_t *track)
+{
+  _pos = 0;
+  for(uint16_t i = 0; i < _count; i++){
+    _order[i] = (uint8_t)i;
+  }
+  if(_shuffle){
+    shuffleFrom(0);
+  }
+  return current(track);
+}
+
+bool PlayQueue::current(uint32_t *track) const
+{
+  if(_pos >= _count){
+    return false;
+  }
+  *track = _tracks[_order[_pos]];
+  return true;
+}
+
+bool PlayQueue::next(uint32_t *track, bool skip)
+{
+  if(_count == 0){
+    return false;
+  }
+  if((_repeat == PLAY_REPEAT_ONE) && !skip){
+    return current(track);
+  }
+  if(_pos + 1 < _count){
+    _pos++;
+  }else if(_repeat != PLAY_REPEAT_OFF){   // Start over
+    uint8_t last = _order[(_pos < _count) ? _pos : (_count - 1)];
+    _pos = 0;
+    if(_shuffle){
+      shuffleFrom(0);
+      if((_count > 1) && (_order[0] == last)){   // Do not play the same track twice in a row
+        _order[0] = _order[_count - 1];
+        _order[_count - 1] = last;
+      }
+    }
+  }else{
+    _pos = _count;
+    return false;
+  }
+  return current(track);
+}
@@ -0,0 +1,119 @@
+/*!
+ * @file  PlayQueue.h
+ * @brief  Define the playlist queue of the SD card player
+ * @details  The queue holds track numbers of the music index. It knows the track being played and works out the
+ * @n        next one from the repeat mode and the shuffle order, so the player can open the next track ahead of time.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __PLAY_QUEUE_H__
+#define __PLAY_QUEUE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define PLAY_QUEUE_SIZE   ((uint16_t)(64))   //!< The most tracks in the queue
+
+#define PLAY_REPEAT_OFF   ((uint8_t)(0))   //!< Stop after the last track of the queue
+#define PLAY_REPEAT_ONE   ((uint8_t)(1))   //!< Repeat the current track
+#define PLAY_REPEAT_ALL   ((uint8_t)(2))   //!< Start over after the last track, with a new order when shuffled
+
+class PlayQueue
+{
+public:
+  /**
+   * @fn PlayQueue
+   * @brief Constructor
+   * @return None
+   */
+  PlayQueue(void);
+
+  /**
+   * @fn enqueue
+   * @brief Add a track to the end of the queue, or at a random place after the current track when shuffled
+   * @param track - The track number
+   * @return true on success, false when the queue is full
+   */
+  bool enqueue(uint32_t track);
+
+  /**
+   * @fn clear
+   * @brief Remove all the tracks
+   * @return None
+   */
+  void clear(void);
+
+  /**
+   * @fn size
+   * @brief Get the number of tracks in the queue
+   * @return The number of tracks
+   */
+  uint16_t size(void) const { return _count; }
+
+  /**
+   * @fn setRepeat
+   * @brief Set the repeat mode
+   * @param mode - PLAY_REPEAT_OFF, PLAY_REPEAT_ONE or PLAY_REPEAT_ALL
+   * @return None
+   */
+  void setRepeat(uint8_t mode);
+
+  /**
+   * @fn setShuffle
+   * @brief Play the tracks after the current one in random order, or in the queued order again
+   * @param shuffle - true: random order; false: queued order
+   * @return None
+   */
+  void setShuffle(bool shuffle);
+
+  /**
+   * @fn setSeed
+   * @brief Set the seed of the shuffle order
+   * @param seed - Any value except 0
+   * @return None
+   */
+  void setSeed(uint32_t seed);
+
+  /**
+   * @fn start
+   * @brief Go to the first track, a new order is drawn when shuffled
+   * @param track - The first track
+   * @return true on success, false when the queue is empty
+   */
+  bool start(uint32_t *track);
+
+  /**
+   * @fn current
+   * @brief Get the current track
+   * @param track - The current track
+   * @return true on success, false when the queue is empty or has ended
+   */
+  bool current(uint32_t *track) const;
+
+  /**
+   * @fn next
+   * @brief Go to the next track according to the repeat mode and the shuffle order
+   * @param track - The next track
+   * @param skip - true: asked by the user, PLAY_REPEAT_ONE moves on like PLAY_REPEAT_ALL
+   * @return true on success, false at the end of the queue
+   */
+  bool next(uint32_t *track, bool skip=false);
+
+protected:
+  uint32_t random(void);
+  void shuffleFrom(uint16_t first);
+
+  uint32_t _tracks[PLAY_QUEUE_SIZE];   // In the queued order
+  uint8_t _order[PLAY_QUEUE_SIZE];   // Play order, positions in _tracks
+  uint16_t _count;
+  uint16_t _pos;   // Position in _order, _count at the end of the queue
+  uint8_t _repeat;
+  bool _shuffle;
+  uint32_t _seed;   // xorshift32 state
+};
+
+#endif
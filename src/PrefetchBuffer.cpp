@@ -0,0 +1,155 @@
+/*!
+ * @file  PrefetchBuffer.cpp
+ * @brief  Define the pool of read-ahead buffers between a slow audio source and the player
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <stdlib.h>
+
+#include "PrefetchBuffer.h"
+
+PrefetchBuffer::PrefetchBuffer(void)
+  : _raw(NULL), _data(NULL), _count(0), _size(0), _fillSize(0), _tag(0), _head(0), _tail(0), _end(false), _stalls(0), _stalled(false), _lowWater(0)
+{
+}
+
+PrefetchBuffer::~PrefetchBuffer()
+{
+  end();
+}
+
+bool PrefetchBuffer::begin(uint8_t count, size_t size)
+{
+  if(count < 2){
+    count = 2;
+  }else if(count > PREFETCH_MAX_BUFFERS){
+    count = PREFETCH_MAX_BUFFERS;
+  }
+  size = (size + PREFETCH_ALIGN - 1) & ~(PREFETCH_ALIGN - 1);
+  if(size == 0){
+    size = PREFETCH_ALIGN;
+  }
+
+  end();
+  _raw = (uint8_t *)malloc(count * size + PREFETCH_ALIGN - 1);
+  if(_raw == NULL){
+    return false;
+  }
+  _data = (uint8_t *)(((uintptr_t)_raw + PREFETCH_ALIGN - 1) & ~(uintptr_t)(PREFETCH_ALIGN - 1));
+  _count = count;
+  _size = size;
+  _fillSize = size;
+  clear();
+  resetCounters();
+  return true;
+}
+
+void PrefetchBuffer::end(void)
+{
+  free(_raw);
+  _raw = NULL;
+  _data = NULL;
+  _count = 0;
+  _size = 0;
+  _fillSize = 0;
+}
+
+void PrefetchBuffer::clear(void)
+{
+  _head.store(0, std::memory_order_relaxed);
+  _tail.store(0, std::memory_order_relaxed);
+  _end.store(false, std::memory_order_release);
+  _stalled = false;
+}
+
+void PrefetchBuffer::setBlockAlign(uint16_t align)
+{
+  if(align == 0){
+    align = 1;
+  }
+  _fillSize = _size - _size % align;
+}
+
+void PrefetchBuffer::restart(uint8_t tag)
+{
+  _tag = tag;
+  _end.store(false, std::memory_order_release);
+}
+
+bool PrefetchBuffer::fill(AudioSource &source)
+{
+  uint32_t head = _head.load(std::memory_order_relaxed);
+  uint32_t tail = _tail.load(std::memory_order_acquire);
+  if((_data == NULL) || (head - tail >= _count) || _end.load(std::memory_order_relaxed)){
+    return false;
+  }
+
+  uint8_t index = head % _count;
+  size_t len = source.read(_data + index * _size, _fillSize);
+  if(len == 0){
+    _end.store(true, std::memory_order_release);
+    return false;
+  }
+  _len[index] = len;
+  _tags[index] = _tag;
+  _head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+const uint8_t * PrefetchBuffer::getReadBuffer(size_t *len, uint8_t *tag)
+{
+  bool ended = _end.load(std::memory_order_acquire);   // Loaded first, so no buffer filled before the end mark is missed
+  uint32_t tail = _tail.load(std::memory_order_relaxed);
+  uint32_t head = _head.load(std::memory_order_acquire);
+  uint8_t filled = (uint8_t)(head - tail);
+
+  if(!ended && (filled < _lowWater.load(std::memory_order_relaxed))){
+    _lowWater.store(filled, std::memory_order_relaxed);
+  }
+  if(filled == 0){
+    if(!ended && (_data != NULL) && !_stalled){   // Counted when the data runs out, not on every poll
+      _stalled = true;
+      _stalls.fetch_add(1, std::memory_order_relaxed);
+    }
+    *len = 0;
+    return NULL;
+  }
+
+  _stalled = false;
+  uint8_t index = tail % _count;
+  *len = _len[index];
+  if(tag != NULL){
+    *tag = _tags[index];
+  }
+  return _data + index * _size;
+}
+
+void PrefetchBuffer::releaseRead(void)
+{
+  _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool PrefetchBuffer::isEnd(void) const
+{
+  bool ended = _end.load(std::memory_order_acquire);
+  return ended && (_head.load(std::memory_order_acquire) == _tail.load(std::memory_order_relaxed));
+}
+
+bool PrefetchBuffer::isReady(void) const
+{
+  if(_end.load(std::memory_order_acquire)){
+    return true;
+  }
+  return (uint32_t)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed)) >= _count;
+}
+
+void PrefetchBuffer::resetCounters(void)
+{
+  _stalls.store(0, std::memory_order_relaxed);
+  _stalled = false;
+  _lowWater.store(_count, std::memory_order_relaxed);
+}
@@ -0,0 +1,177 @@
+/*!
+ * @file  PrefetchBuffer.h
+ * @brief  Define the pool of read-ahead buffers between a slow audio source and the player
+ * @details  A reader task fills the buffers of the pool ahead of playback, the player consumes them in the same order.
+ * @n        Each buffer is aligned to PREFETCH_ALIGN bytes and its size is a multiple of it, so the SD driver reads
+ * @n        whole sectors straight into it. There is one producer and one consumer, no lock is used.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __PREFETCH_BUFFER_H__
+#define __PREFETCH_BUFFER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "AudioSource.h"
+
+#define PREFETCH_ALIGN   ((size_t)(512))   //!< Alignment and size granularity (bytes) of the buffers, one SD sector
+#define PREFETCH_MAX_BUFFERS   ((uint8_t)(16))   //!< The largest number of buffers in the pool
+
+class PrefetchBuffer
+{
+public:
+  /**
+   * @fn PrefetchBuffer
+   * @brief Constructor, no memory is allocated before begin()
+   * @return None
+   */
+  PrefetchBuffer(void);
+  ~PrefetchBuffer();
+
+  /**
+   * @fn begin
+   * @brief Allocate the buffers
+   * @param count - The number of buffers, range: 2 to PREFETCH_MAX_BUFFERS
+   * @param size - Byte length of each buffer, rounded up to a multiple of PREFETCH_ALIGN
+   * @return true on success, false on error
+   */
+  bool begin(uint8_t count, size_t size);
+
+  /**
+   * @fn end
+   * @brief Release the buffers
+   * @return None
+   */
+  void end(void);
+
+  /**
+   * @fn clear
+   * @brief Drop all the filled buffers and the end mark, e.g. before the next track
+   * @note Neither the producer nor the consumer may use the pool meanwhile
+   * @return None
+   */
+  void clear(void);
+
+  /**
+   * @fn setBlockAlign
+   * @brief Fill each buffer with whole frames only, so a frame never spans two buffers
+   * @param align - Byte length of one frame, default to 1
+   * @note Neither the producer nor the consumer may use the pool meanwhile
+   * @return None
+   */
+  void setBlockAlign(uint16_t align);
+
+  /**
+   * @fn restart
+   * @brief Continue with the next source after the end of the current one, the filled buffers are kept
+   * @param tag - Tag of the buffers filled from now on, so the consumer sees where the next source starts
+   * @note The producer may not use the pool meanwhile
+   * @return None
+   */
+  void restart(uint8_t tag);
+
+  /**
+   * @fn fill
+   * @brief Fill the next free buffer from the source, called by the producer
+   * @param source - The audio source, it may block
+   * @return true when a buffer was filled, false when all buffers are full or at the end of the source
+   */
+  bool fill(AudioSource &source);
+
+  /**
+   * @fn getReadBuffer
+   * @brief Get the oldest filled buffer, called by the consumer
+   * @param len - Byte length of the audio data in the buffer
+   * @param tag - The tag given by restart() when the buffer was filled, NULL if not needed
+   * @return The buffer, NULL when no buffer is filled (a stall, unless isEnd())
+   */
+  const uint8_t * getReadBuffer(size_t *len, uint8_t *tag=NULL);
+
+  /**
+   * @fn isSourceEnd
+   * @brief Whether the source has ended, some of its data may still be waiting in the buffers
+   * @return true at the end of the source
+   */
+  bool isSourceEnd(void) const { return _end.load(std::memory_order_acquire); }
+
+  /**
+   * @fn releaseRead
+   * @brief Give the buffer got by getReadBuffer() back to the producer
+   * @return None
+   */
+  void releaseRead(void);
+
+  /**
+   * @fn isEnd
+   * @brief Whether the source has ended and all its data has been consumed
+   * @return true at the end
+   */
+  bool isEnd(void) const;
+
+  /**
+   * @fn isReady
+   * @brief Whether all the buffers are filled or the source has ended, so the consumer can start without stalling
+   * @return true when ready
+   */
+  bool isReady(void) const;
+
+  /**
+   * @fn count
+   * @brief Get the number of buffers
+   * @return The number of buffers
+   */
+  uint8_t count(void) const { return _count; }
+
+  /**
+   * @fn size
+   * @brief Get the byte length of each buffer
+   * @return The byte length of each buffer
+   */
+  size_t size(void) const { return _size; }
+
+  /**
+   * @fn getStalls
+   * @brief Get the number of times the consumer ran out of filled buffers before the end of the source
+   * @n     A stall counts once, however often the consumer polls until the next buffer is filled
+   * @return The number of stalls
+   */
+  uint32_t getStalls(void) const { return _stalls.load(std::memory_order_relaxed); }
+
+  /**
+   * @fn getLowWater
+   * @brief Get the fewest filled buffers the consumer has found, the read-ahead margin left in the worst case
+   * @return The number of buffers
+   */
+  uint8_t getLowWater(void) const { return _lowWater.load(std::memory_order_relaxed); }
+
+  /**
+   * @fn resetCounters
+   * @brief Reset the stall counter and the low-water mark
+   * @return None
+   */
+  void resetCounters(void);
+
+protected:
+  uint8_t *_raw;   // The allocated memory
+  uint8_t *_data;   // The first buffer, aligned
+  uint8_t _count;
+  size_t _size;
+  size_t _fillSize;   // Bytes read into each buffer, the largest multiple of the frame length
+  size_t _len[PREFETCH_MAX_BUFFERS];   // Byte length of the audio data in each buffer
+  uint8_t _tags[PREFETCH_MAX_BUFFERS];   // Tag of each buffer
+  uint8_t _tag;   // Tag of the buffers being filled
+  std::atomic<uint32_t> _head;   // Total buffers filled, only changed by the producer
+  std::atomic<uint32_t> _tail;   // Total buffers consumed, only changed by the consumer
+  std::atomic<bool> _end;   // The source has ended, set by the producer after its last buffer
+  std::atomic<uint32_t> _stalls;
+  bool _stalled;   // The last getReadBuffer() found no buffer, only used by the consumer
+  std::atomic<uint8_t> _lowWater;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*!
+ * @file  Requantizer.cpp
+ * @brief  Define the requantization of the processed samples to the output, with TPDF dither and noise shaping
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <string.h>
+
+#include "Requantizer.h"
+
+/**
+ * The index of an output sample width in _modeSet, -1 for an unknown width
+ */
+static int widthIndex(uint8_t bitsPerSample)
+{
+  switch(bitsPerSample){
+    case 16: return 0;
+    case 24: return 1;
+    case 32: return 2;
+    default: return -1;
+  }
+}
+
+Requantizer::Requantizer(void)
+  : _bits(16), _mode(0xff), _modeBits(0), _seed(0x9e3779b9)
+{
+  _modeSet[0].store(DITHER_TPDF, std::memory_order_relaxed);
+  _modeSet[1].store(DITHER_OFF, std::memory_order_relaxed);
+  _modeSet[2].store(DITHER_OFF, std::memory_order_relaxed);
+  memset(&_shaper, 0, sizeof(_shaper));
+  _shaper.noise = _noise;
+}
+
+bool Requantizer::setMode(uint8_t bitsPerSample, uint8_t mode)
+{
+  int i = widthIndex(bitsPerSample);
+  if((i < 0) || (mode > DITHER_SHAPED2) || ((bitsPerSample == 32) && (mode != DITHER_OFF))){
+    return false;
+  }
+  _modeSet[i].store(mode, std::memory_order_relaxed);
+  return true;
+}
+
+uint8_t Requantizer::getMode(uint8_t bitsPerSample) const
+{
+  int i = widthIndex(bitsPerSample);
+  return (i < 0) ? DITHER_OFF : _modeSet[i].load(std::memory_order_relaxed);
+}
+
+void Requantizer::begin(size_t frames, sShaper_t *shaper)
+{
+  int i = widthIndex(_bits);
+  uint8_t mode = (i < 0) ? DITHER_OFF : _modeSet[i].load(std::memory_order_relaxed);
+  if((mode != _mode) || (_bits != _modeBits)){
+    _mode = mode;
+    _modeBits = _bits;
+    _shaper.half = (_bits == 32) ? 0 : (1 << 7);   // 24-bit output steps are 256 LSBs of the word
+    _shaper.stepMask = (_bits == 32) ? -1 : ~0xff;
+    _shaper.ditherMask = (mode == DITHER_OFF) ? 0 : -1;
+    _shaper.c1 = (mode == DITHER_SHAPED1) ? 1 : ((mode == DITHER_SHAPED2) ? 2 : 0);
+    _shaper.c2 = (mode == DITHER_SHAPED2) ? -1 : 0;
+    _shaper.e1L = 0;
+    _shaper.e2L = 0;
+    _shaper.e1R = 0;
+    _shaper.e2R = 0;
+  }
+  _shaper.next = 0;
+  *shaper = _shaper;
+  if(mode == DITHER_OFF){
+    return;
+  }
+  if(frames > DITHER_BLOCK_FRAMES){
+    frames = DITHER_BLOCK_FRAMES;
+  }
+  uint32_t x = _seed;
+  for(size_t i=0; i<frames; i++){
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _noise[i] = x;
+  }
+  _seed = x;
+}
@@ -0,0 +1,240 @@
+/*!
+ * @file  Requantizer.h
+ * @brief  Define the requantization of the processed samples to the output, with TPDF dither and noise shaping
+ * @details  The processing chains carry DSP_FRACTION_BITS below the output LSB, float samples carry their own fraction.
+ * @n        The requantizer adds triangular (TPDF) dither of +-1 LSB, so the error is noise independent of the signal
+ * @n        instead of distortion, optionally shapes the error towards high frequencies by error feedback, rounds and
+ * @n        saturates. The random words come from xorshift32, one word per stereo frame, generated a block at a time.
+ * @n        The mode is kept per output sample width, the one of the current output is used.
+ * @n        16-bit output is written as int16_t. 24-bit and 32-bit output is written as int32_t words with the sample
+ * @n        MSB-aligned: 24-bit samples are rounded at bit 8 of the word, 32-bit words carry all the bits the processing has.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __REQUANTIZER_H__
+#define __REQUANTIZER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "Biquad.h"
+
+#define DITHER_OFF   ((uint8_t)(0))   //!< Round to the nearest output step, no dither
+#define DITHER_TPDF   ((uint8_t)(1))   //!< TPDF dither, a flat noise floor and no distortion
+#define DITHER_SHAPED1   ((uint8_t)(2))   //!< TPDF dither, the noise shaped by (1 - z^-1), lower below about fs/6, higher above
+#define DITHER_SHAPED2   ((uint8_t)(3))   //!< TPDF dither, the noise shaped by (1 - z^-1)^2, lower below about fs/4.5, higher above
+
+#define WIDE_FULL_SCALE   ((int32_t)(0x7ffff000))   //!< The largest int32_t word of wide output, the headroom keeps the rounding from overflowing
+#define DITHER_BLOCK_FRAMES   ((uint32_t)(512))   //!< The most random words generated at a time, a power of two, larger blocks reuse them
+
+class Requantizer
+{
+public:
+  /**
+   * @fn Requantizer
+   * @brief Constructor, 16-bit output with TPDF dither, no dither for wider output
+   * @return None
+   */
+  Requantizer(void);
+
+  /**
+   * @fn setOutputBits
+   * @brief Set the output sample width, called by the audio task between blocks
+   * @param bitsPerSample - 16, 24 or 32
+   * @return None
+   */
+  void setOutputBits(uint8_t bitsPerSample) { _bits = bitsPerSample; }
+
+  /**
+   * @fn setMode
+   * @brief Set the dither of an output sample width, called by the control task
+   * @param bitsPerSample - The output sample width: 16, 24 or 32
+   * @param mode - DITHER_OFF, DITHER_TPDF, DITHER_SHAPED1 or DITHER_SHAPED2, only DITHER_OFF for 32-bit output which is not rounded
+   * @return true on success, false for an unknown width or mode
+   */
+  bool setMode(uint8_t bitsPerSample, uint8_t mode);
+
+  /**
+   * @fn getMode
+   * @brief Get the dither of an output sample width
+   * @param bitsPerSample - The output sample width: 16, 24 or 32
+   * @return The mode, DITHER_OFF for an unknown width
+   */
+  uint8_t getMode(uint8_t bitsPerSample) const;
+
+  /**
+   * @struct sShaper_t
+   * @brief The state used per frame, copied into the processing loop so that it stays in registers
+   */
+  typedef struct
+  {
+    const uint32_t *noise;   // The random words of the block, four random bytes per stereo frame
+    uint32_t next;   // The next random word
+    int32_t ditherMask;   // 0 without dither
+    int32_t half;   // Half an output step of wide output, in LSBs of the int32_t word
+    int32_t stepMask;   // Clears the bits of the word below the output step
+    int32_t c1, c2;   // Error feedback, the output is v - c1 * e1 - c2 * e2 plus the new error
+    int32_t e1L, e2L;   // The errors of the last two frames of each channel
+    int32_t e1R, e2R;
+  }sShaper_t;
+
+  /**
+   * @fn begin
+   * @brief Pick up the mode and generate the random words of a block, called by the audio task
+   * @param frames - Number of stereo frames in the block
+   * @param shaper - The state for the block
+   * @return None
+   */
+  void begin(size_t frames, sShaper_t *shaper);
+
+  /**
+   * @fn end
+   * @brief Store the state back after a block
+   * @param shaper - The state after the block
+   * @return None
+   */
+  void end(const sShaper_t &shaper) { _shaper = shaper; }
+
+  /**
+   * @fn tick
+   * @brief Requantize one stereo frame to 16-bit output, int16_t
+   * @param shaper - The state from begin()
+   * @param l - The left sample, int32_t with DSP_FRACTION_BITS or float, overwritten by the output sample
+   * @param r - The right sample, overwritten by the output sample
+   * @return None
+   */
+  static void tick(sShaper_t &shaper, int32_t &l, int32_t &r);
+  static void tick(sShaper_t &shaper, float &l, float &r);
+
+  /**
+   * @fn tickWide
+   * @brief Requantize one stereo frame to 24-bit or 32-bit output, int32_t words with the sample MSB-aligned
+   * @param shaper - The state from begin()
+   * @param l - The left sample, int32_t with DSP_FRACTION_BITS or float, overwritten by the output word
+   * @param r - The right sample, overwritten by the output word
+   * @return None
+   */
+  static void tickWide(sShaper_t &shaper, int32_t &l, int32_t &r);
+  static void tickWide(sShaper_t &shaper, float &l, float &r);
+
+  /**
+   * @fn process
+   * @brief Requantize a block of interleaved stereo frames
+   * @param in - The processed samples
+   * @param out - The output samples
+   * @param frames - Number of stereo frames in the block
+   * @param swap - 1: swap the left and right channels of the output; 0: keep them
+   * @return None
+   */
+  template <typename sample_t>
+  void process(const sample_t *in, int16_t *out, size_t frames, uint8_t swap)
+  {
+    sShaper_t shaper;
+    begin(frames, &shaper);
+    for(size_t i=0; i<frames; i++){
+      sample_t l = in[2 * i];
+      sample_t r = in[2 * i + 1];
+      tick(shaper, l, r);
+      out[2 * i + swap] = (int16_t)l;
+      out[2 * i + 1 - swap] = (int16_t)r;
+    }
+    end(shaper);
+  }
+  template <typename sample_t>
+  void process(const sample_t *in, int32_t *out, size_t frames, uint8_t swap)
+  {
+    sShaper_t shaper;
+    begin(frames, &shaper);
+    for(size_t i=0; i<frames; i++){
+      sample_t l = in[2 * i];
+      sample_t r = in[2 * i + 1];
+      tickWide(shaper, l, r);
+      out[2 * i + swap] = (int32_t)l;
+      out[2 * i + 1 - swap] = (int32_t)r;
+    }
+    end(shaper);
+  }
+
+protected:
+  static DSP_INLINE int32_t quantize(const sShaper_t &shaper, int32_t v, int32_t dither, int32_t &e1, int32_t &e2);
+  static DSP_INLINE int32_t quantizeWide(const sShaper_t &shaper, int32_t v, int32_t dither, int32_t &e1, int32_t &e2);
+
+  std::atomic<uint8_t> _modeSet[3];   // Set by the control task for 16, 24 and 32-bit output
+  uint8_t _bits;   // The output sample width, set by the audio task
+  uint8_t _mode;   // The mode and width the shaper is set up for
+  uint8_t _modeBits;
+  uint32_t _seed;   // xorshift32 state
+  sShaper_t _shaper;
+  uint32_t _noise[DITHER_BLOCK_FRAMES];
+};
+
+DSP_INLINE int32_t Requantizer::quantize(const sShaper_t &shaper, int32_t v, int32_t dither, int32_t &e1, int32_t &e2)
+{
+  int32_t s = v - shaper.c1 * e1 - shaper.c2 * e2;
+  int32_t t = s + dither + (1 << (DSP_FRACTION_BITS - 1));
+  int32_t y = t >> DSP_FRACTION_BITS;
+  e2 = e1;
+  e1 = (t & ~((1 << DSP_FRACTION_BITS) - 1)) - s;   // Taken before the saturation, so the loop stays stable while clipping
+  return (y > 32767) ? 32767 : ((y < -32768) ? -32768 : y);
+}
+
+DSP_INLINE void Requantizer::tick(sShaper_t &shaper, int32_t &l, int32_t &r)
+{
+  // Two uniform bytes make one triangular value of +-255, that is +-1 LSB
+  uint32_t n = shaper.noise[shaper.next++ % DITHER_BLOCK_FRAMES];
+  int32_t dl = ((int32_t)(n & 0xff) + (int32_t)((n >> 8) & 0xff) - 255) & shaper.ditherMask;
+  int32_t dr = ((int32_t)((n >> 16) & 0xff) + (int32_t)(n >> 24) - 255) & shaper.ditherMask;
+  l = quantize(shaper, l, dl, shaper.e1L, shaper.e2L);
+  r = quantize(shaper, r, dr, shaper.e1R, shaper.e2R);
+}
+
+DSP_INLINE void Requantizer::tick(sShaper_t &shaper, float &l, float &r)
+{
+  int32_t il = (int32_t)(l * (float)(1 << DSP_FRACTION_BITS));
+  int32_t ir = (int32_t)(r * (float)(1 << DSP_FRACTION_BITS));
+  tick(shaper, il, ir);
+  l = (float)il;
+  r = (float)ir;
+}
+
+DSP_INLINE int32_t Requantizer::quantizeWide(const sShaper_t &shaper, int32_t v, int32_t dither, int32_t &e1, int32_t &e2)
+{
+  // v is at most WIDE_FULL_SCALE, the feedback, dither and rounding stay within the 4096 LSBs left below 2^31
+  int32_t s = v - shaper.c1 * e1 - shaper.c2 * e2;
+  int32_t t = (s + dither + shaper.half) & shaper.stepMask;
+  e2 = e1;
+  e1 = t - s;
+  return t;
+}
+
+DSP_INLINE void Requantizer::tickWide(sShaper_t &shaper, int32_t &l, int32_t &r)
+{
+  uint32_t n = shaper.noise[shaper.next++ % DITHER_BLOCK_FRAMES];
+  int32_t dl = ((int32_t)(n & 0xff) + (int32_t)((n >> 8) & 0xff) - 255) & shaper.ditherMask;   // One 24-bit LSB is 256
+  int32_t dr = ((int32_t)((n >> 16) & 0xff) + (int32_t)(n >> 24) - 255) & shaper.ditherMask;
+  const int32_t top = WIDE_FULL_SCALE >> (16 - DSP_FRACTION_BITS);
+  int32_t il = (l > top) ? top : ((l < -top) ? -top : l);
+  int32_t ir = (r > top) ? top : ((r < -top) ? -top : r);
+  l = quantizeWide(shaper, il * (1 << (16 - DSP_FRACTION_BITS)), dl, shaper.e1L, shaper.e2L);
+  r = quantizeWide(shaper, ir * (1 << (16 - DSP_FRACTION_BITS)), dr, shaper.e1R, shaper.e2R);
+}
+
+DSP_INLINE void Requantizer::tickWide(sShaper_t &shaper, float &l, float &r)
+{
+  uint32_t n = shaper.noise[shaper.next++ % DITHER_BLOCK_FRAMES];
+  int32_t dl = ((int32_t)(n & 0xff) + (int32_t)((n >> 8) & 0xff) - 255) & shaper.ditherMask;
+  int32_t dr = ((int32_t)((n >> 16) & 0xff) + (int32_t)(n >> 24) - 255) & shaper.ditherMask;
+  const float top = WIDE_FULL_SCALE * (1.0f / 65536);
+  float fl = (l > top) ? top : ((l < -top) ? -top : l);
+  float fr = (r > top) ? top : ((r < -top) ? -top : r);
+  // The words have no more significant bits than the float samples, so they are exact as float
+  l = (float)quantizeWide(shaper, (int32_t)(fl * 65536.0f), dl, shaper.e1L, shaper.e2L);
+  r = (float)quantizeWide(shaper, (int32_t)(fr * 65536.0f), dr, shaper.e1R, shaper.e2R);
+}
+
+#endif
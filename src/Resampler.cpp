@@ -0,0 +1,252 @@
+/*!
+ * @file  Resampler.cpp
+ * @brief  Define the polyphase sample-rate converter of interleaved stereo pcm_t audio
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "Resampler.h"
+
+#define RESAMPLER_BUF_FRAMES   ((size_t)(RESAMPLER_MAX_TAPS + RESAMPLER_BLOCK_FRAMES))
+
+/**
+ * @struct sResamplerTier_t
+ * @brief The kernel parameters of a quality tier
+ */
+typedef struct
+{
+  uint16_t taps;
+  uint16_t phases;
+  bool interpolate;
+  float cutoff;   // Passband edge relative to the lower Nyquist frequency
+  float beta;   // Kaiser window parameter
+}sResamplerTier_t;
+
+static const sResamplerTier_t _tiers[] = {
+  {  8, 256, false, 0.80f,  5.0f },   // RESAMPLER_QUALITY_LOW
+  { 16,  64, true,  0.88f,  7.0f },   // RESAMPLER_QUALITY_MEDIUM
+  { 32, 128, true,  0.92f,  9.0f },   // RESAMPLER_QUALITY_HIGH
+};
+
+#ifdef PCM_WIDE_SAMPLES
+typedef int64_t acc_t;   // Sums of Q31 samples by Q15 coefficients
+#else
+typedef int32_t acc_t;
+#endif
+
+static inline int16_t saturate16(int32_t x)
+{
+  return (x > 32767) ? 32767 : ((x < -32768) ? -32768 : (int16_t)x);
+}
+
+static inline pcm_t saturatePCM(acc_t x)
+{
+  return (x > PCM_SAMPLE_MAX) ? PCM_SAMPLE_MAX : ((x < PCM_SAMPLE_MIN) ? PCM_SAMPLE_MIN : (pcm_t)x);
+}
+
+/**
+ * @fn besselI0
+ * @brief Modified Bessel function of the first kind, order 0, used by the Kaiser window
+ */
+static double besselI0(double x)
+{
+  double sum = 1.0, term = 1.0;
+  for(int k = 1; k < 32; k++){
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if(term < sum * 1e-12){
+      break;
+    }
+  }
+  return sum;
+}
+
+Resampler::Resampler(void)
+  : _coef(NULL), _taps(0), _phases(0), _interpolate(false), _inRate(0), _outRate(0), _nominalStep(0), _step(0), _pos(0), _fill(0)
+{
+}
+
+Resampler::~Resampler()
+{
+  end();
+}
+
+bool Resampler::begin(uint32_t inRate, uint32_t outRate, uint8_t quality, bool adjustable)
+{
+  end();
+  _inRate = inRate;
+  _outRate = outRate;
+  if(((inRate == outRate) && !adjustable) || (inRate == 0) || (outRate == 0)){
+    return true;
+  }
+  if(quality > RESAMPLER_QUALITY_HIGH){
+    quality = RESAMPLER_QUALITY_HIGH;
+  }
+
+  const sResamplerTier_t &tier = _tiers[quality];
+  _coef = (int16_t *)malloc((tier.phases + 1) * tier.taps * sizeof(int16_t));
+  if(_coef == NULL){
+    return false;
+  }
+  _taps = tier.taps;
+  _phases = tier.phases;
+  _interpolate = tier.interpolate;
+  _nominalStep = ((uint64_t)inRate << 32) / outRate;
+  _step = _nominalStep;
+  design(quality);
+  reset();
+  return true;
+}
+
+void Resampler::end(void)
+{
+  free(_coef);
+  _coef = NULL;
+  _taps = 0;
+  _phases = 0;
+}
+
+void Resampler::reset(void)
+{
+  // Start with half a kernel of silence, so the first output frame is centered on the first source frame
+  _fill = (_taps > 0) ? (_taps / 2 - 1) : 0;
+  memset(_buf, 0, _fill * 2 * sizeof(pcm_t));
+  _pos = 0;
+}
+
+void Resampler::setTrim(float ppm)
+{
+  // 1 ppm of a step near 1.0 is about 4295 in 32.32, far above the float rounding of the product
+  _step = (uint64_t)((int64_t)_nominalStep + (int64_t)(ppm * 1e-6f * (float)_nominalStep));
+}
+
+void Resampler::design(uint8_t quality)
+{
+  const sResamplerTier_t &tier = _tiers[quality];
+  double fc = tier.cutoff;   // Cutoff relative to the source Nyquist frequency
+  if(_outRate < _inRate){
+    fc *= (double)_outRate / _inRate;
+  }
+  double half = _taps / 2.0;
+  double i0Beta = besselI0(tier.beta);
+
+  for(uint16_t p = 0; p <= _phases; p++){
+    double frac = (double)p / _phases;
+    double h[RESAMPLER_MAX_TAPS];
+    double sum = 0.0;
+    for(uint16_t k = 0; k < _taps; k++){
+      double t = (k - (half - 1.0)) - frac;   // Distance from the output position in source frames, |t| <= half
+      double x = M_PI * fc * t;
+      double sinc = (fabs(x) < 1e-9) ? 1.0 : sin(x) / x;
+      double r = t / half;
+      double w = (fabs(r) >= 1.0) ? 0.0 : besselI0(tier.beta * sqrt(1.0 - r * r)) / i0Beta;
+      h[k] = fc * sinc * w;
+      sum += h[k];
+    }
+    // Scale each phase to a DC gain of exactly 1.0 in Q15, the rounding remainder goes to the largest tap
+    int32_t total = 0;
+    uint16_t peak = 0;
+    int16_t *row = _coef + p * _taps;
+    for(uint16_t k = 0; k < _taps; k++){
+      row[k] = (int16_t)lrint(h[k] / sum * 32768.0);
+      total += row[k];
+      if(h[k] > h[peak]){
+        peak = k;
+      }
+    }
+    row[peak] = saturate16(row[peak] + (32768 - total));
+  }
+}
+
+size_t Resampler::process(const pcm_t *in, size_t inFrames, pcm_t *out, size_t outFrames, size_t *consumed)
+{
+  if(_coef == NULL){   // Pass through
+    size_t n = (inFrames < outFrames) ? inFrames : outFrames;
+    memmove(out, in, n * 2 * sizeof(pcm_t));
+    *consumed = n;
+    return n;
+  }
+
+  const uint16_t taps = _taps;
+  size_t produced = 0, used = 0;
+  while(1){
+    while(produced < outFrames){
+      size_t i = (size_t)(_pos >> 32);
+      if(i + taps > _fill){
+        break;
+      }
+      const pcm_t *x = _buf + i * 2;
+      uint64_t scaled = (uint64_t)(uint32_t)_pos * _phases;   // Phase in 32.32 fixed-point
+      acc_t l, r;
+      if(_interpolate){
+        const int16_t *h0 = _coef + (uint32_t)(scaled >> 32) * taps;
+        const int16_t *h1 = h0 + taps;
+        acc_t l0 = 0, r0 = 0, l1 = 0, r1 = 0;
+        for(uint16_t k = 0; k < taps; k++){
+          l0 += (acc_t)x[2 * k] * h0[k];
+          r0 += (acc_t)x[2 * k + 1] * h0[k];
+          l1 += (acc_t)x[2 * k] * h1[k];
+          r1 += (acc_t)x[2 * k + 1] * h1[k];
+        }
+        int32_t a = (int32_t)((uint32_t)scaled >> 17);   // Q15 weight of the second phase
+        l = l0 + (acc_t)(((int64_t)(l1 - (int64_t)l0) * a) >> 15);
+        r = r0 + (acc_t)(((int64_t)(r1 - (int64_t)r0) * a) >> 15);
+      }else{
+        const int16_t *h = _coef + (uint32_t)((scaled + 0x80000000u) >> 32) * taps;
+        l = 0;
+        r = 0;
+        for(uint16_t k = 0; k < taps; k++){
+          l += (acc_t)x[2 * k] * h[k];
+          r += (acc_t)x[2 * k + 1] * h[k];
+        }
+      }
+      out[2 * produced] = saturatePCM((l + (1 << 14)) >> 15);
+      out[2 * produced + 1] = saturatePCM((r + (1 << 14)) >> 15);
+      produced++;
+      _pos += _step;
+    }
+
+    // Drop the frames no longer needed, then top up with source frames
+    size_t i = (size_t)(_pos >> 32);
+    if(i > _fill){
+      i = _fill;
+    }
+    memmove(_buf, _buf + i * 2, (_fill - i) * 2 * sizeof(pcm_t));
+    _fill -= i;
+    _pos -= (uint64_t)i << 32;
+
+    if((produced == outFrames) || (used == inFrames)){
+      break;
+    }
+    size_t n = RESAMPLER_BUF_FRAMES - _fill;
+    if(n > inFrames - used){
+      n = inFrames - used;
+    }
+    memcpy(_buf + _fill * 2, in + used * 2, n * 2 * sizeof(pcm_t));
+    _fill += n;
+    used += n;
+  }
+
+  *consumed = used;
+  return produced;
+}
+
+size_t Resampler::flush(pcm_t *out, size_t outFrames)
+{
+  if(_coef == NULL){   // Nothing held back
+    return 0;
+  }
+  // Half a kernel of silence centers the last output frame on the last source frame, as reset() does for the first one
+  static const pcm_t silence[RESAMPLER_MAX_TAPS] = {0};
+  size_t used;
+  size_t n = process(silence, _taps / 2, out, outFrames, &used);
+  reset();
+  return n;
+}
@@ -0,0 +1,142 @@
+/*!
+ * @file  Resampler.h
+ * @brief  Define the polyphase sample-rate converter of interleaved stereo pcm_t audio
+ * @details  Windowed-sinc (Kaiser) interpolation from any source rate to a fixed output rate, so the I2S clock never changes.
+ * @n        The kernel is stored as a table of phases in Q15, designed once per rate pair, the cutoff follows the
+ * @n        lower of the two rates. The quality tier selects the number of taps, phases and phase interpolation.
+ * @n        An adjustable converter also runs between equal rates, and its ratio can be trimmed by a few hundred ppm
+ * @n        while it runs, so a source clocked a little off the output clock is followed without dropping frames.
+ * @n        With PCM_WIDE_SAMPLES the products of the Q31 samples are summed in int64_t, the output keeps their low bits.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __RESAMPLER_H__
+#define __RESAMPLER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "PCMSample.h"
+
+#define RESAMPLER_QUALITY_LOW      ((uint8_t)(0))   //!< 8 taps, 256 phases, the nearest phase
+#define RESAMPLER_QUALITY_MEDIUM   ((uint8_t)(1))   //!< 16 taps, 64 phases, interpolated between the two nearest phases
+#define RESAMPLER_QUALITY_HIGH     ((uint8_t)(2))   //!< 32 taps, 128 phases, interpolated between the two nearest phases
+
+#define RESAMPLER_MAX_TAPS   ((uint16_t)(32))   //!< The taps of the highest quality tier
+#define RESAMPLER_BLOCK_FRAMES   ((uint16_t)(128))   //!< The number of stereo input frames buffered at a time
+
+class Resampler
+{
+public:
+  /**
+   * @fn Resampler
+   * @brief Constructor, the converter passes the audio through until begin()
+   * @return None
+   */
+  Resampler(void);
+  ~Resampler();
+
+  /**
+   * @fn begin
+   * @brief Design the kernel for a rate pair and clear the history
+   * @param inRate - Sample rate of the source
+   * @param outRate - Sample rate of the output
+   * @param quality - RESAMPLER_QUALITY_LOW, RESAMPLER_QUALITY_MEDIUM or RESAMPLER_QUALITY_HIGH
+   * @param adjustable - true: design the kernel even for equal rates, so the ratio can be trimmed by setTrim()
+   * @return true on success, false when the kernel could not be allocated (the audio is passed through)
+   */
+  bool begin(uint32_t inRate, uint32_t outRate, uint8_t quality=RESAMPLER_QUALITY_MEDIUM, bool adjustable=false);
+
+  /**
+   * @fn end
+   * @brief Release the kernel, the audio is passed through afterwards
+   * @return None
+   */
+  void end(void);
+
+  /**
+   * @fn reset
+   * @brief Clear the history, e.g. before the next track at the same rate
+   * @return None
+   */
+  void reset(void);
+
+  /**
+   * @fn isBypass
+   * @brief Whether the source and the output rate are the same, the caller can skip process() then
+   * @return true when no conversion is needed
+   */
+  bool isBypass(void) const { return _coef == NULL; }
+
+  /**
+   * @fn setTrim
+   * @brief Trim the ratio of the rates, called between two process() calls
+   * @param ppm - Deviation from the nominal ratio in ppm, positive to consume the source faster
+   * @return None
+   */
+  void setTrim(float ppm);
+
+  /**
+   * @fn process
+   * @brief Convert interleaved stereo frames, as many as the output buffer holds
+   * @param in - The source frames
+   * @param inFrames - The number of source frames
+   * @param out - Buffer for the converted frames
+   * @param outFrames - The number of frames the buffer holds
+   * @param consumed - The number of source frames used, call again with the rest
+   * @return The number of converted frames
+   */
+  size_t process(const pcm_t *in, size_t inFrames, pcm_t *out, size_t outFrames, size_t *consumed);
+
+  /**
+   * @fn flush
+   * @brief Convert the source frames still held in the history, as if the source went on in silence, and clear it
+   * @n Called at the end of a source, e.g. before begin() for the next track at another rate, so its tail is not lost
+   * @param out - Buffer for the converted frames, the history holds RESAMPLER_MAX_TAPS / 2 frames of the source at most
+   * @param outFrames - The number of frames the buffer holds
+   * @return The number of converted frames
+   */
+  size_t flush(pcm_t *out, size_t outFrames);
+
+  /**
+   * @fn buffered
+   * @brief Get the source frames taken by process() and not yet passed by the output, part of the latency of the source
+   * @return Source frames ahead of the position of the next output frame, 0 when passing through
+   */
+  float buffered(void) const { return (_coef == NULL) ? 0.0f : ((float)_fill - (float)_pos * (1.0f / 4294967296.0f)); }
+
+  /**
+   * @fn getInRate
+   * @brief Get the sample rate of the source
+   * @return Sample rate of the source
+   */
+  uint32_t getInRate(void) const { return _inRate; }
+
+  /**
+   * @fn getOutRate
+   * @brief Get the sample rate of the output
+   * @return Sample rate of the output
+   */
+  uint32_t getOutRate(void) const { return _outRate; }
+
+protected:
+  void design(uint8_t quality);
+
+  int16_t *_coef;   // (_phases + 1) rows of _taps Q15 coefficients, the last row is the first one shifted by a tap
+  uint16_t _taps;
+  uint16_t _phases;
+  bool _interpolate;
+  uint32_t _inRate;
+  uint32_t _outRate;
+  uint64_t _nominalStep;   // Source frames per output frame of the nominal rates in 32.32 fixed-point
+  uint64_t _step;   // Source frames per output frame in 32.32 fixed-point, trimmed
+  uint64_t _pos;   // Position of the next output frame in _buf in 32.32 fixed-point
+  size_t _fill;   // Frames in _buf
+  pcm_t _buf[(RESAMPLER_MAX_TAPS + RESAMPLER_BLOCK_FRAMES) * 2];   // History and buffered source frames
+};
+
+#endif
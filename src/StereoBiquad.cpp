@@ -0,0 +1,94 @@
+/*!
+ * @file  StereoBiquad.cpp
+ * @brief  Define the stereo biquad filters
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "StereoBiquad.h"
+
+StereoBiquad::StereoBiquad(void)
+{
+  a0 = 1.0;
+  a1 = a2 = b1 = b2 = 0.0;
+  z1[0] = z1[1] = z2[0] = z2[1] = 0.0;
+}
+
+void StereoBiquad::setBiquad(int type, float Fc, float Q, float peakGainDB)
+{
+  sCoef_t coef;
+  calcCoefficients(type, Fc, Q, peakGainDB, coef);
+  setCoefficients(coef);
+  z1[0] = z1[1] = z2[0] = z2[1] = 0.0;
+}
+
+void StereoBiquad::calcCoefficients(int type, float Fc, float Q, float peakGainDB, sCoef_t &coef)
+{
+  float c[5];
+  Biquad::calcCoefficients(type, Fc, Q, peakGainDB, c);
+  coef.a0 = c[0];
+  coef.a1 = c[1];
+  coef.a2 = c[2];
+  coef.b1 = c[3];
+  coef.b2 = c[4];
+}
+
+void StereoBiquad::setCoefficients(const sCoef_t &coef)
+{
+  a0 = coef.a0;
+  a1 = coef.a1;
+  a2 = coef.a2;
+  b1 = coef.b1;
+  b2 = coef.b2;
+}
+
+StereoBiquadFixed::StereoBiquadFixed(void)
+{
+  shift = BIQUAD_FIXED_SHIFT;
+  a0 = (int32_t)1 << BIQUAD_FIXED_SHIFT;
+  a1 = a2 = b1 = b2 = 0;
+  for(int i=0; i<2; i++){
+    x1[i] = x2[i] = y1[i] = y2[i] = 0;
+    e1[i] = e2[i] = 0;
+  }
+}
+
+void StereoBiquadFixed::setBiquad(int type, float Fc, float Q, float peakGainDB)
+{
+  sCoef_t coef;
+  calcCoefficients(type, Fc, Q, peakGainDB, coef);
+  setCoefficients(coef);
+  for(int i=0; i<2; i++){
+    x1[i] = x2[i] = y1[i] = y2[i] = 0;
+    e1[i] = e2[i] = 0;
+  }
+}
+
+void StereoBiquadFixed::calcCoefficients(int type, float Fc, float Q, float peakGainDB, sCoef_t &coef)
+{
+  float f[5];
+  int32_t c[5];
+  Biquad::calcCoefficients(type, Fc, Q, peakGainDB, f);
+  quantizeBiquad(f, c, &coef.shift);
+  coef.a0 = c[0];
+  coef.a1 = c[1];
+  coef.a2 = c[2];
+  coef.b1 = c[3];
+  coef.b2 = c[4];
+}
+
+void StereoBiquadFixed::setCoefficients(const sCoef_t &coef)
+{
+  a0 = coef.a0;
+  a1 = coef.a1;
+  a2 = coef.a2;
+  b1 = coef.b1;
+  b2 = coef.b2;
+  if(shift != coef.shift){   // The truncation errors are relative to the old scale
+    e1[0] = e1[1] = e2[0] = e2[1] = 0;
+  }
+  shift = coef.shift;
+}
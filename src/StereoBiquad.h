@@ -0,0 +1,183 @@
+/*!
+ * @file  StereoBiquad.h
+ * @brief  Define the stereo biquad filters
+ * @details  One set of coefficients is shared by the left and right channels, the state of the two channels is kept side by side,
+ * @n        so one tick() updates both channels. The processing chains run every stage frame by frame, see DSPChain.h.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __STEREO_BIQUAD_H__
+#define __STEREO_BIQUAD_H__
+
+#include "Biquad.h"
+#include "BiquadFixed.h"
+
+class StereoBiquad
+{
+public:
+  /**
+   * @struct sCoef_t
+   * @brief The coefficients of the filter, calculated apart from the filter so that they can be handed over to the audio task
+   */
+  typedef struct
+  {
+    float a0, a1, a2, b1, b2;
+  }sCoef_t;
+
+  /**
+   * @fn StereoBiquad
+   * @brief Constructor, the filter passes the data through unchanged until it is set
+   * @return None
+   */
+  StereoBiquad(void);
+
+  /**
+   * @fn calcCoefficients
+   * @brief Calculate the coefficients of a filter
+   * @param type - Filter type select, as the enumerated type in Biquad.h
+   * @param Fc - Ratio of filter threshold to sampling frequency, range: 0.0-0.5
+   * @param Q - Filter coefficient
+   * @param peakGainDB - Peak gain. It is required in some filter modes
+   * @param coef - The calculated coefficients
+   * @return None
+   */
+  static void calcCoefficients(int type, float Fc, float Q, float peakGainDB, sCoef_t &coef);
+
+  /**
+   * @fn setCoefficients
+   * @brief Replace the coefficients, the state of both channels is kept so the change does not click
+   * @param coef - The new coefficients
+   * @return None
+   */
+  void setCoefficients(const sCoef_t &coef);
+
+  /**
+   * @fn setBiquad
+   * @brief Set all the parameters of the filter and clear the state of both channels
+   * @param type - Filter type select, as the enumerated type in Biquad.h
+   * @param Fc - Ratio of filter threshold to sampling frequency, range: 0.0-0.5
+   * @param Q - Filter coefficient
+   * @param peakGainDB - Peak gain. It is required in some filter modes
+   * @return None
+   */
+  void setBiquad(int type, float Fc, float Q, float peakGainDB);
+
+  /**
+   * @fn tick
+   * @brief Process one stereo frame, for processing chains which run all their stages frame by frame
+   * @param l - The left sample, overwritten by the processed sample
+   * @param r - The right sample, overwritten by the processed sample
+   * @return None
+   */
+  void tick(float &l, float &r);
+
+protected:
+  float a0, a1, a2, b1, b2;
+  float z1[2], z2[2];   // State of the left and right channels side by side
+};
+
+class StereoBiquadFixed
+{
+public:
+  /**
+   * @struct sCoef_t
+   * @brief The coefficients of the filter, calculated apart from the filter so that they can be handed over to the audio task
+   */
+  typedef struct
+  {
+    int32_t a0, a1, a2, b1, b2;   // Coefficients scaled by 2^shift
+    int shift;
+  }sCoef_t;
+
+  /**
+   * @fn StereoBiquadFixed
+   * @brief Constructor, the filter passes the data through unchanged until it is set
+   * @return None
+   */
+  StereoBiquadFixed(void);
+
+  /**
+   * @fn calcCoefficients
+   * @brief Calculate the coefficients of a filter
+   * @param type - Filter type select, as the enumerated type in Biquad.h
+   * @param Fc - Ratio of filter threshold to sampling frequency, range: 0.0-0.5
+   * @param Q - Filter coefficient
+   * @param peakGainDB - Peak gain. It is required in some filter modes
+   * @param coef - The calculated coefficients
+   * @return None
+   */
+  static void calcCoefficients(int type, float Fc, float Q, float peakGainDB, sCoef_t &coef);
+
+  /**
+   * @fn setCoefficients
+   * @brief Replace the coefficients, the state of both channels is kept so the change does not click
+   * @param coef - The new coefficients
+   * @return None
+   */
+  void setCoefficients(const sCoef_t &coef);
+
+  /**
+   * @fn setBiquad
+   * @brief Set all the parameters of the filter and clear the state of both channels
+   * @param type - Filter type select, as the enumerated type in Biquad.h
+   * @param Fc - Ratio of filter threshold to sampling frequency, range: 0.0-0.5
+   * @param Q - Filter coefficient
+   * @param peakGainDB - Peak gain. It is required in some filter modes
+   * @return None
+   */
+  void setBiquad(int type, float Fc, float Q, float peakGainDB);
+
+  /**
+   * @fn tick
+   * @brief Process one stereo frame, for processing chains which run all their stages frame by frame
+   * @param l - The left sample, overwritten by the processed sample
+   * @param r - The right sample, overwritten by the processed sample
+   * @return None
+   */
+  void tick(int32_t &l, int32_t &r);
+
+protected:
+  int32_t a0, a1, a2, b1, b2;   // Coefficients scaled by 2^shift
+  int shift;
+  int32_t x1[2], x2[2], y1[2], y2[2];   // State of the left and right channels side by side
+  int64_t e1[2], e2[2];
+};
+
+DSP_INLINE void StereoBiquad::tick(float &l, float &r) {
+  float yL = l * a0 + z1[0];
+  float yR = r * a0 + z1[1];
+  z1[0] = l * a1 + z2[0] - b1 * yL;
+  z1[1] = r * a1 + z2[1] - b1 * yR;
+  z2[0] = l * a2 - b2 * yL;
+  z2[1] = r * a2 - b2 * yR;
+  l = yL;
+  r = yR;
+}
+
+DSP_INLINE void StereoBiquadFixed::tick(int32_t &l, int32_t &r) {
+  const int64_t mask = ((int64_t)1 << shift) - 1;
+  int64_t accL = 2 * e1[0] - e2[0] + (int64_t)a0 * l + (int64_t)a1 * x1[0] + (int64_t)a2 * x2[0]
+                                   - (int64_t)b1 * y1[0] - (int64_t)b2 * y2[0];
+  int64_t accR = 2 * e1[1] - e2[1] + (int64_t)a0 * r + (int64_t)a1 * x1[1] + (int64_t)a2 * x2[1]
+                                   - (int64_t)b1 * y1[1] - (int64_t)b2 * y2[1];
+  e2[0] = e1[0];
+  e2[1] = e1[1];
+  e1[0] = accL & mask;
+  e1[1] = accR & mask;
+  x2[0] = x1[0];
+  x2[1] = x1[1];
+  x1[0] = l;
+  x1[1] = r;
+  y2[0] = y1[0];
+  y2[1] = y1[1];
+  y1[0] = (int32_t)(accL >> shift);
+  y1[1] = (int32_t)(accR >> shift);
+  l = y1[0];
+  r = y1[1];
+}
+
+#endif
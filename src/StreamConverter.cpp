@@ -0,0 +1,84 @@
+/*!
+ * @file  StreamConverter.cpp
+ * @brief  Define the conversion of a streamed source from the PCM buffer to the output rate, following the drift of its clock
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include "StreamConverter.h"
+
+StreamConverter::StreamConverter(void)
+{
+}
+
+bool StreamConverter::begin(uint32_t inRate, uint32_t outRate, uint8_t quality, size_t latency)
+{
+  _drift.end();
+  if(!_resampler.begin(inRate, outRate, quality, latency > 0)){   // Only an adjustable converter runs between equal rates
+    return false;
+  }
+  if((latency > 0) && !_resampler.isBypass()){
+    _drift.begin(outRate, latency);
+  }
+  return true;
+}
+
+void StreamConverter::end(void)
+{
+  _drift.end();
+  _resampler.end();
+}
+
+size_t StreamConverter::getPrefill(void) const
+{
+  return _drift.isActive() ? sourceBytes(_drift.getTarget()) : 0;
+}
+
+size_t StreamConverter::sourceBytes(size_t frames) const
+{
+  if(_resampler.isBypass()){
+    return frames * PCM_FRAME_BYTES;
+  }
+  uint64_t in = ((uint64_t)frames * _resampler.getInRate() + _resampler.getOutRate() - 1) / _resampler.getOutRate();
+  return (size_t)in * PCM_FRAME_BYTES;
+}
+
+size_t StreamConverter::read(PCMRingBuffer &buffer, pcm_t *out, size_t frames)
+{
+  size_t produced = 0;
+  while(produced < frames){
+    size_t len = buffer.available() & ~(PCM_FRAME_BYTES - 1);
+    if(len == 0){
+      break;
+    }
+    uint8_t *first, *second;
+    size_t firstLen;
+    buffer.peek(len, &first, &firstLen, &second);   // The part up to the end of the storage, the rest in the next turn
+    size_t used;
+    size_t n = _resampler.process((const pcm_t *)first, firstLen / PCM_FRAME_BYTES, out + 2 * produced, frames - produced, &used);
+    buffer.skip(used * PCM_FRAME_BYTES);
+    produced += n;
+    if((n == 0) && (used == 0)){
+      break;
+    }
+  }
+  return produced;
+}
+
+void StreamConverter::update(const PCMRingBuffer &buffer, size_t frames, bool playing)
+{
+  if(!_drift.isActive()){
+    return;
+  }
+  if(!playing){
+    _drift.restart();
+    return;
+  }
+  // The time the frames of the stream last at the output, those in the buffer and those held by the converter
+  float source = (float)(buffer.available() / PCM_FRAME_BYTES) + _resampler.buffered();
+  float fill = source * (float)_resampler.getOutRate() / (float)_resampler.getInRate();
+  _resampler.setTrim(_drift.update((size_t)(fill + 0.5f), frames));
+}
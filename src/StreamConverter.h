@@ -0,0 +1,109 @@
+/*!
+ * @file  StreamConverter.h
+ * @brief  Define the conversion of a streamed source from the PCM buffer to the output rate, following the drift of its clock
+ * @details  The producer, e.g. the A2DP data callback, only copies the frames of the stream at their own rate into the PCM
+ * @n        buffer. The consumer, the output task, converts them as it drains the buffer, so the filter runs next to the
+ * @n        rest of the processing and the producer never waits for it. With drift compensation the fill level of the
+ * @n        buffer, plus the frames held by the converter, is taken after every block of output and DriftController trims
+ * @n        the ratio of the conversion, so the latency stays at its target. Without it, a stream at the output rate is
+ * @n        passed through. All functions are called by the consumer, except getDrift().
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __STREAM_CONVERTER_H__
+#define __STREAM_CONVERTER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "PCMRingBuffer.h"
+#include "Resampler.h"
+#include "DriftController.h"
+
+class StreamConverter
+{
+public:
+  /**
+   * @fn StreamConverter
+   * @brief Constructor, the stream is passed through until begin()
+   * @return None
+   */
+  StreamConverter(void);
+
+  /**
+   * @fn begin
+   * @brief Set up the conversion of a new stream, the history and the drift estimate start from scratch
+   * @param inRate - Sample rate of the stream
+   * @param outRate - Sample rate of the output
+   * @param quality - RESAMPLER_QUALITY_LOW, RESAMPLER_QUALITY_MEDIUM or RESAMPLER_QUALITY_HIGH
+   * @param latency - The fill level (stereo frames at the output rate) to keep, 0 for no drift compensation
+   * @return true on success, false when the converter could not be allocated (the stream is passed through)
+   */
+  bool begin(uint32_t inRate, uint32_t outRate, uint8_t quality, size_t latency);
+
+  /**
+   * @fn end
+   * @brief Pass the stream through from now on, without drift compensation
+   * @return None
+   */
+  void end(void);
+
+  /**
+   * @fn isBypass
+   * @brief Whether the stream is passed through, the consumer reads the PCM buffer itself then
+   * @return true when the stream is at the output rate and its drift is not compensated
+   */
+  bool isBypass(void) const { return _resampler.isBypass(); }
+
+  /**
+   * @fn getPrefill
+   * @brief Get the fill level the output waits for before it starts, the target of the drift compensation
+   * @return Bytes of the stream in the PCM buffer, 0 without drift compensation
+   */
+  size_t getPrefill(void) const;
+
+  /**
+   * @fn sourceBytes
+   * @brief Get the bytes of the stream converted into a number of output frames
+   * @param frames - Stereo frames at the output rate
+   * @return Bytes of the stream, rounded up to whole frames
+   */
+  size_t sourceBytes(size_t frames) const;
+
+  /**
+   * @fn read
+   * @brief Convert the frames of the stream in the PCM buffer to the output rate
+   * @param buffer - The PCM buffer the producer writes the stream to
+   * @param out - Buffer for the converted interleaved stereo frames
+   * @param frames - The stereo frames wanted
+   * @return The stereo frames converted, less than frames when the buffer runs dry
+   */
+  size_t read(PCMRingBuffer &buffer, pcm_t *out, size_t frames);
+
+  /**
+   * @fn update
+   * @brief Take the fill level after a block of output and trim the ratio of the conversion
+   * @param buffer - The PCM buffer the producer writes the stream to
+   * @param frames - The stereo frames output since the last update, the time passed at the output rate
+   * @param playing - Whether the output drains the buffer at its clock, the fill level does not tell the drift otherwise
+   * @return None
+   */
+  void update(const PCMRingBuffer &buffer, size_t frames, bool playing);
+
+  /**
+   * @fn getDrift
+   * @brief Get the estimated drift of the stream, may be called by any task
+   * @return How much faster the clock of the stream runs than the output clock, in ppm
+   */
+  float getDrift(void) const { return _drift.getDrift(); }
+
+protected:
+  Resampler _resampler;
+  DriftController _drift;   // Active with drift compensation, its fill levels are in frames at the output rate
+};
+
+#endif
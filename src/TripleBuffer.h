@@ -0,0 +1,69 @@
+/*!
+ * @file  TripleBuffer.h
+ * @brief  Define the lock-free buffer publishing a value (e.g. a set of filter coefficients) from one task to another
+ * @details  The writer fills its back slot and publishes it with one atomic exchange, the reader picks up the latest
+ * @n        published slot with another exchange at a point it chooses (e.g. a block boundary). The two sides never
+ * @n        touch the same slot at the same time, so the reader can not see a half written value, and neither side waits.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __TRIPLE_BUFFER_H__
+#define __TRIPLE_BUFFER_H__
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T>
+class TripleBuffer
+{
+public:
+  TripleBuffer(void) : _back(0), _front(1), _middle(2) {}
+
+  /**
+   * @fn write
+   * @brief Copy a value into the back slot and publish it, only called by the writer
+   * @param value - The value to be published
+   * @return None
+   */
+  void write(const T &value)
+  {
+    _buf[_back] = value;
+    _back = _middle.exchange(_back | DIRTY, std::memory_order_acq_rel) & INDEX;
+  }
+
+  /**
+   * @fn update
+   * @brief Pick up the latest published value, only called by the reader
+   * @return true when a new value was published since the last update, false when front() is unchanged
+   */
+  bool update(void)
+  {
+    if(!(_middle.load(std::memory_order_relaxed) & DIRTY)){
+      return false;
+    }
+    _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+
+  /**
+   * @fn front
+   * @brief Get the value picked up by the last update(), only called by the reader
+   * @return The reference of the value
+   */
+  const T & front(void) const { return _buf[_front]; }
+
+protected:
+  static const uint8_t INDEX = 0x03;
+  static const uint8_t DIRTY = 0x04;
+
+  T _buf[3];
+  uint8_t _back;   // Slot owned by the writer
+  uint8_t _front;   // Slot owned by the reader
+  std::atomic<uint8_t> _middle;   // Slot exchanged between the two sides, with the dirty flag
+};
+
+#endif
@@ -0,0 +1,217 @@
+/*!
+ * @file  WavParser.cpp
+ * @brief  Define the incremental parser of the WAV (RIFF/WAVE) header
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <string.h>
+
+#include "WavParser.h"
+
+static inline uint16_t readLE16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t readLE32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+WavParser::WavParser(void)
+{
+  reset();
+}
+
+void WavParser::reset(void)
+{
+  _state = eStateRiff;
+  _need = 12;
+  _have = 0;
+  _offset = 0;
+  _chunkSize = 0;
+  _skip = 0;
+  _haveFmt = false;
+  memset(&_format, 0, sizeof(_format));
+  _error = NULL;
+}
+
+WavParser::eWavResult_t WavParser::fail(const char *error)
+{
+  _state = eStateError;
+  _error = error;
+  return eWavError;
+}
+
+WavParser::eWavResult_t WavParser::parse(const uint8_t *data, size_t len, size_t *consumed)
+{
+  size_t used = 0;
+  eWavResult_t ret = eWavNeedMore;
+
+  while((ret == eWavNeedMore) && (_state != eStateDone) && (_state != eStateError)){
+    // Gather the bytes of the current header
+    size_t n = _need - _have;
+    if(n > len - used){
+      n = len - used;
+    }
+    memcpy(_buf + _have, data + used, n);
+    _have += n;
+    used += n;
+    _offset += n;
+    if(_have < _need){
+      break;
+    }
+    _have = 0;
+
+    switch(_state){
+      case eStateRiff:
+        if(memcmp(_buf, "RIFF", 4) || memcmp(_buf + 8, "WAVE", 4)){
+          ret = fail("RIFF/WAVE descriptor not found");
+          break;
+        }
+        _state = eStateChunk;
+        _need = 8;
+        break;
+
+      case eStateChunk:
+        _chunkSize = readLE32(_buf + 4);
+        if(!memcmp(_buf, "fmt ", 4)){
+          if(_chunkSize < 16){
+            ret = fail("fmt chunk too short");
+            break;
+          }
+          _state = eStateFmt;
+          _need = (_chunkSize < sizeof(_buf)) ? _chunkSize : sizeof(_buf);
+        }else if(!memcmp(_buf, "data", 4)){
+          if(!_haveFmt){
+            ret = fail("data chunk before fmt chunk");
+            break;
+          }
+          _format.dataOffset = _offset;
+          _format.dataSize = _chunkSize;
+          _state = eStateDone;
+          ret = eWavData;
+        }else{   // Skip the whole chunk, including the pad byte of odd sizes
+          _skip = _chunkSize + (_chunkSize & 1);
+          _offset += _skip;
+          _need = 8;
+          ret = eWavSkip;
+        }
+        break;
+
+      case eStateFmt:
+        ret = parseFmt();
+        if(ret == eWavError){
+          break;
+        }
+        _skip = _chunkSize + (_chunkSize & 1) - _need;   // Unread part of a long fmt chunk and the pad byte
+        if(_skip){
+          _offset += _skip;
+          ret = eWavSkip;
+        }
+        _state = eStateChunk;
+        _need = 8;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  *consumed = used;
+  return ret;
+}
+
+WavParser::eWavResult_t WavParser::parseFmt(void)
+{
+  uint16_t formatTag = readLE16(_buf);
+  _format.numChannels = readLE16(_buf + 2);
+  _format.sampleRate = readLE32(_buf + 4);
+  _format.bytesPerSecond = readLE32(_buf + 8);
+  _format.blockAlign = readLE16(_buf + 12);
+  _format.bitsPerSample = readLE16(_buf + 14);
+  _format.validBits = _format.bitsPerSample;
+
+  if(formatTag == WAV_FORMAT_EXTENSIBLE){
+    if(_chunkSize < 40){
+      return fail("WAVE_FORMAT_EXTENSIBLE fmt chunk too short");
+    }
+    uint16_t validBits = readLE16(_buf + 18);
+    if(validBits){
+      _format.validBits = validBits;
+    }
+    formatTag = readLE16(_buf + 24);   // The first two bytes of the sub-format GUID
+  }
+  _format.formatTag = formatTag;
+
+  if((formatTag != WAV_FORMAT_PCM) && (formatTag != WAV_FORMAT_IEEE_FLOAT)){
+    return fail("compressed format not supported");
+  }
+  if((_format.numChannels < 1) || (_format.numChannels > 2)){
+    return fail("only mono and stereo supported");
+  }
+  if(formatTag == WAV_FORMAT_IEEE_FLOAT){
+    if(_format.bitsPerSample != 32){
+      return fail("only 32-bit float supported");
+    }
+  }else if((_format.bitsPerSample != 8) && (_format.bitsPerSample != 16) &&
+           (_format.bitsPerSample != 24) && (_format.bitsPerSample != 32)){
+    return fail("bits per sample not supported");
+  }
+  if(_format.blockAlign != _format.numChannels * (_format.bitsPerSample / 8)){
+    return fail("block align does not match the format");
+  }
+  if(_format.sampleRate == 0){
+    return fail("invalid sample rate");
+  }
+  _haveFmt = true;
+  return eWavNeedMore;
+}
+
+bool WavParser::parseFile(FILE *fp)
+{
+  uint8_t header[WAV_HEADER_READ_SIZE];
+  size_t len = 0, pos = 0;
+
+  reset();
+  while(1){
+    if(pos == len){
+      len = fread(header, 1, sizeof(header), fp);
+      pos = 0;
+      if(len == 0){
+        fail("unexpected end of WAV header");
+        return false;
+      }
+    }
+    size_t used;
+    eWavResult_t ret = parse(header + pos, len - pos, &used);
+    pos += used;
+    switch(ret){
+      case eWavSkip:
+        if(_skip <= len - pos){   // Still in the bytes already read
+          pos += _skip;
+        }else{   // One seek over the rest of the chunk
+          if(fseek(fp, (long)(_skip - (len - pos)), SEEK_CUR)){
+            fail("unable to skip WAV chunk");
+            return false;
+          }
+          len = pos = 0;
+        }
+        break;
+      case eWavData:
+        if(fseek(fp, (long)_format.dataOffset, SEEK_SET)){   // Rewind over the samples read with the header
+          fail("unable to seek to WAV data");
+          return false;
+        }
+        return true;
+      case eWavError:
+        return false;
+      default:
+        break;
+    }
+  }
+}
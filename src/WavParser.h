@@ -0,0 +1,138 @@
+/*!
+ * @file  WavParser.h
+ * @brief  Define the incremental parser of the WAV (RIFF/WAVE) header
+ * @details  The parser is fed with whatever bytes the caller has read and walks the chunks one by one. Unknown chunks
+ * @n        (LIST, id3, cue, ...) are not read, the parser asks the caller to skip each of them with one seek,
+ * @n        so the time to the first sample does not depend on the amount of metadata before the data chunk.
+ * @n        PCM 8/16/24/32-bit integer, 32-bit float, mono and stereo are recognized, also in WAVE_FORMAT_EXTENSIBLE.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __WAV_PARSER_H__
+#define __WAV_PARSER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define WAV_FORMAT_PCM          ((uint16_t)(0x0001))   //!< Integer PCM
+#define WAV_FORMAT_IEEE_FLOAT   ((uint16_t)(0x0003))   //!< Float PCM
+#define WAV_HEADER_READ_SIZE   ((size_t)(64))   //!< The size of each read of parseFile() while walking the chunks
+
+#define WAV_FORMAT_EXTENSIBLE   ((uint16_t)(0xFFFE))   //!< The real format is in the sub-format GUID
+
+/**
+ * @struct sWavFormat_t
+ * @brief The format of the audio data in WAV format
+ */
+typedef struct
+{
+  uint16_t formatTag;   // WAV_FORMAT_PCM or WAV_FORMAT_IEEE_FLOAT, the sub-format of WAVE_FORMAT_EXTENSIBLE is resolved
+  uint16_t numChannels;
+  uint32_t sampleRate;
+  uint32_t bytesPerSecond;
+  uint16_t blockAlign;   // Bytes of one frame of all the channels
+  uint16_t bitsPerSample;   // Container size of one sample: 8, 16, 24 or 32
+  uint16_t validBits;   // Significant bits of one sample, the same as bitsPerSample unless given by WAVE_FORMAT_EXTENSIBLE
+  uint32_t dataOffset;   // File offset of the first sample
+  uint32_t dataSize;   // Byte length of the data chunk, 0xFFFFFFFF when unknown (e.g. written by a stream)
+}sWavFormat_t;
+
+class WavParser
+{
+public:
+  /**
+   * @enum eWavResult_t
+   * @brief What the caller should do after parse()
+   */
+  typedef enum
+  {
+    eWavNeedMore = 0,   // Read more bytes and call parse() again
+    eWavSkip,   // Skip getSkip() bytes after the consumed ones (e.g. seek), then call parse() again
+    eWavData,   // The header is complete, getFormat() tells where the samples are
+    eWavError,   // Not a supported WAV file
+  }eWavResult_t;
+
+  /**
+   * @fn WavParser
+   * @brief Constructor
+   * @return None
+   */
+  WavParser(void);
+
+  /**
+   * @fn reset
+   * @brief Start parsing a new file
+   * @return None
+   */
+  void reset(void);
+
+  /**
+   * @fn parse
+   * @brief Feed the parser with the next bytes of the file
+   * @param data - The bytes following the ones consumed before (and the skipped ones)
+   * @param len - Byte length of data
+   * @param consumed - The number of bytes used by the parser, the rest should be fed again after acting on the result
+   * @return What the caller should do next, see eWavResult_t
+   */
+  eWavResult_t parse(const uint8_t *data, size_t len, size_t *consumed);
+
+  /**
+   * @fn parseFile
+   * @brief Parse the header of an opened file, reading it in small pieces and seeking over the unknown chunks
+   * @param fp - The opened file, read from its start, it is left at the first sample on success
+   * @return true on success, false on error (see getError())
+   */
+  bool parseFile(FILE *fp);
+
+  /**
+   * @fn getSkip
+   * @brief Get the number of bytes to be skipped after eWavSkip
+   * @return Byte length to be skipped
+   */
+  uint32_t getSkip(void) const { return _skip; }
+
+  /**
+   * @fn getFormat
+   * @brief Get the parsed format, valid after eWavData
+   * @return The format of the audio data
+   */
+  const sWavFormat_t & getFormat(void) const { return _format; }
+
+  /**
+   * @fn getError
+   * @brief Get the reason of eWavError
+   * @return Description of the error
+   */
+  const char * getError(void) const { return _error; }
+
+protected:
+  typedef enum
+  {
+    eStateRiff = 0,   // "RIFF" size "WAVE"
+    eStateChunk,   // Chunk ID and size
+    eStateFmt,   // Body of the fmt chunk
+    eStateDone,
+    eStateError,
+  }eState_t;
+
+  eWavResult_t fail(const char *error);
+  eWavResult_t parseFmt(void);
+
+  eState_t _state;
+  uint8_t _buf[40];   // Bytes gathered for the current header, the longest is the fmt chunk of WAVE_FORMAT_EXTENSIBLE
+  size_t _need;   // Bytes the current header needs
+  size_t _have;   // Bytes gathered in _buf
+  uint32_t _offset;   // File offset of the next byte to be fed
+  uint32_t _chunkSize;   // Size of the current chunk
+  uint32_t _skip;
+  bool _haveFmt;
+  sWavFormat_t _format;
+  const char *_error;
+};
+
+#endif
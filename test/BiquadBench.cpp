@@ -0,0 +1,122 @@
+/*!
+ * @file  BiquadBench.cpp
+ * @brief  Compare the fused filter chain of the output task with the per-sample filter path it replaced
+ * @details  The old filterToWork() ran every sample of each channel through three low-pass and then three high-pass
+ * @n        mono Biquad::process() calls, twelve calls per stereo frame. The output task runs the low-pass and high-pass
+ * @n        FilterCascade as stages of one DSPChain, both channels per tick(), with the state of all stages in a local
+ * @n        copy for the block. Both run the same coefficients over the same noise: the outputs must agree, and the fused
+ * @n        chain must be faster. The JSON document gives the ns per stereo frame.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define BENCH_FRAMES   4096   // Frames per block
+#define BENCH_REPEAT   200   // Blocks per case
+#define BASELINE_STAGES   3   // Mono biquads per filter and channel in filterToWork(), NUMBER_OF_FILTER
+#define SPEEDUP_MIN   (1.3)   // The fused chain against the per-sample path
+
+typedef FilterCascade<StereoBiquad, 2 * BASELINE_STAGES> LowPass_t;   // Three second-order stages, as the old filter
+typedef FilterCascade<StereoBiquad, 2 * BASELINE_STAGES> HighPass_t;
+typedef DSPChain<ChainCascade<LowPass_t>, ChainCascade<HighPass_t> > filterChain_t;
+
+static int16_t noise[BENCH_FRAMES * 2];
+static int16_t outBaseline[BENCH_FRAMES * 2];
+static float outFused[BENCH_FRAMES * 2];
+
+/**
+ * A mono biquad of the old filter path, set to a stage of the cascade
+ */
+class BaselineBiquad : public Biquad
+{
+public:
+  void setCoefficients(const StereoBiquad::sCoef_t &c)
+  {
+    a0 = c.a0;
+    a1 = c.a1;
+    a2 = c.a2;
+    b1 = c.b1;
+    b2 = c.b2;
+    z1 = z2 = 0;
+  }
+};
+
+/**
+ * filterToWork() of the old output loop, one sample through the low-pass and then the high-pass stages
+ */
+static int16_t filterToWork(BaselineBiquad *filterHP, BaselineBiquad *filterLP, float rawData)
+{
+  for(int i=0; i<BASELINE_STAGES; i++){
+    rawData = filterLP[i].process(rawData);
+  }
+  for(int i=0; i<BASELINE_STAGES; i++){
+    rawData = filterHP[i].process(rawData);
+  }
+  return (int16_t)((rawData > 32767.0f) ? 32767.0f : ((rawData < -32767.0f) ? -32767.0f : rawData));
+}
+
+int main(void)
+{
+  uint32_t state = 2463534242u;
+  for(int i=0; i<BENCH_FRAMES * 2; i++){
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    noise[i] = (int16_t)((int32_t)state >> 18);   // -12 dBFS, the filters do not clip
+  }
+
+  StereoBiquad::sCoef_t lp[LowPass_t::STAGES], hp[HighPass_t::STAGES];
+  LowPass_t::design(bq_type_lowpass, 15000.0f / 44100, lp);
+  HighPass_t::design(bq_type_highpass, 50.0f / 44100, hp);
+  BaselineBiquad baseline[2][2][BASELINE_STAGES];   // Channel, low-pass or high-pass, stage
+  for(int ch=0; ch<2; ch++){
+    for(int i=0; i<BASELINE_STAGES; i++){
+      baseline[ch][0][i].setCoefficients(lp[i]);
+      baseline[ch][1][i].setCoefficients(hp[i]);
+    }
+  }
+  LowPass_t lowPass;
+  HighPass_t highPass;
+  lowPass.setCoefficients(lp);
+  highPass.setCoefficients(hp);
+  filterChain_t fused((ChainCascade<LowPass_t>(&lowPass)), (ChainCascade<HighPass_t>(&highPass)));
+
+  benchBegin("BiquadBench");
+  uint64_t start = hostNanos(), cycles = hostCycles();
+  for(int r=0; r<BENCH_REPEAT; r++){
+    for(int i=0; i<BENCH_FRAMES; i++){
+      outBaseline[2 * i] = filterToWork(baseline[0][1], baseline[0][0], noise[2 * i]);
+      outBaseline[2 * i + 1] = filterToWork(baseline[1][1], baseline[1][0], noise[2 * i + 1]);
+    }
+    __asm__ __volatile__("" : : "r"(outBaseline) : "memory");   // Keep every block, only the last one is read
+  }
+  uint64_t nsBaseline = hostNanos() - start;
+  benchResult("filterToWork_per_sample", (uint64_t)BENCH_REPEAT * BENCH_FRAMES, nsBaseline, hostCycles() - cycles);
+
+  start = hostNanos();
+  cycles = hostCycles();
+  for(int r=0; r<BENCH_REPEAT; r++){
+    fused.process<float>(noise, outFused, BENCH_FRAMES, 0);
+    __asm__ __volatile__("" : : "r"(outFused) : "memory");
+  }
+  uint64_t nsFused = hostNanos() - start;
+  benchResult("fused_chain", (uint64_t)BENCH_REPEAT * BENCH_FRAMES, nsFused, hostCycles() - cycles);
+  benchEnd();
+
+  // The last blocks ran on the same state, the old path truncates to int16_t
+  float error = 0;
+  for(int i=0; i<BENCH_FRAMES * 2; i++){
+    float e = fabsf(outBaseline[i] - outFused[i]);
+    error = (e > error) ? e : error;
+  }
+  double speedup = (double)nsBaseline / nsFused;
+  printf("fused chain: %.2f times as fast as the per-sample path, %.3f LSB apart\n", speedup, error);
+  CHECK(error <= 1.0f, "the fused chain is %.3f LSB off the per-sample path", error);
+  CHECK(speedup > SPEEDUP_MIN, "the fused chain is only %.2f times as fast as the per-sample path", speedup);
+  return hostTestResult("BiquadBench");
+}
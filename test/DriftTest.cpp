@@ -0,0 +1,162 @@
+/*!
+ * @file  DriftTest.cpp
+ * @brief  Simulate a Bluetooth stream whose clock runs 200 ppm off the output clock, and bound the latency of the PCM buffer
+ * @details  The producer writes packets of the stream into a PCMRingBuffer at its own clock, with the burst jitter of a
+ * @n        Bluetooth link, and the consumer drains it one DMA buffer at a time at the output clock through a
+ * @n        StreamConverter, as the A2DP callback and the output task do, on simulated time. Ten minutes are run. With
+ * @n        drift compensation the latency must stay near its target from the start, settle on it, with no underrun
+ * @n        or overrun, and the drift estimate must settle on the offset of the clocks. Without it a stream at the
+ * @n        output rate is passed through unconverted, and its latency grows with the drift.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <string.h>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define OUT_RATE   ((uint32_t)(44100))
+#define SIM_SECONDS   (600.0)
+#define PACKET_FRAMES   ((size_t)(512))   // Stereo frames of the stream per packet
+#define JITTER_MS   (20.0)   // A packet arrives up to this late, packets are never reordered
+#define LATENCY_MS   (40.0)   // The fill level kept, JITTER_LATENCY_MS
+#define WINDOW_SECONDS   (10.0)   // The latency is averaged over time in windows, the packets and blocks move it within each
+#define BOUND_MS   (5.0)   // The average stays this close to its target from the first window on
+#define SETTLED_MS   (2.0)   // And moves by less than this in the second half of the run
+#define DRIFT_TOLERANCE_PPM   (10.0)   // The drift estimate at the end of the run
+#define UNCOMPENSATED_GROWTH_MS   (40.0)   // 200 ppm for ten minutes is 120 ms, until the buffer is full
+
+typedef struct
+{
+  double minMs, maxMs;   // The average latency of the windows from the start of the output on
+  double settledMinMs, settledMaxMs;   // In the second half of the run
+  uint32_t underruns;   // Blocks short of frames after the start
+  uint32_t overruns;   // Packets dropped, the buffer was full
+  float drift;   // The estimate at the end
+}sSimResult_t;
+
+/**
+ * Run the producer and the consumer on simulated time
+ */
+static sSimResult_t simulate(uint32_t inRate, double ppm, bool compensate)
+{
+  PCMRingBuffer buffer;
+  buffer.begin(PCM_BUFFER_SIZE);
+  StreamConverter converter;
+  converter.begin(inRate, OUT_RATE, RESAMPLER_QUALITY_MEDIUM, compensate ? (size_t)(OUT_RATE * LATENCY_MS / 1000) : 0);
+  size_t prefill = converter.getPrefill() ? converter.getPrefill() : OUTPUT_PREFILL_SIZE;
+  size_t need = converter.sourceBytes(I2S_DMA_BUF_LEN);
+
+  static int16_t packet[PACKET_FRAMES * 2];
+  static int16_t out[I2S_DMA_BUF_LEN * 2];
+  for(size_t i=0; i<PACKET_FRAMES; i++){
+    packet[2 * i] = packet[2 * i + 1] = (int16_t)(8000 * sin(0.05 * i));
+  }
+
+  sSimResult_t result = {1e9, -1e9, 1e9, -1e9, 0, 0, 0};
+  double packetPeriod = PACKET_FRAMES / (inRate * (1.0 + ppm * 1e-6));
+  double blockPeriod = (double)I2S_DMA_BUF_LEN / OUT_RATE;
+  uint32_t state = 2463534242u;
+  uint64_t packets = 0, blocks = 0;
+  double arrival = 0;   // Of the next packet, with its jitter
+  bool playing = false, started = false;
+  double windowSum = 0, windowTime = 0, last = 0;
+  while(blocks * blockPeriod < SIM_SECONDS){
+    double consume = blocks * blockPeriod;
+    double now = (arrival <= consume) ? arrival : consume;
+    if(started){   // The latency over time, not only where the blocks sample it
+      windowSum += (buffer.available() / 4) * 1000.0 / inRate * (now - last);
+      windowTime += now - last;
+    }
+    last = now;
+    if(arrival <= consume){
+      if(!buffer.write(packet, sizeof(packet))){
+        result.overruns++;
+      }
+      packets++;
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      double late = (state % 1000) * (JITTER_MS / 1000.0 / 1000.0);
+      double next = packets * packetPeriod + late;
+      arrival = (next > arrival) ? next : arrival;
+      continue;
+    }
+
+    // One DMA buffer, the output task of DFRobot_MAX98357A
+    blocks++;
+    bool convert = !converter.isBypass();
+    if(buffer.available() < (playing ? (convert ? need : I2S_DMA_BUF_LEN * 4) : prefill)){
+      if(started){
+        result.underruns++;
+      }
+      playing = false;
+      converter.update(buffer, 0, false);
+      continue;
+    }
+    size_t done = convert ? converter.read(buffer, out, I2S_DMA_BUF_LEN) : (buffer.read(out, I2S_DMA_BUF_LEN * 4) / 4);
+    playing = (done == I2S_DMA_BUF_LEN);
+    started = true;
+    converter.update(buffer, done, playing);
+
+    if(windowTime < WINDOW_SECONDS){
+      continue;
+    }
+    double ms = windowSum / windowTime;
+    windowSum = 0;
+    windowTime = 0;
+    result.minMs = (ms < result.minMs) ? ms : result.minMs;
+    result.maxMs = (ms > result.maxMs) ? ms : result.maxMs;
+    if(consume > SIM_SECONDS / 2){
+      result.settledMinMs = (ms < result.settledMinMs) ? ms : result.settledMinMs;
+      result.settledMaxMs = (ms > result.settledMaxMs) ? ms : result.settledMaxMs;
+    }
+  }
+  result.drift = converter.getDrift();
+  buffer.end();
+  return result;
+}
+
+static char report[512];   // Printed after the JSON document
+
+static void checkCompensated(uint32_t inRate, double ppm, const char *name)
+{
+  uint64_t start = hostNanos();
+  sSimResult_t r = simulate(inRate, ppm, true);
+  benchResult(name, (uint64_t)(SIM_SECONDS * OUT_RATE), hostNanos() - start);
+  size_t len = strlen(report);
+  snprintf(report + len, sizeof(report) - len, "%s: latency %.2f to %.2f ms, settled %.2f to %.2f ms, drift %.1f ppm\n",
+           name, r.minMs, r.maxMs, r.settledMinMs, r.settledMaxMs, r.drift);
+  CHECK((r.underruns == 0) && (r.overruns == 0), "%s: %u underruns, %u overruns", name, (unsigned)r.underruns, (unsigned)r.overruns);
+  // The target is the level right after a block, over time the buffer holds up to a block more
+  double blockMs = I2S_DMA_BUF_LEN * 1000.0 / OUT_RATE;
+  CHECK((r.minMs > LATENCY_MS - BOUND_MS) && (r.maxMs < LATENCY_MS + blockMs + BOUND_MS),
+        "%s: latency %.2f to %.2f ms, the target is %.0f ms", name, r.minMs, r.maxMs, LATENCY_MS);
+  CHECK((r.settledMinMs > LATENCY_MS) && (r.settledMaxMs < LATENCY_MS + blockMs) && (r.settledMaxMs - r.settledMinMs < SETTLED_MS),
+        "%s: settled latency %.2f to %.2f ms", name, r.settledMinMs, r.settledMaxMs);
+  CHECK(fabs(r.drift - ppm) < DRIFT_TOLERANCE_PPM, "%s: drift estimate %.1f ppm for %.0f ppm", name, r.drift, ppm);
+}
+
+int main(void)
+{
+  StreamConverter passThrough;
+  CHECK(passThrough.begin(OUT_RATE, OUT_RATE, RESAMPLER_QUALITY_MEDIUM, 0) && passThrough.isBypass() && (passThrough.getPrefill() == 0),
+        "without drift compensation a stream at the output rate is passed through");
+  CHECK(passThrough.begin(OUT_RATE, OUT_RATE, RESAMPLER_QUALITY_MEDIUM, 1764) && !passThrough.isBypass(), "with drift compensation it is converted");
+
+  benchBegin("DriftTest");
+  checkCompensated(44100, 200, "44100_plus_200ppm");
+  checkCompensated(44100, -200, "44100_minus_200ppm");
+  checkCompensated(48000, 200, "48000_plus_200ppm");
+  checkCompensated(48000, -200, "48000_minus_200ppm");
+  benchEnd();
+  printf("%s", report);
+
+  sSimResult_t r = simulate(44100, 200, false);
+  printf("uncompensated: latency %.1f to %.1f ms\n", r.minMs, r.maxMs);
+  CHECK(r.maxMs - r.minMs > UNCOMPENSATED_GROWTH_MS, "an uncompensated stream did not drift, %.1f to %.1f ms", r.minMs, r.maxMs);
+  return hostTestResult("DriftTest");
+}
@@ -0,0 +1,152 @@
+/*!
+ * @file  FilterCascadeTest.cpp
+ * @brief  Measure the magnitude response of the cascaded filters against the analytic Butterworth and Linkwitz-Riley response
+ * @details  The stages are designed with the bilinear transform, so the response at f is the analog one at the warped
+ * @n        frequency tan(PI * f / fs) / tan(PI * fc / fs): |H|^2 = 1 / (1 + w^(2N)) for a Butterworth low-pass of order N,
+ * @n        and |H| = 1 / (1 + w^N) for a Linkwitz-Riley low-pass of order N, w is inverted for the high-pass filters.
+ * @n        A sine is run through the filter and its amplitude fitted by least squares after the filter has settled. The
+ * @n        low-pass and high-pass outputs of a Linkwitz-Riley crossover must also sum to a flat response.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define SAMPLE_RATE   (44100.0)
+#define SETTLE_FRAMES   ((int)(16384))   // Frames run before the fit, longer than the decay of the slowest stage
+#define FIT_FRAMES   ((int)(16384))
+#define AMPLITUDE   (16384.0)   // -6 dBFS in the scale of the int16_t samples
+#define PASS_TOLERANCE_DB   (0.01)   // Where the expected response is above -6 dB
+#define SLOPE_TOLERANCE_DB   (0.2)   // Down to -60 dB
+#define FLOOR_DB   (-60.0)   // Below it only the attenuation is checked, the rounding of the fixed-point filter is -100 dB
+
+#ifdef FILTER_FIXED_POINT
+#define SAMPLE_SCALE   ((double)(1 << DSP_FRACTION_BITS))   // The samples of the chains carry fraction bits
+#else
+#define SAMPLE_SCALE   (1.0)
+#endif
+
+/**
+ * The analytic magnitude in dB
+ */
+static double analyticDB(int order, uint8_t alignment, int type, double f, double fc)
+{
+  double w = tan(M_PI * f / SAMPLE_RATE) / tan(M_PI * fc / SAMPLE_RATE);
+  if(type == bq_type_highpass){
+    w = 1.0 / w;
+  }
+  if(alignment == FILTER_LINKWITZ_RILEY){
+    return -20.0 * log10(1.0 + pow(w, order));
+  }
+  return -10.0 * log10(1.0 + pow(w, 2 * order));
+}
+
+/**
+ * Least-squares amplitude of the sine of frequency f in y
+ */
+static double fitAmplitude(const double *y, int n, double f)
+{
+  double w = 2.0 * M_PI * f / SAMPLE_RATE;
+  double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+  for(int i=0; i<n; i++){
+    double s = sin(w * (SETTLE_FRAMES + i)), c = cos(w * (SETTLE_FRAMES + i));
+    ss += s * s;
+    cc += c * c;
+    sc += s * c;
+    ys += y[i] * s;
+    yc += y[i] * c;
+  }
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det;
+  double b = (yc * ss - ys * sc) / det;
+  return sqrt(a * a + b * b);
+}
+
+/**
+ * Run a sine through the low-pass and high-pass filter, and return the fitted amplitudes of each and of their sum
+ */
+template <typename Cascade>
+static void measure(Cascade &lp, Cascade &hp, double f, double sign, double *lpDB, double *hpDB, double *sumDB)
+{
+  static double yLP[FIT_FRAMES], yHP[FIT_FRAMES], ySum[FIT_FRAMES];
+  for(int i=0; i<SETTLE_FRAMES + FIT_FRAMES; i++){
+    filterSample_t x = (filterSample_t)(AMPLITUDE * SAMPLE_SCALE * sin(2.0 * M_PI * f * i / SAMPLE_RATE));
+    filterSample_t l1 = x, r1 = -x, l2 = x, r2 = -x;
+    lp.tick(l1, r1);
+    hp.tick(l2, r2);
+    if(i >= SETTLE_FRAMES){
+      yLP[i - SETTLE_FRAMES] = (double)l1 / SAMPLE_SCALE;
+      yHP[i - SETTLE_FRAMES] = (double)l2 / SAMPLE_SCALE;
+      ySum[i - SETTLE_FRAMES] = ((double)l1 + sign * (double)l2) / SAMPLE_SCALE;
+    }
+  }
+  *lpDB = 20.0 * log10(fitAmplitude(yLP, FIT_FRAMES, f) / AMPLITUDE + 1e-12);
+  *hpDB = 20.0 * log10(fitAmplitude(yHP, FIT_FRAMES, f) / AMPLITUDE + 1e-12);
+  *sumDB = 20.0 * log10(fitAmplitude(ySum, FIT_FRAMES, f) / AMPLITUDE + 1e-12);
+}
+
+static void compare(const char *name, double measured, double expected, double f, double fc, double *worst)
+{
+  double err = fabs(measured - expected);
+  if(expected > -6.0){
+    CHECK(err < PASS_TOLERANCE_DB, "%s fc %.0f: %.1f Hz is %.3f dB, expected %.3f dB", name, fc, f, measured, expected);
+    *worst = (err > *worst) ? err : *worst;
+  }else if(expected > FLOOR_DB){
+    CHECK(err < SLOPE_TOLERANCE_DB, "%s fc %.0f: %.1f Hz is %.3f dB, expected %.3f dB", name, fc, f, measured, expected);
+  }else{
+    CHECK(measured < FLOOR_DB + 3.0, "%s fc %.0f: %.1f Hz is %.3f dB, expected %.3f dB", name, fc, f, measured, expected);
+  }
+}
+
+template <int ORDER, uint8_t ALIGNMENT>
+static void checkCascade(const char *name)
+{
+  typedef FilterCascade<FilterBiquad, ORDER, ALIGNMENT> cascade_t;
+  static const double thresholds[] = {200.0, 2000.0, 8000.0};
+  // Orders 2 and 6 of a Linkwitz-Riley crossover sum flat with the high-pass output inverted
+  double sign = ((ALIGNMENT == FILTER_LINKWITZ_RILEY) && (ORDER % 4 == 2)) ? -1.0 : 1.0;
+  double worst = 0.0;
+
+  for(double fc : thresholds){
+    typename FilterBiquad::sCoef_t lpCoef[cascade_t::STAGES], hpCoef[cascade_t::STAGES];
+    cascade_t::design(bq_type_lowpass, (float)(fc / SAMPLE_RATE), lpCoef);
+    cascade_t::design(bq_type_highpass, (float)(fc / SAMPLE_RATE), hpCoef);
+    for(int k=-8; k<=8; k++){   // Half octaves around the threshold
+      double f = fc * pow(2.0, k / 2.0);
+      if((f < 20.0) || (f > 0.45 * SAMPLE_RATE)){
+        continue;
+      }
+      cascade_t lp, hp;   // From rest for every frequency
+      lp.setCoefficients(lpCoef);
+      hp.setCoefficients(hpCoef);
+      double lpDB, hpDB, sumDB;
+      measure(lp, hp, f, sign, &lpDB, &hpDB, &sumDB);
+      compare(name, lpDB, analyticDB(ORDER, ALIGNMENT, bq_type_lowpass, f, fc), f, fc, &worst);
+      compare(name, hpDB, analyticDB(ORDER, ALIGNMENT, bq_type_highpass, f, fc), f, fc, &worst);
+      if(ALIGNMENT == FILTER_LINKWITZ_RILEY){
+        CHECK(fabs(sumDB) < PASS_TOLERANCE_DB, "%s fc %.0f: the crossover sums to %.3f dB at %.1f Hz", name, fc, sumDB, f);
+      }
+    }
+  }
+  printf("%s: worst pass band error %.4f dB\n", name, worst);
+}
+
+int main(void)
+{
+  checkCascade<1, FILTER_BUTTERWORTH>("butterworth1");
+  checkCascade<2, FILTER_BUTTERWORTH>("butterworth2");
+  checkCascade<3, FILTER_BUTTERWORTH>("butterworth3");
+  checkCascade<4, FILTER_BUTTERWORTH>("butterworth4");
+  checkCascade<5, FILTER_BUTTERWORTH>("butterworth5");
+  checkCascade<6, FILTER_BUTTERWORTH>("butterworth6");
+  checkCascade<8, FILTER_BUTTERWORTH>("butterworth8");
+  checkCascade<2, FILTER_LINKWITZ_RILEY>("linkwitzRiley2");
+  checkCascade<4, FILTER_LINKWITZ_RILEY>("linkwitzRiley4");
+  checkCascade<6, FILTER_LINKWITZ_RILEY>("linkwitzRiley6");
+  checkCascade<8, FILTER_LINKWITZ_RILEY>("linkwitzRiley8");
+  return hostTestResult("FilterCascadeTest");
+}
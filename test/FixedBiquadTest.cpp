@@ -0,0 +1,181 @@
+/*!
+ * @file  FixedBiquadTest.cpp
+ * @brief  Bound the error of the fixed-point filters against the float filters, and time both
+ * @details  The same noise, at the sample scale of the processing chains (DSP_FRACTION_BITS below the 16-bit LSB), runs
+ * @n        through StereoBiquad, StereoBiquadFixed and a double-precision reference with the same design. The largest error
+ * @n        of the fixed-point filter must stay below a fraction of the 16-bit LSB, also for a large boost which costs the
+ * @n        coefficients fraction bits and for a low threshold, where the poles sit close to the unit circle and the float
+ * @n        filter loses more than an LSB.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define TEST_FRAMES   4096   // Frames per block
+#define TEST_REPEAT   100   // Blocks per case, the error is measured over all of them
+#define ERROR_BOUND_LSB   0.25   // The largest error allowed, in 16-bit LSBs
+
+typedef FilterCascade<StereoBiquad, 6> CascadeFloat_t;
+typedef FilterCascade<StereoBiquadFixed, 6> CascadeFixed_t;
+
+static int32_t input[TEST_FRAMES * 2];   // 16-bit noise scaled by 2^DSP_FRACTION_BITS
+static float inputFloat[TEST_FRAMES * 2];
+static int32_t outFixed[TEST_FRAMES * 2];
+static float outFloat[TEST_FRAMES * 2];
+static double outRef[TEST_FRAMES * 2];
+
+/**
+ * The direct form I in double of a series of stages, the reference of both filters
+ */
+class Reference
+{
+public:
+  Reference(const StereoBiquad::sCoef_t *coef, int stages) : _coef(coef), _stages(stages) { memset(_s, 0, sizeof(_s)); }
+
+  void processBlock(const int32_t *in, double *out, size_t frames)
+  {
+    for(size_t i=0; i<frames * 2; i++){
+      double x = in[i];
+      int ch = i & 1;
+      for(int k=0; k<_stages; k++){
+        const StereoBiquad::sCoef_t &c = _coef[k];
+        double *s = _s[k][ch];   // x1, x2, y1, y2
+        double y = c.a0 * x + c.a1 * s[0] + c.a2 * s[1] - c.b1 * s[2] - c.b2 * s[3];
+        s[1] = s[0];
+        s[0] = x;
+        s[3] = s[2];
+        s[2] = y;
+        x = y;
+      }
+      out[i] = x;
+    }
+  }
+
+protected:
+  const StereoBiquad::sCoef_t *_coef;
+  int _stages;
+  double _s[8][2][4];
+};
+
+/**
+ * Run a block of interleaved stereo frames through a filter frame by frame, as the processing chains do
+ */
+template <typename Filter, typename sample_t>
+static void runBlock(Filter &filter, const sample_t *in, sample_t *out, size_t frames)
+{
+  for(size_t i=0; i<frames; i++){
+    sample_t l = in[2 * i], r = in[2 * i + 1];
+    filter.tick(l, r);
+    out[2 * i] = l;
+    out[2 * i + 1] = r;
+  }
+}
+
+typedef struct
+{
+  double fixed;   // The largest error of the fixed-point filter in 16-bit LSBs
+  double floating;   // The largest error of the float filter
+}sError_t;
+
+/**
+ * Run both filters and the reference over the noise, return the largest errors and print the timings
+ */
+template <typename FloatFilter, typename FixedFilter>
+static sError_t compare(const char *name, FloatFilter &filterFloat, FixedFilter &filterFixed, Reference &reference)
+{
+  char label[64];
+  sError_t error = {0, 0};
+  uint64_t nsFloat = 0, nsFixed = 0;
+  for(int r=0; r<TEST_REPEAT; r++){
+    uint64_t start = hostNanos();
+    runBlock(filterFloat, inputFloat, outFloat, TEST_FRAMES);
+    nsFloat += hostNanos() - start;
+    start = hostNanos();
+    runBlock(filterFixed, input, outFixed, TEST_FRAMES);
+    nsFixed += hostNanos() - start;
+    reference.processBlock(input, outRef, TEST_FRAMES);
+    for(int i=0; i<TEST_FRAMES * 2; i++){
+      double e = fabs((double)outFixed[i] - outRef[i]) / (1 << DSP_FRACTION_BITS);
+      error.fixed = (e > error.fixed) ? e : error.fixed;
+      e = fabs((double)outFloat[i] - outRef[i]) / (1 << DSP_FRACTION_BITS);
+      error.floating = (e > error.floating) ? e : error.floating;
+    }
+  }
+  snprintf(label, sizeof(label), "%s_float", name);
+  benchResult(label, (uint64_t)TEST_REPEAT * TEST_FRAMES, nsFloat);
+  snprintf(label, sizeof(label), "%s_fixed", name);
+  benchResult(label, (uint64_t)TEST_REPEAT * TEST_FRAMES, nsFixed);
+  return error;
+}
+
+static sError_t compareBiquad(const char *name, int type, float Fc, float Q, float gainDB)
+{
+  StereoBiquad filterFloat;
+  StereoBiquadFixed filterFixed;
+  StereoBiquad::sCoef_t coef;
+  StereoBiquad::calcCoefficients(type, Fc, Q, gainDB, coef);
+  filterFloat.setBiquad(type, Fc, Q, gainDB);
+  filterFixed.setBiquad(type, Fc, Q, gainDB);
+  Reference reference(&coef, 1);
+  return compare(name, filterFloat, filterFixed, reference);
+}
+
+static sError_t compareCascade(const char *name, int type, float Fc)
+{
+  StereoBiquad::sCoef_t coefFloat[CascadeFloat_t::STAGES];
+  StereoBiquadFixed::sCoef_t coefFixed[CascadeFixed_t::STAGES];
+  CascadeFloat_t::design(type, Fc, coefFloat);
+  CascadeFixed_t::design(type, Fc, coefFixed);
+  CascadeFloat_t filterFloat;
+  CascadeFixed_t filterFixed;
+  filterFloat.setCoefficients(coefFloat);
+  filterFixed.setCoefficients(coefFixed);
+  Reference reference(coefFloat, CascadeFloat_t::STAGES);
+  return compare(name, filterFloat, filterFixed, reference);
+}
+
+int main(void)
+{
+  uint32_t state = 2463534242u;
+  for(int i=0; i<TEST_FRAMES * 2; i++){
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    input[i] = (int32_t)(int16_t)(state >> 16) / 2 * (1 << DSP_FRACTION_BITS);   // -6 dBFS, room for the boost
+    inputFloat[i] = (float)input[i];
+  }
+
+  // One designer: the fixed-point coefficients are the float ones, rounded
+  float coef[5];
+  int32_t fixed[5];
+  int shift;
+  Biquad::calcCoefficients(bq_type_peak, 1000.0f / 44100, 1.0f, 3.0f, coef);
+  quantizeBiquad(coef, fixed, &shift);
+  CHECK(shift == BIQUAD_FIXED_SHIFT, "shift %d", shift);
+  for(int i=0; i<5; i++){
+    CHECK(fabs(ldexp((double)fixed[i], -shift) - coef[i]) <= ldexp(0.5, -shift), "coefficient %d", i);
+  }
+  Biquad::calcCoefficients(bq_type_highshelf, 8000.0f / 44100, 0.707f, 12.0f, coef);   // a0 is about 4
+  quantizeBiquad(coef, fixed, &shift);
+  CHECK(shift < BIQUAD_FIXED_SHIFT, "a large boost keeps shift %d", shift);
+
+  benchBegin("FixedBiquadTest");
+  sError_t peak = compareBiquad("peak_1k", bq_type_peak, 1000.0f / 44100, 1.0f, 3.0f);
+  sError_t shelf = compareBiquad("highshelf_12db", bq_type_highshelf, 8000.0f / 44100, 0.707f, 12.0f);
+  sError_t lowpass = compareCascade("lowpass6_15k", bq_type_lowpass, 15000.0f / 44100);
+  sError_t highpass = compareCascade("highpass6_50", bq_type_highpass, 50.0f / 44100);
+  benchEnd();
+
+  printf("fixed error (16-bit LSB): peak %.4f, highshelf %.4f, lowpass %.4f, highpass %.4f\n", peak.fixed, shelf.fixed, lowpass.fixed, highpass.fixed);
+  printf("float error (16-bit LSB): peak %.4f, highshelf %.4f, lowpass %.4f, highpass %.4f\n", peak.floating, shelf.floating, lowpass.floating, highpass.floating);
+  CHECK(peak.fixed < ERROR_BOUND_LSB, "peak error %.4f LSB", peak.fixed);
+  CHECK(shelf.fixed < ERROR_BOUND_LSB, "highshelf error %.4f LSB", shelf.fixed);
+  CHECK(lowpass.fixed < ERROR_BOUND_LSB, "lowpass error %.4f LSB", lowpass.fixed);
+  CHECK(highpass.fixed < ERROR_BOUND_LSB, "highpass error %.4f LSB", highpass.fixed);
+  return hostTestResult("FixedBiquadTest");
+}
@@ -0,0 +1,199 @@
+/*!
+ * @file  GainStageBench.cpp
+ * @brief  Check the volume stage of the processing chains as the output task runs it, in accuracy and speed
+ * @details  Every step of the dB table must be within half a Q15 step of 10^(dB / 20). ChainGain<int32_t> must give
+ * @n        exactly the Q24 ramp of GainStage::ramp() applied to each sample, the volume chain to 16-bit output, without
+ * @n        dither, must be within one LSB of the float product, and ChainGain<float> must agree with the integer stage.
+ * @n        A ramp must move monotonically from the old gain to the new one over one block. The gain stage alone and the
+ * @n        volume chain with dither are timed against the float multiply of the old output loop.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define BENCH_FRAMES   4096   // Frames per block
+#define BENCH_REPEAT   200   // Blocks per case
+
+typedef DSPChain<ChainGain<int32_t> > gainChain_t;   // The stage alone, its int32_t output carries DSP_FRACTION_BITS
+typedef DSPChain<ChainGain<float> > gainFloatChain_t;
+typedef DSPChain<ChainGain<int32_t>, ChainRequantizer<int16_t> > volumeChain_t;   // The volume chain of the output task
+
+static int16_t input[BENCH_FRAMES * 2];
+static int16_t output[BENCH_FRAMES * 2];
+static int32_t output32[BENCH_FRAMES * 2];
+static float outputFloat[BENCH_FRAMES * 2];
+static int16_t outputOld[BENCH_FRAMES * 2];
+
+static void checkTable(void)
+{
+  GainStage gain;
+  double worst = 0;
+  for(float dB=GAIN_TABLE_MIN_DB; dB<=6.0f; dB+=GAIN_TABLE_STEP_DB){
+    gain.setGainDB(dB);
+    double e = fabs(gain.getGain() - GAIN_UNITY_Q15 * pow(10.0, dB / 20.0));
+    worst = (e > worst) ? e : worst;
+  }
+  CHECK(worst <= 0.5, "the dB table is %.3f Q15 steps off", worst);
+  gain.setGainDB(-100.0f);
+  CHECK(gain.getGain() == 0, "below the table mutes");
+  gain.setGain(3.0f);
+  CHECK(gain.getGain() == GAIN_MAX_Q15, "the linear gain is clamped");
+}
+
+/**
+ * The gain of the int32_t stage for one sample, gain in Q24
+ */
+static int32_t model(int16_t x, int32_t gain)
+{
+  return (x * (gain >> 9)) >> (15 - DSP_FRACTION_BITS);
+}
+
+/**
+ * Ramp from unity to g over one block, then hold it over another, and check each stage frame by frame
+ */
+static void checkConstant(float g)
+{
+  GainStage stage, floatStage, volumeStage;
+  stage.setGain(g);
+  floatStage.setGain(g);
+  volumeStage.setGain(g);
+  gainChain_t chain((ChainGain<int32_t>(&stage)));
+  gainFloatChain_t floatChain((ChainGain<float>(&floatStage)));
+  Requantizer requantizer;
+  requantizer.setMode(16, DITHER_OFF);
+  volumeChain_t volume((ChainGain<int32_t>(&volumeStage)), (ChainRequantizer<int16_t>(&requantizer)));
+
+  int32_t start = GAIN_UNITY_Q15 << 9;
+  int32_t target = stage.getGain() << 9;
+  int32_t step = (target - start) / BENCH_FRAMES;
+  uint32_t mismatches = 0;
+  for(int block=0; block<2; block++){
+    chain.process<int32_t>(input, output32, BENCH_FRAMES, 0);
+    for(int i=0; i<BENCH_FRAMES; i++){
+      int32_t gain = block ? target : (start + (i + 1) * step);
+      mismatches += (output32[2 * i] != model(input[2 * i], gain)) + (output32[2 * i + 1] != model(input[2 * i + 1], gain));
+    }
+  }
+  CHECK(mismatches == 0, "gain %.3f: %u samples differ from the Q24 ramp", g, (unsigned)mismatches);
+
+  floatChain.process<float>(input, outputFloat, BENCH_FRAMES, 0);
+  floatChain.process<float>(input, outputFloat, BENCH_FRAMES, 0);
+  double worstFloat = 0;
+  for(int i=0; i<BENCH_FRAMES * 2; i++){
+    double e = fabs(outputFloat[i] - output32[i] / (double)(1 << DSP_FRACTION_BITS));
+    worstFloat = (e > worstFloat) ? e : worstFloat;
+  }
+  // The integer stage truncates below DSP_FRACTION_BITS, the float stage does not
+  CHECK(worstFloat <= 1.0 / (1 << DSP_FRACTION_BITS), "gain %.3f: the float stage is %.4f LSB off the integer stage", g, worstFloat);
+
+  volume.process<int32_t>(input, output, BENCH_FRAMES, 0);
+  volume.process<int32_t>(input, output, BENCH_FRAMES, 0);
+  float q = stage.getGain() / (float)GAIN_UNITY_Q15;   // The float multiply with the same, quantized gain
+  int worst = 0;
+  for(int i=0; i<BENCH_FRAMES * 2; i++){
+    float y = input[i] * q;
+    y = (y > 32767.0f) ? 32767.0f : ((y < -32768.0f) ? -32768.0f : y);
+    int e = abs(output[i] - (int)lrintf(y));
+    worst = (e > worst) ? e : worst;
+  }
+  CHECK(worst <= 1, "gain %.3f: the volume chain is %d LSB off the float product", g, worst);
+}
+
+static void checkRamp(void)
+{
+  static int16_t dc[BENCH_FRAMES * 2];
+  for(int i=0; i<BENCH_FRAMES * 2; i++){
+    dc[i] = 16384;
+  }
+  GainStage stage;
+  Requantizer requantizer;
+  requantizer.setMode(16, DITHER_OFF);
+  volumeChain_t volume((ChainGain<int32_t>(&stage)), (ChainRequantizer<int16_t>(&requantizer)));
+  stage.setGain(0.25f);
+  volume.process<int32_t>(dc, output, BENCH_FRAMES, 0);
+  bool monotonic = true;
+  for(int i=1; i<BENCH_FRAMES; i++){
+    monotonic = monotonic && (output[2 * i] <= output[2 * (i - 1)]) && (output[2 * i + 1] == output[2 * i]);
+  }
+  CHECK(monotonic, "the ramp down is not monotonic");
+  CHECK(output[0] < 16384, "the ramp starts at the first frame");
+  CHECK(abs(output[2 * (BENCH_FRAMES - 1)] - 4096) <= 1, "the ramp ends at %d", output[2 * (BENCH_FRAMES - 1)]);
+  CHECK(!stage.isUnity() && stage.isAttenuating(), "flags after the ramp");
+}
+
+static void bench(void)
+{
+  GainStage stage;
+  Requantizer requantizer;   // TPDF dither, as the output task requantizes 16-bit output
+  volumeChain_t volume((ChainGain<int32_t>(&stage)), (ChainRequantizer<int16_t>(&requantizer)));
+  stage.setGain(0.6f);
+  volume.process<int32_t>(input, output, 1, 0);
+
+  GainStage alone;
+  gainChain_t chain((ChainGain<int32_t>(&alone)));
+  alone.setGain(0.6f);
+  chain.process<int32_t>(input, output32, 1, 0);
+  uint64_t start = hostNanos(), cycles = hostCycles();
+  for(int r=0; r<BENCH_REPEAT; r++){
+    chain.process<int32_t>(input, output32, BENCH_FRAMES, 0);
+    __asm__ __volatile__("" : : "r"(output32) : "memory");
+  }
+  benchResult("gain_stage", (uint64_t)BENCH_REPEAT * BENCH_FRAMES, hostNanos() - start, hostCycles() - cycles);
+
+  start = hostNanos();
+  cycles = hostCycles();
+  for(int r=0; r<BENCH_REPEAT; r++){
+    volume.process<int32_t>(input, output, BENCH_FRAMES, 0);
+  }
+  benchResult("volume_chain", (uint64_t)BENCH_REPEAT * BENCH_FRAMES, hostNanos() - start, hostCycles() - cycles);
+
+  start = hostNanos();
+  cycles = hostCycles();
+  for(int r=0; r<BENCH_REPEAT; r++){
+    stage.setGain((r & 1) ? 0.6f : 0.5f);
+    volume.process<int32_t>(input, output, BENCH_FRAMES, 0);
+  }
+  benchResult("volume_chain_ramp", (uint64_t)BENCH_REPEAT * BENCH_FRAMES, hostNanos() - start, hostCycles() - cycles);
+
+  volatile float level = 0.6f;   // As the float multiply of the old output loop
+  start = hostNanos();
+  cycles = hostCycles();
+  for(int r=0; r<BENCH_REPEAT; r++){
+    float v = level;
+    for(int i=0; i<BENCH_FRAMES * 2; i++){
+      float y = input[i] * v;
+      outputOld[i] = (int16_t)((y > 32767.0f) ? 32767.0f : ((y < -32768.0f) ? -32768.0f : y));
+    }
+    __asm__ __volatile__("" : : "r"(outputOld) : "memory");   // Keep every block, the output is not read
+  }
+  benchResult("float_multiply", (uint64_t)BENCH_REPEAT * BENCH_FRAMES, hostNanos() - start, hostCycles() - cycles);
+}
+
+int main(void)
+{
+  uint32_t state = 2463534242u;
+  for(int i=0; i<BENCH_FRAMES * 2; i++){
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    input[i] = (int16_t)(state >> 16);
+  }
+
+  checkTable();
+  checkConstant(0.0f);
+  checkConstant(0.123f);
+  checkConstant(0.6f);
+  checkConstant(1.0f);
+  checkConstant(1.8f);   // Saturates
+  checkRamp();
+
+  benchBegin("GainStageBench");
+  bench();
+  benchEnd();
+  return hostTestResult("GainStageBench");
+}
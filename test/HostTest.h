@@ -0,0 +1,115 @@
+/*!
+ * @file  HostTest.h
+ * @brief  Define the checks and the timing shared by the host tests and benchmarks
+ * @details  A test counts its failed CHECK()s and returns hostTestResult() from main(), so ctest sees the failures.
+ * @n        A benchmark prints one JSON document per run with benchBegin(), benchResult() and benchEnd().
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static int _hostFailures = 0;   // The failed checks of the test
+static bool _benchFirst = true;   // No comma before the first result
+
+/**
+ * Check a condition, print the failure with its location and go on
+ */
+#define CHECK(cond, ...)   do{ if(!(cond)){ _hostFailures++; printf("%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); printf(__VA_ARGS__); printf("\n"); } }while(0)
+
+/**
+ * @fn hostTestResult
+ * @brief Print the summary of the test
+ * @param name - The name of the test
+ * @return The exit code of main(), 0 when all checks passed
+ */
+static inline int hostTestResult(const char *name)
+{
+  printf("%s: %s (%d failed)\n", name, _hostFailures ? "FAIL" : "PASS", _hostFailures);
+  return _hostFailures ? 1 : 0;
+}
+
+/**
+ * @fn hostNanos
+ * @brief Get the time of the steady clock
+ * @return Nanoseconds since an arbitrary start
+ */
+static inline uint64_t hostNanos(void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @fn hostCycles
+ * @brief Get the cycle counter of the host CPU, for cases reported in cycles as on the ESP32
+ * @return The time stamp counter on x86, 0 elsewhere
+ */
+static inline uint64_t hostCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @fn benchBegin
+ * @brief Print the start of the JSON document of a benchmark
+ * @param name - The name of the benchmark
+ * @return None
+ */
+static inline void benchBegin(const char *name)
+{
+#ifdef FILTER_FIXED_POINT
+  printf("{\"bench\":\"%s\",\"filter\":\"fixed\",\"results\":[", name);
+#else
+  printf("{\"bench\":\"%s\",\"filter\":\"float\",\"results\":[", name);
+#endif
+}
+
+/**
+ * @fn benchResult
+ * @brief Print the result of one case
+ * @param name - The name of the case
+ * @param items - The items processed, e.g. frames
+ * @param ns - The time taken in ns
+ * @param cycles - The host cycles taken, 0 to leave them out
+ * @return None
+ */
+static inline void benchResult(const char *name, uint64_t items, uint64_t ns, uint64_t cycles=0)
+{
+  if(ns == 0){
+    ns = 1;
+  }
+  printf("%s{\"name\":\"%s\",\"items\":%llu,\"ns\":%llu,\"ns_per_item\":%.2f", _benchFirst ? "" : ",", name,
+         (unsigned long long)items, (unsigned long long)ns, (double)ns / (double)items);
+  if(cycles > 0){
+    printf(",\"cycles_per_item\":%.2f", (double)cycles / (double)items);
+  }
+  printf("}");
+  _benchFirst = false;
+}
+
+/**
+ * @fn benchEnd
+ * @brief Print the end of the JSON document
+ * @return None
+ */
+static inline void benchEnd(void)
+{
+  printf("]}\n");
+}
+
+#endif
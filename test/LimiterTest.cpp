@@ -0,0 +1,224 @@
+/*!
+ * @file  LimiterTest.cpp
+ * @brief  Check that the output never wraps and that no frame is lost or inserted when the limiter enters or leaves the path
+ * @details  Wrap: a sine near full scale is streamed through the library at volume 9, with and without the filter and the
+ * @n        equalizer and with the volume switched while it plays, for 16-bit, 24-bit and 32-bit output. No output sample may exceed the
+ * @n        ceiling of the limiter, and no sample may have the opposite sign of the sine, as a wrapped sample has.
+ * @n        Continuity: frames of random levels are streamed while the volume moves between attenuation (limiter bypassed),
+ * @n        unity (written in place) and gain (limiter in the path). Output frame k must be input frame k times a gain.
+ * @n        The limiter alone is timed as well.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <vector>
+#include <mutex>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define SAMPLE_RATE   (44100.0)
+#define BLOCK_FRAMES   ((uint32_t)(3000))   // Frames per write, the settings change between writes
+#define WRAP_BLOCKS   ((uint32_t)(30))
+#define WRAP_SETTLE_FRAMES   ((uint32_t)(4410))   // The filters start from the state they were left in, 100 ms to settle
+#define WRAP_AMPLITUDE   (30000.0)   // Below the ceiling, so only gain can take it above
+#define WRAP_FREQ   (200.0)
+#define WRAP_MIN_SINE   (0.5)   // The samples checked for their sign, 30 degrees or more away from the zero crossings
+#define CEILING_DB   (-0.3)
+#define CONTINUITY_BLOCKS   ((uint32_t)(40))
+#define BENCH_FRAMES   ((uint32_t)(1) << 20)
+
+/**
+ * Keeps every output sample, in units of a 16-bit step
+ */
+class RecordingSink : public AudioSink
+{
+public:
+  RecordingSink(void) : bits(16), frames(0) {}
+
+  size_t write(const void *data, size_t len, uint32_t ticksToWait)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(bits == 16){
+      const int16_t *pcm = (const int16_t *)data;
+      for(size_t i=0; i<len / 2; i++){
+        samples.push_back(pcm[i]);
+      }
+    }else{
+      const int32_t *pcm = (const int32_t *)data;
+      for(size_t i=0; i<len / 4; i++){
+        samples.push_back(pcm[i] / 65536.0);
+      }
+    }
+    frames.store(samples.size() / 2);
+    return len;
+  }
+
+  bool setBitsPerSample(uint8_t bitsPerSample)
+  {
+    bits = bitsPerSample;
+    return true;
+  }
+
+  uint8_t bits;
+  std::atomic<size_t> frames;
+  std::vector<double> samples;
+  std::mutex mutex;
+};
+
+class TestAmplifier : public DFRobot_MAX98357A
+{
+public:
+  static bool write(const uint8_t *data, uint32_t len, uint32_t ticksToWait) { return writeToBuffer(data, len, ticksToWait); }
+  void filterDefaults(void)
+  {
+    setFilter(bq_type_lowpass, 20000.0);
+    setFilter(bq_type_highpass, 2.0);
+  }
+  void stop(void) { end(); }
+};
+
+/**
+ * Wait until the sink has all the frames, the output task flushes the rest and the limiter after OUTPUT_WAIT_TICKS
+ */
+static void drain(RecordingSink &sink, size_t frames)
+{
+  for(uint32_t waited=0; (sink.frames.load() < frames) && (waited < 5000); waited+=10){
+    delay(10);
+  }
+  delay(50);   // Anything more would be inserted frames
+}
+
+static void checkWrap(uint8_t bits, bool filter, bool eq)
+{
+  TestAmplifier amplifier;
+  RecordingSink sink;
+  amplifier.setAudioSink(&sink);
+  amplifier.filterDefaults();
+  amplifier.setEqualizerBand(0, bq_type_peak, 200.0, 1.0, 12.0);
+  amplifier.setLimiter(CEILING_DB, LIMITER_ATTACK_MS, LIMITER_RELEASE_MS);
+  CHECK(amplifier.setOutputBits(bits), "setOutputBits(%u)", bits);
+  if(filter){   // Switched on before the stream, switching the filter on and off is not smoothed
+    amplifier.openFilter(bq_type_lowpass, 8000);
+  }
+  if(eq){
+    amplifier.openEqualizer();
+  }
+  amplifier.setVolume(9);
+  CHECK(amplifier.initI2S(25, 26, 27), "initI2S");
+
+  static int16_t block[BLOCK_FRAMES * 2];
+  uint32_t k = 0;
+  for(uint32_t b=0; b<WRAP_BLOCKS; b++){
+    static const float volumes[] = {9, 9, 5, 9, 2, 9, 9, 2, 5};   // Without filter and equalizer: limiter in, written in place, bypassed
+    amplifier.setVolume(volumes[b % (sizeof(volumes) / sizeof(volumes[0]))]);
+    for(uint32_t i=0; i<BLOCK_FRAMES; i++, k++){
+      block[2 * i] = block[2 * i + 1] = (int16_t)lrint(WRAP_AMPLITUDE * sin(2.0 * M_PI * WRAP_FREQ * k / SAMPLE_RATE));
+    }
+    TestAmplifier::write((const uint8_t *)block, sizeof(block), portMAX_DELAY);
+  }
+  drain(sink, WRAP_BLOCKS * BLOCK_FRAMES);
+  amplifier.stop();
+  amplifier.closeFilter();
+  amplifier.closeEqualizer();
+
+  const char *name = filter ? (eq ? "filter and equalizer" : "filter") : (eq ? "equalizer" : "volume");
+  // Output frame k is input frame k, the limiter enters and leaves the path without shifting the frames. Away from the
+  // zero crossings the filter and the equalizer do not move the phase of the sine far enough to flip a sample, a wrap does
+  double ceiling = 32767.0 * pow(10.0, CEILING_DB / 20.0) + 1.0;   // And one step of dither
+  double peak = 0;
+  uint32_t flipped = 0;
+  for(size_t k=0; 2 * k + 1 < sink.samples.size(); k++){
+    double x = sin(2.0 * M_PI * WRAP_FREQ * k / SAMPLE_RATE);
+    for(int ch=0; ch<2; ch++){
+      double y = sink.samples[2 * k + ch];
+      peak = (fabs(y) > peak) ? fabs(y) : peak;
+      if((k >= WRAP_SETTLE_FRAMES) && (fabs(x) > WRAP_MIN_SINE) && (x * y < 0) && (flipped++ < 5)){
+        printf("%u-bit %s: frame %u is %.0f, the sine is %.3f\n", bits, name, (unsigned)k, y, x);
+      }
+    }
+  }
+  CHECK(sink.frames.load() == WRAP_BLOCKS * BLOCK_FRAMES, "%u-bit %s: %u of %u frames", bits, name, (unsigned)sink.frames.load(), WRAP_BLOCKS * BLOCK_FRAMES);
+  CHECK(peak <= ceiling, "%u-bit %s: peak %.1f above the ceiling %.1f", bits, name, peak, ceiling);
+  CHECK(flipped == 0, "%u-bit %s: %u samples of the wrong sign, the output wrapped", bits, name, flipped);
+  printf("wrap %u-bit %s: peak %.1f\n", bits, name, peak);
+}
+
+static void checkContinuity(void)
+{
+  TestAmplifier amplifier;
+  RecordingSink sink;
+  amplifier.setAudioSink(&sink);
+  amplifier.setOutputBits(16);
+  amplifier.setVolume(5);
+  CHECK(amplifier.initI2S(25, 26, 27), "initI2S");
+
+  std::vector<int16_t> sent;
+  static int16_t block[BLOCK_FRAMES * 2];
+  uint32_t state = 12345;
+  static const float volumes[] = {5.5, 5, 4, 5.5, 4, 5, 5.5};   // Limiter in, in place, bypassed, in, bypassed, in place, in
+  for(uint32_t b=0; b<CONTINUITY_BLOCKS; b++){
+    amplifier.setVolume(volumes[b % (sizeof(volumes) / sizeof(volumes[0]))]);
+    for(uint32_t i=0; i<BLOCK_FRAMES; i++){
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      int16_t x = (int16_t)(2000 + state % 18000) * ((state & 0x80000000) ? -1 : 1);   // 2000 to 20000, never limited
+      block[2 * i] = block[2 * i + 1] = x;
+      sent.push_back(x);
+    }
+    TestAmplifier::write((const uint8_t *)block, sizeof(block), portMAX_DELAY);
+  }
+  drain(sink, sent.size());   // The stream ends with the limiter in the path, its delay line must be flushed
+  amplifier.stop();
+  amplifier.setVolume(5);
+
+  CHECK(sink.frames.load() == sent.size(), "%u of %u frames", (unsigned)sink.frames.load(), (unsigned)sent.size());
+  uint32_t errors = 0;
+  for(size_t k=0; (k<sent.size()) && (2 * k + 1 < sink.samples.size()); k++){
+    for(int ch=0; ch<2; ch++){
+      double ratio = sink.samples[2 * k + ch] / sent[k];   // Between the gains of volume 4 and 5.5, and the dither
+      if(((ratio < 0.795) || (ratio > 1.105)) && (errors++ < 5)){
+        printf("frame %u channel %d: %.0f for %d\n", (unsigned)k, ch, sink.samples[2 * k + ch], sent[k]);
+      }
+    }
+  }
+  CHECK(errors == 0, "%u samples are not their input frame, frames were lost or inserted", errors);
+}
+
+static void benchLimiter(void)
+{
+  static int32_t data[4096 * 2];
+  for(int i=0; i<4096; i++){
+    data[2 * i] = data[2 * i + 1] = (int32_t)(50000.0 * sin(2.0 * M_PI * 1000.0 * i / SAMPLE_RATE)) * (1 << DSP_FRACTION_BITS);
+  }
+  PeakLimiter limiter(44100);
+  static int32_t work[4096 * 2];
+  uint64_t ns = 0, cycles = 0;
+  for(uint32_t done=0; done<BENCH_FRAMES; done+=4096){
+    memcpy(work, data, sizeof(work));
+    uint64_t start = hostNanos(), startCycles = hostCycles();
+    limiter.process(work, 4096);
+    ns += hostNanos() - start;
+    cycles += hostCycles() - startCycles;
+  }
+  benchBegin("LimiterTest");
+  benchResult("limiter_int32", BENCH_FRAMES, ns, cycles);
+  benchEnd();
+}
+
+int main(void)
+{
+  checkContinuity();
+  static const uint8_t widths[] = {16, 24, 32};
+  for(uint8_t bits : widths){
+    checkWrap(bits, false, false);
+    checkWrap(bits, true, false);
+    checkWrap(bits, false, true);
+    checkWrap(bits, true, true);
+  }
+  benchLimiter();
+  return hostTestResult("LimiterTest");
+}
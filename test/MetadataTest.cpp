@@ -0,0 +1,217 @@
+/*!
+ * @file  MetadataTest.cpp
+ * @brief  Inject AVRC events into the callback of the library, and check the metadata cache and the requests it sends
+ * @details  On connection all attributes must be requested in one command and the track change notification registered.
+ * @n        Each response fills its attribute, calls the metadata callback once per change, and getMetadata() returns it
+ * @n        at once. A track change empties the cache, calls the callback for every attribute cleared, requests the
+ * @n        metadata again and renews the registration, which the notification used up. Long texts are cut at a UTF-8
+ * @n        character boundary, and a reader task never sees a half-written text.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <DFRobot_MAX98357A.h>
+#include "HostStubs.h"
+#include "HostTest.h"
+
+#define GET_ROUNDS   ((uint32_t)(100000))   // getMetadata() calls timed
+#define STRESS_WRITES   ((uint32_t)(20000))   // Responses of the Bluetooth task while the reader reads
+
+class TestAmplifier : public DFRobot_MAX98357A
+{
+public:
+  static void inject(esp_avrc_ct_cb_event_t event, esp_avrc_ct_cb_param_t *param) { avrcCallback(event, param); }
+};
+
+static const uint8_t attrs[METADATA_ATTR_COUNT] = {
+  ESP_AVRC_MD_ATTR_TITLE, ESP_AVRC_MD_ATTR_ARTIST, ESP_AVRC_MD_ATTR_ALBUM, ESP_AVRC_MD_ATTR_TRACK_NUM,
+  ESP_AVRC_MD_ATTR_NUM_TRACKS, ESP_AVRC_MD_ATTR_GENRE, ESP_AVRC_MD_ATTR_PLAYING_TIME
+};
+static const char *texts[METADATA_ATTR_COUNT] = {"Title", "Artist", "Album", "3", "12", "Jazz", "215000"};
+
+static uint32_t callbacks;   // Calls of the metadata callback since the last reset
+static uint8_t callbackMask;   // The attributes it reported
+static char callbackText[METADATA_ATTR_COUNT][METADATA_TEXT_SIZE];
+
+static void metadataCallback(uint8_t type, const char *text)
+{
+  callbacks++;
+  callbackMask |= type;
+  for(uint8_t i=0; i<METADATA_ATTR_COUNT; i++){
+    if(attrs[i] == type){
+      strncpy(callbackText[i], text, METADATA_TEXT_SIZE - 1);
+    }
+  }
+}
+
+static void resetCallbacks(void)
+{
+  callbacks = 0;
+  callbackMask = 0;
+  memset(callbackText, 0, sizeof(callbackText));
+}
+
+static void connect(bool connected)
+{
+  esp_avrc_ct_cb_param_t param;
+  memset(&param, 0, sizeof(param));
+  param.conn_stat.connected = connected;
+  for(uint8_t i=0; i<6; i++){
+    param.conn_stat.remote_bda[i] = (uint8_t)(0xa0 + i);
+  }
+  TestAmplifier::inject(ESP_AVRC_CT_CONNECTION_STATE_EVT, &param);
+}
+
+static void respond(uint8_t attrId, const char *text, int len)
+{
+  esp_avrc_ct_cb_param_t param;
+  memset(&param, 0, sizeof(param));
+  param.meta_rsp.attr_id = attrId;
+  param.meta_rsp.attr_text = (uint8_t *)text;
+  param.meta_rsp.attr_length = len;
+  TestAmplifier::inject(ESP_AVRC_CT_METADATA_RSP_EVT, &param);
+}
+
+static void notify(uint8_t eventId)
+{
+  esp_avrc_ct_cb_param_t param;
+  memset(&param, 0, sizeof(param));
+  param.change_ntf.event_id = eventId;
+  TestAmplifier::inject(ESP_AVRC_CT_CHANGE_NOTIFY_EVT, &param);
+}
+
+static void checkEvents(DFRobot_MAX98357A &amplifier)
+{
+  amplifier.setMetadataCallback(metadataCallback);
+  CHECK(amplifier.getMetadata(ESP_AVRC_MD_ATTR_TITLE) == "", "metadata before the connection");
+
+  // Connection: one command for all attributes, and the track change notification
+  hostResetCalls();
+  connect(true);
+  CHECK((hostCalls.metadataRequests == 1) && (hostCalls.metadataMask == METADATA_ATTR_ALL) && (hostCalls.metadataLabel == AVRC_TL_METADATA),
+        "%u metadata requests, mask 0x%02x", (unsigned)hostCalls.metadataRequests, hostCalls.metadataMask);
+  CHECK((hostCalls.notificationRequests == 1) && (hostCalls.notificationEvent == ESP_AVRC_RN_TRACK_CHANGE) &&
+        (hostCalls.notificationLabel == AVRC_TL_TRACK_CHANGE), "%u notification registrations, event %u",
+        (unsigned)hostCalls.notificationRequests, hostCalls.notificationEvent);
+  uint8_t *address = amplifier.getRemoteAddress();
+  CHECK((address != NULL) && (address[0] == 0xa0) && (address[5] == 0xa5), "remote address");
+
+  // The responses, one event per attribute, unknown and repeated ones do not call the callback
+  resetCallbacks();
+  for(uint8_t i=0; i<METADATA_ATTR_COUNT; i++){
+    respond(attrs[i], texts[i], (int)strlen(texts[i]));
+  }
+  respond(0x80, "unknown", 7);
+  respond(ESP_AVRC_MD_ATTR_TITLE | ESP_AVRC_MD_ATTR_ARTIST, "two bits", 8);
+  respond(ESP_AVRC_MD_ATTR_TITLE, texts[0], (int)strlen(texts[0]));
+  CHECK((callbacks == METADATA_ATTR_COUNT) && (callbackMask == METADATA_ATTR_ALL), "%u callbacks for %u attributes, mask 0x%02x",
+        (unsigned)callbacks, (unsigned)METADATA_ATTR_COUNT, callbackMask);
+  for(uint8_t i=0; i<METADATA_ATTR_COUNT; i++){
+    CHECK(strcmp(callbackText[i], texts[i]) == 0, "callback of attribute 0x%02x: \"%s\"", attrs[i], callbackText[i]);
+    CHECK(amplifier.getMetadata(attrs[i]) == texts[i], "getMetadata(0x%02x): \"%s\"", attrs[i], amplifier.getMetadata(attrs[i]).c_str());
+  }
+  CHECK(amplifier.getMetadata(0x80) == "", "an unknown attribute");
+  respond(ESP_AVRC_MD_ATTR_ARTIST, "Other", 5);
+  CHECK((callbacks == METADATA_ATTR_COUNT + 1) && (amplifier.getMetadata(ESP_AVRC_MD_ATTR_ARTIST) == "Other"), "a changed attribute");
+
+  // A long title of 2-byte characters is cut before the character that does not fit
+  char longText[300];
+  for(size_t i=0; i<sizeof(longText); i+=2){
+    longText[i] = (char)0xc3;
+    longText[i + 1] = (char)0xa9;   // U+00E9
+  }
+  respond(ESP_AVRC_MD_ATTR_TITLE, longText, (int)sizeof(longText));
+  String title = amplifier.getMetadata(ESP_AVRC_MD_ATTR_TITLE);
+  CHECK((title.length() == (METADATA_TEXT_SIZE - 1) / 2 * 2) && (memcmp(title.c_str(), longText, title.length()) == 0),
+        "a long title is cut to %u bytes", (unsigned)title.length());
+
+  // Track change: the cache empties, the metadata is requested again and the registration renewed
+  hostResetCalls();
+  resetCallbacks();
+  notify(ESP_AVRC_RN_PLAY_STATUS_CHANGE);
+  CHECK((callbacks == 0) && (hostCalls.metadataRequests == 0) && (hostCalls.notificationRequests == 0), "another notification");
+  notify(ESP_AVRC_RN_TRACK_CHANGE);
+  CHECK((callbacks == METADATA_ATTR_COUNT) && (callbackMask == METADATA_ATTR_ALL) && (callbackText[0][0] == 0),
+        "%u callbacks on the track change, mask 0x%02x", (unsigned)callbacks, callbackMask);
+  for(uint8_t i=0; i<METADATA_ATTR_COUNT; i++){
+    CHECK(amplifier.getMetadata(attrs[i]) == "", "attribute 0x%02x after the track change", attrs[i]);
+  }
+  CHECK((hostCalls.metadataRequests == 1) && (hostCalls.metadataMask == METADATA_ATTR_ALL), "metadata requested again on the track change");
+  CHECK((hostCalls.notificationRequests == 1) && (hostCalls.notificationEvent == ESP_AVRC_RN_TRACK_CHANGE), "the registration renewed");
+  respond(ESP_AVRC_MD_ATTR_TITLE, "Next", 4);
+  CHECK(amplifier.getMetadata(ESP_AVRC_MD_ATTR_TITLE) == "Next", "the title of the next track");
+
+  // Disconnection: the cache empties, nothing is requested
+  hostResetCalls();
+  resetCallbacks();
+  connect(false);
+  CHECK((callbacks == 1) && (callbackMask == ESP_AVRC_MD_ATTR_TITLE), "%u callbacks on disconnection", (unsigned)callbacks);
+  CHECK((amplifier.getMetadata(ESP_AVRC_MD_ATTR_TITLE) == "") && (amplifier.getRemoteAddress() == NULL), "disconnected");
+  CHECK(hostCalls.metadataRequests == 0, "metadata requested on disconnection");
+  amplifier.setMetadataCallback(NULL);
+}
+
+static std::atomic<bool> writing(false);
+
+/**
+ * Responses of the Bluetooth task, each text one letter repeated, of a length of its own
+ */
+static void bluetoothTask(void)
+{
+  char text[METADATA_TEXT_SIZE];
+  for(uint32_t i=0; i<STRESS_WRITES; i++){
+    int len = 1 + (int)(i * 37 % (METADATA_TEXT_SIZE - 1));
+    memset(text, 'a' + (char)(i % 26), len);
+    respond(ESP_AVRC_MD_ATTR_TITLE, text, len);
+  }
+  writing = false;
+}
+
+static void checkReader(DFRobot_MAX98357A &amplifier)
+{
+  writing = true;
+  std::thread writer(bluetoothTask);
+  uint32_t reads = 0, torn = 0;
+  while(writing){
+    String title = amplifier.getMetadata(ESP_AVRC_MD_ATTR_TITLE);
+    const char *text = title.c_str();
+    for(size_t i=1; i<title.length(); i++){
+      if(text[i] != text[0]){
+        torn++;
+        break;
+      }
+    }
+    reads++;
+  }
+  writer.join();
+  CHECK(torn == 0, "%u of %u titles read half-written", (unsigned)torn, (unsigned)reads);
+}
+
+static void benchGet(DFRobot_MAX98357A &amplifier)
+{
+  respond(ESP_AVRC_MD_ATTR_ARTIST, "Artist", 6);
+  size_t length = 0;
+  uint64_t start = hostNanos(), cycles = hostCycles();
+  for(uint32_t i=0; i<GET_ROUNDS; i++){
+    length += amplifier.getMetadata(ESP_AVRC_MD_ATTR_ARTIST).length();
+  }
+  benchResult("getMetadata", GET_ROUNDS, hostNanos() - start, hostCycles() - cycles);
+  CHECK(length == GET_ROUNDS * 6, "getMetadata returned %u bytes", (unsigned)length);
+}
+
+int main(void)
+{
+  DFRobot_MAX98357A amplifier;
+  checkEvents(amplifier);
+  checkReader(amplifier);
+  benchBegin("MetadataTest");
+  benchGet(amplifier);
+  benchEnd();
+  return hostTestResult("MetadataTest");
+}
@@ -0,0 +1,194 @@
+/*!
+ * @file  MusicIndexTest.cpp
+ * @brief  Build the music index of a directory tree and check what update() re-examines when the tree changes
+ * @details  The tree holds WAV files of several formats in nested directories, a file with a bad header and a file
+ * @n        which is not a WAV file. An update without changes must not open any directory or header again, adding or
+ * @n        removing a file must only re-examine its own directory, and a full update must parse every header again.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <map>
+#include <string>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+/**
+ * @struct sExpected_t
+ * @brief A WAV file written to the tree
+ */
+typedef struct
+{
+  uint16_t formatTag;
+  uint16_t channels;
+  uint32_t sampleRate;
+  uint16_t bits;
+  uint32_t size;   // File size
+  uint32_t dataOffset;
+  uint32_t dataSize;
+}sExpected_t;
+
+static char root[] = "/tmp/mi.XXXXXX";   // The index file path must fit MUSIC_INDEX_ROOT_LEN
+static std::map<std::string, sExpected_t> expected;   // By the path relative to the root
+
+static void put16(FILE *fp, uint16_t x) { fputc(x & 0xff, fp); fputc(x >> 8, fp); }
+static void put32(FILE *fp, uint32_t x) { put16(fp, x & 0xffff); put16(fp, x >> 16); }
+
+/**
+ * Write a WAV file, with a LIST chunk between the fmt and data chunks when list is true
+ */
+static void writeWav(const char *rel, uint16_t formatTag, uint16_t channels, uint32_t sampleRate, uint16_t bits,
+                     uint32_t frames, bool list=false)
+{
+  std::string path = std::string(root) + rel;
+  FILE *fp = fopen(path.c_str(), "wb");
+  uint16_t blockAlign = channels * bits / 8;
+  uint32_t dataSize = frames * blockAlign;
+  uint32_t listSize = list ? 8 + 10 : 0;
+  fwrite("RIFF", 1, 4, fp);
+  put32(fp, 4 + 8 + 16 + listSize + 8 + dataSize);
+  fwrite("WAVEfmt ", 1, 8, fp);
+  put32(fp, 16);
+  put16(fp, formatTag);
+  put16(fp, channels);
+  put32(fp, sampleRate);
+  put32(fp, sampleRate * blockAlign);
+  put16(fp, blockAlign);
+  put16(fp, bits);
+  if(list){
+    fwrite("LIST", 1, 4, fp);
+    put32(fp, 10);
+    fwrite("INFOxxxxxx", 1, 10, fp);
+  }
+  fwrite("data", 1, 4, fp);
+  put32(fp, dataSize);
+  for(uint32_t i=0; i<dataSize; i++){
+    fputc(i & 0xff, fp);
+  }
+  fclose(fp);
+
+  sExpected_t e = {formatTag, channels, sampleRate, bits, 44 + listSize + dataSize, 44 + listSize, dataSize};
+  expected[rel] = e;
+}
+
+static void writeText(const char *rel, const char *text)
+{
+  FILE *fp = fopen((std::string(root) + rel).c_str(), "wb");
+  fputs(text, fp);
+  fclose(fp);
+}
+
+static void removeFile(const char *rel)
+{
+  remove((std::string(root) + rel).c_str());
+  expected.erase(rel);
+}
+
+static void makeDir(const char *rel)
+{
+  mkdir((std::string(root) + rel).c_str(), 0755);
+}
+
+/**
+ * Check that the index holds exactly the expected tracks, read in reverse order so that every page is read again
+ */
+static void checkTracks(const char *step, MusicIndex &index)
+{
+  CHECK(index.count() == expected.size(), "%s: %u tracks, expected %u", step, index.count(), (unsigned)expected.size());
+  std::map<std::string, int> seen;
+  sMusicTrack_t track;
+  for(uint32_t i=index.count(); i-- > 0;){
+    if(!index.getTrack(i, &track)){
+      CHECK(false, "%s: track %u not read", step, i);
+      continue;
+    }
+    seen[track.path]++;
+    std::map<std::string, sExpected_t>::const_iterator it = expected.find(track.path);
+    if(it == expected.end()){
+      CHECK(false, "%s: unexpected track %s", step, track.path);
+      continue;
+    }
+    const sExpected_t &e = it->second;
+    CHECK((track.size == e.size) && (track.format.formatTag == e.formatTag) && (track.format.numChannels == e.channels) &&
+          (track.format.sampleRate == e.sampleRate) && (track.format.bitsPerSample == e.bits) &&
+          (track.format.dataOffset == e.dataOffset) && (track.format.dataSize == e.dataSize),
+          "%s: %s has size %u, format %u/%u/%u/%u, data %u+%u", step, track.path, track.size, track.format.formatTag,
+          track.format.numChannels, track.format.sampleRate, track.format.bitsPerSample, track.format.dataOffset,
+          track.format.dataSize);
+  }
+  for(std::map<std::string, int>::const_iterator it=seen.begin(); it!=seen.end(); ++it){
+    CHECK(it->second == 1, "%s: %s listed %d times", step, it->first.c_str(), it->second);
+  }
+  CHECK(!index.getTrack(index.count(), &track), "%s: track past the end was read", step);
+}
+
+static void checkUpdate(const char *step, MusicIndex &index, bool full, uint32_t dirs, uint32_t parsed)
+{
+  CHECK(index.update(full), "%s: update failed", step);
+  CHECK(index.getScannedDirs() == dirs, "%s: %u directories re-examined, expected %u", step, index.getScannedDirs(), dirs);
+  CHECK(index.getParsedFiles() == parsed, "%s: %u headers parsed, expected %u", step, index.getParsedFiles(), parsed);
+  checkTracks(step, index);
+}
+
+static int removeEntry(const char *path, const struct stat *st, int flag, struct FTW *ftw)
+{
+  return remove(path);
+}
+
+int main(void)
+{
+  if(mkdtemp(root) == NULL){
+    printf("MusicIndexTest: no temporary directory\n");
+    return 1;
+  }
+  std::string indexFile = std::string(root) + "/.musicindex";
+
+  makeDir("/d1");
+  makeDir("/d2");
+  makeDir("/d2/sub");
+  makeDir("/d3");
+  writeWav("/a.wav", WAV_FORMAT_PCM, 2, 44100, 16, 100);
+  writeWav("/d1/b.wav", WAV_FORMAT_PCM, 1, 22050, 8, 33);
+  writeWav("/d1/C.WAV", WAV_FORMAT_PCM, 2, 48000, 24, 10, true);
+  writeWav("/d2/sub/e.wav", WAV_FORMAT_IEEE_FLOAT, 2, 96000, 32, 7);
+  char name[32];
+  for(int i=0; i<10; i++){   // More than a page of tracks in one directory
+    sprintf(name, "/d3/t%02d.wav", i);
+    writeWav(name, WAV_FORMAT_PCM, 2, 32000, 16, 5 + i);
+  }
+  writeText("/bad.wav", "not a RIFF file");   // Parsed, but not indexed
+  writeText("/d1/readme.txt", "not a WAV file");   // Not even parsed
+
+  MusicIndex index;
+  CHECK(!index.begin(root, indexFile.c_str()), "An index was found before the first update");
+  checkUpdate("first update", index, false, 5, 15);
+  checkUpdate("unchanged", index, false, 0, 0);
+
+  MusicIndex reopened;
+  CHECK(reopened.begin(root, indexFile.c_str()), "The index was not opened again");
+  checkTracks("reopened", reopened);
+  reopened.end();
+
+  writeWav("/d2/sub/f.wav", WAV_FORMAT_PCM, 1, 16000, 16, 3);
+  checkUpdate("file added", index, false, 1, 1);
+
+  removeFile("/d1/b.wav");
+  checkUpdate("file removed", index, false, 1, 0);   // C.WAV is copied from the previous index
+
+  makeDir("/d4");
+  writeWav("/d4/g.wav", WAV_FORMAT_PCM, 2, 8000, 16, 2);
+  checkUpdate("directory added", index, false, 2, 2);   // The root lists a new entry, its bad.wav is parsed again
+
+  writeWav("/a.wav", WAV_FORMAT_PCM, 1, 11025, 16, 200);   // Replaced under the same name, the root signature is the same
+  checkUpdate("full update", index, true, 6, 16);
+
+  index.end();
+  nftw(root, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+  return hostTestResult("MusicIndexTest");
+}
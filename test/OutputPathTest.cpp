@@ -0,0 +1,269 @@
+/*!
+ * @file  OutputPathTest.cpp
+ * @brief  Stream a pattern through the output task into a recording sink, and check the in-place output paths bit for bit
+ * @details  Every frame of the pattern is unique and its channels differ, so each frame the sink records tells whether it
+ * @n        was passed through, swapped or processed, and where it belongs in the stream. OUTPUT_PATH_PASSTHROUGH and
+ * @n        OUTPUT_PATH_SWAP must give the pattern bit for bit over many wraps of the PCM buffer. Gain, filter and swap
+ * @n        are then switched, once with the stream drained between the settings and once while it flows: no frame may be
+ * @n        lost or repeated through the limiter and the crossfade, and the in-place paths must be bit-exact again once
+ * @n        the gain is back at unity and the filter off.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <atomic>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define RECORD_FRAMES   ((uint32_t)(600000))   // Capacity of the recording sink
+#define PHASE_FRAMES   ((uint32_t)(20000))   // Frames of one drained phase, about five wraps of the PCM buffer
+#define BLOCK_FRAMES   ((uint32_t)(777))   // Frames per write, odd so the writes and the reads cross the wrap anywhere
+#define STREAM_FRAMES   ((uint32_t)(120000))   // Frames of each stream with settings switched while it flows
+#define TOGGLE_EVERY   ((uint32_t)(3000))   // Frames written between two switches
+#define NEAR_ZERO_FRAMES   ((uint32_t)(64))   // Processed frames of a phase that may still come out as the pattern, those near zero
+#define DRAIN_MS   ((uint32_t)(5000))   // The longest wait for the output task to write everything to the sink
+
+/**
+ * Takes everything, and records the 16-bit frames in the order they were written
+ */
+class RecordingSink : public AudioSink
+{
+public:
+  RecordingSink(void) : frames(0) {}
+
+  size_t write(const void *data, size_t len, uint32_t ticksToWait)
+  {
+    uint32_t n = frames.load(std::memory_order_relaxed);
+    uint32_t add = (uint32_t)(len / 4);
+    add = (n + add > RECORD_FRAMES) ? (RECORD_FRAMES - n) : add;
+    memcpy(record + 2 * n, data, add * 4);
+    frames.store(n + add, std::memory_order_release);
+    return len;
+  }
+
+  int16_t record[RECORD_FRAMES * 2];
+  std::atomic<uint32_t> frames;
+};
+
+class TestAmplifier : public DFRobot_MAX98357A
+{
+public:
+  static bool write(const uint8_t *data, uint32_t len, uint32_t ticksToWait) { return writeToBuffer(data, len, ticksToWait); }
+  void stop(void) { end(); }
+};
+
+static RecordingSink sink;
+static uint32_t written;   // Frames of the pattern written so far
+
+static int16_t patternL(uint32_t k)
+{
+  return (int16_t)((k * 2654435761u) >> 16);
+}
+
+static int16_t patternR(uint32_t k)
+{
+  return (int16_t)~patternL(k);   // Never equal to the left sample
+}
+
+/**
+ * Write the next frames of the pattern, in blocks of BLOCK_FRAMES
+ */
+static void writePattern(uint32_t frames)
+{
+  static int16_t block[BLOCK_FRAMES * 2];
+  while(frames > 0){
+    uint32_t n = (frames < BLOCK_FRAMES) ? frames : BLOCK_FRAMES;
+    for(uint32_t i=0; i<n; i++){
+      block[2 * i] = patternL(written + i);
+      block[2 * i + 1] = patternR(written + i);
+    }
+    TestAmplifier::write((const uint8_t *)block, n * 4, portMAX_DELAY);
+    written += n;
+    frames -= n;
+  }
+}
+
+/**
+ * Wait until the sink has every frame written, the output task flushes the rest after OUTPUT_WAIT_TICKS
+ */
+static bool drain(void)
+{
+  for(uint32_t waited=0; waited<DRAIN_MS; waited+=5){
+    if(sink.frames.load(std::memory_order_acquire) >= written){
+      delay(5 * OUTPUT_WAIT_TICKS);   // And nothing more comes
+      return sink.frames.load(std::memory_order_acquire) == written;
+    }
+    delay(5);
+  }
+  return false;
+}
+
+typedef enum
+{
+  eFramePassed = 0,
+  eFrameSwapped,
+  eFrameOther,   // Processed
+}eFrame_t;
+
+static eFrame_t frameAt(uint32_t k)
+{
+  int16_t l = sink.record[2 * k], r = sink.record[2 * k + 1];
+  if((l == patternL(k)) && (r == patternR(k))){
+    return eFramePassed;
+  }
+  return ((l == patternR(k)) && (r == patternL(k))) ? eFrameSwapped : eFrameOther;
+}
+
+/**
+ * Count the recorded frames from start to end that are not of the given kind
+ */
+static uint32_t countNot(eFrame_t kind, uint32_t start, uint32_t end)
+{
+  uint32_t n = 0;
+  for(uint32_t k=start; k<end; k++){
+    n += (frameAt(k) != kind);
+  }
+  return n;
+}
+
+/**
+ * One setting at a time, written and drained before the next
+ */
+static void checkDrained(TestAmplifier &amplifier)
+{
+  // The default source is Bluetooth, whose channels are swapped
+  uint32_t start = written;
+  writePattern(PHASE_FRAMES);
+  CHECK(drain(), "swap: %u of %u frames", sink.frames.load(), written);
+  CHECK(countNot(eFrameSwapped, start, written) == 0, "swap: %u frames not swapped bit for bit", countNot(eFrameSwapped, start, written));
+
+  amplifier.reverseLeftRightChannels();
+  start = written;
+  writePattern(PHASE_FRAMES);
+  CHECK(drain(), "passthrough: %u of %u frames", sink.frames.load(), written);
+  CHECK(countNot(eFramePassed, start, written) == 0, "passthrough: %u frames not passed bit for bit", countNot(eFramePassed, start, written));
+
+  // Below unity: the volume chain, it ramps over the first block
+  amplifier.setVolume(2.5f);
+  start = written;
+  writePattern(PHASE_FRAMES);
+  CHECK(drain(), "half volume: %u of %u frames", sink.frames.load(), written);
+  uint32_t off = 0;
+  for(uint32_t k=start + I2S_DMA_BUF_LEN; k<written; k++){
+    off += (abs(sink.record[2 * k] - patternL(k) / 2) > 2) || (abs(sink.record[2 * k + 1] - patternR(k) / 2) > 2);
+  }
+  CHECK(off == 0, "half volume: %u frames not at half the pattern", off);
+
+  // Back at unity, in place again after the ramp
+  amplifier.setVolume(5.0f);
+  start = written;
+  writePattern(PHASE_FRAMES);
+  CHECK(drain(), "unity after half volume: %u of %u frames", sink.frames.load(), written);
+  CHECK(countNot(eFramePassed, start + I2S_DMA_BUF_LEN, written) == 0, "unity after half volume: %u frames not passed",
+        countNot(eFramePassed, start + I2S_DMA_BUF_LEN, written));
+
+  // Above unity the limiter is in the path, its delay line is primed and flushed without losing a frame
+  amplifier.setVolume(7.0f);
+  start = written;
+  writePattern(PHASE_FRAMES);
+  CHECK(drain(), "limiter: %u of %u frames", sink.frames.load(), written);
+  CHECK(countNot(eFrameOther, start + I2S_DMA_BUF_LEN, written) < NEAR_ZERO_FRAMES, "limiter: %u frames not processed",
+        countNot(eFrameOther, start + I2S_DMA_BUF_LEN, written));
+  amplifier.setVolume(5.0f);
+  start = written;
+  writePattern(PHASE_FRAMES);
+  CHECK(drain(), "unity after the limiter: %u of %u frames", sink.frames.load(), written);
+  CHECK(countNot(eFramePassed, start + I2S_DMA_BUF_LEN, written) == 0, "unity after the limiter: %u frames not passed",
+        countNot(eFramePassed, start + I2S_DMA_BUF_LEN, written));
+
+  // The filter, opened twice so the second crossfade starts from scratch, and swapped meanwhile
+  for(int round=0; round<2; round++){
+    amplifier.openFilter(bq_type_lowpass, 4000.0f);
+    start = written;
+    writePattern(PHASE_FRAMES);
+    amplifier.reverseLeftRightChannels();
+    writePattern(PHASE_FRAMES);
+    amplifier.reverseLeftRightChannels();
+    CHECK(drain(), "filter %d: %u of %u frames", round, sink.frames.load(), written);
+    CHECK(countNot(eFrameOther, start, written) < I2S_DMA_BUF_LEN, "filter %d: %u frames not filtered", round, countNot(eFrameOther, start, written));
+    amplifier.closeFilter();
+    start = written;
+    writePattern(PHASE_FRAMES);
+    CHECK(drain(), "filter %d closed: %u of %u frames", round, sink.frames.load(), written);
+    CHECK(countNot(eFramePassed, start, written) == 0, "filter %d closed: %u frames not passed", round, countNot(eFramePassed, start, written));
+  }
+}
+
+/**
+ * Only the channels are switched while the stream flows, every frame must be in place, passed or swapped
+ */
+static void checkSwapStream(TestAmplifier &amplifier)
+{
+  uint32_t start = written;
+  for(uint32_t sent=0; sent<STREAM_FRAMES; sent+=TOGGLE_EVERY){
+    writePattern(TOGGLE_EVERY);
+    amplifier.reverseLeftRightChannels();
+  }
+  if((STREAM_FRAMES / TOGGLE_EVERY) & 1){
+    amplifier.reverseLeftRightChannels();   // Passthrough again
+  }
+  CHECK(drain(), "swap stream: %u of %u frames", sink.frames.load(), written);
+  uint32_t passed = 0, swapped = 0;
+  for(uint32_t k=start; k<written; k++){
+    eFrame_t kind = frameAt(k);
+    passed += (kind == eFramePassed);
+    swapped += (kind == eFrameSwapped);
+  }
+  CHECK((passed + swapped == written - start) && (passed > 0) && (swapped > 0), "swap stream: %u passed, %u swapped of %u frames",
+        passed, swapped, written - start);
+}
+
+/**
+ * Gain, filter and swap are switched while the stream flows, no frame may be lost or repeated, and the output must be
+ * bit-exact again after the last switch
+ */
+static void checkMixedStream(TestAmplifier &amplifier)
+{
+  uint32_t start = written;
+  writePattern(TOGGLE_EVERY);
+  amplifier.setVolume(2.5f);
+  writePattern(TOGGLE_EVERY);
+  amplifier.openFilter(bq_type_lowpass, 4000.0f);
+  writePattern(TOGGLE_EVERY);
+  amplifier.reverseLeftRightChannels();
+  writePattern(TOGGLE_EVERY);
+  amplifier.setVolume(7.0f);   // The limiter joins the filter
+  writePattern(TOGGLE_EVERY);
+  amplifier.closeFilter();
+  writePattern(TOGGLE_EVERY);
+  amplifier.reverseLeftRightChannels();
+  writePattern(TOGGLE_EVERY);
+  amplifier.openFilter(bq_type_highpass, 200.0f);
+  writePattern(TOGGLE_EVERY);
+  amplifier.closeFilter();
+  amplifier.setVolume(5.0f);   // Unity again, in place after the ramp and the flush of the limiter
+  uint32_t last = written;
+  writePattern(STREAM_FRAMES - (written - start));
+  CHECK(drain(), "mixed stream: %u of %u frames", sink.frames.load(), written);
+  uint32_t tail = last + 2 * I2S_DMA_BUF_LEN;
+  CHECK(countNot(eFramePassed, tail, written) == 0, "mixed stream: %u of the last %u frames not passed",
+        countNot(eFramePassed, tail, written), written - tail);
+  CHECK(countNot(eFrameOther, start + TOGGLE_EVERY + PCM_BUFFER_SIZE / 4, last) < (last - start) / 4, "mixed stream: too few processed frames");
+}
+
+int main(void)
+{
+  TestAmplifier amplifier;
+  amplifier.setAudioSink(&sink);
+  CHECK(amplifier.initI2S(25, 26, 27), "initI2S");
+
+  checkDrained(amplifier);
+  checkSwapStream(amplifier);
+  checkMixedStream(amplifier);
+  printf("%u frames recorded, %u ring wraps\n", sink.frames.load(), (unsigned)(written * 4ULL / amplifier.getPCMBuffer()->size()));
+  amplifier.stop();
+  return hostTestResult("OutputPathTest");
+}
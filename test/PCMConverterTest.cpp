@@ -0,0 +1,173 @@
+/*!
+ * @file  PCMConverterTest.cpp
+ * @brief  Check the WAV sample converters bit-exactly against a plain reference, and time them
+ * @details  8-bit, 16-bit and 24-bit samples are checked exhaustively, 32-bit and float samples with their edge cases and
+ * @n        random values. The source is read from an odd address, as a WAV file gives no alignment. select() must pick
+ * @n        the kernel of each layout. Built with PCM_WIDE_SAMPLES as well, the samples must then keep all of their bits,
+ * @n        left-justified in 32 bits.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <vector>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define CHUNK_FRAMES   ((size_t)(4096))   // Frames converted per call
+
+/**
+ * The sample of the reference, in double so that nothing overflows
+ */
+static pcm_t reference(int bits, bool isFloat, const uint8_t *p)
+{
+  double scale = 32768.0 * (1 << PCM_FRACTION_BITS);   // Full scale of the samples
+  if(isFloat){
+    float f;
+    memcpy(&f, p, 4);   // The host is little-endian as the WAV file
+    if(f != f){
+      return (pcm_t)PCM_SAMPLE_MAX;   // NaN saturates high
+    }
+    double x = (double)f * scale;
+    if(x >= PCM_SAMPLE_MAX){
+      return (pcm_t)PCM_SAMPLE_MAX;
+    }
+    if(x <= PCM_SAMPLE_MIN){
+      return (pcm_t)PCM_SAMPLE_MIN;
+    }
+    double r = floor(x + 0.5);
+    if((r - x == 0.5) && (fmod(r, 2.0) != 0.0)){   // Halfway rounds to even, as lrintf()
+      r -= 1.0;
+    }
+    return (pcm_t)r;
+  }
+  int64_t x;   // Left-justified in 32 bits
+  switch(bits){
+    case 8:
+      x = ((int64_t)p[0] - 128) << 24;
+      break;
+    case 16:
+      x = (int64_t)(int16_t)(uint16_t)(p[0] | (p[1] << 8)) << 16;
+      break;
+    case 24:
+      x = (int64_t)(int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24);
+      break;
+    default:
+      x = (int64_t)(int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+      break;
+  }
+  return (pcm_t)(x >> (16 - PCM_FRACTION_BITS));   // The low-memory mode keeps the top 16 bits
+}
+
+/**
+ * Convert the samples with the kernel selected for the layout and compare every output sample with the reference
+ */
+static void checkLayout(const char *name, int bits, bool isFloat, int channels, const std::vector<uint8_t> &samples)
+{
+  sWavFormat_t format;
+  memset(&format, 0, sizeof(format));
+  format.formatTag = isFloat ? WAV_FORMAT_IEEE_FLOAT : WAV_FORMAT_PCM;
+  format.numChannels = channels;
+  format.bitsPerSample = bits;
+  format.validBits = bits;
+  format.blockAlign = channels * bits / 8;
+  pcmConvert_t convert = PCMConverter::select(format);
+  CHECK((convert != NULL) || ((bits == 16) && (channels == 2) && !isFloat && (PCM_FRACTION_BITS == 0)), "%s: no kernel", name);
+  if(convert == NULL){
+    return;
+  }
+
+  size_t bytes = bits / 8;
+  size_t frames = samples.size() / (bytes * channels);
+  std::vector<uint8_t> source(samples.size() + 1);
+  memcpy(source.data() + 1, samples.data(), samples.size());   // At an odd address
+  static pcm_t out[CHUNK_FRAMES * 2];
+
+  uint32_t errors = 0;
+  uint64_t ns = 0;
+  for(size_t done=0; done<frames; done+=CHUNK_FRAMES){
+    size_t n = (frames - done < CHUNK_FRAMES) ? (frames - done) : CHUNK_FRAMES;
+    const uint8_t *in = source.data() + 1 + done * bytes * channels;
+    uint64_t start = hostNanos();
+    convert(in, out, n);
+    ns += hostNanos() - start;
+    for(size_t i=0; i<n; i++){
+      for(int ch=0; ch<2; ch++){
+        pcm_t expected = reference(bits, isFloat, in + (i * channels + ((channels == 2) ? ch : 0)) * bytes);
+        if((out[2 * i + ch] != expected) && (errors++ < 5)){
+          printf("%s: frame %u channel %d is %ld, expected %ld\n", name, (unsigned)(done + i), ch, (long)out[2 * i + ch], (long)expected);
+        }
+      }
+    }
+  }
+  CHECK(errors == 0, "%s: %u samples differ", name, errors);
+  benchResult(name, frames, ns);
+}
+
+static void put(std::vector<uint8_t> &v, uint32_t x, int bytes)
+{
+  for(int i=0; i<bytes; i++){
+    v.push_back((uint8_t)(x >> (8 * i)));
+  }
+}
+
+int main(void)
+{
+  std::vector<uint8_t> all8, all16, all24, some32, floats;
+  for(uint32_t x=0; x<256; x++){
+    put(all8, x, 1);
+  }
+  for(uint32_t x=0; x<65536; x++){
+    put(all16, x, 2);
+  }
+  for(uint32_t x=0; x<(1u << 24); x++){
+    put(all24, x, 3);
+  }
+  uint32_t state = 2463534242u;
+  static const uint32_t edges32[] = {0, 1, 0xffff, 0x10000, 0x7fffffff, 0x80000000, 0xffffffff, 0x7fff0000, 0x8000ffff};
+  for(uint32_t x : edges32){
+    put(some32, x, 4);
+  }
+  static const float edges[] = {0.0f, -0.0f, 1.0f, -1.0f, 0.5f, -0.5f, 1.5f, -1.5f, 1e-9f, -1e-9f, 1e30f, -1e30f,
+                                0.5f / 32768, 1.5f / 32768, 2.5f / 32768, -0.5f / 32768, -2.5f / 32768, 32767.5f / 32768,
+                                -32768.5f / 32768, 0.5f / 2147483648.0f, 2.5f / 2147483648.0f, -1.5f / 2147483648.0f,
+                                (float)INFINITY, -(float)INFINITY, (float)NAN};   // Halfway between the steps of both modes
+  for(float f : edges){
+    uint32_t u;
+    memcpy(&u, &f, 4);
+    put(floats, u, 4);
+  }
+  for(int i=0; i<1000000; i++){
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    put(some32, state, 4);
+    float f = (float)(int32_t)state / 1073741824.0f;   // -2.0 to 2.0, a quarter of them clip
+    uint32_t u;
+    memcpy(&u, &f, 4);
+    put(floats, u, 4);
+  }
+  floats.resize(floats.size() - floats.size() % 8);   // Whole stereo frames
+  some32.resize(some32.size() - some32.size() % 8);
+
+  benchBegin("PCMConverterTest");
+  checkLayout("mono8", 8, false, 1, all8);
+  checkLayout("stereo8", 8, false, 2, all8);
+  checkLayout("mono16", 16, false, 1, all16);
+  checkLayout("stereo16", 16, false, 2, all16);   // Used in place in the low-memory mode, no kernel
+  checkLayout("mono24", 24, false, 1, all24);
+  checkLayout("stereo24", 24, false, 2, all24);
+  checkLayout("mono32", 32, false, 1, some32);
+  checkLayout("stereo32", 32, false, 2, some32);
+  checkLayout("monoFloat", 32, true, 1, floats);
+  checkLayout("stereoFloat", 32, true, 2, floats);
+  benchEnd();
+
+  // stereo16 is still a kernel, e.g. for data of an odd address
+  static pcm_t out[2];
+  PCMConverter::stereo16(all16.data() + 2 * 0x1234, out, 1);
+  CHECK((out[0] == (0x1234 << PCM_FRACTION_BITS)) && (out[1] == (0x1235 << PCM_FRACTION_BITS)), "stereo16 %ld %ld", (long)out[0], (long)out[1]);
+  return hostTestResult("PCMConverterTest");
+}
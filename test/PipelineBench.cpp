@@ -0,0 +1,28 @@
+/*!
+ * @file  PipelineBench.cpp
+ * @brief  Run the benchmark example on the host
+ * @details  The sketch is compiled as it is against the stubs, so the real A2DP data callback, output processing, converters
+ * @n        and filters are measured, and its JSON document is printed to stdout. The fixed-point build is the same sketch
+ * @n        with FILTER_FIXED_POINT defined.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <stdint.h>
+
+// The prototypes the Arduino builder generates for the sketch
+void makeTestSignal(void);
+void setSwap(bool swap);
+void benchA2DP(const char *name);
+void benchSD(const char *name, uint16_t bits, uint32_t rate, uint8_t quality);
+
+#include "../examples/benchmark/benchmark.ino"
+
+int main(void)
+{
+  setup();
+  return 0;
+}
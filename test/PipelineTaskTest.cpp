@@ -0,0 +1,206 @@
+/*!
+ * @file  PipelineTaskTest.cpp
+ * @brief  Stop the pipeline tasks the way end() does, and measure how the throughput scales with the tasks on their cores
+ * @details  A task waiting for a notification, or looping with a lock held for part of each turn, must leave its loop on
+ * @n        stop() without ending inside the lock, and a task whose function returns must count as ended and be started
+ * @n        again. The threads carry the task name and are pinned to the core of their configuration. For the scaling, each
+ * @n        task converts the sample rate of its own block of audio: with as many tasks as cores, up to two as on the
+ * @n        ESP32, the work done per second must grow with the tasks.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <mutex>
+#include <thread>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define WORK_IN_FRAMES   ((size_t)(48000))   // One second at 48 kHz, converted by each task
+#define WORK_ROUNDS   ((uint32_t)(20))
+#define SCALING_MIN   (1.5)   // The speedup of two tasks on two cores, 2.0 at best
+
+static const sTaskConfig_t testConfig = {1, 5, 4096};
+
+static std::atomic<uint32_t> waits(0);   // Notifications taken by the waiting task
+static std::atomic<bool> waitEnded(false);
+
+static void waitingTask(void *arg)
+{
+  while(PipelineTask::keepRunning()){
+    if(PipelineTask::wait(portMAX_DELAY)){
+      waits++;
+    }
+  }
+  waitEnded = true;
+}
+
+static std::mutex lock;   // Held by the locking task for part of each turn, as the prefetch lock is
+static std::atomic<bool> lockEnded(false);
+
+static void lockingTask(void *arg)
+{
+  while(PipelineTask::keepRunning()){
+    lock.lock();
+    PipelineTask::sleep(2);
+    lock.unlock();
+    PipelineTask::sleep(1);
+  }
+  lockEnded = true;
+}
+
+/**
+ * The CPUs the test may run on, and the one the n-th core of a task configuration is pinned to
+ */
+static int allowedCPUs(int n, int *cpu)
+{
+  cpu_set_t allowed;
+  sched_getaffinity(0, sizeof(allowed), &allowed);
+  n %= CPU_COUNT(&allowed);
+  for(int i=0; i<CPU_SETSIZE; i++){
+    if(CPU_ISSET(i, &allowed) && (n-- == 0)){
+      *cpu = i;
+    }
+  }
+  return CPU_COUNT(&allowed);
+}
+
+static char taskName[16];
+static cpu_set_t taskCPUs;
+
+static void namedTask(void *arg)
+{
+  pthread_getname_np(pthread_self(), taskName, sizeof(taskName));
+  pthread_getaffinity_np(pthread_self(), sizeof(taskCPUs), &taskCPUs);
+}
+
+static void checkStop(void)
+{
+  PipelineTask task;
+  CHECK(task.start("waitingTask", waitingTask, NULL, testConfig) && task.isRunning(), "start");
+  CHECK(!task.start("waitingTask", waitingTask, NULL, testConfig), "started twice");
+  for(uint32_t i=0; i<3; i++){
+    task.notify();
+    PipelineTask::sleep(20);
+  }
+  task.stop();
+  CHECK(waitEnded && !task.isRunning(), "the waiting task did not leave its loop");
+  CHECK(waits == 3, "%u of 3 notifications taken", (unsigned)waits.load());
+
+  PipelineTask locking;
+  CHECK(locking.start("lockingTask", lockingTask, NULL, testConfig), "start");
+  for(uint32_t i=0; i<20; i++){
+    PipelineTask::sleep(1);
+    locking.stop();   // Anywhere in the turn
+    CHECK(lockEnded, "the locking task did not leave its loop");
+    CHECK(lock.try_lock(), "the locking task ended holding the lock");
+    lock.unlock();
+    lockEnded = false;
+    CHECK(locking.start("lockingTask", lockingTask, NULL, testConfig), "start again");
+  }
+  locking.stop();
+}
+
+static void checkThread(void)
+{
+  int cpu = -1;
+  allowedCPUs(testConfig.core, &cpu);
+  PipelineTask task;
+  CHECK(task.start("prefetchTaskWithALongName", namedTask, NULL, testConfig), "start");
+  for(uint32_t i=0; (i<1000) && task.isRunning(); i++){
+    PipelineTask::sleep(1);
+  }
+  CHECK(!task.isRunning(), "a task whose function returned still runs");
+  CHECK(strcmp(taskName, "prefetchTaskWit") == 0, "the thread is named \"%s\"", taskName);
+  CHECK((CPU_COUNT(&taskCPUs) == 1) && CPU_ISSET(cpu, &taskCPUs), "the thread runs on %d CPUs, not on CPU %d", CPU_COUNT(&taskCPUs), cpu);
+
+  sTaskConfig_t anyCore = testConfig;
+  anyCore.core = PIPELINE_NO_AFFINITY;
+  CHECK(task.start("anyCore", namedTask, NULL, anyCore), "start again after the task ended");
+  task.stop();
+  cpu_set_t all;
+  pthread_getaffinity_np(pthread_self(), sizeof(all), &all);
+  CHECK(CPU_EQUAL(&taskCPUs, &all), "a task without affinity is pinned");
+}
+
+static int16_t workInput[WORK_IN_FRAMES * 2];
+
+/**
+ * The work of one task, sample rate conversion of the input, as the play task does
+ */
+static void workTask(void *arg)
+{
+  static const size_t outFrames = 1024;
+  int16_t out[outFrames * 2];
+  Resampler resampler;
+  resampler.begin(48000, 44100, RESAMPLER_QUALITY_HIGH);
+  for(uint32_t round=0; round<WORK_ROUNDS; round++){
+    size_t done = 0;
+    while(done < WORK_IN_FRAMES){
+      size_t used;
+      resampler.process(workInput + 2 * done, WORK_IN_FRAMES - done, out, outFrames, &used);
+      done += used;
+    }
+  }
+  *(volatile int16_t *)arg = out[0];
+}
+
+/**
+ * Run the work on a number of tasks at once, one per core, return the time taken in ns
+ */
+static uint64_t runWork(uint32_t count)
+{
+  PipelineTask tasks[2];
+  int16_t results[2];
+  uint64_t start = hostNanos();
+  for(uint32_t i=0; i<count; i++){
+    sTaskConfig_t config = testConfig;
+    config.core = (int8_t)i;
+    tasks[i].start("workTask", workTask, &results[i], config);
+  }
+  for(uint32_t i=0; i<count; i++){
+    while(tasks[i].isRunning()){
+      PipelineTask::sleep(1);
+    }
+    tasks[i].stop();
+  }
+  return hostNanos() - start;
+}
+
+static void checkScaling(void)
+{
+  for(size_t i=0; i<WORK_IN_FRAMES * 2; i++){
+    workInput[i] = (int16_t)(10000 * sin(0.01 * i));
+  }
+  int cpu;
+  int cpus = allowedCPUs(0, &cpu);
+  uint32_t count = (cpus >= 2) ? 2 : 1;
+  runWork(1);   // Warm up
+  uint64_t one = runWork(1);
+  uint64_t all = runWork(count);
+  double scaling = (double)count * one / all;
+
+  benchBegin("PipelineTaskTest");
+  benchResult("1_task", WORK_IN_FRAMES * WORK_ROUNDS, one);
+  benchResult(count == 2 ? "2_tasks" : "1_task_again", WORK_IN_FRAMES * WORK_ROUNDS * count, all);
+  benchEnd();
+  printf("tasks %u, CPUs %d: %.2f times the throughput of one task\n", (unsigned)count, cpus, scaling);
+  if(count == 2){
+    CHECK(scaling > SCALING_MIN, "two tasks on two cores do %.2f times the work of one", scaling);
+  }else{   // One core, no speedup to expect, but no cost of the task either
+    CHECK(scaling > 0.8, "the same work took %.2f times as long", 1.0 / scaling);
+  }
+}
+
+int main(void)
+{
+  checkStop();
+  checkThread();
+  checkScaling();
+  return hostTestResult("PipelineTaskTest");
+}
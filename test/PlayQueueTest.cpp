@@ -0,0 +1,171 @@
+/*!
+ * @file  PlayQueueTest.cpp
+ * @brief  Walk the play queue through its repeat modes, the shuffle order and skips, and check the tracks it gives
+ * @details  Without repeat the queue ends after its last track, PLAY_REPEAT_ONE stays on the current track until a
+ * @n        skip, and PLAY_REPEAT_ALL starts over. Shuffled, every round must play each track once, a new round must not
+ * @n        start with the track that ended the last one, a track enqueued meanwhile must come after the current one,
+ * @n        and turning the shuffle off must go on in the queued order from the current track.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <string.h>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define TRACKS   ((uint16_t)(7))
+#define ROUNDS   ((uint32_t)(200))   // Shuffled rounds per seed
+#define SEEDS   ((uint32_t)(20))
+#define TRACK_BASE   ((uint32_t)(100))   // Track numbers of the music index, not positions
+
+static void fill(PlayQueue &queue, uint16_t tracks)
+{
+  queue.clear();
+  for(uint16_t i=0; i<tracks; i++){
+    queue.enqueue(TRACK_BASE + i);
+  }
+}
+
+static void checkRepeatOff(void)
+{
+  PlayQueue queue;
+  uint32_t track = 0;
+  CHECK(!queue.start(&track) && !queue.current(&track) && !queue.next(&track), "an empty queue");
+  fill(queue, TRACKS);
+  CHECK(queue.start(&track) && (track == TRACK_BASE), "first track %u", (unsigned)track);
+  for(uint16_t i=1; i<TRACKS; i++){
+    CHECK(queue.next(&track) && (track == TRACK_BASE + i), "track %u of %u is %u", i, TRACKS, (unsigned)track);
+  }
+  CHECK(!queue.next(&track) && !queue.current(&track), "the queue ends after its last track");
+  CHECK(!queue.next(&track, true), "a skip at the end");
+  CHECK(queue.start(&track) && (track == TRACK_BASE), "started again");
+  for(uint16_t i=1; i<TRACKS; i++){
+    CHECK(queue.next(&track, true) && (track == TRACK_BASE + i), "skip to track %u gives %u", i, (unsigned)track);
+  }
+  CHECK(!queue.next(&track, true), "a skip past the last track");
+
+  for(uint16_t i=TRACKS; i<PLAY_QUEUE_SIZE; i++){
+    queue.enqueue(TRACK_BASE + i);
+  }
+  CHECK((queue.size() == PLAY_QUEUE_SIZE) && !queue.enqueue(0), "a full queue takes %u tracks", queue.size());
+}
+
+static void checkRepeatOne(void)
+{
+  PlayQueue queue;
+  fill(queue, TRACKS);
+  queue.setRepeat(PLAY_REPEAT_ONE);
+  uint32_t track = 0;
+  queue.start(&track);
+  for(int i=0; i<10; i++){
+    CHECK(queue.next(&track) && (track == TRACK_BASE), "repeat one moved on to %u", (unsigned)track);
+  }
+  CHECK(queue.next(&track, true) && (track == TRACK_BASE + 1), "a skip moves on, to %u", (unsigned)track);
+  CHECK(queue.next(&track) && (track == TRACK_BASE + 1), "and repeats the new track");
+  for(uint16_t i=2; i<TRACKS; i++){
+    queue.next(&track, true);
+  }
+  CHECK((track == TRACK_BASE + TRACKS - 1) && queue.next(&track) && (track == TRACK_BASE + TRACKS - 1), "the last track repeats");
+  CHECK(queue.next(&track, true) && (track == TRACK_BASE), "a skip on the last track starts over, at %u", (unsigned)track);
+}
+
+static void checkRepeatAll(void)
+{
+  PlayQueue queue;
+  fill(queue, TRACKS);
+  queue.setRepeat(PLAY_REPEAT_ALL);
+  uint32_t track = 0;
+  queue.start(&track);
+  uint32_t wrong = 0;
+  for(uint32_t i=1; i<TRACKS * 5; i++){
+    wrong += !queue.next(&track) || (track != TRACK_BASE + i % TRACKS);
+  }
+  CHECK(wrong == 0, "repeat all: %u tracks out of the queued order", (unsigned)wrong);
+
+  fill(queue, 1);
+  queue.start(&track);
+  CHECK(queue.next(&track) && (track == TRACK_BASE) && queue.next(&track, true) && (track == TRACK_BASE), "a single track repeats");
+}
+
+/**
+ * Shuffled rounds: each a permutation of the tracks, no track twice in a row across the start of a round
+ */
+static void checkShuffle(void)
+{
+  uint32_t bad = 0, repeats = 0, firsts[TRACKS] = {0};
+  for(uint32_t seed=1; seed<=SEEDS; seed++){
+    PlayQueue queue;
+    fill(queue, TRACKS);
+    queue.setRepeat(PLAY_REPEAT_ALL);
+    queue.setSeed(seed * 2654435761u);
+    queue.setShuffle(true);
+    uint32_t track = 0, last = 0xffffffff;
+    queue.start(&track);
+    for(uint32_t round=0; round<ROUNDS; round++){
+      bool seen[TRACKS] = {false};
+      for(uint16_t i=0; i<TRACKS; i++){
+        if((i > 0) || (round > 0)){
+          queue.next(&track, (i + round) % 3 == 0);   // Skips move on as the end of a track does
+        }
+        bool valid = (track >= TRACK_BASE) && (track < TRACK_BASE + TRACKS);
+        bad += !valid || seen[track - TRACK_BASE];
+        if(valid){
+          seen[track - TRACK_BASE] = true;
+        }
+        repeats += (track == last);
+        last = track;
+        if(valid && (i == 0)){
+          firsts[track - TRACK_BASE]++;
+        }
+      }
+    }
+  }
+  CHECK(bad == 0, "%u shuffled rounds missed or repeated a track", (unsigned)bad);
+  CHECK(repeats == 0, "the same track twice in a row %u times", (unsigned)repeats);
+  for(uint16_t i=0; i<TRACKS; i++){
+    CHECK(firsts[i] > SEEDS * ROUNDS / TRACKS / 2, "track %u started %u of %u rounds", i, (unsigned)firsts[i], (unsigned)(SEEDS * ROUNDS));
+  }
+
+  // Enqueued while shuffled: after the current track, and the round still plays every track once
+  PlayQueue queue;
+  fill(queue, TRACKS);
+  queue.setShuffle(true);
+  uint32_t track = 0, first = 0;
+  queue.start(&first);
+  queue.next(&track);
+  uint32_t current = track;
+  CHECK(queue.enqueue(TRACK_BASE + TRACKS), "enqueue while shuffled");
+  bool seen[TRACKS + 1] = {false};
+  seen[first - TRACK_BASE] = seen[current - TRACK_BASE] = true;
+  uint16_t played = 2;
+  while(queue.next(&track)){
+    CHECK(!seen[track - TRACK_BASE], "track %u played twice", (unsigned)track);
+    seen[track - TRACK_BASE] = true;
+    played++;
+  }
+  CHECK((played == TRACKS + 1) && seen[TRACKS], "%u of %u tracks played after the enqueue", played, TRACKS + 1);
+
+  // The shuffle off: the queued order from the current track on
+  queue.start(&track);
+  queue.next(&track);
+  current = track;
+  queue.setShuffle(false);
+  CHECK(queue.current(&track) && (track == current), "the current track stays when the shuffle is turned off");
+  uint32_t wrong = 0;
+  for(uint32_t t=current + 1; t<=TRACK_BASE + TRACKS; t++){
+    wrong += !queue.next(&track) || (track != t);
+  }
+  CHECK((wrong == 0) && !queue.next(&track), "%u tracks out of the queued order after the shuffle", (unsigned)wrong);
+}
+
+int main(void)
+{
+  checkRepeatOff();
+  checkRepeatOne();
+  checkRepeatAll();
+  checkShuffle();
+  return hostTestResult("PlayQueueTest");
+}
@@ -0,0 +1,136 @@
+/*!
+ * @file  PrefetchTest.cpp
+ * @brief  Feed the prefetch pool from a throttled SD card source and consume it at a steady rate
+ * @details  The source reads a byte pattern, taking 1 ms per read plus a long hiccup every few reads, as an SD card does
+ * @n        when it erases or remaps. The consumer takes one buffer per period after the pool is ready. A pool deep enough
+ * @n        to cover the hiccup must never stall, a shallow one must show its stalls in the counters, each stall once
+ * @n        however often the consumer polls during it. Every byte must arrive
+ * @n        in order, in whole frames, and the tag of the next track must start exactly at its first buffer.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <thread>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define TEST_BUFFER_SIZE   ((size_t)(4096))   // Bytes per buffer
+#define TEST_FRAME_BYTES   ((uint16_t)(6))   // 24-bit stereo, a frame never spans two buffers
+#define TEST_TRACK_BYTES   ((uint32_t)(TEST_FRAME_BYTES * 20000))   // Two tracks of 30 buffers each
+#define CONSUME_PERIOD_MS   10   // The consumer takes a buffer per period
+
+/**
+ * A source with the timing of an SD card: 1 ms per read and a hiccup every HICCUP_READS reads
+ */
+class ThrottledSource : public AudioSource
+{
+public:
+  ThrottledSource(uint32_t len, uint8_t seed, uint32_t hiccupMs, uint32_t hiccupReads)
+    : _len(len), _pos(0), _seed(seed), _hiccupMs(hiccupMs), _hiccupReads(hiccupReads), _reads(0) {}
+
+  size_t read(void *data, size_t len)
+  {
+    if(++_reads % _hiccupReads == 0){
+      delay(_hiccupMs);
+    }else{
+      delay(1);
+    }
+    len = (len > _len - _pos) ? (_len - _pos) : len;
+    for(size_t i=0; i<len; i++){
+      ((uint8_t *)data)[i] = pattern(_seed, _pos + i);
+    }
+    _pos += len;
+    return len;
+  }
+
+  static uint8_t pattern(uint8_t seed, uint32_t pos) { return (uint8_t)(seed + pos * 13 + (pos >> 8)); }
+
+protected:
+  uint32_t _len;
+  uint32_t _pos;
+  uint8_t _seed;
+  uint32_t _hiccupMs;
+  uint32_t _hiccupReads;
+  uint32_t _reads;
+};
+
+/**
+ * Play two tracks through a pool, return the stalls counted by the pool
+ */
+static uint32_t playTracks(uint8_t count, uint32_t hiccupMs, uint32_t hiccupReads)
+{
+  PrefetchBuffer pool;
+  CHECK(pool.begin(count, TEST_BUFFER_SIZE), "begin");
+  pool.setBlockAlign(TEST_FRAME_BYTES);
+  std::atomic<bool> stop(false);
+
+  std::thread producer([&]{   // The SD reader task
+    ThrottledSource first(TEST_TRACK_BYTES, 0, hiccupMs, hiccupReads);
+    ThrottledSource second(TEST_TRACK_BYTES, 100, hiccupMs, hiccupReads);
+    AudioSource *source = &first;
+    while(!stop.load()){
+      if(pool.fill(*source)){
+        continue;
+      }
+      if(pool.isSourceEnd() && (source == &first)){   // Gapless: the next track goes on in the same pool
+        source = &second;
+        pool.restart(1);
+      }else{
+        delay(1);
+      }
+    }
+  });
+
+  while(!pool.isReady()){
+    delay(1);
+  }
+  pool.resetCounters();
+
+  uint32_t received[2] = {0, 0}, errors = 0, misaligned = 0, stalls = 0, polls = 0;
+  uint8_t lastTag = 0;
+  bool tagBack = false;
+  while((received[0] + received[1] < 2 * TEST_TRACK_BYTES) && !(pool.isEnd() && (received[1] > 0))){
+    delay(CONSUME_PERIOD_MS);
+    size_t len;
+    uint8_t tag;
+    const uint8_t *data;
+    if((data = pool.getReadBuffer(&len, &tag)) == NULL){   // A stall, counted by the pool
+      stalls++;
+      while((data = pool.getReadBuffer(&len, &tag)) == NULL){
+        polls++;
+        delay(1);
+      }
+    }
+    tagBack = tagBack || (tag < lastTag);
+    lastTag = tag;
+    misaligned += (len % TEST_FRAME_BYTES) != 0;
+    for(size_t i=0; i<len; i++){
+      errors += data[i] != ThrottledSource::pattern(tag ? 100 : 0, received[tag & 1] + i);
+    }
+    received[tag & 1] += len;
+    pool.releaseRead();
+  }
+  stop.store(true);
+  producer.join();
+
+  CHECK(received[0] == TEST_TRACK_BYTES, "%u bytes of the first track", received[0]);
+  CHECK(received[1] == TEST_TRACK_BYTES, "%u bytes of the second track", received[1]);
+  CHECK(errors == 0, "%u bytes out of order", errors);
+  CHECK(misaligned == 0, "%u buffers not of whole frames", misaligned);
+  CHECK(!tagBack, "the tag went back");
+  CHECK(pool.getStalls() == stalls, "%u stalls counted for %u stalls polled %u times", pool.getStalls(), stalls, polls);
+  printf("%u buffers, hiccup %u ms: %u stalls, %u polls, low water %u\n", count, hiccupMs, pool.getStalls(), polls, pool.getLowWater());
+  return pool.getStalls();
+}
+
+int main(void)
+{
+  // 7 buffers ahead cover 70 ms, the 30 ms hiccup is hidden
+  CHECK(playTracks(8, 30, 8) == 0, "a deep pool must not stall");
+  // 1 buffer ahead covers 10 ms, the 60 ms hiccup is not
+  CHECK(playTracks(2, 60, 8) > 0, "a shallow pool must count its stalls");
+  return hostTestResult("PrefetchTest");
+}
@@ -0,0 +1,234 @@
+/*!
+ * @file  RequantizerTest.cpp
+ * @brief  Measure the spectrum of the requantization error for each dither mode, and time the requantizer
+ * @details  A sine of 2.5 LSB, where plain rounding distorts most, is requantized to 16-bit and 24-bit output and the
+ * @n        output minus the exact input is the error. Its spectrum is the average of Hann-windowed FFTs. Without dither
+ * @n        the error has harmonics of the sine. With TPDF dither it must be white noise of 1/4 LSB^2, rounding plus dither,
+ * @n        with no harmonics above the floor, and with noise shaping it must follow |1 - z^-1|^2 or |1 - z^-1|^4 times
+ * @n        that floor in every octave band. Integer and float input must give the same output words.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <stdarg.h>
+#include <string.h>
+#include <algorithm>
+#include <complex>
+#include <string>
+#include <vector>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define SAMPLE_RATE   (44100.0)
+#define FFT_SIZE   ((size_t)(4096))
+#define FFT_SEGMENTS   ((size_t)(128))   // Averaged, each bin is within about +-0.4 dB of the mean
+#define TEST_FRAMES   (FFT_SIZE * FFT_SEGMENTS)
+#define BLOCK_FRAMES   ((size_t)(256))   // Frames per process(), as the output task requantizes
+#define SINE_BIN   ((size_t)(93))   // 1001.3 Hz, the sine and its harmonics fall on bins
+#define SINE_LSB   (2.5)   // Amplitude in output steps
+#define DITHERED_POWER   (0.25)   // Rounding 1/12 plus TPDF dither of +-1 LSB 1/6, in LSB^2
+#define HARMONICS   ((size_t)(9))   // The 2nd to 10th harmonics are checked
+#define FLOOR_TOLERANCE_DB   (2.0)   // No harmonic bin of dithered output may stand out further above the floor
+#define DISTORTION_DB   (10.0)   // The strongest harmonic without dither stands out at least this far
+#define BAND_TOLERANCE_DB   (1.0)   // Octave bands against the shaping filter
+#define POWER_TOLERANCE   (0.03)   // The total error power against DITHERED_POWER, relative
+
+typedef std::complex<double> complex_t;
+
+static int32_t inputFixed[TEST_FRAMES * 2];
+static float inputFloat[TEST_FRAMES * 2];
+static int16_t output16[TEST_FRAMES * 2];
+static int32_t output32[TEST_FRAMES * 2];
+static int16_t outputFloat16[TEST_FRAMES * 2];
+static std::string report;   // Printed after the JSON document
+
+/**
+ * Append a line to the report
+ */
+static void reportf(const char *format, ...)
+{
+  char line[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  report += line;
+}
+
+/**
+ * In-place radix-2 FFT, the size a power of two
+ */
+static void fft(std::vector<complex_t> &x)
+{
+  size_t n = x.size();
+  for(size_t i=1, j=0; i<n; i++){
+    size_t bit = n >> 1;
+    for(; j & bit; bit >>= 1){
+      j ^= bit;
+    }
+    j ^= bit;
+    if(i < j){
+      std::swap(x[i], x[j]);
+    }
+  }
+  for(size_t len=2; len<=n; len<<=1){
+    complex_t w = std::polar(1.0, -2.0 * M_PI / len);
+    for(size_t i=0; i<n; i+=len){
+      complex_t wk = 1.0;
+      for(size_t k=0; k<len / 2; k++){
+        complex_t a = x[i + k], b = x[i + k + len / 2] * wk;
+        x[i + k] = a + b;
+        x[i + k + len / 2] = a - b;
+        wk *= w;
+      }
+    }
+  }
+}
+
+/**
+ * The averaged power spectrum of the error, per bin in LSB^2, white noise of power p gives p in every bin
+ */
+static std::vector<double> spectrum(const std::vector<double> &e)
+{
+  std::vector<double> window(FFT_SIZE), psd(FFT_SIZE / 2, 0.0);
+  double norm = 0;
+  for(size_t i=0; i<FFT_SIZE; i++){
+    window[i] = 0.5 - 0.5 * cos(2.0 * M_PI * i / FFT_SIZE);
+    norm += window[i] * window[i];
+  }
+  std::vector<complex_t> x(FFT_SIZE);
+  for(size_t s=0; s<FFT_SEGMENTS; s++){
+    for(size_t i=0; i<FFT_SIZE; i++){
+      x[i] = e[s * FFT_SIZE + i] * window[i];
+    }
+    fft(x);
+    for(size_t k=0; k<FFT_SIZE / 2; k++){
+      psd[k] += std::norm(x[k]) / norm / FFT_SEGMENTS;
+    }
+  }
+  return psd;
+}
+
+/**
+ * The power of the shaped error relative to the unshaped one at bin k
+ */
+static double shaping(uint8_t mode, size_t k)
+{
+  double g = 2.0 - 2.0 * cos(2.0 * M_PI * k / FFT_SIZE);   // |1 - z^-1|^2
+  return (mode == DITHER_SHAPED1) ? g : ((mode == DITHER_SHAPED2) ? g * g : 1.0);
+}
+
+/**
+ * Requantize the sine in one mode and width, check the error spectrum, print the time taken
+ */
+static void checkMode(uint8_t bits, uint8_t mode, const char *name)
+{
+  // The input in output steps: 16-bit steps carry DSP_FRACTION_BITS as int32_t, 24-bit steps are 1/256 of the float sample
+  double scale = (bits == 16) ? 1.0 : (1.0 / 256);
+  for(size_t i=0; i<TEST_FRAMES; i++){
+    double x = SINE_LSB * sin(2.0 * M_PI * SINE_BIN * i / FFT_SIZE);
+    int32_t v = (int32_t)lrint(x * scale * (1 << DSP_FRACTION_BITS));
+    inputFixed[2 * i] = v;
+    inputFixed[2 * i + 1] = -v;
+    inputFloat[2 * i] = (bits == 16) ? (float)v / (1 << DSP_FRACTION_BITS) : (float)(x * scale);
+    inputFloat[2 * i + 1] = -inputFloat[2 * i];
+  }
+
+  Requantizer requantizer;
+  requantizer.setOutputBits(bits);
+  CHECK(requantizer.setMode(bits, mode), "%s: setMode", name);
+  uint64_t start = hostNanos(), cycles = hostCycles();
+  for(size_t i=0; i<TEST_FRAMES; i+=BLOCK_FRAMES){
+    if(bits == 16){
+      requantizer.process(inputFixed + 2 * i, output16 + 2 * i, BLOCK_FRAMES, 0);
+    }else{
+      requantizer.process(inputFloat + 2 * i, output32 + 2 * i, BLOCK_FRAMES, 0);
+    }
+  }
+  benchResult(name, TEST_FRAMES, hostNanos() - start, hostCycles() - cycles);
+
+  std::vector<double> e(TEST_FRAMES);
+  double power = 0, right = 0;
+  for(size_t i=0; i<TEST_FRAMES; i++){
+    double y = (bits == 16) ? output16[2 * i] : output32[2 * i] / 256.0;
+    double yr = (bits == 16) ? output16[2 * i + 1] : output32[2 * i + 1] / 256.0;
+    // Wide output starts from the float sample cut to the int32_t word, 1/256 of an output step
+    double x = (bits == 16) ? (double)inputFixed[2 * i] / (1 << DSP_FRACTION_BITS) : (int32_t)(inputFloat[2 * i] * 65536.0f) / 256.0;
+    e[i] = y - x;
+    power += e[i] * e[i] / TEST_FRAMES;
+    right += (yr + x) * (yr + x) / TEST_FRAMES;
+  }
+  CHECK(fabs(right / power - 1.0) < 0.1, "%s: the right channel error %.3f, the left %.3f", name, right, power);
+
+  if(bits == 16){   // The same words from float input, the requantizer starts from the same seed
+    Requantizer floatRequantizer;
+    floatRequantizer.setMode(bits, mode);
+    for(size_t i=0; i<TEST_FRAMES; i+=BLOCK_FRAMES){
+      floatRequantizer.process(inputFloat + 2 * i, outputFloat16 + 2 * i, BLOCK_FRAMES, 0);
+    }
+    CHECK(memcmp(output16, outputFloat16, sizeof(output16)) == 0, "%s: float input differs from int32_t input", name);
+  }
+
+  std::vector<double> psd = spectrum(e);
+  double harmonic = 0;
+  for(size_t h=2; h<HARMONICS + 2; h++){
+    harmonic = (psd[h * SINE_BIN] > harmonic) ? psd[h * SINE_BIN] : harmonic;
+  }
+  std::vector<double> sorted(psd.begin() + 1, psd.end());
+  std::sort(sorted.begin(), sorted.end());
+  double median = sorted[sorted.size() / 2];
+
+  if(mode == DITHER_OFF){
+    CHECK(10.0 * log10(harmonic / median) > DISTORTION_DB, "%s: the harmonics are %.1f dB above the median, not distorted",
+          name, 10.0 * log10(harmonic / median));
+    reportf("%s: power %.3f LSB^2, harmonics %.1f dB above the median\n", name, power, 10.0 * log10(harmonic / median));
+    return;
+  }
+
+  double expected = 0;
+  for(size_t k=0; k<FFT_SIZE / 2; k++){
+    expected += 2.0 * DITHERED_POWER * shaping(mode, k) / FFT_SIZE;
+  }
+  CHECK(fabs(power / expected - 1.0) < POWER_TOLERANCE, "%s: error power %.4f LSB^2, expected %.4f", name, power, expected);
+  for(size_t h=2; h<HARMONICS + 2; h++){
+    double floor = DITHERED_POWER * shaping(mode, h * SINE_BIN);
+    CHECK(10.0 * log10(psd[h * SINE_BIN] / floor) < FLOOR_TOLERANCE_DB, "%s: harmonic %u %.1f dB above the noise floor",
+          name, (unsigned)h, 10.0 * log10(psd[h * SINE_BIN] / floor));
+  }
+  reportf("%s: power %.3f LSB^2 (%.3f) octave bands (dB):", name, power, expected);
+  for(size_t lo=16; lo<FFT_SIZE / 2; lo*=2){   // From 172 Hz
+    double measured = 0, shaped = 0;
+    for(size_t k=lo; k<2 * lo; k++){
+      measured += psd[k];
+      shaped += DITHERED_POWER * shaping(mode, k);
+    }
+    double db = 10.0 * log10(measured / shaped);
+    reportf(" %+.2f", db);
+    CHECK(fabs(db) < BAND_TOLERANCE_DB, "%s: the band from %.0f Hz is %.2f dB off the shaped floor", name, lo * SAMPLE_RATE / FFT_SIZE, db);
+  }
+  reportf("\n");
+}
+
+int main(void)
+{
+  Requantizer modes;
+  CHECK(modes.getMode(16) == DITHER_TPDF, "16-bit output defaults to TPDF dither");
+  CHECK(modes.getMode(24) == DITHER_OFF, "24-bit output defaults to no dither");
+  CHECK(!modes.setMode(32, DITHER_TPDF), "32-bit output is not rounded");
+  CHECK(!modes.setMode(20, DITHER_OFF) && !modes.setMode(16, DITHER_SHAPED2 + 1), "unknown width or mode");
+
+  benchBegin("RequantizerTest");
+  checkMode(16, DITHER_OFF, "16_off");
+  checkMode(16, DITHER_TPDF, "16_tpdf");
+  checkMode(16, DITHER_SHAPED1, "16_shaped1");
+  checkMode(16, DITHER_SHAPED2, "16_shaped2");
+  checkMode(24, DITHER_OFF, "24_off");
+  checkMode(24, DITHER_TPDF, "24_tpdf");
+  checkMode(24, DITHER_SHAPED2, "24_shaped2");
+  benchEnd();
+  printf("%s", report.c_str());
+  return hostTestResult("RequantizerTest");
+}
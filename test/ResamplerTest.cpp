@@ -0,0 +1,103 @@
+/*!
+ * @file  ResamplerTest.cpp
+ * @brief  Measure the THD+N of the sample rate converter for each quality tier, and time it
+ * @details  A sine at the source rate is converted to 44100 Hz, the sine of the same frequency is fitted to the output by
+ * @n        least squares and everything else, harmonics, images, aliases and rounding, is the distortion plus noise.
+ * @n        Each tier must stay below its bound, the higher tiers below the lower ones, and the number of output frames must
+ * @n        follow the ratio of the rates.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define OUT_RATE   ((uint32_t)(44100))
+#define TEST_IN_FRAMES   ((size_t)(48000))   // One second at 48 kHz
+#define SETTLE_FRAMES   ((size_t)(1000))   // Output frames skipped while the history fills
+#define AMPLITUDE   (0.5 * 32767)   // -6 dBFS
+#define THDN_LOW_DB   (-68.0)   // The bounds keep about 3 dB to the measured tiers, the 16-bit rounding alone is about -92 dB here
+#define THDN_MEDIUM_DB   (-75.0)
+#define THDN_HIGH_DB   (-82.0)
+#define THDN_HIGH_10K_DB   (-80.0)
+#define LSB   ((double)(1 << PCM_FRACTION_BITS))   // A 16-bit LSB in samples, built with PCM_WIDE_SAMPLES as well
+
+static pcm_t input[TEST_IN_FRAMES * 2];
+static pcm_t output[TEST_IN_FRAMES * 4];
+
+/**
+ * Convert a sine and return the THD+N in dB, print the time taken
+ */
+static double thdn(uint32_t inRate, double freq, uint8_t quality, const char *name)
+{
+  size_t inFrames = TEST_IN_FRAMES * inRate / 48000;
+  for(size_t i=0; i<inFrames; i++){
+    pcm_t s = (pcm_t)lrint(AMPLITUDE * LSB * sin(2.0 * M_PI * freq * i / inRate));
+    input[2 * i] = s;
+    input[2 * i + 1] = -s;
+  }
+
+  Resampler resampler;
+  CHECK(resampler.begin(inRate, OUT_RATE, quality), "begin");
+  size_t done = 0, produced = 0;
+  uint64_t start = hostNanos();
+  while(done < inFrames){
+    size_t used;
+    produced += resampler.process(input + 2 * done, inFrames - done, output + 2 * produced, 1024, &used);
+    done += used;
+  }
+  benchResult(name, inFrames, hostNanos() - start);
+
+  double expected = (double)inFrames * OUT_RATE / inRate;
+  CHECK(fabs(produced - expected) < RESAMPLER_MAX_TAPS + RESAMPLER_BLOCK_FRAMES, "%s: %u frames for %.0f", name, (unsigned)produced, expected);
+
+  // Least-squares fit of a sin(wt) + b cos(wt) on the left channel
+  double w = 2.0 * M_PI * freq / OUT_RATE;
+  double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0, n = 0;
+  for(size_t i=SETTLE_FRAMES; i<produced - SETTLE_FRAMES; i++){
+    double s = sin(w * i), c = cos(w * i), y = output[2 * i] / LSB;
+    ss += s * s; cc += c * c; sc += s * c; ys += y * s; yc += y * c; n++;
+  }
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det, b = (yc * ss - ys * sc) / det;
+  double signal = 0, residual = 0, right = 0;
+  for(size_t i=SETTLE_FRAMES; i<produced - SETTLE_FRAMES; i++){
+    double fit = a * sin(w * i) + b * cos(w * i);
+    double e = output[2 * i] / LSB - fit;
+    signal += fit * fit;
+    residual += e * e;
+    double sum = ((double)output[2 * i] + output[2 * i + 1]) / LSB;
+    right += sum * sum;
+  }
+  CHECK(right / n < 4.0, "%s: the channels are not converted alike", name);
+  return 10.0 * log10(residual / signal);
+}
+
+int main(void)
+{
+  Resampler bypass;
+  CHECK(bypass.begin(OUT_RATE, OUT_RATE) && bypass.isBypass(), "equal rates pass through");
+
+  benchBegin("ResamplerTest");
+  double low = thdn(48000, 1000, RESAMPLER_QUALITY_LOW, "48000_1k_low");
+  double medium = thdn(48000, 1000, RESAMPLER_QUALITY_MEDIUM, "48000_1k_medium");
+  double high = thdn(48000, 1000, RESAMPLER_QUALITY_HIGH, "48000_1k_high");
+  double high10k = thdn(48000, 10000, RESAMPLER_QUALITY_HIGH, "48000_10k_high");
+  double up = thdn(22050, 1000, RESAMPLER_QUALITY_MEDIUM, "22050_1k_medium");
+  double up32 = thdn(32000, 1000, RESAMPLER_QUALITY_MEDIUM, "32000_1k_medium");
+  benchEnd();
+
+  printf("THD+N (dB): 48k 1k low %.1f, medium %.1f, high %.1f, high 10k %.1f, 22.05k medium %.1f, 32k medium %.1f\n",
+         low, medium, high, high10k, up, up32);
+  CHECK(low < THDN_LOW_DB, "low tier %.1f dB", low);
+  CHECK(medium < THDN_MEDIUM_DB, "medium tier %.1f dB", medium);
+  CHECK(high < THDN_HIGH_DB, "high tier %.1f dB", high);
+  CHECK(high10k < THDN_HIGH_10K_DB, "high tier at 10 kHz %.1f dB", high10k);
+  CHECK(up < THDN_MEDIUM_DB, "22050 Hz medium tier %.1f dB", up);
+  CHECK(up32 < THDN_MEDIUM_DB, "32000 Hz medium tier %.1f dB", up32);
+  CHECK((high < medium) && (medium < low), "the tiers are not ordered");
+  return hostTestResult("ResamplerTest");
+}
@@ -0,0 +1,160 @@
+/*!
+ * @file  RingBufferTest.cpp
+ * @brief  Hammer the PCM ring buffer from a producer and a consumer thread
+ * @details  The buffer alone: a producer writes a byte sequence in parts of random length, a consumer takes it back with
+ * @n        read() and with peek() and skip() in turn, every byte must arrive once and in order.
+ * @n        The library: the PCM buffer size is clamped to PCM_BUFFER_MIN_SIZE, and a thread writing blocks larger than
+ * @n        the whole buffer through writeToBuffer() feeds the real output task, the sink must see every frame in order.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <thread>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define HAMMER_BYTES   ((uint32_t)(1) << 25)   // Bytes through the buffer alone, the 32-bit positions wrap several times over the sizes
+#define HAMMER_SIZE   ((size_t)(4096))   // Depth of the buffer alone
+#define STREAM_FRAMES   ((uint32_t)(200000))   // Frames through the library
+#define STREAM_BLOCK_FRAMES   ((uint32_t)(5000))   // Frames per write, 20000 bytes, more than the smallest PCM buffer
+
+static uint32_t random32(uint32_t &state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+static void hammerBuffer(void)
+{
+  PCMRingBuffer buffer;
+  CHECK(buffer.begin(HAMMER_SIZE - 100), "begin");
+  CHECK(buffer.size() == HAMMER_SIZE, "size %u rounded up", (unsigned)buffer.size());
+
+  std::thread producer([&buffer]{
+    uint8_t part[HAMMER_SIZE];
+    uint32_t state = 1, sent = 0;
+    while(sent < HAMMER_BYTES){
+      size_t n = 1 + random32(state) % (HAMMER_SIZE / 2);
+      n = (n > HAMMER_BYTES - sent) ? (HAMMER_BYTES - sent) : n;
+      for(size_t i=0; i<n; i++){
+        part[i] = (uint8_t)((sent + i) * 7);
+      }
+      while(!buffer.write(part, n)){   // Full, the overrun is counted and the write is tried again
+        std::this_thread::yield();
+      }
+      sent += n;
+    }
+  });
+
+  uint8_t part[HAMMER_SIZE];
+  uint32_t state = 2, received = 0, errors = 0;
+  bool usePeek = false;
+  while(received < HAMMER_BYTES){
+    size_t want = 1 + random32(state) % (HAMMER_SIZE / 2);
+    want = (want > HAMMER_BYTES - received) ? (HAMMER_BYTES - received) : want;
+    if(buffer.available() < want){
+      std::this_thread::yield();
+      continue;
+    }
+    if(usePeek){
+      uint8_t *first, *second;
+      size_t firstLen;
+      size_t n = buffer.peek(want, &first, &firstLen, &second);
+      for(size_t i=0; i<n; i++){
+        uint8_t b = (i < firstLen) ? first[i] : second[i - firstLen];
+        errors += (b != (uint8_t)((received + i) * 7));
+      }
+      buffer.skip(n);
+      received += n;
+    }else{
+      size_t n = buffer.read(part, want);
+      for(size_t i=0; i<n; i++){
+        errors += (part[i] != (uint8_t)((received + i) * 7));
+      }
+      received += n;
+    }
+    usePeek = !usePeek;
+  }
+  producer.join();
+
+  CHECK(errors == 0, "%u bytes out of order", errors);
+  CHECK(buffer.available() == 0, "%u bytes left", (unsigned)buffer.available());
+  CHECK(buffer.getUnderruns() == 0, "%u underruns, the consumer only takes what is available", buffer.getUnderruns());
+  CHECK(buffer.getHighWater() <= HAMMER_SIZE, "high water %u", (unsigned)buffer.getHighWater());
+  printf("hammer: %u bytes, %u overruns retried, high water %u\n", HAMMER_BYTES, buffer.getOverruns(), (unsigned)buffer.getHighWater());
+}
+
+/**
+ * Takes the output of the library and checks that frame k is (k, k)
+ */
+class SequenceSink : public AudioSink
+{
+public:
+  SequenceSink(void) : frames(0), errors(0) {}
+
+  size_t write(const void *data, size_t len, uint32_t ticksToWait)
+  {
+    const int16_t *pcm = (const int16_t *)data;
+    uint32_t n = frames.load();
+    for(size_t i=0; i<len / 4; i++, n++){
+      errors += (pcm[2 * i] != (int16_t)n) || (pcm[2 * i + 1] != (int16_t)n);
+    }
+    frames.store(n);
+    return len;
+  }
+
+  std::atomic<uint32_t> frames;
+  uint32_t errors;
+};
+
+class TestAmplifier : public DFRobot_MAX98357A
+{
+public:
+  static bool write(const uint8_t *data, uint32_t len, uint32_t ticksToWait) { return writeToBuffer(data, len, ticksToWait); }
+  void stop(void) { end(); }
+};
+
+static void streamLibrary(void)
+{
+  TestAmplifier amplifier;
+  SequenceSink sink;
+  amplifier.setAudioSink(&sink);
+  amplifier.setPCMBufferSize(16);   // Clamped
+  CHECK(amplifier.initI2S(25, 26, 27), "initI2S");
+  size_t size = amplifier.getPCMBuffer()->size();
+  CHECK((size >= PCM_BUFFER_MIN_SIZE) && (size < 2 * PCM_BUFFER_MIN_SIZE), "PCM buffer of %u bytes", (unsigned)size);
+  CHECK(STREAM_BLOCK_FRAMES * 4 > size, "the blocks must be larger than the buffer");
+
+  std::thread producer([]{
+    static int16_t block[STREAM_BLOCK_FRAMES * 2];
+    for(uint32_t sent=0; sent<STREAM_FRAMES; sent+=STREAM_BLOCK_FRAMES){
+      for(uint32_t i=0; i<STREAM_BLOCK_FRAMES; i++){
+        block[2 * i] = block[2 * i + 1] = (int16_t)(sent + i);
+      }
+      CHECK(TestAmplifier::write((const uint8_t *)block, sizeof(block), portMAX_DELAY), "write at frame %u", sent);
+    }
+  });
+  producer.join();
+
+  uint32_t waited = 0;
+  while((sink.frames.load() < STREAM_FRAMES) && (waited < 5000)){   // The output task flushes the rest after OUTPUT_WAIT_TICKS
+    delay(10);
+    waited += 10;
+  }
+  amplifier.stop();
+  CHECK(sink.frames.load() == STREAM_FRAMES, "%u of %u frames written", sink.frames.load(), STREAM_FRAMES);
+  CHECK(sink.errors == 0, "%u frames out of order", sink.errors);
+  CHECK(amplifier.getPCMBuffer()->getOverruns() == 0, "%u overruns", amplifier.getPCMBuffer()->getOverruns());
+}
+
+int main(void)
+{
+  hammerBuffer();
+  streamLibrary();
+  return hostTestResult("RingBufferTest");
+}
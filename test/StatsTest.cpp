@@ -0,0 +1,160 @@
+/*!
+ * @file  StatsTest.cpp
+ * @brief  Check the runtime statistics, of the counters alone and of a stream through the library into a mocked sink
+ * @details  The counters: each value must land in its power-of-two bucket, and the shares and the load follow from the
+ * @n        recorded cycles. The library: the sink accepts only half of some writes, and the statistics must match what
+ * @n        the sink saw, frames, short writes, dropped bytes and the peak, exactly.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <thread>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define STREAM_FRAMES   ((uint32_t)(100000))   // Frames through the library
+#define CLIP_FRAME   ((uint32_t)(54321))   // The only frame at full scale
+#define SHORT_EVERY   ((uint32_t)(5))   // Every fifth write of the sink takes half of the data
+
+static void checkCounters(void)
+{
+  PipelineStats stats;
+  static const uint32_t values[] = {0, 255, 256, 511, 512, 1000, 0xffffffff};
+  static const uint8_t buckets[] = {0, 0, 1, 1, 2, 2, STATS_HIST_BUCKETS - 1};
+  for(uint8_t i=0; i<sizeof(values) / sizeof(values[0]); i++){
+    stats.recordCallback(values[i]);
+  }
+  stats.recordOutput(44100, 24000000, 6000000, 1000);   // One second of output at 240 MHz, a tenth busy, a quarter of it filtering
+  stats.recordOutput(0, 0, 0, 32767);
+  stats.recordShortWrite(100);
+  stats.recordShortWrite(28);
+  stats.recordDepth(64);
+  stats.recordSDRead(4095);
+
+  sPipelineStats_t s;
+  stats.snapshot(&s, 240000000, 44100);
+  uint32_t expected[STATS_HIST_BUCKETS] = {0};
+  for(uint8_t i=0; i<sizeof(buckets); i++){
+    expected[buckets[i]]++;
+  }
+  CHECK(!memcmp(s.callbackCycles.bucket, expected, sizeof(expected)), "callback buckets %u %u %u ... %u",
+        s.callbackCycles.bucket[0], s.callbackCycles.bucket[1], s.callbackCycles.bucket[2], s.callbackCycles.bucket[STATS_HIST_BUCKETS - 1]);
+  CHECK((s.callbackCycles.count == 7) && (s.callbackCycles.max == 0xffffffff) && (s.callbackCycles.shift == STATS_CYCLES_SHIFT),
+        "callback count %u max %u", s.callbackCycles.count, s.callbackCycles.max);
+  CHECK((s.pcmDepth.bucket[1] == 1) && (s.pcmDepth.count == 1), "depth of 64 bytes in bucket 1");
+  CHECK((s.sdReadCycles.bucket[0] == 1) && (s.sdReadCycles.max == 4095), "SD read below 4096 cycles in bucket 0");
+  CHECK(s.outputFrames == 44100, "output frames %u", s.outputFrames);
+  CHECK((s.filterShare >= 249) && (s.filterShare <= 250), "filter share %u", s.filterShare);   // Summed in units of 256 cycles
+  CHECK((s.shortWrites == 2) && (s.droppedBytes == 128), "short writes %u, dropped %u", s.shortWrites, s.droppedBytes);
+  CHECK((s.peak == 32767) && (s.clippedBlocks == 1), "peak %u, clipped blocks %u", s.peak, s.clippedBlocks);
+
+  PipelineStats load;
+  load.recordOutput(44100, 24000000, 0, 0);
+  load.recordCallback(12000000);
+  load.snapshot(&s, 240000000, 44100);
+  CHECK((s.cpuLoad >= 149) && (s.cpuLoad <= 150), "cpu load %u, 36M busy cycles of 240M", s.cpuLoad);
+  load.snapshot(&s, 240000000, 22050);
+  CHECK((s.cpuLoad >= 74) && (s.cpuLoad <= 75), "cpu load %u at half the sample rate", s.cpuLoad);
+
+  stats.reset();
+  stats.snapshot(&s, 240000000, 44100);
+  CHECK((s.callbackCycles.count == 0) && (s.callbackCycles.max == 0) && (s.outputFrames == 0) && (s.shortWrites == 0) &&
+        (s.peak == 0) && (s.cpuLoad == 0), "reset");
+}
+
+/**
+ * Accepts half of every SHORT_EVERY-th write, and counts what it saw
+ */
+class ShortSink : public AudioSink
+{
+public:
+  ShortSink(void) : writes(0), shortWrites(0), dropped(0), bytes(0), peak(0) {}
+
+  size_t write(const void *data, size_t len, uint32_t ticksToWait)
+  {
+    const int16_t *pcm = (const int16_t *)data;
+    for(size_t i=0; i<len / 2; i++){   // The peak of everything offered, the dropped part was processed as well
+      int32_t x = (pcm[i] < 0) ? -pcm[i] : pcm[i];
+      peak = (x > peak) ? x : peak;
+    }
+    size_t accepted = len;
+    if((++writes % SHORT_EVERY) == 0){
+      accepted = (len / 2) & ~3;
+      shortWrites++;
+      dropped += len - accepted;
+    }
+    bytes.fetch_add(len);
+    return accepted;
+  }
+
+  uint32_t writes;
+  uint32_t shortWrites;
+  uint32_t dropped;
+  std::atomic<uint32_t> bytes;   // Offered
+  int32_t peak;
+};
+
+class TestAmplifier : public DFRobot_MAX98357A
+{
+public:
+  static bool write(const uint8_t *data, uint32_t len, uint32_t ticksToWait) { return writeToBuffer(data, len, ticksToWait); }
+  void stop(void) { end(); }
+};
+
+static void checkStream(void)
+{
+  TestAmplifier amplifier;
+  ShortSink sink;
+  amplifier.setAudioSink(&sink);
+  CHECK(amplifier.initI2S(25, 26, 27), "initI2S");
+  amplifier.resetStats();
+
+  std::thread producer([]{
+    static int16_t block[1000 * 2];
+    for(uint32_t sent=0; sent<STREAM_FRAMES; sent+=1000){
+      for(uint32_t i=0; i<1000; i++){
+        int16_t x = (int16_t)(((sent + i) * 37) % 40001) - 20000;   // Within +-20000
+        block[2 * i] = x;
+        block[2 * i + 1] = (sent + i == CLIP_FRAME) ? 32767 : -x;
+      }
+      TestAmplifier::write((const uint8_t *)block, sizeof(block), portMAX_DELAY);
+    }
+  });
+  producer.join();
+  for(uint32_t waited=0; (sink.bytes.load() < STREAM_FRAMES * 4) && (waited < 5000); waited+=10){   // The rest is flushed after OUTPUT_WAIT_TICKS
+    delay(10);
+  }
+  size_t size = amplifier.getPCMBuffer()->size();
+  amplifier.stop();
+
+  sPipelineStats_t s;
+  amplifier.getStats(&s);
+  CHECK(sink.bytes.load() == STREAM_FRAMES * 4, "the sink was offered %u of %u bytes", sink.bytes.load(), STREAM_FRAMES * 4);
+  CHECK(s.outputFrames == STREAM_FRAMES, "output frames %u", s.outputFrames);
+  CHECK((s.shortWrites == sink.shortWrites) && (sink.shortWrites > 0), "short writes %u, the sink made %u", s.shortWrites, sink.shortWrites);
+  CHECK(s.droppedBytes == sink.dropped, "dropped %u, the sink dropped %u", s.droppedBytes, sink.dropped);
+  CHECK((s.peak == 32767) && (sink.peak == 32767), "peak %u, the sink saw %d", s.peak, sink.peak);
+  CHECK(s.clippedBlocks == 1, "clipped blocks %u", s.clippedBlocks);
+  CHECK((s.outputCycles.count == s.pcmDepth.count) && (s.pcmDepth.count > 0) && (s.pcmDepth.count <= sink.writes),
+        "%u output blocks, %u depths, %u sink writes", s.outputCycles.count, s.pcmDepth.count, sink.writes);
+  CHECK(s.pcmDepth.max <= size, "depth %u", s.pcmDepth.max);
+  CHECK((s.pcmHighWater >= s.pcmDepth.max) && (s.pcmHighWater <= size), "high water %u", s.pcmHighWater);
+  CHECK((s.callbackCycles.count == 0) && (s.filterShare == 0), "no callback, no filter");
+  CHECK(s.cpuLoad < 1000, "cpu load %u", s.cpuLoad);
+  printf("stream: %u sink writes, %u short, cpu load %u/1000\n", sink.writes, sink.shortWrites, s.cpuLoad);
+
+  amplifier.resetStats();
+  amplifier.getStats(&s);
+  CHECK((s.outputFrames == 0) && (s.shortWrites == 0) && (s.droppedBytes == 0) && (s.peak == 0) && (s.pcmDepth.count == 0),
+        "reset");
+}
+
+int main(void)
+{
+  checkCounters();
+  checkStream();
+  return hostTestResult("StatsTest");
+}
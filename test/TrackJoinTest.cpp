@@ -0,0 +1,183 @@
+/*!
+ * @file  TrackJoinTest.cpp
+ * @brief  Join tracks as the SD card player does, through its converter into the output, and count the frames that come out
+ * @details  Two tracks at 22050 Hz are followed by one at 48000 Hz, and converted to the 44100 Hz of the output with the
+ * @n        calls of playWAV(): at the same rate the converter keeps its history, so the tracks join as one source; at
+ * @n        another rate the tail still held in the history is flushed before the converter is set up again, and at the
+ * @n        end of the queue as well. Each source must give exactly the output frames of its length at the ratio of the
+ * @n        rates, the frame centered on its last frame included, and the sink must receive bit for bit what one converter
+ * @n        per source gives.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <atomic>
+#include <vector>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define OUT_RATE   ((uint32_t)(44100))   // The rate of the output task
+#define RECORD_FRAMES   ((uint32_t)(200000))
+#define DRAIN_MS   ((uint32_t)(5000))
+
+/**
+ * @struct sTrack_t
+ * @brief A track of the test, a sine so the join can be heard in the samples
+ */
+typedef struct
+{
+  uint32_t rate;
+  uint32_t frames;
+  double freq;
+}sTrack_t;
+
+static const sTrack_t tracks[] = {
+  {22050, 20011, 441.0},
+  {22050, 15013, 441.0},   // Same rate, it joins the first one
+  {48000, 30007, 1000.0},   // Another rate, the tail of the two before is flushed
+};
+#define TRACK_COUNT   (sizeof(tracks) / sizeof(tracks[0]))
+
+class RecordingSink : public AudioSink
+{
+public:
+  RecordingSink(void) : frames(0) {}
+
+  size_t write(const void *data, size_t len, uint32_t ticksToWait)
+  {
+    uint32_t n = frames.load(std::memory_order_relaxed);
+    uint32_t add = (uint32_t)(len / 4);
+    add = (n + add > RECORD_FRAMES) ? (RECORD_FRAMES - n) : add;
+    memcpy(record + 2 * n, data, add * 4);
+    frames.store(n + add, std::memory_order_release);
+    return len;
+  }
+
+  int16_t record[RECORD_FRAMES * 2];
+  std::atomic<uint32_t> frames;
+};
+
+class TestAmplifier : public DFRobot_MAX98357A
+{
+public:
+  static bool write(Resampler &resampler, int16_t *out, const int16_t *data, uint32_t frames)
+  {
+    return writeResampled(resampler, out, (const uint8_t *)data, frames * 4, portMAX_DELAY);
+  }
+  static bool flush(Resampler &resampler, int16_t *out) { return flushResampled(resampler, out, portMAX_DELAY); }
+  void stop(void) { end(); }
+};
+
+static RecordingSink sink;
+
+static std::vector<int16_t> makeTrack(const sTrack_t &track, double *phase)
+{
+  std::vector<int16_t> pcm(track.frames * 2);
+  for(uint32_t i=0; i<track.frames; i++){
+    int16_t s = (int16_t)lrint(16000 * sin(*phase));
+    pcm[2 * i] = s;
+    pcm[2 * i + 1] = (int16_t)(-s / 2);
+    *phase += 2.0 * M_PI * track.freq / track.rate;
+  }
+  return pcm;
+}
+
+/**
+ * The output frames of a source of the given length: those up to the one centered on its last frame
+ */
+static uint32_t expectedFrames(uint32_t rate, uint64_t frames)
+{
+  uint64_t step = ((uint64_t)rate << 32) / OUT_RATE;
+  return (uint32_t)(((frames << 32) - 1) / step + 1);
+}
+
+/**
+ * One converter for the whole source, flushed at its end
+ */
+static void reference(uint32_t rate, const std::vector<int16_t> &pcm, std::vector<int16_t> &out)
+{
+  Resampler resampler;
+  resampler.begin(rate, OUT_RATE, RESAMPLER_QUALITY_MEDIUM);
+  static int16_t block[RESAMPLE_OUT_FRAMES * 2];
+  size_t done = 0, frames = pcm.size() / 2;
+  while(done < frames){
+    size_t used;
+    size_t n = resampler.process(&pcm[2 * done], frames - done, block, RESAMPLE_OUT_FRAMES, &used);
+    out.insert(out.end(), block, block + 2 * n);
+    done += used;
+  }
+  size_t n = resampler.flush(block, RESAMPLE_OUT_FRAMES);
+  out.insert(out.end(), block, block + 2 * n);
+}
+
+static bool drain(uint32_t frames)
+{
+  for(uint32_t waited=0; waited<DRAIN_MS; waited+=5){
+    if(sink.frames.load(std::memory_order_acquire) >= frames){
+      delay(5 * OUTPUT_WAIT_TICKS);   // And nothing more comes
+      return sink.frames.load(std::memory_order_acquire) == frames;
+    }
+    delay(5);
+  }
+  return false;
+}
+
+int main(void)
+{
+  TestAmplifier amplifier;
+  amplifier.setAudioSink(&sink);
+  CHECK(amplifier.initI2S(25, 26, 27), "initI2S");
+  amplifier.reverseLeftRightChannels();   // Passed through in place, as converted
+
+  std::vector<int16_t> pcm[TRACK_COUNT];
+  double phase = 0;
+  for(size_t t=0; t<TRACK_COUNT; t++){
+    phase = (t && (tracks[t].rate != tracks[t - 1].rate)) ? 0 : phase;   // The same rate continues the sine
+    pcm[t] = makeTrack(tracks[t], &phase);
+  }
+
+  // The player: one converter, kept at the same rate, flushed and set up again at another rate and at the end
+  static int16_t resampled[RESAMPLE_OUT_FRAMES * 2];
+  Resampler resampler;
+  resampler.begin(tracks[0].rate, OUT_RATE, RESAMPLER_QUALITY_MEDIUM);
+  for(size_t t=0; t<TRACK_COUNT; t++){
+    if(resampler.getInRate() != tracks[t].rate){
+      TestAmplifier::flush(resampler, resampled);
+      resampler.begin(tracks[t].rate, OUT_RATE, RESAMPLER_QUALITY_MEDIUM);
+    }
+    for(uint32_t i=0; i<tracks[t].frames; i+=WAV_WRITE_FRAMES){
+      uint32_t n = (tracks[t].frames - i < WAV_WRITE_FRAMES) ? (tracks[t].frames - i) : WAV_WRITE_FRAMES;
+      TestAmplifier::write(resampler, resampled, &pcm[t][2 * i], n);
+    }
+  }
+  TestAmplifier::flush(resampler, resampled);
+
+  // One converter per source: the tracks at the same rate are one source
+  std::vector<int16_t> joined(pcm[0]);
+  joined.insert(joined.end(), pcm[1].begin(), pcm[1].end());
+  std::vector<int16_t> expected;
+  reference(tracks[0].rate, joined, expected);
+  uint32_t first = (uint32_t)(expected.size() / 2);
+  reference(tracks[2].rate, pcm[2], expected);
+  uint32_t second = (uint32_t)(expected.size() / 2) - first;
+  uint32_t total = first + second;
+
+  CHECK(first == expectedFrames(tracks[0].rate, tracks[0].frames + tracks[1].frames), "the tracks at %u Hz give %u frames, not %u",
+        (unsigned)tracks[0].rate, (unsigned)first, (unsigned)expectedFrames(tracks[0].rate, tracks[0].frames + tracks[1].frames));
+  CHECK(second == expectedFrames(tracks[2].rate, tracks[2].frames), "the track at %u Hz gives %u frames, not %u",
+        (unsigned)tracks[2].rate, (unsigned)second, (unsigned)expectedFrames(tracks[2].rate, tracks[2].frames));
+  CHECK(drain(total), "the sink has %u of %u frames", sink.frames.load(), (unsigned)total);
+  uint32_t frames = sink.frames.load();
+  uint32_t differ = 0;
+  for(uint32_t i=0; (i<frames) && (i<total); i++){
+    differ += (sink.record[2 * i] != expected[2 * i]) || (sink.record[2 * i + 1] != expected[2 * i + 1]);
+  }
+  CHECK(differ == 0, "%u frames differ from one converter per source", (unsigned)differ);
+  printf("%u + %u frames out of %u + %u + %u source frames\n", (unsigned)first, (unsigned)second,
+         (unsigned)tracks[0].frames, (unsigned)tracks[1].frames, (unsigned)tracks[2].frames);
+  amplifier.stop();
+  return hostTestResult("TrackJoinTest");
+}
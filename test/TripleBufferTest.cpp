@@ -0,0 +1,114 @@
+/*!
+ * @file  TripleBufferTest.cpp
+ * @brief  Stress the TripleBuffer with a writer and a reader thread and look for torn reads
+ * @details  The writer publishes records whose every word is derived from a sequence number, as fast as it can. The reader
+ * @n        picks them up as fast as it can, each record it sees must be whole and never older than the one before.
+ * @n        The Equalizer, which hands its coefficients over the same way, is then run while the bands change under it.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <thread>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define STRESS_WRITES   ((uint32_t)(2000000))   // Records published by the writer
+#define RECORD_WORDS   64   // Words per record, larger than a cache line so a torn copy is likely to be seen
+#define EQ_CHANGES   ((uint32_t)(20000))   // Band changes while the equalizer runs
+
+typedef struct
+{
+  uint32_t seq;
+  uint32_t word[RECORD_WORDS];   // seq * (i + 1)
+}sRecord_t;
+
+static void stressRecords(void)
+{
+  static TripleBuffer<sRecord_t> buffer;
+  std::atomic<bool> done(false);
+
+  std::thread writer([&done]{
+    sRecord_t record;
+    for(uint32_t seq=1; seq<=STRESS_WRITES; seq++){
+      record.seq = seq;
+      for(int i=0; i<RECORD_WORDS; i++){
+        record.word[i] = seq * (i + 1);
+      }
+      buffer.write(record);
+      if((seq & 63) == 0){   // Let the reader in also on a single core
+        std::this_thread::yield();
+      }
+    }
+    done.store(true);
+  });
+
+  uint32_t last = 0, torn = 0, backwards = 0, updates = 0;
+  bool finished = false;
+  while(!finished){
+    finished = done.load();   // One more pass after the writer is done, to pick up the last record
+    if(!buffer.update()){
+      std::this_thread::yield();
+      continue;
+    }
+    updates++;
+    const sRecord_t &record = buffer.front();
+    for(int i=0; i<RECORD_WORDS; i++){
+      if(record.word[i] != record.seq * (i + 1)){
+        torn++;
+        break;
+      }
+    }
+    backwards += (record.seq < last);
+    last = record.seq;
+  }
+  writer.join();
+
+  printf("records: %u written, %u picked up\n", STRESS_WRITES, updates);
+  CHECK(torn == 0, "%u torn records", torn);
+  CHECK(backwards == 0, "%u records older than the one before", backwards);
+  CHECK(last == STRESS_WRITES, "the last record picked up is %u", last);
+  CHECK(updates > 0, "no record picked up");
+}
+
+static void stressEqualizer(void)
+{
+  static Equalizer eq;
+  std::atomic<bool> done(false);
+  eq.setBand(0, bq_type_lowshelf, 100, 0.707f, 3);
+  eq.enableBand(0, true);
+
+  std::thread control([&done]{
+    for(uint32_t i=0; i<EQ_CHANGES; i++){
+      eq.setBand(1 + i % 3, bq_type_peak, 200.0f + i % 5000, 1.0f, (i & 1) ? 6.0f : -6.0f);
+      eq.enableBand(1 + i % 3, (i % 7) != 0);
+    }
+    done.store(true);
+  });
+
+  static float data[256 * 2];
+  uint32_t blocks = 0, bad = 0;
+  while(!done.load()){
+    for(int i=0; i<256 * 2; i++){
+      data[i] = (i & 1) ? 1000.0f : -1000.0f;
+    }
+    eq.update();
+    eq.process(data, 256);
+    for(int i=0; i<256 * 2; i++){
+      bad += !isfinite(data[i]) || (fabsf(data[i]) > 1e5f);   // A torn coefficient set may be unstable
+    }
+    blocks++;
+  }
+  control.join();
+  printf("equalizer: %u blocks while %u band changes\n", blocks, EQ_CHANGES);
+  CHECK(bad == 0, "%u samples out of range", bad);
+}
+
+int main(void)
+{
+  stressRecords();
+  stressEqualizer();
+  return hostTestResult("TripleBufferTest");
+}
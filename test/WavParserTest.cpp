@@ -0,0 +1,285 @@
+/*!
+ * @file  WavParserTest.cpp
+ * @brief  Feed WAV headers built in memory to the incremental parser, in pieces of every size, and check the format it gives
+ * @details  8/16/24/32-bit integer and 32-bit float, mono and stereo are parsed from plain fmt chunks and from
+ * @n        WAVE_FORMAT_EXTENSIBLE. A LIST chunk and a chunk of odd size before the data chunk must each be skipped with
+ * @n        one eWavSkip, padding included, also when the bytes come one at a time. The same file fed in pieces of 1 byte,
+ * @n        of odd sizes and of random sizes must give the same sWavFormat_t as fed at once, and parseFile() must leave
+ * @n        the file at the first sample. Truncated headers, a missing data chunk, non-RIFF input and unsupported formats
+ * @n        must not give eWavData.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <string.h>
+#include <vector>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define LIST_SIZE   ((uint32_t)(150))   // Longer than one read of parseFile()
+#define ODD_SIZE   ((uint32_t)(7))   // Followed by a pad byte
+#define DATA_SIZE   ((uint32_t)(96))
+#define RANDOM_PIECES   (20)   // Runs with pieces of random sizes
+
+typedef std::vector<uint8_t> file_t;
+
+static void put16(file_t &f, uint16_t v)
+{
+  f.push_back((uint8_t)v);
+  f.push_back((uint8_t)(v >> 8));
+}
+
+static void put32(file_t &f, uint32_t v)
+{
+  put16(f, (uint16_t)v);
+  put16(f, (uint16_t)(v >> 16));
+}
+
+static void putId(file_t &f, const char *id)
+{
+  for(int i=0; i<4; i++){
+    f.push_back((uint8_t)id[i]);
+  }
+}
+
+static void putChunk(file_t &f, const char *id, uint32_t size)
+{
+  putId(f, id);
+  put32(f, size);
+  for(uint32_t i=0; i<size + (size & 1); i++){
+    f.push_back((uint8_t)(0xa5 ^ i));
+  }
+}
+
+/**
+ * A WAV file: RIFF header, optionally LIST and an odd chunk before fmt, fmt, an odd chunk after it, and the data chunk
+ */
+static file_t makeWav(uint16_t tag, uint16_t channels, uint16_t bits, uint32_t rate, bool extensible, bool metadata)
+{
+  file_t f;
+  putId(f, "RIFF");
+  put32(f, 0);   // Patched below
+  putId(f, "WAVE");
+  if(metadata){
+    putChunk(f, "LIST", LIST_SIZE);
+  }
+  putId(f, "fmt ");
+  put32(f, extensible ? 40 : 16);
+  put16(f, extensible ? WAV_FORMAT_EXTENSIBLE : tag);
+  put16(f, channels);
+  put32(f, rate);
+  put32(f, rate * channels * (bits / 8));
+  put16(f, (uint16_t)(channels * (bits / 8)));
+  put16(f, bits);
+  if(extensible){
+    static const uint8_t guidTail[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71};
+    put16(f, 22);   // cbSize
+    put16(f, (bits == 32) && (tag == WAV_FORMAT_PCM) ? 24 : bits);   // Valid bits, 24 in a 32-bit container
+    put32(f, (channels == 1) ? 0x4 : 0x3);   // Channel mask
+    put16(f, tag);
+    f.insert(f.end(), guidTail, guidTail + sizeof(guidTail));
+  }
+  if(metadata){
+    putChunk(f, "odd ", ODD_SIZE);
+  }
+  putId(f, "data");
+  put32(f, DATA_SIZE);
+  for(uint32_t i=0; i<DATA_SIZE; i++){
+    f.push_back((uint8_t)i);
+  }
+  uint32_t riff = (uint32_t)f.size() - 8;
+  memcpy(&f[4], &riff, 4);   // The host is little-endian as the WAV file
+  return f;
+}
+
+/**
+ * @struct sFeed_t
+ * @brief What the caller saw while feeding a file
+ */
+typedef struct
+{
+  WavParser::eWavResult_t result;   // The last result, eWavNeedMore when the file ended first
+  uint32_t skips;   // eWavSkip results
+  uint32_t skipped[4];   // getSkip() of the first ones
+  sWavFormat_t format;
+}sFeed_t;
+
+/**
+ * Feed the file as a caller reading it in pieces, the size of each piece given by pieceSize(), and seeking on eWavSkip
+ */
+template <typename PieceSize>
+static sFeed_t feed(const file_t &f, PieceSize pieceSize)
+{
+  WavParser parser;
+  sFeed_t r;
+  memset(&r, 0, sizeof(r));
+  r.result = WavParser::eWavNeedMore;
+  size_t pos = 0;
+  while(pos < f.size()){
+    size_t len = pieceSize();
+    len = (len > f.size() - pos) ? (f.size() - pos) : len;
+    size_t used;
+    r.result = parser.parse(&f[pos], len, &used);
+    pos += used;
+    if(r.result == WavParser::eWavSkip){
+      if(r.skips < 4){
+        r.skipped[r.skips] = parser.getSkip();
+      }
+      r.skips++;
+      pos += parser.getSkip();
+    }else if(r.result != WavParser::eWavNeedMore){
+      break;
+    }
+  }
+  memcpy(&r.format, &parser.getFormat(), sizeof(r.format));
+  return r;
+}
+
+struct FixedPiece
+{
+  size_t size;
+  size_t operator()(void) { return size; }
+};
+
+struct RandomPiece
+{
+  uint32_t state;
+  size_t operator()(void)
+  {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return 1 + state % 23;
+  }
+};
+
+static bool parseFile(const file_t &f, WavParser &parser, long *position)
+{
+  FILE *fp = tmpfile();
+  fwrite(f.data(), 1, f.size(), fp);
+  rewind(fp);
+  bool ok = parser.parseFile(fp);
+  *position = ftell(fp);
+  fclose(fp);
+  return ok;
+}
+
+static void checkFormat(const char *name, uint16_t tag, uint16_t channels, uint16_t bits, bool extensible)
+{
+  const uint32_t rate = 44100;
+  for(int metadata=0; metadata<2; metadata++){
+    file_t f = makeWav(tag, channels, bits, rate, extensible, metadata);
+    FixedPiece whole = {f.size()};
+    sFeed_t ref = feed(f, whole);
+    const sWavFormat_t &w = ref.format;
+    uint32_t dataOffset = (uint32_t)f.size() - DATA_SIZE;
+    uint16_t validBits = (extensible && (bits == 32) && (tag == WAV_FORMAT_PCM)) ? 24 : bits;
+    CHECK(ref.result == WavParser::eWavData, "%s: result %d", name, ref.result);
+    CHECK((w.formatTag == tag) && (w.numChannels == channels) && (w.sampleRate == rate) && (w.bitsPerSample == bits) &&
+          (w.validBits == validBits) && (w.blockAlign == channels * bits / 8) && (w.bytesPerSecond == rate * channels * bits / 8),
+          "%s: tag 0x%04x, %u channels, %u Hz, %u/%u bits, block %u", name, w.formatTag, w.numChannels, (unsigned)w.sampleRate,
+          w.validBits, w.bitsPerSample, w.blockAlign);
+    CHECK((w.dataOffset == dataOffset) && (w.dataSize == DATA_SIZE), "%s: data at %u, %u bytes", name, (unsigned)w.dataOffset, (unsigned)w.dataSize);
+
+    // One skip per unknown chunk with its pad byte, however the bytes come
+    uint32_t skips = metadata ? 2 : 0;
+    CHECK((ref.skips == skips) && (!metadata || ((ref.skipped[0] == LIST_SIZE) && (ref.skipped[1] == ODD_SIZE + 1))),
+          "%s: %u skips, %u and %u bytes", name, (unsigned)ref.skips, (unsigned)ref.skipped[0], (unsigned)ref.skipped[1]);
+
+    static const size_t pieces[] = {1, 2, 3, 5, 7, 13, 41, WAV_HEADER_READ_SIZE};
+    for(size_t i=0; i<sizeof(pieces) / sizeof(pieces[0]); i++){
+      FixedPiece piece = {pieces[i]};
+      sFeed_t r = feed(f, piece);
+      CHECK((r.result == WavParser::eWavData) && (r.skips == skips) && !memcmp(&r.format, &ref.format, sizeof(sWavFormat_t)),
+            "%s: fed in pieces of %u bytes, result %d, %u skips", name, (unsigned)pieces[i], r.result, (unsigned)r.skips);
+    }
+    for(int i=0; i<RANDOM_PIECES; i++){
+      RandomPiece piece = {2463534242u + (uint32_t)i};
+      sFeed_t r = feed(f, piece);
+      CHECK((r.result == WavParser::eWavData) && (r.skips == skips) && !memcmp(&r.format, &ref.format, sizeof(sWavFormat_t)),
+            "%s: fed in random pieces, seed %d, result %d", name, i, r.result);
+    }
+
+    WavParser parser;
+    long position;
+    bool ok = parseFile(f, parser, &position);
+    CHECK(ok && (position == (long)dataOffset) && !memcmp(&parser.getFormat(), &ref.format, sizeof(sWavFormat_t)),
+          "%s: parseFile() %s, left at %ld", name, ok ? "succeeded" : parser.getError(), position);
+  }
+}
+
+/**
+ * The file must not give eWavData, fed at once, one byte at a time and through parseFile()
+ */
+static void checkRejected(const char *name, const file_t &f)
+{
+  FixedPiece whole = {f.size() ? f.size() : 1};
+  FixedPiece single = {1};
+  sFeed_t r = feed(f, whole);
+  sFeed_t rSingle = feed(f, single);
+  WavParser parser;
+  long position;
+  bool ok = parseFile(f, parser, &position);
+  CHECK((r.result != WavParser::eWavData) && (rSingle.result == r.result), "%s: result %d, %d one byte at a time",
+        name, r.result, rSingle.result);
+  CHECK(!ok && (parser.getError() != NULL), "%s: parseFile() succeeded", name);
+}
+
+static void checkErrors(void)
+{
+  file_t f = makeWav(WAV_FORMAT_PCM, 2, 16, 44100, false, true);
+  size_t fmtEnd = 12 + 8 + LIST_SIZE + 8 + 16;
+  static const size_t cuts[] = {0, 3, 11, 12, 15, 12 + 8 + LIST_SIZE, 12 + 8 + LIST_SIZE + 8 + 10, fmtEnd, fmtEnd + 8 + ODD_SIZE + 1 + 5};
+  for(size_t i=0; i<sizeof(cuts) / sizeof(cuts[0]); i++){
+    char name[48];
+    snprintf(name, sizeof(name), "truncated at %u bytes", (unsigned)cuts[i]);
+    file_t cut(f.begin(), f.begin() + cuts[i]);
+    checkRejected(name, cut);
+    FixedPiece whole = {cut.size() ? cut.size() : 1};
+    CHECK(feed(cut, whole).result != WavParser::eWavError, "%s: a truncated header is not an error until the caller runs out", name);
+  }
+
+  file_t noData(f.begin(), f.end() - DATA_SIZE - 8);   // Ends after the chunk following fmt
+  checkRejected("no data chunk", noData);
+
+  file_t rifx = f;
+  rifx[3] = 'X';
+  checkRejected("RIFX", rifx);
+  FixedPiece whole = {rifx.size()};
+  CHECK(feed(rifx, whole).result == WavParser::eWavError, "RIFX is an error");
+  file_t avi = f;
+  memcpy(&avi[8], "AVI ", 4);
+  checkRejected("RIFF AVI", avi);
+  const char text[] = "This is not a WAV file, only some text that is long enough to hold a header.";
+  checkRejected("text", file_t(text, text + sizeof(text)));
+
+  file_t dataFirst = makeWav(WAV_FORMAT_PCM, 2, 16, 44100, false, false);
+  memcpy(&dataFirst[12], "data", 4);
+  checkRejected("data chunk before fmt chunk", dataFirst);
+  checkRejected("ADPCM", makeWav(0x0002, 2, 16, 44100, false, false));
+  checkRejected("float 64-bit", makeWav(WAV_FORMAT_IEEE_FLOAT, 2, 64, 44100, false, false));
+  checkRejected("12-bit", makeWav(WAV_FORMAT_PCM, 2, 12, 44100, false, false));
+  checkRejected("3 channels", makeWav(WAV_FORMAT_PCM, 3, 16, 44100, false, false));
+  checkRejected("0 Hz", makeWav(WAV_FORMAT_PCM, 2, 16, 0, false, false));
+}
+
+int main(void)
+{
+  static const uint16_t bits[] = {8, 16, 24, 32};
+  for(int channels=1; channels<=2; channels++){
+    for(int extensible=0; extensible<2; extensible++){
+      char name[48];
+      for(size_t i=0; i<sizeof(bits) / sizeof(bits[0]); i++){
+        snprintf(name, sizeof(name), "%u-bit %s%s", bits[i], (channels == 1) ? "mono" : "stereo", extensible ? " extensible" : "");
+        checkFormat(name, WAV_FORMAT_PCM, channels, bits[i], extensible);
+      }
+      snprintf(name, sizeof(name), "float %s%s", (channels == 1) ? "mono" : "stereo", extensible ? " extensible" : "");
+      checkFormat(name, WAV_FORMAT_IEEE_FLOAT, channels, 32, extensible);
+    }
+  }
+  checkErrors();
+  return hostTestResult("WavParserTest");
+}
@@ -0,0 +1,231 @@
+/*!
+ * @file  WidePathTest.cpp
+ * @brief  Stream a 24-bit source through the wide samples into a recording sink, and check that only the requantizer narrows it
+ * @details  Built with PCM_WIDE_SAMPLES. The 24-bit frames are converted as playWAV() does and written to the PCM buffer.
+ * @n        At unity gain 24-bit output without dither and 32-bit output must give the source bit for bit. 16-bit output
+ * @n        is requantized with TPDF dither: each sample stays within the dither of the source, and a level of a quarter
+ * @n        of a 16-bit LSB must come out on average, which the low-memory mode would have cut at the source. A sine below
+ * @n        the 16-bit LSB is finally converted from 48000 Hz, and must keep its level through the sample-rate converter.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <atomic>
+#include <vector>
+#include <DFRobot_MAX98357A.h>
+#include "HostTest.h"
+
+#define RECORD_FRAMES   ((uint32_t)(120000))
+#define PHASE_FRAMES   ((uint32_t)(20011))   // Frames of each phase, not a multiple of the blocks
+#define DRAIN_MS   ((uint32_t)(5000))
+#define QUARTER_LSB   ((int32_t)(64))   // A quarter of a 16-bit LSB in 24-bit steps
+#define LOW_AMPLITUDE   (40.0)   // Of the sine through the converter, in 24-bit steps
+#define SETTLE_FRAMES   ((uint32_t)(1000))   // Output frames skipped while the history of the converter fills
+
+/**
+ * Takes every width, and records the samples of 16-bit output as they are and the words of wider output
+ */
+class RecordingSink : public AudioSink
+{
+public:
+  RecordingSink(void) : frames(0), bits(16) {}
+
+  size_t write(const void *data, size_t len, uint32_t ticksToWait)
+  {
+    uint32_t n = frames.load(std::memory_order_relaxed);
+    uint32_t add = (uint32_t)(len / ((bits == 16) ? 4 : 8));
+    add = (n + add > RECORD_FRAMES) ? (RECORD_FRAMES - n) : add;
+    for(uint32_t i=0; i<2 * add; i++){
+      record[2 * n + i] = (bits == 16) ? ((const int16_t *)data)[i] : ((const int32_t *)data)[i];
+    }
+    frames.store(n + add, std::memory_order_release);
+    return len;
+  }
+
+  bool setBitsPerSample(uint8_t bitsPerSample)
+  {
+    bits = bitsPerSample;
+    return true;
+  }
+
+  int32_t record[RECORD_FRAMES * 2];
+  std::atomic<uint32_t> frames;
+  uint8_t bits;
+};
+
+class TestAmplifier : public DFRobot_MAX98357A
+{
+public:
+  static bool write(Resampler &resampler, pcm_t *out, const pcm_t *data, uint32_t frames)
+  {
+    return writeResampled(resampler, out, (const uint8_t *)data, frames * PCM_FRAME_BYTES, portMAX_DELAY);
+  }
+  static bool flush(Resampler &resampler, pcm_t *out) { return flushResampled(resampler, out, portMAX_DELAY); }
+  void stop(void) { end(); }
+};
+
+static RecordingSink sink;
+static uint32_t written;   // Frames written so far
+
+static void put24(std::vector<uint8_t> &v, int32_t x)
+{
+  v.push_back((uint8_t)x);
+  v.push_back((uint8_t)(x >> 8));
+  v.push_back((uint8_t)(x >> 16));
+}
+
+/**
+ * Convert the 24-bit frames with the kernel of their layout and write them at the given rate
+ */
+static void writeSource(const std::vector<uint8_t> &wav, uint32_t rate)
+{
+  sWavFormat_t format;
+  memset(&format, 0, sizeof(format));
+  format.formatTag = WAV_FORMAT_PCM;
+  format.numChannels = 2;
+  format.bitsPerSample = 24;
+  format.validBits = 24;
+  format.blockAlign = 6;
+  pcmConvert_t convert = PCMConverter::select(format);
+  static pcm_t converted[WAV_WRITE_FRAMES * 2];
+  static pcm_t resampled[RESAMPLE_OUT_FRAMES * 2];
+  Resampler resampler;
+  resampler.begin(rate, 44100, RESAMPLER_QUALITY_HIGH);
+  uint32_t frames = (uint32_t)(wav.size() / 6);
+  for(uint32_t i=0; i<frames; i+=WAV_WRITE_FRAMES){
+    uint32_t n = (frames - i < WAV_WRITE_FRAMES) ? (frames - i) : WAV_WRITE_FRAMES;
+    convert(&wav[6 * i], converted, n);
+    TestAmplifier::write(resampler, resampled, converted, n);
+  }
+  TestAmplifier::flush(resampler, resampled);
+}
+
+static bool drain(uint32_t frames)
+{
+  for(uint32_t waited=0; waited<DRAIN_MS; waited+=5){
+    if(sink.frames.load(std::memory_order_acquire) >= frames){
+      delay(5 * OUTPUT_WAIT_TICKS);   // And nothing more comes
+      return sink.frames.load(std::memory_order_acquire) == frames;
+    }
+    delay(5);
+  }
+  return false;
+}
+
+static int32_t sourceL(uint32_t k)
+{
+  return (int32_t)lrint(7000000.0 * sin(2.0 * M_PI * 997.0 * k / 44100));   // About -1.6 dBFS
+}
+
+static int32_t sourceR(uint32_t k)
+{
+  return ((int32_t)(k * 2654435761u) >> 9) | 1;   // Every bit of 24 bits, about -6 dBFS
+}
+
+/**
+ * The sine and the noise at unity gain, bit for bit in 24-bit and 32-bit words, within the dither at 16 bits
+ */
+static void checkWidth(TestAmplifier &amplifier, uint8_t bits)
+{
+  amplifier.setOutputBits(bits);
+  std::vector<uint8_t> wav;
+  for(uint32_t k=0; k<PHASE_FRAMES; k++){
+    put24(wav, sourceL(k));
+    put24(wav, sourceR(k));
+  }
+  uint32_t start = written;
+  writeSource(wav, 44100);
+  written += PHASE_FRAMES;
+  CHECK(drain(written), "%u-bit output: %u of %u frames", bits, sink.frames.load(), written);
+
+  uint32_t differ = 0;
+  double worst = 0;
+  for(uint32_t k=0; k<PHASE_FRAMES; k++){
+    int32_t l = sink.record[2 * (start + k)], r = sink.record[2 * (start + k) + 1];
+    if(bits == 16){
+      double el = fabs(l - sourceL(k) / 256.0), er = fabs(r - sourceR(k) / 256.0);
+      worst = (el > worst) ? el : worst;
+      worst = (er > worst) ? er : worst;
+    }else{
+      differ += (l != sourceL(k) * 256) || (r != sourceR(k) * 256);
+    }
+  }
+  CHECK(differ == 0, "%u-bit output: %u frames differ from the 24-bit source", bits, differ);
+  CHECK(worst < 1.5, "16-bit output: %.2f LSB off the source, more than the dither", worst);
+}
+
+/**
+ * A level below the 16-bit LSB, the requantizer gets it and the dither carries it into the 16-bit output on average
+ */
+static void checkQuarterLSB(TestAmplifier &amplifier)
+{
+  amplifier.setOutputBits(16);
+  std::vector<uint8_t> wav;
+  for(uint32_t k=0; k<PHASE_FRAMES; k++){
+    put24(wav, QUARTER_LSB);
+    put24(wav, -QUARTER_LSB);
+  }
+  uint32_t start = written;
+  writeSource(wav, 44100);
+  written += PHASE_FRAMES;
+  CHECK(drain(written), "a quarter LSB: %u of %u frames", sink.frames.load(), written);
+  double sumL = 0, sumR = 0;
+  for(uint32_t k=start; k<written; k++){
+    sumL += sink.record[2 * k];
+    sumR += sink.record[2 * k + 1];
+  }
+  double meanL = sumL / PHASE_FRAMES, meanR = sumR / PHASE_FRAMES;
+  printf("a quarter of a 16-bit LSB comes out as %.3f and %.3f\n", meanL, meanR);
+  CHECK((fabs(meanL - 0.25) < 0.03) && (fabs(meanR + 0.25) < 0.03), "a quarter LSB comes out as %.3f and %.3f", meanL, meanR);
+}
+
+/**
+ * A sine of LOW_AMPLITUDE steps at 48000 Hz, the low-memory mode would give silence
+ */
+static void checkResampled(TestAmplifier &amplifier)
+{
+  amplifier.setOutputBits(24);
+  std::vector<uint8_t> wav;
+  for(uint32_t k=0; k<PHASE_FRAMES; k++){
+    int32_t s = (int32_t)lrint(LOW_AMPLITUDE * sin(2.0 * M_PI * 1000.0 * k / 48000));
+    put24(wav, s);
+    put24(wav, -s);
+  }
+  uint32_t start = sink.frames.load();
+  writeSource(wav, 48000);
+  uint32_t expected = (uint32_t)((((uint64_t)PHASE_FRAMES << 32) - 1) / ((48000ULL << 32) / 44100) + 1);
+  written += expected;
+  CHECK(drain(written), "resampled: %u of %u frames", sink.frames.load(), written);
+  double sumL = 0, sumR = 0;
+  uint32_t n = 0;
+  for(uint32_t k=start + SETTLE_FRAMES; k<written - SETTLE_FRAMES; k++, n++){
+    double l = sink.record[2 * k] / 256.0, r = sink.record[2 * k + 1] / 256.0;
+    sumL += l * l;
+    sumR += (l + r) * (l + r);
+  }
+  double rms = sqrt(sumL / n), mismatch = sqrt(sumR / n);
+  printf("a sine of %.0f 24-bit steps comes out at %.2f steps rms, %.2f expected\n", LOW_AMPLITUDE, rms, LOW_AMPLITUDE / sqrt(2.0));
+  CHECK(fabs(rms / (LOW_AMPLITUDE / sqrt(2.0)) - 1.0) < 0.05, "the resampled sine is at %.2f steps rms", rms);
+  CHECK(mismatch < 1.0, "the resampled channels differ by %.2f steps rms", mismatch);
+}
+
+int main(void)
+{
+  TestAmplifier amplifier;
+  amplifier.setAudioSink(&sink);
+  amplifier.setDither(24, DITHER_OFF);
+  amplifier.setDither(16, DITHER_TPDF);
+  CHECK(amplifier.initI2S(25, 26, 27), "initI2S");
+  amplifier.reverseLeftRightChannels();   // Output as converted
+
+  checkWidth(amplifier, 24);
+  checkWidth(amplifier, 32);
+  checkWidth(amplifier, 16);
+  checkQuarterLSB(amplifier);
+  checkResampled(amplifier);
+  amplifier.stop();
+  return hostTestResult("WidePathTest");
+}
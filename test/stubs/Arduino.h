@@ -0,0 +1,129 @@
+/*!
+ * @file  Arduino.h
+ * @brief  Define the part of the Arduino-ESP32 core used by the library, for the host tests and benchmarks
+ * @details  Only what the library and the benchmark sketch use is declared, HostStubs.cpp implements it: Serial writes to
+ * @n        stdout, the time functions and ESP.getCycleCount() follow the steady clock, the semaphores are a mutex and a condition variable.
+ * @n        The FreeRTOS task functions are declared for the syntax check of the ESP_PLATFORM code, they are not implemented.
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+
+#define PI   3.1415926535897932384626433832795
+#define HEX   16
+#define DEC   10
+#define constrain(amt, low, high)   ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define IRAM_ATTR
+#define ESP_OK   0
+#define ESP_ERROR_CHECK(x)   (void)(x)
+typedef int esp_err_t;
+
+/************************ FreeRTOS ********************************/
+
+typedef void * TaskHandle_t;
+typedef void * xTaskHandle;
+typedef void * SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define portMAX_DELAY   ((TickType_t)0xffffffffu)
+#define portTICK_PERIOD_MS   1   //!< A tick is 1 ms on the host
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define pdPASS   1
+#define pdTRUE   1
+#define pdFALSE   0
+#define tskNO_AFFINITY   0x7fffffff
+#define configMAX_PRIORITIES   25
+
+BaseType_t xTaskCreate(void (*entry)(void *), const char *name, uint32_t stackSize, void *arg, UBaseType_t priority, TaskHandle_t *handle);
+BaseType_t xTaskCreatePinnedToCore(void (*entry)(void *), const char *name, uint32_t stackSize, void *arg, UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+void vTaskDelete(TaskHandle_t handle);
+void vTaskDelay(TickType_t ticks);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t handle);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t handle);
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+/************************ ESP32 ********************************/
+
+uint32_t esp_random(void);
+uint32_t getCpuFrequencyMhz(void);
+
+class EspClass
+{
+public:
+  uint32_t getCycleCount(void);   // At getCpuFrequencyMhz(), from the steady clock
+};
+extern EspClass ESP;
+
+/************************ Arduino ********************************/
+
+void delay(uint32_t ms);
+uint32_t millis(void);
+uint32_t micros(void);
+
+bool btStarted(void);
+bool btStart(void);
+bool btStop(void);
+
+class String
+{
+public:
+  String(void) {}
+  String(const char *text) : _s(text ? text : "") {}
+  String(const std::string &text) : _s(text) {}
+  const char * c_str(void) const { return _s.c_str(); }
+  size_t length(void) const { return _s.size(); }
+  bool operator==(const char *text) const { return _s == text; }
+  bool operator==(const String &text) const { return _s == text._s; }
+  bool operator!=(const String &text) const { return _s != text._s; }
+
+protected:
+  std::string _s;
+};
+
+class HardwareSerial
+{
+public:
+  void begin(unsigned long baud) {}
+  size_t print(const char *text) { return fputs(text, stdout) >= 0 ? strlen(text) : 0; }
+  size_t print(const String &text) { return print(text.c_str()); }
+  size_t print(char c) { return (putchar(c) == EOF) ? 0 : 1; }
+  size_t print(long n, int base=DEC) { return printf((base == HEX) ? "%lx" : "%ld", n); }
+  size_t print(unsigned long n, int base=DEC) { return printf((base == HEX) ? "%lx" : "%lu", n); }
+  size_t print(int n, int base=DEC) { return print((long)n, base); }
+  size_t print(unsigned int n, int base=DEC) { return print((unsigned long)n, base); }
+  size_t print(unsigned long long n, int base=DEC) { return print((unsigned long)n, base); }
+  size_t print(double n, int digits=2) { return printf("%.*f", digits, n); }
+  size_t println(void) { return print("\n"); }
+  template <typename T>
+  size_t println(T value) { size_t n = print(value); return n + println(); }
+  template <typename T>
+  size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,208 @@
+/*!
+ * @file  HostStubs.cpp
+ * @brief  Define the stubbed Arduino, FreeRTOS and ESP-IDF functions used by the library on a Linux host
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#include <stdarg.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <Arduino.h>
+#include <SD.h>
+#include <driver/i2s.h>
+#include <esp_a2dp_api.h>
+#include <esp_avrc_api.h>
+#include <esp_bt_main.h>
+#include <esp_bt_device.h>
+#include <esp_gap_bt_api.h>
+
+#include "HostStubs.h"
+
+#define HOST_CPU_MHZ   ((uint32_t)(240))   //!< The clock ESP.getCycleCount() counts at, as the ESP32
+
+HardwareSerial Serial;
+EspClass ESP;
+SDFS SD;
+sHostCalls_t hostCalls;
+
+static const std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+
+static uint64_t elapsedNs(void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+}
+
+void hostResetCalls(void)
+{
+  memset(&hostCalls, 0, sizeof(hostCalls));
+}
+
+/************************ Arduino ********************************/
+
+size_t HardwareSerial::printf(const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  int n = vprintf(format, args);
+  va_end(args);
+  return (n < 0) ? 0 : n;
+}
+
+void delay(uint32_t ms)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+uint32_t millis(void)
+{
+  return (uint32_t)(elapsedNs() / 1000000);
+}
+
+uint32_t micros(void)
+{
+  return (uint32_t)(elapsedNs() / 1000);
+}
+
+uint32_t EspClass::getCycleCount(void)
+{
+  return (uint32_t)(elapsedNs() * HOST_CPU_MHZ / 1000);
+}
+
+uint32_t getCpuFrequencyMhz(void)
+{
+  return HOST_CPU_MHZ;
+}
+
+uint32_t esp_random(void)
+{
+  static uint32_t state = 2463534242u;   // xorshift32, the same sequence on every run
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+bool btStarted(void) { return true; }
+bool btStart(void) { return true; }
+bool btStop(void) { return true; }
+
+/************************ FreeRTOS ********************************/
+
+/**
+ * A FreeRTOS semaphore, a mutex is created given, a binary semaphore taken. Either may be given by another thread
+ */
+class HostSemaphore
+{
+public:
+  HostSemaphore(bool given) : _given(given) {}
+
+  bool take(TickType_t ticks)
+  {
+    std::unique_lock<std::mutex> lock(_lock);
+    if(ticks == portMAX_DELAY){
+      _changed.wait(lock, [this]{ return _given; });
+    }else if(!_changed.wait_for(lock, std::chrono::milliseconds(ticks), [this]{ return _given; })){
+      return false;
+    }
+    _given = false;
+    return true;
+  }
+
+  void give(void)
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _given = true;
+    _changed.notify_one();
+  }
+
+protected:
+  std::mutex _lock;
+  std::condition_variable _changed;
+  bool _given;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+  return new HostSemaphore(true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+  return new HostSemaphore(false);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+  return ((HostSemaphore *)semaphore)->take(ticks) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+  ((HostSemaphore *)semaphore)->give();
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+  delete (HostSemaphore *)semaphore;
+}
+
+/************************ I2S ********************************/
+
+int i2s_driver_install(i2s_port_t port, const i2s_config_t *config, int queueSize, void *queue) { return ESP_OK; }
+int i2s_driver_uninstall(i2s_port_t port) { return ESP_OK; }
+int i2s_set_pin(i2s_port_t port, const i2s_pin_config_t *pins) { return ESP_OK; }
+int i2s_set_clk(i2s_port_t port, uint32_t rate, i2s_bits_per_sample_t bits, i2s_channel_t channels) { return ESP_OK; }
+int i2s_set_sample_rates(i2s_port_t port, uint32_t rate) { return ESP_OK; }
+int i2s_zero_dma_buffer(i2s_port_t port) { return ESP_OK; }
+
+int i2s_write(i2s_port_t port, const void *data, size_t size, size_t *written, uint32_t ticksToWait)
+{
+  hostCalls.i2sWrites++;
+  hostCalls.i2sBytes += size;
+  *written = size;
+  return ESP_OK;
+}
+
+/************************ Bluetooth ********************************/
+
+esp_bluedroid_status_t esp_bluedroid_get_status(void) { return ESP_BLUEDROID_STATUS_ENABLED; }
+int esp_bluedroid_init(void) { return ESP_OK; }
+int esp_bluedroid_enable(void) { return ESP_OK; }
+int esp_bluedroid_disable(void) { return ESP_OK; }
+int esp_bluedroid_deinit(void) { return ESP_OK; }
+int esp_bt_dev_set_device_name(const char *name) { return ESP_OK; }
+int esp_bt_gap_set_scan_mode(int connectable, int discoverable) { return ESP_OK; }
+
+int esp_a2d_sink_init(void) { return ESP_OK; }
+int esp_a2d_sink_deinit(void) { return ESP_OK; }
+int esp_a2d_register_callback(esp_a2d_cb_t callback) { return ESP_OK; }
+int esp_a2d_sink_register_data_callback(esp_a2d_sink_data_cb_t callback) { return ESP_OK; }
+
+int esp_avrc_ct_init(void) { return ESP_OK; }
+int esp_avrc_ct_deinit(void) { return ESP_OK; }
+int esp_avrc_ct_register_callback(esp_avrc_ct_cb_t callback) { return ESP_OK; }
+int esp_avrc_ct_send_passthrough_cmd(uint8_t tl, uint8_t keyCode, uint8_t keyState) { return ESP_OK; }
+
+int esp_avrc_ct_send_metadata_cmd(uint8_t tl, uint8_t attrMask)
+{
+  hostCalls.metadataRequests++;
+  hostCalls.metadataMask = attrMask;
+  hostCalls.metadataLabel = tl;
+  return ESP_OK;
+}
+
+int esp_avrc_ct_send_register_notification_cmd(uint8_t tl, uint8_t eventId, uint32_t interval)
+{
+  hostCalls.notificationRequests++;
+  hostCalls.notificationEvent = eventId;
+  hostCalls.notificationLabel = tl;
+  return ESP_OK;
+}
@@ -0,0 +1,42 @@
+/*!
+ * @file  HostStubs.h
+ * @brief  Define the record of the calls into the stubbed ESP-IDF functions, so the host tests can check them
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_STUBS_H__
+#define __HOST_STUBS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @struct sHostCalls_t
+ * @brief The calls of the stubbed functions since the last hostResetCalls()
+ */
+typedef struct
+{
+  uint32_t metadataRequests;   // esp_avrc_ct_send_metadata_cmd()
+  uint8_t metadataMask;   // The attribute mask of the last metadata request
+  uint8_t metadataLabel;   // The transaction label of the last metadata request
+  uint32_t notificationRequests;   // esp_avrc_ct_send_register_notification_cmd()
+  uint8_t notificationEvent;   // The event of the last notification registered
+  uint8_t notificationLabel;
+  uint32_t i2sWrites;   // i2s_write()
+  uint64_t i2sBytes;   // Bytes taken by i2s_write()
+}sHostCalls_t;
+
+extern sHostCalls_t hostCalls;
+
+/**
+ * @fn hostResetCalls
+ * @brief Clear the record of the calls
+ * @return None
+ */
+void hostResetCalls(void);
+
+#endif
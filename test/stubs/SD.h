@@ -0,0 +1,30 @@
+/*!
+ * @file  SD.h
+ * @brief  The SD library of the Arduino-ESP32 core for the host stubs, the card is always mounted, the library reads the files with stdio
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_SD_H__
+#define __HOST_SD_H__
+
+#include <Arduino.h>
+
+#define CARD_NONE   0
+#define CARD_MMC   1
+#define CARD_SD   2
+#define CARD_SDHC   3
+
+class SDFS
+{
+public:
+  bool begin(uint8_t csPin) { return true; }
+  uint8_t cardType(void) { return CARD_SDHC; }
+  uint64_t cardSize(void) { return 0; }
+};
+extern SDFS SD;
+
+#endif
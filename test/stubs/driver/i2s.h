@@ -0,0 +1,57 @@
+/*!
+ * @file  i2s.h
+ * @brief  The legacy I2S driver of ESP-IDF for the host stubs, every call succeeds and i2s_write() takes all the data
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_DRIVER_I2S_H__
+#define __HOST_DRIVER_I2S_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {I2S_NUM_0, I2S_NUM_1} i2s_port_t;
+typedef enum {I2S_MODE_MASTER = 1, I2S_MODE_SLAVE = 2, I2S_MODE_TX = 4, I2S_MODE_RX = 8} i2s_mode_t;
+typedef enum {I2S_BITS_PER_SAMPLE_16BIT = 16, I2S_BITS_PER_SAMPLE_24BIT = 24, I2S_BITS_PER_SAMPLE_32BIT = 32} i2s_bits_per_sample_t;
+typedef enum {I2S_CHANNEL_MONO = 1, I2S_CHANNEL_STEREO = 2} i2s_channel_t;
+typedef enum {I2S_CHANNEL_FMT_RIGHT_LEFT, I2S_CHANNEL_FMT_ALL_RIGHT, I2S_CHANNEL_FMT_ALL_LEFT} i2s_channel_fmt_t;
+typedef enum {I2S_COMM_FORMAT_STAND_I2S = 1} i2s_comm_format_t;
+
+#define ESP_INTR_FLAG_LEVEL1   (1 << 1)
+#define I2S_PIN_NO_CHANGE   (-1)
+
+typedef struct
+{
+  i2s_mode_t mode;
+  int sample_rate;
+  i2s_bits_per_sample_t bits_per_sample;
+  i2s_channel_fmt_t channel_format;
+  i2s_comm_format_t communication_format;
+  int intr_alloc_flags;
+  int dma_buf_count;
+  int dma_buf_len;
+  bool use_apll;
+  bool tx_desc_auto_clear;
+}i2s_config_t;
+
+typedef struct
+{
+  int bck_io_num;
+  int ws_io_num;
+  int data_out_num;
+  int data_in_num;
+}i2s_pin_config_t;
+
+int i2s_driver_install(i2s_port_t port, const i2s_config_t *config, int queueSize, void *queue);
+int i2s_driver_uninstall(i2s_port_t port);
+int i2s_set_pin(i2s_port_t port, const i2s_pin_config_t *pins);
+int i2s_set_clk(i2s_port_t port, uint32_t rate, i2s_bits_per_sample_t bits, i2s_channel_t channels);
+int i2s_set_sample_rates(i2s_port_t port, uint32_t rate);
+int i2s_zero_dma_buffer(i2s_port_t port);
+int i2s_write(i2s_port_t port, const void *data, size_t size, size_t *written, uint32_t ticksToWait);
+
+#endif
@@ -0,0 +1,59 @@
+/*!
+ * @file  esp_a2dp_api.h
+ * @brief  The A2DP API of Bluedroid for the host stubs, the tests call the callbacks with their own events
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_ESP_A2DP_API_H__
+#define __HOST_ESP_A2DP_API_H__
+
+#include <stdint.h>
+
+typedef uint8_t esp_bd_addr_t[6];
+
+typedef enum {
+  ESP_A2D_CONNECTION_STATE_EVT = 0,
+  ESP_A2D_AUDIO_STATE_EVT,
+  ESP_A2D_AUDIO_CFG_EVT,
+  ESP_A2D_MEDIA_CTRL_ACK_EVT,
+  ESP_A2D_PROF_STATE_EVT,
+}esp_a2d_cb_event_t;
+
+#define ESP_A2D_MCT_SBC   (0)
+
+typedef struct
+{
+  uint8_t type;
+  union {
+    uint8_t sbc[4];
+  }cie;
+}esp_a2d_mcc_t;
+
+typedef union {
+  struct {
+    int state;
+    esp_bd_addr_t remote_bda;
+  }conn_stat;
+  struct {
+    int state;
+    esp_bd_addr_t remote_bda;
+  }audio_stat;
+  struct {
+    esp_bd_addr_t remote_bda;
+    esp_a2d_mcc_t mcc;
+  }audio_cfg;
+}esp_a2d_cb_param_t;
+
+typedef void (*esp_a2d_cb_t)(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param);
+typedef void (*esp_a2d_sink_data_cb_t)(const uint8_t *data, uint32_t len);
+
+int esp_a2d_sink_init(void);
+int esp_a2d_sink_deinit(void);
+int esp_a2d_register_callback(esp_a2d_cb_t callback);
+int esp_a2d_sink_register_data_callback(esp_a2d_sink_data_cb_t callback);
+
+#endif
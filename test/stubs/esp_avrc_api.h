@@ -0,0 +1,72 @@
+/*!
+ * @file  esp_avrc_api.h
+ * @brief  The AVRC controller API of Bluedroid for the host stubs, the tests call the callback with their own events
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_ESP_AVRC_API_H__
+#define __HOST_ESP_AVRC_API_H__
+
+#include <stdint.h>
+
+typedef enum {
+  ESP_AVRC_CT_CONNECTION_STATE_EVT = 0,
+  ESP_AVRC_CT_PASSTHROUGH_RSP_EVT,
+  ESP_AVRC_CT_METADATA_RSP_EVT,
+  ESP_AVRC_CT_PLAY_STATUS_RSP_EVT,
+  ESP_AVRC_CT_CHANGE_NOTIFY_EVT,
+  ESP_AVRC_CT_REMOTE_FEATURES_EVT,
+  ESP_AVRC_CT_GET_RN_CAPABILITIES_RSP_EVT,
+  ESP_AVRC_CT_SET_ABSOLUTE_VOLUME_RSP_EVT,
+}esp_avrc_ct_cb_event_t;
+
+#define ESP_AVRC_MD_ATTR_TITLE   0x1
+#define ESP_AVRC_MD_ATTR_ARTIST   0x2
+#define ESP_AVRC_MD_ATTR_ALBUM   0x4
+#define ESP_AVRC_MD_ATTR_TRACK_NUM   0x8
+#define ESP_AVRC_MD_ATTR_NUM_TRACKS   0x10
+#define ESP_AVRC_MD_ATTR_GENRE   0x20
+#define ESP_AVRC_MD_ATTR_PLAYING_TIME   0x40
+
+#define ESP_AVRC_RN_PLAY_STATUS_CHANGE   0x01
+#define ESP_AVRC_RN_TRACK_CHANGE   0x02
+
+typedef union {
+  uint8_t elm_id[8];
+  uint32_t playback;
+}esp_avrc_rn_param_t;
+
+typedef union {
+  struct {
+    bool connected;
+    uint8_t remote_bda[6];
+  }conn_stat;
+  struct {
+    uint8_t attr_id;
+    uint8_t *attr_text;
+    int attr_length;
+  }meta_rsp;
+  struct {
+    uint8_t event_id;
+    esp_avrc_rn_param_t event_parameter;
+  }change_ntf;
+  struct {
+    uint32_t feat_mask;
+    uint16_t tg_feat_flag;
+  }rmt_feats;
+}esp_avrc_ct_cb_param_t;
+
+typedef void (*esp_avrc_ct_cb_t)(esp_avrc_ct_cb_event_t event, esp_avrc_ct_cb_param_t *param);
+
+int esp_avrc_ct_init(void);
+int esp_avrc_ct_deinit(void);
+int esp_avrc_ct_register_callback(esp_avrc_ct_cb_t callback);
+int esp_avrc_ct_send_metadata_cmd(uint8_t tl, uint8_t attrMask);
+int esp_avrc_ct_send_register_notification_cmd(uint8_t tl, uint8_t eventId, uint32_t interval);
+int esp_avrc_ct_send_passthrough_cmd(uint8_t tl, uint8_t keyCode, uint8_t keyState);
+
+#endif
@@ -0,0 +1,16 @@
+/*!
+ * @file  esp_bt_device.h
+ * @brief  The Bluetooth device API for the host stubs
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_ESP_BT_DEVICE_H__
+#define __HOST_ESP_BT_DEVICE_H__
+
+int esp_bt_dev_set_device_name(const char *name);
+
+#endif
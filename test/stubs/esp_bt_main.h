@@ -0,0 +1,26 @@
+/*!
+ * @file  esp_bt_main.h
+ * @brief  The Bluedroid main API for the host stubs, the stack is always enabled
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_ESP_BT_MAIN_H__
+#define __HOST_ESP_BT_MAIN_H__
+
+typedef enum {
+  ESP_BLUEDROID_STATUS_UNINITIALIZED = 0,
+  ESP_BLUEDROID_STATUS_INITIALIZED,
+  ESP_BLUEDROID_STATUS_ENABLED,
+}esp_bluedroid_status_t;
+
+esp_bluedroid_status_t esp_bluedroid_get_status(void);
+int esp_bluedroid_init(void);
+int esp_bluedroid_enable(void);
+int esp_bluedroid_disable(void);
+int esp_bluedroid_deinit(void);
+
+#endif
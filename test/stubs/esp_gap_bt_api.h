@@ -0,0 +1,22 @@
+/*!
+ * @file  esp_gap_bt_api.h
+ * @brief  The classic Bluetooth GAP API for the host stubs
+ * @copyright  Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @license  The MIT License (MIT)
+ * @author  [qsjhyy](yihuan.huang@dfrobot.com)
+ * @version  V1.0
+ * @date  2026-10-16
+ * @url  https://github.com/DFRobot/DFRobot_MAX98357A
+ */
+#ifndef __HOST_ESP_GAP_BT_API_H__
+#define __HOST_ESP_GAP_BT_API_H__
+
+#define ESP_BT_NON_CONNECTABLE   0
+#define ESP_BT_CONNECTABLE   1
+#define ESP_BT_NON_DISCOVERABLE   0
+#define ESP_BT_LIMITED_DISCOVERABLE   1
+#define ESP_BT_GENERAL_DISCOVERABLE   2
+
+int esp_bt_gap_set_scan_mode(int connectable, int discoverable);
+
+#endif